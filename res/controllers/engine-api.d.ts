@@ -184,6 +184,51 @@ declare namespace engine {
      */
     function getParameterForValue(group: string, name: string, value: number): number;
 
+    /**
+     * Resolves a control once for the *ByHandle functions, which are faster
+     * than their counterparts taking the group and name, e.g. for controls
+     * that are read or written on every incoming message.
+     *
+     * @param group Group of the control e.g. "[Channel1]"
+     * @param name Name of the control e.g. "play_indicator"
+     * @returns Handle of the control or -1 if the control does not exist
+     */
+    function getControlHandle(group: string, name: string): number;
+
+    /**
+     * Gets the value of a control resolved with getControlHandle
+     *
+     * @param handle Handle returned by getControlHandle
+     * @returns Value of the control
+     */
+    function getValueByHandle(handle: number): number;
+
+    /**
+     * Sets the value of a control resolved with getControlHandle
+     *
+     * @param handle Handle returned by getControlHandle
+     * @param newValue Value to be set
+     */
+    function setValueByHandle(handle: number, newValue: number): void;
+
+    /**
+     * Gets the value of a control resolved with getControlHandle,
+     * normalized to a range of 0..1
+     *
+     * @param handle Handle returned by getControlHandle
+     * @returns Value of the control normalized to range of 0..1
+     */
+    function getParameterByHandle(handle: number): number;
+
+    /**
+     * Sets the value of a control resolved with getControlHandle,
+     * specified with normalized range of 0..1
+     *
+     * @param handle Handle returned by getControlHandle
+     * @param newValue Value to be set, normalized to a range of 0..1
+     */
+    function setParameterByHandle(handle: number, newValue: number): void;
+
     /**
      * Resets the control to its default value
      *
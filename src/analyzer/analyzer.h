@@ -1,9 +1,14 @@
 #pragma once
 
+#include <QString>
+#include <utility>
+
 #include "analyzer/analyzertrack.h"
 #include "audio/signalinfo.h"
 #include "audio/types.h"
 #include "util/assert.h"
+#include "util/duration.h"
+#include "util/threadcputime.h"
 #include "util/types.h"
 
 /*
@@ -50,8 +55,14 @@ typedef std::unique_ptr<Analyzer> AnalyzerPtr;
 
 class AnalyzerWithState final {
   public:
-    explicit AnalyzerWithState(AnalyzerPtr analyzer)
+    // The CPU time is only measured on demand, because querying the
+    // clock of the thread twice per chunk is not free.
+    explicit AnalyzerWithState(AnalyzerPtr analyzer,
+            QString name = QString(),
+            bool measureCpuTime = false)
             : m_analyzer(std::move(analyzer)),
+              m_name(std::move(name)),
+              m_measureCpuTime(measureCpuTime),
               m_active(false) {
         DEBUG_ASSERT(m_analyzer);
     }
@@ -67,30 +78,51 @@ class AnalyzerWithState final {
         return m_active;
     }
 
+    const QString& name() const {
+        return m_name;
+    }
+
+    bool isMeasuringCpuTime() const {
+        return m_measureCpuTime;
+    }
+
+    // Returns the CPU time spent in the analyzer since the previous
+    // invocation and resets it.
+    mixxx::Duration takeCpuTime() {
+        return std::exchange(m_cpuTime, mixxx::Duration::empty());
+    }
+
     bool initialize(const AnalyzerTrack& track,
             mixxx::audio::SampleRate sampleRate,
             mixxx::audio::ChannelCount channelCount,
             SINT frameLength) {
         DEBUG_ASSERT(!m_active);
-        return m_active = m_analyzer->initialize(track, sampleRate, channelCount, frameLength);
+        const auto startTime = startCpuTime();
+        m_active = m_analyzer->initialize(track, sampleRate, channelCount, frameLength);
+        stopCpuTime(startTime);
+        return m_active;
     }
 
     void processSamples(const CSAMPLE* pIn, const int count) {
         if (m_active) {
+            const auto startTime = startCpuTime();
             m_active = m_analyzer->processSamples(pIn, count);
             if (!m_active) {
                 // Ensure that cleanup() is invoked after processing
                 // failed and the analyzer became inactive!
                 m_analyzer->cleanup();
             }
+            stopCpuTime(startTime);
         }
     }
 
     void finish(const AnalyzerTrack& track) {
         if (m_active) {
+            const auto startTime = startCpuTime();
             m_analyzer->storeResults(track.getTrack());
             m_analyzer->cleanup();
             m_active = false;
+            stopCpuTime(startTime);
         }
     }
 
@@ -102,6 +134,20 @@ class AnalyzerWithState final {
     }
 
   private:
+    mixxx::Duration startCpuTime() const {
+        return m_measureCpuTime ? mixxx::threadCpuTime() : mixxx::Duration::empty();
+    }
+
+    void stopCpuTime(mixxx::Duration startTime) {
+        if (m_measureCpuTime) {
+            m_cpuTime += mixxx::threadCpuTime() - startTime;
+        }
+    }
+
     AnalyzerPtr m_analyzer;
+    QString m_name;
+    bool m_measureCpuTime;
     bool m_active;
+    // Accumulated from the threads that invoked the analyzer
+    mixxx::Duration m_cpuTime;
 };
@@ -0,0 +1,129 @@
+#include "analyzer/analyzerpipeline.h"
+
+#include <QtConcurrentRun>
+#include <algorithm>
+
+#include "util/assert.h"
+#include "util/compatibility/qmutex.h"
+
+AnalyzerPipeline::AnalyzerPipeline(SINT samplesPerChunk)
+        : m_writeIndex(0),
+          m_endOfStream(false),
+          m_cancelled(false) {
+    for (auto& chunk : m_chunks) {
+        mixxx::SampleBuffer(samplesPerChunk).swap(chunk.buffer);
+    }
+}
+
+AnalyzerPipeline::~AnalyzerPipeline() {
+    VERIFY_OR_DEBUG_ASSERT(!isRunning()) {
+        cancel();
+    }
+}
+
+void AnalyzerPipeline::start(const std::vector<AnalyzerWithState*>& analyzers) {
+    DEBUG_ASSERT(!isRunning());
+    {
+        const auto locker = lockMutex(&m_mutex);
+        m_writeIndex = 0;
+        m_endOfStream = false;
+        m_cancelled = false;
+        for (auto& chunk : m_chunks) {
+            chunk.pData = nullptr;
+            chunk.count = 0;
+            chunk.pendingStages = 0;
+        }
+    }
+    const auto activeAnalyzers = std::count_if(analyzers.cbegin(),
+            analyzers.cend(),
+            [](const AnalyzerWithState* pAnalyzer) {
+                return pAnalyzer->isActive();
+            });
+    m_threadPool.setMaxThreadCount(std::max(static_cast<int>(activeAnalyzers), 1));
+    m_stages.reserve(activeAnalyzers);
+    for (auto* pAnalyzer : analyzers) {
+        if (!pAnalyzer->isActive()) {
+            continue;
+        }
+        m_stages.push_back(QtConcurrent::run(&m_threadPool, [this, pAnalyzer] {
+            runStage(pAnalyzer);
+        }));
+    }
+}
+
+AnalyzerPipeline::Chunk* AnalyzerPipeline::waitForFreeChunk() {
+    Chunk* pChunk = &m_chunks[m_writeIndex % kDepth];
+    while (pChunk->pendingStages > 0) {
+        m_chunkReleased.wait(&m_mutex);
+    }
+    return pChunk;
+}
+
+mixxx::SampleBuffer::WritableSlice AnalyzerPipeline::nextChunkBuffer() {
+    DEBUG_ASSERT(isRunning());
+    const auto locker = lockMutex(&m_mutex);
+    return mixxx::SampleBuffer::WritableSlice(waitForFreeChunk()->buffer);
+}
+
+void AnalyzerPipeline::publishChunk(const CSAMPLE* pData, SINT count) {
+    DEBUG_ASSERT(isRunning());
+    const auto locker = lockMutex(&m_mutex);
+    DEBUG_ASSERT(!m_endOfStream);
+    Chunk* pChunk = waitForFreeChunk();
+    pChunk->pData = pData;
+    pChunk->count = count;
+    pChunk->pendingStages = static_cast<int>(m_stages.size());
+    ++m_writeIndex;
+    m_chunkPublished.wakeAll();
+}
+
+void AnalyzerPipeline::runStage(AnalyzerWithState* pAnalyzer) {
+    quint64 readIndex = 0;
+    while (true) {
+        Chunk* pChunk;
+        {
+            const auto locker = lockMutex(&m_mutex);
+            while (readIndex == m_writeIndex && !m_endOfStream && !m_cancelled) {
+                m_chunkPublished.wait(&m_mutex);
+            }
+            if (m_cancelled || readIndex == m_writeIndex) {
+                return;
+            }
+            pChunk = &m_chunks[readIndex % kDepth];
+        }
+        // Inactive analyzers have failed, but still need to release
+        // the chunks for the others
+        if (pAnalyzer->isActive()) {
+            pAnalyzer->processSamples(pChunk->pData, pChunk->count);
+        }
+        {
+            const auto locker = lockMutex(&m_mutex);
+            DEBUG_ASSERT(pChunk->pendingStages > 0);
+            if (--pChunk->pendingStages == 0) {
+                m_chunkReleased.wakeAll();
+            }
+        }
+        ++readIndex;
+    }
+}
+
+void AnalyzerPipeline::stop(bool cancelled) {
+    {
+        const auto locker = lockMutex(&m_mutex);
+        m_endOfStream = true;
+        m_cancelled = cancelled;
+        m_chunkPublished.wakeAll();
+    }
+    for (auto& stage : m_stages) {
+        stage.waitForFinished();
+    }
+    m_stages.clear();
+}
+
+void AnalyzerPipeline::finish() {
+    stop(false);
+}
+
+void AnalyzerPipeline::cancel() {
+    stop(true);
+}
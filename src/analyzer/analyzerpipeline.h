@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QFuture>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <array>
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+/// Runs the analyzers of a single track concurrently, each analyzer on its
+/// own thread, while the next chunks of audio data are decoded by the
+/// calling thread.
+///
+/// The decoded chunks are shared read-only by all analyzers through a ring
+/// of kDepth buffers. A buffer is reused after all analyzers have processed
+/// its chunk, so decoding is at most kDepth chunks ahead of the slowest
+/// analyzer. Each analyzer receives the chunks in order, exactly like from
+/// the serial loop in AnalyzerThread.
+///
+/// initialize(), finish() and cancel() of the analyzers must be invoked by
+/// the calling thread before start() and after finish() or cancel() of the
+/// pipeline.
+class AnalyzerPipeline {
+  public:
+    static constexpr int kDepth = 8;
+
+    explicit AnalyzerPipeline(SINT samplesPerChunk);
+    ~AnalyzerPipeline();
+
+    AnalyzerPipeline(const AnalyzerPipeline&) = delete;
+    AnalyzerPipeline& operator=(const AnalyzerPipeline&) = delete;
+
+    bool isRunning() const {
+        return !m_stages.empty();
+    }
+
+    /// Starts a thread for each active analyzer.
+    void start(const std::vector<AnalyzerWithState*>& analyzers);
+
+    /// Blocks until the buffer for the next chunk is no longer used by any
+    /// analyzer and returns it.
+    mixxx::SampleBuffer::WritableSlice nextChunkBuffer();
+
+    /// Hands the next chunk over to all analyzers. The data must either be
+    /// stored in the buffer returned by nextChunkBuffer() or outlive the
+    /// pipeline. Blocks while all buffers are in use.
+    void publishChunk(const CSAMPLE* pData, SINT count);
+
+    /// Blocks until all analyzers have processed all published chunks.
+    void finish();
+
+    /// Stops all analyzers after the chunk they are processing.
+    void cancel();
+
+  private:
+    struct Chunk {
+        mixxx::SampleBuffer buffer;
+        const CSAMPLE* pData = nullptr;
+        SINT count = 0;
+        // The number of analyzers that have not processed the chunk yet
+        int pendingStages = 0;
+    };
+
+    void runStage(AnalyzerWithState* pAnalyzer);
+    // Waits until the next chunk is free, the mutex must be locked
+    Chunk* waitForFreeChunk();
+    void stop(bool cancelled);
+
+    QMutex m_mutex;
+    QWaitCondition m_chunkPublished;
+    QWaitCondition m_chunkReleased;
+
+    std::array<Chunk, kDepth> m_chunks;
+    // The total number of published chunks
+    quint64 m_writeIndex;
+    bool m_endOfStream;
+    bool m_cancelled;
+
+    QThreadPool m_threadPool;
+    std::vector<QFuture<void>> m_stages;
+};
@@ -1,5 +1,6 @@
 #include "analyzer/analyzerthread.h"
 
+#include <QMutex>
 #include <mutex>
 
 #include "analyzer/analyzerbeats.h"
@@ -14,6 +15,7 @@
 #include "sources/audiosourcestereoproxy.h"
 #include "sources/soundsourceproxy.h"
 #include "track/track.h"
+#include "util/compatibility/qmutex.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/db/dbconnectionpooler.h"
 #include "util/logger.h"
@@ -40,6 +42,10 @@ void deleteAnalyzerThread(AnalyzerThread* plainPtr) {
     }
 }
 
+// Accumulated by all analyzer threads of the process
+QMutex s_analyzerCpuTimesMutex;
+QMap<QString, mixxx::Duration> s_analyzerCpuTimes;
+
 std::once_flag registerMetaTypesOnceFlag;
 
 void registerMetaTypesOnce() {
@@ -92,6 +98,7 @@ void AnalyzerThread::doRun() {
     // The thread-local database connection  must not be closed
     // before returning from this function.
     mixxx::DbConnectionPooler dbConnectionPooler;
+    const bool measureCpuTime = (m_modeFlags & AnalyzerModeFlags::MeasureCpuTime) != 0;
 
     if (m_modeFlags & AnalyzerModeFlags::WithWaveform) {
         dbConnectionPooler = mixxx::DbConnectionPooler(m_dbConnectionPool); // move assignment
@@ -101,35 +108,66 @@ void AnalyzerThread::doRun() {
             return;
         }
         QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_dbConnectionPool);
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerWaveform>(m_pConfig, dbConnection)));
+        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerWaveform>(m_pConfig, dbConnection),
+                QStringLiteral("waveform"),
+                measureCpuTime));
     }
     if (AnalyzerGain::isEnabled(ReplayGainSettings(m_pConfig))) {
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerGain>(m_pConfig)));
+        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerGain>(m_pConfig),
+                QStringLiteral("gain"),
+                measureCpuTime));
     }
     if (AnalyzerEbur128::isEnabled(ReplayGainSettings(m_pConfig))) {
-        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerEbur128>(m_pConfig)));
+        m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerEbur128>(m_pConfig),
+                QStringLiteral("ebur128"),
+                measureCpuTime));
     }
     // BPM detection might be disabled in the config, but can be overridden
     // and enabled by explicitly setting the mode flag.
     const bool enforceBpmDetection = (m_modeFlags & AnalyzerModeFlags::WithBeats) != 0;
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerBeats>(m_pConfig, enforceBpmDetection)));
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerKey>(m_pConfig)));
-    m_analyzers.push_back(AnalyzerWithState(std::make_unique<AnalyzerSilence>(m_pConfig)));
+    m_analyzers.push_back(AnalyzerWithState(
+            std::make_unique<AnalyzerBeats>(m_pConfig, enforceBpmDetection),
+            QStringLiteral("beats"),
+            measureCpuTime));
+    m_analyzers.push_back(AnalyzerWithState(
+            std::make_unique<AnalyzerKey>(m_pConfig),
+            QStringLiteral("key"),
+            measureCpuTime));
+    m_analyzers.push_back(AnalyzerWithState(
+            std::make_unique<AnalyzerSilence>(m_pConfig),
+            QStringLiteral("silence"),
+            measureCpuTime));
     DEBUG_ASSERT(!m_analyzers.empty());
     kLogger.debug() << "Activated" << m_analyzers.size() << "analyzers";
 
+    if (m_modeFlags & AnalyzerModeFlags::Pipelined) {
+        m_pPipeline = std::make_unique<AnalyzerPipeline>(mixxx::kAnalysisSamplesPerChunk);
+    }
+
     m_lastBusyProgressEmittedTimer.start();
 
     mixxx::AudioSource::OpenParams openParams;
     openParams.setChannelCount(mixxx::kAnalysisMaxChannels);
 
+    // Tracks that have been decoded before are read from the cache,
+    // all other tracks are stored in the cache while analyzing them.
+    const auto pDecodedAudioCache = mixxx::DecodedAudioCache::create(m_pConfig);
+
     while (awaitWorkItemsFetched()) {
         DEBUG_ASSERT(m_currentTrack.has_value());
         kLogger.debug() << "Analyzing" << m_currentTrack->getTrack()->getLocation();
 
         // Get the audio
-        mixxx::AudioSourcePointer audioSource =
-                SoundSourceProxy(m_currentTrack->getTrack()).openAudioSource(openParams);
+        mixxx::AudioSourcePointer audioSource;
+        if (pDecodedAudioCache) {
+            audioSource = pDecodedAudioCache->openAudioSource(
+                    m_currentTrack->getTrack(), openParams);
+        }
+        const bool decodeAudioSource = !audioSource;
+        if (decodeAudioSource) {
+            audioSource = SoundSourceProxy(m_currentTrack->getTrack())
+                                  .openAudioSource(openParams);
+        }
         if (!audioSource) {
             kLogger.warning()
                     << "Failed to open file for analyzing:"
@@ -158,9 +196,38 @@ void AnalyzerThread::doRun() {
         }
 
         if (processTrack) {
-            const auto analysisResult = analyzeAudioSource(audioSource);
+            std::unique_ptr<mixxx::DecodedAudioCacheWriter> pDecodedAudioCacheWriter;
+            if (pDecodedAudioCache && decodeAudioSource) {
+                pDecodedAudioCacheWriter = pDecodedAudioCache->createWriter(
+                        m_currentTrack->getTrack(),
+                        openParams,
+                        audioSource->getSignalInfo(),
+                        audioSource->getBitrate(),
+                        audioSource->frameIndexRange());
+            }
+            if (m_pPipeline) {
+                std::vector<AnalyzerWithState*> analyzers;
+                analyzers.reserve(m_analyzers.size());
+                for (auto&& analyzer : m_analyzers) {
+                    analyzers.push_back(&analyzer);
+                }
+                m_pPipeline->start(analyzers);
+            }
+            const auto analysisResult = analyzeAudioSource(
+                    audioSource, pDecodedAudioCacheWriter.get());
             DEBUG_ASSERT(analysisResult != AnalysisResult::Pending);
+            if (m_pPipeline) {
+                if (analysisResult == AnalysisResult::Finished) {
+                    m_pPipeline->finish();
+                } else {
+                    m_pPipeline->cancel();
+                }
+            }
             if (analysisResult == AnalysisResult::Finished) {
+                if (pDecodedAudioCacheWriter) {
+                    // Partially decoded tracks are not cached
+                    pDecodedAudioCacheWriter->commit();
+                }
                 // The analysis has been finished, and is either complete without
                 // any errors or partial if it has been aborted due to a corrupt
                 // audio file. In both cases don't reanalyze tracks during this
@@ -183,16 +250,33 @@ void AnalyzerThread::doRun() {
             kLogger.debug() << "Skipping track analysis because no analyzer initialized.";
             emitDoneProgress(kAnalyzerProgressDone);
         }
+        accumulateCpuTimes();
     }
     DEBUG_ASSERT(!m_currentTrack);
     DEBUG_ASSERT(isStopping());
 
+    m_pPipeline.reset();
     m_analyzers.clear();
 
     kLogger.debug() << "Exiting worker thread";
     emitProgress(AnalyzerThreadState::Exit);
 }
 
+void AnalyzerThread::accumulateCpuTimes() {
+    const auto locker = lockMutex(&s_analyzerCpuTimesMutex);
+    for (auto&& analyzer : m_analyzers) {
+        if (analyzer.isMeasuringCpuTime()) {
+            s_analyzerCpuTimes[analyzer.name()] += analyzer.takeCpuTime();
+        }
+    }
+}
+
+// static
+QMap<QString, mixxx::Duration> AnalyzerThread::analyzerCpuTimes() {
+    const auto locker = lockMutex(&s_analyzerCpuTimesMutex);
+    return s_analyzerCpuTimes;
+}
+
 bool AnalyzerThread::submitNextTrack(const AnalyzerTrack& nextTrack) {
     kLogger.debug()
             << "Enqueueing next track"
@@ -225,12 +309,21 @@ WorkerThread::TryFetchWorkItemsResult AnalyzerThread::tryFetchWorkItems() {
 }
 
 AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
-        const mixxx::AudioSourcePointer& audioSource) {
+        const mixxx::AudioSourcePointer& audioSource,
+        mixxx::DecodedAudioCacheWriter* pDecodedAudioCacheWriter) {
     DEBUG_ASSERT(m_currentTrack.has_value());
 
     DEBUG_ASSERT(
             0 == audioSource->getSignalInfo().getChannelCount() % mixxx::kAnalysisChannels);
 
+    // Cached audio data is analyzed in place without copying it
+    mixxx::MappedSampleFramesPointer pMappedSampleFrames;
+    const auto pCachedAudioSource =
+            std::dynamic_pointer_cast<mixxx::AudioSourceDecodedCache>(audioSource);
+    if (pCachedAudioSource) {
+        pMappedSampleFrames = pCachedAudioSource->mappedSampleFrames();
+    }
+
     // Analysis starts now
     emitBusyProgress(kAnalyzerProgressNone);
 
@@ -249,12 +342,19 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
                         math_min(mixxx::kAnalysisFramesPerChunk, remainingFrameRange.length()));
         DEBUG_ASSERT(!chunkFrameRange.empty());
 
-        // Request the next chunk of audio data
-        const auto readableSampleFrames =
-                audioSource->readSampleFrames(
-                        mixxx::WritableSampleFrames(
-                                chunkFrameRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
+        // Request the next chunk of audio data. In pipelined mode it is
+        // decoded into the next free buffer of the pipeline.
+        mixxx::ReadableSampleFrames readableSampleFrames;
+        if (pMappedSampleFrames) {
+            readableSampleFrames = pMappedSampleFrames->readableSampleFrames(chunkFrameRange);
+        } else {
+            readableSampleFrames = audioSource->readSampleFrames(
+                    mixxx::WritableSampleFrames(chunkFrameRange,
+                            m_pPipeline
+                                    ? m_pPipeline->nextChunkBuffer()
+                                    : mixxx::SampleBuffer::WritableSlice(
+                                              m_sampleBuffer)));
+        }
         // The returned range fits into the requested range
         DEBUG_ASSERT(readableSampleFrames.frameIndexRange().isSubrangeOf(chunkFrameRange));
 
@@ -297,12 +397,23 @@ AnalyzerThread::AnalysisResult AnalyzerThread::analyzeAudioSource(
             return AnalysisResult::Cancelled;
         }
 
+        if (pDecodedAudioCacheWriter) {
+            // Writing stops silently after gaps in the decoded frames
+            pDecodedAudioCacheWriter->write(readableSampleFrames);
+        }
+
         // 2nd: step: Analyze chunk of decoded audio data
         if (!readableSampleFrames.frameIndexRange().empty()) {
-            for (auto&& analyzer : m_analyzers) {
-                analyzer.processSamples(
+            if (m_pPipeline) {
+                m_pPipeline->publishChunk(
                         readableSampleFrames.readableData(),
                         readableSampleFrames.readableLength());
+            } else {
+                for (auto&& analyzer : m_analyzers) {
+                    analyzer.processSamples(
+                            readableSampleFrames.readableData(),
+                            readableSampleFrames.readableLength());
+                }
             }
         }
 
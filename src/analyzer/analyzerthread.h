@@ -1,18 +1,23 @@
 #pragma once
 
+#include <QMap>
+#include <QString>
 #include <memory>
 #include <optional>
 #include <vector>
 
 #include "analyzer/analyzer.h"
+#include "analyzer/analyzerpipeline.h"
 #include "analyzer/analyzerprogress.h"
 #include "analyzer/analyzertrack.h"
 #include "preferences/usersettings.h"
 #include "rigtorp/SPSCQueue.h"
 #include "sources/audiosource.h"
+#include "sources/decodedaudiocache.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
 #include "util/db/dbconnectionpool.h"
+#include "util/duration.h"
 #include "util/performancetimer.h"
 #include "util/samplebuffer.h"
 #include "util/workerthread.h"
@@ -22,6 +27,10 @@ enum AnalyzerModeFlags {
     WithBeats = 0x01,
     WithWaveform = 0x02,
     LowPriority = 0x04,
+    // Run the analyzers of a track concurrently, see AnalyzerPipeline
+    Pipelined = 0x08,
+    // Measure the CPU time of each analyzer, see analyzerCpuTimes()
+    MeasureCpuTime = 0x10,
     All = WithBeats | WithWaveform,
 };
 
@@ -79,6 +88,11 @@ class AnalyzerThread : public WorkerThread {
     // worker thread, yet.
     bool submitNextTrack(const AnalyzerTrack& nextTrack);
 
+    // The CPU time consumed by each analyzer, accumulated over all
+    // analyzer threads with AnalyzerModeFlags::MeasureCpuTime since
+    // the start of the process.
+    static QMap<QString, mixxx::Duration> analyzerCpuTimes();
+
   signals:
     // Use a single signal for progress updates to ensure that all signals
     // are queued and received in the same order as emitted from the internal
@@ -120,6 +134,9 @@ class AnalyzerThread : public WorkerThread {
 
     mixxx::SampleBuffer m_sampleBuffer;
 
+    // Only used in pipelined mode
+    std::unique_ptr<AnalyzerPipeline> m_pPipeline;
+
     std::optional<AnalyzerTrack> m_currentTrack;
 
     AnalyzerThreadState m_emittedState;
@@ -131,8 +148,14 @@ class AnalyzerThread : public WorkerThread {
         Finished,
         Cancelled,
     };
+    // The decoded audio data is written into the cache if a
+    // writer is provided.
     AnalysisResult analyzeAudioSource(
-            const mixxx::AudioSourcePointer& audioSource);
+            const mixxx::AudioSourcePointer& audioSource,
+            mixxx::DecodedAudioCacheWriter* pDecodedAudioCacheWriter);
+
+    // Adds the CPU time of the analyzers to analyzerCpuTimes()
+    void accumulateCpuTimes();
 
     // Blocks the worker thread until a next track becomes available
     TrackPointer receiveNextTrack();
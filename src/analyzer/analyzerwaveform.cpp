@@ -126,6 +126,7 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer pTrack) const {
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveform = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
+                    m_analysisDao.upgradeWaveformAnalysis(analysis, *pLoadedTrackWaveform);
                     missingWaveform = false;
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
@@ -137,6 +138,8 @@ bool AnalyzerWaveform::shouldAnalyze(TrackPointer pTrack) const {
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveformSummary = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
+                    m_analysisDao.upgradeWaveformAnalysis(
+                            analysis, *pLoadedTrackWaveformSummary);
                     missingWavesummary = false;
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
@@ -1,5 +1,9 @@
 #include "control/control.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include "control/controlobject.h"
 #include "moc_control.cpp"
 #include "util/mutex.h"
@@ -25,11 +29,51 @@ constexpr Stat::ComputeFlags kComputeFlags = {Stat::COUNT,
         Stat::MIN,
         Stat::MAX};
 
-/// Mutex guarding access to s_qCOHash and s_qCOAliasHash.
+/// An immutable entry of a control slot. Entries are replaced instead of
+/// modified, so lock-free readers always see a consistent entry. Replaced
+/// entries are retired and only deleted in takeAllInstances().
+struct ControlEntry {
+    QWeakPointer<ControlDoublePrivate> pControl;
+};
+
+/// The slots of the registry are allocated in chunks that never move,
+/// the index of a slot is the index of the ControlHandle.
+constexpr int kSlotsPerChunk = 1024;
+constexpr int kMaxChunks = 256;
+
+struct ControlSlotChunk {
+    std::atomic<const ControlEntry*> slots[kSlotsPerChunk] = {};
+};
+
+/// Lock-free readable list of chunks, only ever appended.
+std::atomic<ControlSlotChunk*> s_slotChunks[kMaxChunks] = {};
+
+/// An immutable copy of s_controlHandles for lock-free lookups by
+/// ConfigKey. The assigned handles never change, so a snapshot can only
+/// lack the most recent keys, which are then looked up with the mutex
+/// locked.
+typedef QHash<ConfigKey, int> ControlHandleSnapshot;
+std::atomic<const ControlHandleSnapshot*> s_pHandleSnapshot = nullptr;
+
+/// A new snapshot is only published after this many keys have been added
+/// or a quarter of the size of the snapshot, whichever is more. This keeps
+/// the copying linear in the total number of keys.
+constexpr int kMinSnapshotGrowth = 16;
+
+/// Mutex guarding the modification of the registry and access to
+/// s_controlHandles and s_qCOAliasHash.
 MMutex s_qCOHashMutex;
 
-/// Hash of ControlDoublePrivate instantiations.
-QHash<ConfigKey, QWeakPointer<ControlDoublePrivate>> s_qCOHash
+/// Handles of all ConfigKeys that have been resolved so far, including
+/// aliases.
+QHash<ConfigKey, int> s_controlHandles
+        GUARDED_BY(s_qCOHashMutex);
+
+/// Entries and snapshots that have been replaced and may still be read by
+/// lock-free readers.
+std::vector<const ControlEntry*> s_retiredEntries
+        GUARDED_BY(s_qCOHashMutex);
+std::vector<const ControlHandleSnapshot*> s_retiredSnapshots
         GUARDED_BY(s_qCOHashMutex);
 
 /// Hash of aliases between ConfigKeys. Solely used for looking up the first
@@ -39,6 +83,87 @@ QHash<ConfigKey, ConfigKey> s_qCOAliasHash
 
 /// is used instead of a nullptr, helps to omit null checks everywhere
 QWeakPointer<ControlDoublePrivate> s_pDefaultCO;
+
+std::atomic<const ControlEntry*>* slotForHandle(ControlHandle handle) {
+    if (!handle.isValid() || handle.index() >= kMaxChunks * kSlotsPerChunk) {
+        return nullptr;
+    }
+    ControlSlotChunk* pChunk =
+            s_slotChunks[handle.index() / kSlotsPerChunk].load(std::memory_order_acquire);
+    if (!pChunk) {
+        return nullptr;
+    }
+    return &pChunk->slots[handle.index() % kSlotsPerChunk];
+}
+
+void publishSnapshotIfGrown() REQUIRES(s_qCOHashMutex) {
+    const ControlHandleSnapshot* pSnapshot =
+            s_pHandleSnapshot.load(std::memory_order_relaxed);
+    const int snapshotSize = pSnapshot ? static_cast<int>(pSnapshot->size()) : 0;
+    if (static_cast<int>(s_controlHandles.size()) - snapshotSize <
+            std::max(kMinSnapshotGrowth, snapshotSize / 4)) {
+        return;
+    }
+    // Implicitly shared until s_controlHandles is modified again
+    s_pHandleSnapshot.store(new ControlHandleSnapshot(s_controlHandles),
+            std::memory_order_release);
+    if (pSnapshot) {
+        s_retiredSnapshots.push_back(pSnapshot);
+    }
+}
+
+ControlHandle findHandle(const ConfigKey& key) {
+    const ControlHandleSnapshot* pSnapshot =
+            s_pHandleSnapshot.load(std::memory_order_acquire);
+    if (pSnapshot) {
+        const auto it = pSnapshot->constFind(key);
+        if (it != pSnapshot->constEnd()) {
+            return ControlHandle(it.value());
+        }
+    }
+    const MMutexLocker locker(&s_qCOHashMutex);
+    const auto it = s_controlHandles.constFind(key);
+    if (it == s_controlHandles.constEnd()) {
+        return ControlHandle();
+    }
+    const auto handle = ControlHandle(it.value());
+    publishSnapshotIfGrown();
+    return handle;
+}
+
+ControlHandle insertHandle(const ConfigKey& key) REQUIRES(s_qCOHashMutex) {
+    const auto it = s_controlHandles.constFind(key);
+    if (it != s_controlHandles.constEnd()) {
+        return ControlHandle(it.value());
+    }
+    const int index = static_cast<int>(s_controlHandles.size());
+    const int chunk = index / kSlotsPerChunk;
+    VERIFY_OR_DEBUG_ASSERT(chunk < kMaxChunks) {
+        qWarning() << "Too many controls, unable to register" << key;
+        return ControlHandle();
+    }
+    if (!s_slotChunks[chunk].load(std::memory_order_relaxed)) {
+        s_slotChunks[chunk].store(new ControlSlotChunk(), std::memory_order_release);
+    }
+    s_controlHandles.insert(key, index);
+    return ControlHandle(index);
+}
+
+void publishControl(ControlHandle handle,
+        const QSharedPointer<ControlDoublePrivate>& pControl)
+        REQUIRES(s_qCOHashMutex) {
+    auto* pSlot = slotForHandle(handle);
+    VERIFY_OR_DEBUG_ASSERT(pSlot) {
+        return;
+    }
+    const ControlEntry* pRetired = pSlot->exchange(
+            pControl ? new ControlEntry{pControl} : nullptr,
+            std::memory_order_acq_rel);
+    if (pRetired) {
+        s_retiredEntries.push_back(pRetired);
+    }
+}
+
 } // namespace
 
 // TODO: re-evaluate whether this is needed.
@@ -80,11 +205,8 @@ ControlDoublePrivate::ControlDoublePrivate(
 }
 
 ControlDoublePrivate::~ControlDoublePrivate() {
-    s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
-    s_qCOHash.remove(m_key);
-    s_qCOHashMutex.unlock();
-
+    // The entry in the registry expires with the last shared pointer and
+    // is replaced when the control is created again
     if (m_bPersistInConfiguration) {
         UserSettingsPointer pConfig = s_pUserConfig;
         VERIFY_OR_DEBUG_ASSERT(pConfig) {
@@ -108,20 +230,27 @@ void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey&
         return;
     }
 
-    auto it = s_qCOHash.constFind(key);
-    VERIFY_OR_DEBUG_ASSERT(it != s_qCOHash.constEnd()) {
+    const auto it = s_controlHandles.constFind(key);
+    VERIFY_OR_DEBUG_ASSERT(it != s_controlHandles.constEnd()) {
         qWarning() << "cannot create alias for null control" << key;
         return;
     }
 
-    QSharedPointer<ControlDoublePrivate> pControl = it.value();
+    QSharedPointer<ControlDoublePrivate> pControl = getControl(ControlHandle(it.value()));
     VERIFY_OR_DEBUG_ASSERT(!pControl.isNull()) {
         qWarning() << "cannot create alias for expired control" << key;
         return;
     }
 
     s_qCOAliasHash.insert(key, alias);
-    s_qCOHash.insert(alias, pControl);
+    const auto aliasIt = s_controlHandles.constFind(alias);
+    if (aliasIt == s_controlHandles.constEnd()) {
+        s_controlHandles.insert(alias, it.value());
+    } else if (aliasIt.value() != it.value()) {
+        // The alias has been resolved before, so both handles refer to
+        // the control
+        publishControl(ControlHandle(aliasIt.value()), pControl);
+    }
 }
 
 // static
@@ -142,42 +271,32 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
         return nullptr;
     }
 
-    // Scope for MMutexLocker.
-    {
-        const MMutexLocker locker(&s_qCOHashMutex);
-        const auto it = s_qCOHash.constFind(key);
-        if (it != s_qCOHash.constEnd()) {
-            auto pControl = it.value().lock();
-            if (pControl) {
-                auto actualKey = pControl->getKey();
-                if (actualKey != key) {
-                    qWarning()
-                            << "ControlObject accessed via deprecated key"
-                            << key.group << key.item
-                            << "- use"
-                            << actualKey.group << actualKey.item
-                            << "instead";
-                }
-
-                // Control object already exists
-                if (pCreatorCO) {
-                    qWarning()
-                            << "ControlObject"
-                            << key.group << key.item
-                            << "already created";
-                    DEBUG_ASSERT(!"pCreatorCO != nullptr, ControlObject already created");
-                    return nullptr;
-                }
-                return pControl;
-            } else {
-                // The weak pointer has become invalid and can be cleaned up
-                s_qCOHash.erase(it);
-            }
+    auto pControl = getControl(findHandle(key));
+    if (pControl) {
+        auto actualKey = pControl->getKey();
+        if (actualKey != key) {
+            qWarning()
+                    << "ControlObject accessed via deprecated key"
+                    << key.group << key.item
+                    << "- use"
+                    << actualKey.group << actualKey.item
+                    << "instead";
         }
+
+        // Control object already exists
+        if (pCreatorCO) {
+            qWarning()
+                    << "ControlObject"
+                    << key.group << key.item
+                    << "already created";
+            DEBUG_ASSERT(!"pCreatorCO != nullptr, ControlObject already created");
+            return nullptr;
+        }
+        return pControl;
     }
 
     if (pCreatorCO) {
-        auto pControl = QSharedPointer<ControlDoublePrivate>(
+        pControl = QSharedPointer<ControlDoublePrivate>(
                 new ControlDoublePrivate(key,
                         pCreatorCO,
                         bIgnoreNops,
@@ -185,8 +304,7 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
                         bPersist,
                         defaultValue));
         const MMutexLocker locker(&s_qCOHashMutex);
-        //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
-        s_qCOHash.insert(key, pControl);
+        publishControl(insertHandle(key), pControl);
         return pControl;
     }
 
@@ -215,18 +333,41 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getDefaultControl() {
     return defaultCO;
 }
 
+// static
+ControlHandle ControlDoublePrivate::getHandle(const ConfigKey& key) {
+    if (!key.isValid()) {
+        return ControlHandle();
+    }
+    const ControlHandle handle = findHandle(key);
+    if (handle.isValid()) {
+        return handle;
+    }
+    const MMutexLocker locker(&s_qCOHashMutex);
+    return insertHandle(key);
+}
+
+// static
+QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(ControlHandle handle) {
+    const auto* pSlot = slotForHandle(handle);
+    if (!pSlot) {
+        return nullptr;
+    }
+    const ControlEntry* pEntry = pSlot->load(std::memory_order_acquire);
+    if (!pEntry) {
+        return nullptr;
+    }
+    return pEntry->pControl.toStrongRef();
+}
+
 // static
 QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::getAllInstances() {
     QList<QSharedPointer<ControlDoublePrivate>> result;
     MMutexLocker locker(&s_qCOHashMutex);
-    result.reserve(s_qCOHash.size());
-    for (auto it = s_qCOHash.constBegin(); it != s_qCOHash.constEnd(); ++it) {
-        auto pControl = it.value().lock();
+    result.reserve(s_controlHandles.size());
+    for (auto it = s_controlHandles.constBegin(); it != s_controlHandles.constEnd(); ++it) {
+        auto pControl = getControl(ControlHandle(it.value()));
         if (pControl) {
             result.append(std::move(pControl));
-        } else {
-            // The weak pointer has become invalid and can be cleaned up
-            s_qCOHash.erase(it);
         }
     }
     return result;
@@ -236,14 +377,25 @@ QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::getAllInstance
 QList<QSharedPointer<ControlDoublePrivate>> ControlDoublePrivate::takeAllInstances() {
     QList<QSharedPointer<ControlDoublePrivate>> result;
     MMutexLocker locker(&s_qCOHashMutex);
-    result.reserve(s_qCOHash.size());
-    for (auto it = s_qCOHash.begin(); it != s_qCOHash.end(); ++it) {
-        auto pControl = it.value().lock();
+    result.reserve(s_controlHandles.size());
+    for (auto it = s_controlHandles.constBegin(); it != s_controlHandles.constEnd(); ++it) {
+        const ControlHandle handle(it.value());
+        auto pControl = getControl(handle);
         if (pControl) {
             result.append(std::move(pControl));
         }
+        publishControl(handle, nullptr);
+    }
+    // Only called on shutdown and between tests, when no other thread
+    // looks up controls anymore
+    for (const auto* pEntry : s_retiredEntries) {
+        delete pEntry;
+    }
+    s_retiredEntries.clear();
+    for (const auto* pSnapshot : s_retiredSnapshots) {
+        delete pSnapshot;
     }
-    s_qCOHash.clear();
+    s_retiredSnapshots.clear();
     return result;
 }
 
@@ -28,6 +28,38 @@ enum class ControlFlag {
 Q_DECLARE_FLAGS(ControlFlags, ControlFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(ControlFlags)
 
+/// A stable integer handle for the ConfigKey of a control, see
+/// ControlDoublePrivate::getHandle(). Looking up a control by its handle
+/// neither hashes the key nor locks a mutex.
+class ControlHandle {
+  public:
+    constexpr ControlHandle()
+            : m_index(-1) {
+    }
+    constexpr explicit ControlHandle(int index)
+            : m_index(index) {
+    }
+
+    constexpr bool isValid() const {
+        return m_index >= 0;
+    }
+
+    constexpr int index() const {
+        return m_index;
+    }
+
+    friend constexpr bool operator==(ControlHandle lhs, ControlHandle rhs) {
+        return lhs.m_index == rhs.m_index;
+    }
+
+    friend constexpr bool operator!=(ControlHandle lhs, ControlHandle rhs) {
+        return !(lhs == rhs);
+    }
+
+  private:
+    int m_index;
+};
+
 class ControlDoublePrivate : public QObject {
     Q_OBJECT
   public:
@@ -59,6 +91,17 @@ class ControlDoublePrivate : public QObject {
             double defaultValue = kDefaultValue);
     static QSharedPointer<ControlDoublePrivate> getDefaultControl();
 
+    // Resolves the handle of the ConfigKey. The handle is assigned on first
+    // use, even before the control is created, and refers to the same key
+    // as long as Mixxx runs, also if the control is deleted and created
+    // again. Aliases share the handle of their control if they are inserted
+    // before being resolved. Returns an invalid handle for invalid keys.
+    static ControlHandle getHandle(const ConfigKey& key);
+
+    // Lock-free lookup of the control for a handle. Returns nullptr if the
+    // control does not exist (yet or anymore).
+    static QSharedPointer<ControlDoublePrivate> getControl(ControlHandle handle);
+
     // Returns a list of all existing instances.
     static QList<QSharedPointer<ControlDoublePrivate>> getAllInstances();
     // Clears all existing instances and returns them as a list.
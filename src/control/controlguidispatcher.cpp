@@ -0,0 +1,241 @@
+#include "control/controlguidispatcher.h"
+
+#include <QThread>
+#include <QtDebug>
+#include <atomic>
+#include <bit>
+
+#include "control/control.h"
+#include "control/controlproxy.h"
+#include "moc_controlguidispatcher.cpp"
+#include "util/assert.h"
+#include "util/counter.h"
+
+/// One bit per subscribed control, set by the thread that changes the
+/// control and cleared by dispatch() in the GUI thread. The chunks are
+/// allocated by the GUI thread before the first control of a chunk is
+/// connected and are never moved or freed while connected.
+class ControlGuiDispatcher::DirtySet {
+  public:
+    static constexpr int kBitsPerWord = 64;
+    static constexpr int kWordsPerChunk = 64;
+    static constexpr int kSlotsPerChunk = kBitsPerWord * kWordsPerChunk;
+    static constexpr int kMaxChunks = 64;
+
+    struct Chunk {
+        std::atomic<quint64> words[kWordsPerChunk]{};
+    };
+
+    DirtySet()
+            : m_recordedUpdates(0),
+              m_mergedUpdates(0) {
+        for (auto& pChunk : m_chunks) {
+            pChunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~DirtySet() {
+        for (auto& pChunk : m_chunks) {
+            delete pChunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// GUI thread only
+    bool reserve(int slot) {
+        const int chunkIdx = slot / kSlotsPerChunk;
+        if (chunkIdx >= kMaxChunks) {
+            return false;
+        }
+        if (!m_chunks[chunkIdx].load(std::memory_order_relaxed)) {
+            m_chunks[chunkIdx].store(new Chunk, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /// Lock-free, called from any thread
+    void mark(int slot) {
+        Chunk* pChunk = m_chunks[slot / kSlotsPerChunk].load(std::memory_order_acquire);
+        const int bitIdx = slot % kSlotsPerChunk;
+        const quint64 bit = quint64{1} << (bitIdx % kBitsPerWord);
+        const quint64 oldWord = pChunk->words[bitIdx / kBitsPerWord].fetch_or(
+                bit, std::memory_order_acq_rel);
+        m_recordedUpdates.fetch_add(1, std::memory_order_relaxed);
+        if (oldWord & bit) {
+            m_mergedUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// GUI thread only. Clears all bits and calls func for each slot that
+    /// has been marked.
+    template<typename Func>
+    void takeMarked(Func func) {
+        for (int chunkIdx = 0; chunkIdx < kMaxChunks; ++chunkIdx) {
+            Chunk* pChunk = m_chunks[chunkIdx].load(std::memory_order_relaxed);
+            if (!pChunk) {
+                // The chunks are allocated in order
+                return;
+            }
+            for (int wordIdx = 0; wordIdx < kWordsPerChunk; ++wordIdx) {
+                std::atomic<quint64>& word = pChunk->words[wordIdx];
+                if (word.load(std::memory_order_relaxed) == 0) {
+                    continue;
+                }
+                quint64 bits = word.exchange(0, std::memory_order_acq_rel);
+                while (bits != 0) {
+                    const int bitIdx = std::countr_zero(bits);
+                    bits &= bits - 1;
+                    func(chunkIdx * kSlotsPerChunk + wordIdx * kBitsPerWord + bitIdx);
+                }
+            }
+        }
+    }
+
+    quint64 recordedUpdates() const {
+        return m_recordedUpdates.load(std::memory_order_relaxed);
+    }
+
+    quint64 mergedUpdates() const {
+        return m_mergedUpdates.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<Chunk*> m_chunks[kMaxChunks];
+    std::atomic<quint64> m_recordedUpdates;
+    std::atomic<quint64> m_mergedUpdates;
+};
+
+// static
+ControlGuiDispatcher* ControlGuiDispatcher::s_pInstance = nullptr;
+
+ControlGuiDispatcher::ControlGuiDispatcher()
+        : m_pDirtySet(std::make_shared<DirtySet>()),
+          m_dispatchedUpdates(0),
+          m_reportedMergedUpdates(0) {
+    DEBUG_ASSERT(!s_pInstance);
+    s_pInstance = this;
+}
+
+ControlGuiDispatcher::~ControlGuiDispatcher() {
+    for (const auto& subscription : m_subscriptions) {
+        if (subscription.connection) {
+            disconnect(subscription.connection);
+        }
+    }
+    if (s_pInstance == this) {
+        s_pInstance = nullptr;
+    }
+}
+
+// static
+ControlGuiDispatcher* ControlGuiDispatcher::instance() {
+    return s_pInstance;
+}
+
+int ControlGuiDispatcher::allocateSlot() {
+    if (!m_freeSlots.empty()) {
+        const int slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    const int slot = static_cast<int>(m_subscriptions.size());
+    if (!m_pDirtySet->reserve(slot)) {
+        return -1;
+    }
+    m_subscriptions.emplace_back();
+    return slot;
+}
+
+bool ControlGuiDispatcher::subscribe(ControlProxy* pProxy) {
+    DEBUG_ASSERT(QThread::currentThread() == thread());
+    VERIFY_OR_DEBUG_ASSERT(!m_slotsByProxy.contains(pProxy)) {
+        return true;
+    }
+    const QSharedPointer<ControlDoublePrivate>& pControl = pProxy->m_pControl;
+    int slot = m_slotsByControl.value(pControl.data(), -1);
+    if (slot < 0) {
+        slot = allocateSlot();
+        if (slot < 0) {
+            qWarning() << "ControlGuiDispatcher: Too many controls, delivering"
+                       << pControl->getKey() << "directly";
+            return false;
+        }
+        Subscription& subscription = m_subscriptions[slot];
+        subscription.pControl = pControl;
+        // The connection is executed by the thread that changes the control
+        subscription.connection = connect(
+                pControl.data(),
+                &ControlDoublePrivate::valueChanged,
+                this,
+                [this, pDirtySet = m_pDirtySet, pGuiThread = thread(), slot](
+                        double value, QObject* pSetter) {
+                    if (QThread::currentThread() == pGuiThread) {
+                        deliver(slot, value, pSetter);
+                    } else {
+                        pDirtySet->mark(slot);
+                    }
+                },
+                Qt::DirectConnection);
+        m_slotsByControl.insert(pControl.data(), slot);
+    }
+    m_subscriptions[slot].proxies.append(pProxy);
+    m_slotsByProxy.insert(pProxy, slot);
+    return true;
+}
+
+void ControlGuiDispatcher::unsubscribe(ControlProxy* pProxy) {
+    DEBUG_ASSERT(QThread::currentThread() == thread());
+    const int slot = m_slotsByProxy.value(pProxy, -1);
+    m_slotsByProxy.remove(pProxy);
+    VERIFY_OR_DEBUG_ASSERT(slot >= 0 && slot < static_cast<int>(m_subscriptions.size())) {
+        return;
+    }
+    Subscription& subscription = m_subscriptions[slot];
+    subscription.proxies.removeAll(pProxy);
+    if (!subscription.proxies.isEmpty()) {
+        return;
+    }
+    disconnect(subscription.connection);
+    m_slotsByControl.remove(subscription.pControl.data());
+    // A pending bit of this slot only causes a redundant update of
+    // the next control that uses the slot
+    subscription = Subscription();
+    m_freeSlots.push_back(slot);
+}
+
+void ControlGuiDispatcher::deliver(int slot, double value, QObject* pSetter) {
+    // The receivers may subscribe or unsubscribe proxies
+    const QList<QPointer<ControlProxy>> proxies = m_subscriptions[slot].proxies;
+    for (const auto& pProxy : proxies) {
+        if (pProxy) {
+            pProxy->slotValueChangedDirect(value, pSetter);
+        }
+    }
+}
+
+void ControlGuiDispatcher::dispatch() {
+    DEBUG_ASSERT(QThread::currentThread() == thread());
+    m_pDirtySet->takeMarked([this](int slot) {
+        if (slot >= static_cast<int>(m_subscriptions.size()) ||
+                !m_subscriptions[slot].pControl) {
+            return;
+        }
+        // Latest value wins
+        deliver(slot, m_subscriptions[slot].pControl->get(), nullptr);
+        ++m_dispatchedUpdates;
+    });
+
+    const quint64 mergedUpdates = m_pDirtySet->mergedUpdates();
+    if (mergedUpdates != m_reportedMergedUpdates) {
+        Counter("ControlGuiDispatcher::dispatch merged updates")
+                .increment(static_cast<int>(mergedUpdates - m_reportedMergedUpdates));
+        m_reportedMergedUpdates = mergedUpdates;
+    }
+}
+
+quint64 ControlGuiDispatcher::recordedUpdates() const {
+    return m_pDirtySet->recordedUpdates();
+}
+
+quint64 ControlGuiDispatcher::mergedUpdates() const {
+    return m_pDirtySet->mergedUpdates();
+}
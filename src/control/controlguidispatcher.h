@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMetaObject>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <memory>
+#include <vector>
+
+class ControlDoublePrivate;
+class ControlProxy;
+
+/// Delivers the changes of the controls that are displayed by the GUI once
+/// per GuiTick instead of one queued signal per change and ControlProxy.
+///
+/// A change from another thread, e.g. the engine, only marks the control as
+/// dirty in a lock-free bit set. dispatch() delivers the latest value of
+/// each dirty control to all subscribed proxies, so any number of changes
+/// between two ticks results in a single update (latest value wins).
+/// Changes from the GUI thread itself are delivered immediately as before.
+///
+/// Subscribe a ControlProxy with ControlProxy::connectValueChangedOnGuiTick().
+class ControlGuiDispatcher : public QObject {
+    Q_OBJECT
+  public:
+    ControlGuiDispatcher();
+    ~ControlGuiDispatcher() override;
+
+    /// The dispatcher driven by the GuiTick, or nullptr if there is none.
+    /// Only valid in the GUI thread.
+    static ControlGuiDispatcher* instance();
+
+    /// Returns false if the proxy can't be subscribed and needs to be
+    /// connected directly.
+    bool subscribe(ControlProxy* pProxy);
+    void unsubscribe(ControlProxy* pProxy);
+
+    /// Delivers the latest value of all controls that have been changed
+    /// from other threads since the last call.
+    void dispatch();
+
+    /// The number of changes from other threads
+    quint64 recordedUpdates() const;
+    /// The number of changes that have been merged into a pending update
+    quint64 mergedUpdates() const;
+    /// The number of control updates delivered by dispatch()
+    quint64 dispatchedUpdates() const {
+        return m_dispatchedUpdates;
+    }
+
+  private:
+    class DirtySet;
+
+    struct Subscription {
+        QSharedPointer<ControlDoublePrivate> pControl;
+        QMetaObject::Connection connection;
+        QList<QPointer<ControlProxy>> proxies;
+    };
+
+    int allocateSlot();
+    void deliver(int slot, double value, QObject* pSetter);
+
+    static ControlGuiDispatcher* s_pInstance;
+
+    // Shared with the connections, which may still be executed by another
+    // thread while this is destroyed
+    const std::shared_ptr<DirtySet> m_pDirtySet;
+
+    // Indexed by the slot in the dirty set
+    std::vector<Subscription> m_subscriptions;
+    std::vector<int> m_freeSlots;
+    QHash<const ControlDoublePrivate*, int> m_slotsByControl;
+    QHash<const ControlProxy*, int> m_slotsByProxy;
+
+    quint64 m_dispatchedUpdates;
+    quint64 m_reportedMergedUpdates;
+};
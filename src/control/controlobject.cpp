@@ -63,6 +63,15 @@ ControlObject* ControlObject::getControl(const ConfigKey& key, ControlFlags flag
     return nullptr;
 }
 
+// static
+ControlObject* ControlObject::getControl(ControlHandle handle) {
+    QSharedPointer<ControlDoublePrivate> pCDP = ControlDoublePrivate::getControl(handle);
+    if (pCDP) {
+        return pCDP->getCreatorCO();
+    }
+    return nullptr;
+}
+
 bool ControlObject::exists(const ConfigKey& key) {
     return !ControlDoublePrivate::getControl(key, ControlFlag::NoWarnIfMissing).isNull();
 }
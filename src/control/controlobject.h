@@ -32,6 +32,9 @@ class ControlObject : public QObject {
         ConfigKey key(group, item);
         return getControl(key, flags);
     }
+    // Returns a pointer to the ControlObject for a handle that has been
+    // resolved before with ControlDoublePrivate::getHandle(). Lock-free.
+    static ControlObject* getControl(ControlHandle handle);
 
     // Checks whether a ControlObject exists or not
     static bool exists(const ConfigKey& key);
@@ -5,6 +5,7 @@
 ControlObjectScript::ControlObjectScript(
         const ConfigKey& key, const RuntimeLoggingCategory& logger, QObject* pParent)
         : ControlProxy(key, pParent, ControlFlag::AllowMissingOrInvalid),
+          m_handle(ControlDoublePrivate::getHandle(key)),
           m_logger(logger),
           m_proxy(key, logger, this),
           m_skipSuperseded(false) {
@@ -15,6 +15,11 @@ class ControlObjectScript : public ControlProxy {
             const RuntimeLoggingCategory& logger,
             QObject* pParent = nullptr);
 
+    /// The handle of the key, resolved once on construction
+    ControlHandle getHandle() const {
+        return m_handle;
+    }
+
     bool addScriptConnection(const ScriptConnection& conn);
 
     bool removeScriptConnection(const ScriptConnection& conn);
@@ -41,6 +46,7 @@ class ControlObjectScript : public ControlProxy {
     virtual void slotValueChanged(double v, QObject*);
 
   private:
+    const ControlHandle m_handle;
     QVector<ScriptConnection> m_scriptConnections;
     const RuntimeLoggingCategory m_logger;
     CompressingProxy m_proxy;
@@ -1,6 +1,7 @@
 #include "control/controlproxy.h"
 
 #include "control/control.h"
+#include "control/controlguidispatcher.h"
 #include "moc_controlproxy.cpp"
 
 ControlProxy::ControlProxy(const QString& g, const QString& i, QObject* pParent, ControlFlags flags)
@@ -19,8 +20,26 @@ ControlProxy::ControlProxy(const ConfigKey& key, QObject* pParent, ControlFlags
 
 ControlProxy::~ControlProxy() {
     //qDebug() << "ControlProxy::~ControlProxy()";
+    if (m_pGuiDispatcher) {
+        m_pGuiDispatcher->unsubscribe(this);
+    }
 }
 
 const ConfigKey& ControlProxy::getKey() const {
     return m_pControl->getKey();
 }
+
+bool ControlProxy::subscribeToGuiTick() {
+    if (m_pGuiDispatcher) {
+        return true;
+    }
+    ControlGuiDispatcher* pDispatcher = ControlGuiDispatcher::instance();
+    if (!pDispatcher || pDispatcher->thread() != thread()) {
+        return false;
+    }
+    if (!pDispatcher->subscribe(this)) {
+        return false;
+    }
+    m_pGuiDispatcher = pDispatcher;
+    return true;
+}
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <QObject>
+#include <QPointer>
 #include <QSharedPointer>
 #include <QString>
 
 #include "control/control.h"
 #include "preferences/usersettings.h"
 
+class ControlGuiDispatcher;
+
 //// This class is the successor of ControlObjectThread. It should be used for
 /// new code to avoid unnecessary locking during send if no slot is connected.
 /// Do not (re-)connect slots during runtime, since this locks the mutex in
@@ -99,6 +102,21 @@ class ControlProxy : public QObject {
         return true;
     }
 
+    /// Connects a receiver in the GUI thread like connectValueChanged().
+    /// Changes from other threads are coalesced by the ControlGuiDispatcher
+    /// and delivered once per GuiTick with the latest value. Falls back to
+    /// connectValueChanged() if there is no GuiTick.
+    template<typename Receiver, typename Slot>
+    bool connectValueChangedOnGuiTick(Receiver receiver, Slot func) {
+        if (!valid()) {
+            return false;
+        }
+        if (!subscribeToGuiTick()) {
+            return connectValueChanged(receiver, func);
+        }
+        return connect(this, &ControlProxy::valueChanged, receiver, func, Qt::AutoConnection);
+    }
+
     /// Called from update();
     virtual void emitValueChanged() {
         emit valueChanged(get());
@@ -185,4 +203,12 @@ class ControlProxy : public QObject {
   protected:
     /// Pointer to connected control.
     QSharedPointer<ControlDoublePrivate> m_pControl;
+
+  private:
+    friend class ControlGuiDispatcher;
+
+    bool subscribeToGuiTick();
+
+    /// Set while the value changes are delivered by the dispatcher
+    QPointer<ControlGuiDispatcher> m_pGuiDispatcher;
 };
@@ -31,6 +31,17 @@ class PollingControlProxy {
         DEBUG_ASSERT(m_pControl);
     }
 
+    /// Looks up the control by a handle from ControlDoublePrivate::getHandle()
+    /// without hashing the key or locking, e.g. in the engine thread.
+    PollingControlProxy(ControlHandle handle, ControlFlags flags = ControlFlag::None) {
+        m_pControl = ControlDoublePrivate::getControl(handle);
+        if (!m_pControl) {
+            DEBUG_ASSERT(flags & ControlFlag::AllowMissingOrInvalid);
+            m_pControl = ControlDoublePrivate::getDefaultControl();
+        }
+        DEBUG_ASSERT(m_pControl);
+    }
+
     bool valid() const {
         return m_pControl->getKey().isValid();
     }
@@ -93,6 +93,7 @@ ControllerScriptInterfaceLegacy::~ControllerScriptInterfaceLegacy() {
             // Advance iterator
             it = constErase(&m_controlCache, it);
         }
+        m_controlsByHandle.clear();
     }
 }
 
@@ -113,6 +114,13 @@ ControlObjectScript* ControllerScriptInterfaceLegacy::getControlObjectScript(
     return coScript;
 }
 
+ControlObjectScript* ControllerScriptInterfaceLegacy::getControlObjectScript(int handle) {
+    if (handle < 0 || handle >= m_controlsByHandle.size()) {
+        return nullptr;
+    }
+    return m_controlsByHandle[handle];
+}
+
 QJSValue ControllerScriptInterfaceLegacy::getSetting(const QString& name) {
     VERIFY_OR_DEBUG_ASSERT(m_pScriptEngineLegacy) {
         return QJSValue::UndefinedValue;
@@ -163,13 +171,18 @@ void ControllerScriptInterfaceLegacy::setValue(
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
-        if (pControl &&
-                !m_st.ignore(
-                        pControl, coScript->getParameterForValue(newValue))) {
-            coScript->set(newValue);
-        }
+        setValueInternal(coScript, newValue);
+    }
+}
+
+void ControllerScriptInterfaceLegacy::setValueInternal(
+        ControlObjectScript* coScript, double newValue) {
+    // The handle avoids another lookup of the key
+    ControlObject* pControl = ControlObject::getControl(coScript->getHandle());
+    if (pControl &&
+            !m_st.ignore(
+                    pControl, coScript->getParameterForValue(newValue))) {
+        coScript->set(newValue);
     }
 }
 
@@ -196,11 +209,15 @@ void ControllerScriptInterfaceLegacy::setParameter(
     ControlObjectScript* coScript = getControlObjectScript(group, name);
 
     if (coScript != nullptr) {
-        ControlObject* pControl = ControlObject::getControl(
-                coScript->getKey(), ControlFlag::AllowMissingOrInvalid);
-        if (pControl && !m_st.ignore(pControl, newParameter)) {
-            coScript->setParameter(newParameter);
-        }
+        setParameterInternal(coScript, newParameter);
+    }
+}
+
+void ControllerScriptInterfaceLegacy::setParameterInternal(
+        ControlObjectScript* coScript, double newParameter) {
+    ControlObject* pControl = ControlObject::getControl(coScript->getHandle());
+    if (pControl && !m_st.ignore(pControl, newParameter)) {
+        coScript->setParameter(newParameter);
     }
 }
 
@@ -225,6 +242,79 @@ double ControllerScriptInterfaceLegacy::getParameterForValue(
     return coScript->getParameterForValue(value);
 }
 
+int ControllerScriptInterfaceLegacy::getControlHandle(
+        const QString& group, const QString& name) {
+    ControlObjectScript* coScript = getControlObjectScript(group, name);
+    if (coScript == nullptr || !coScript->getHandle().isValid()) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control (%1, %2) returning -1")
+                        .arg(group, name));
+        return -1;
+    }
+    const int handle = coScript->getHandle().index();
+    if (handle >= m_controlsByHandle.size()) {
+        m_controlsByHandle.resize(handle + 1);
+    }
+    m_controlsByHandle[handle] = coScript;
+    return handle;
+}
+
+double ControllerScriptInterfaceLegacy::getValueByHandle(int handle) {
+    ControlObjectScript* coScript = getControlObjectScript(handle);
+    if (coScript == nullptr) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control handle %1 returning 0.0")
+                        .arg(handle));
+        return 0.0;
+    }
+    return coScript->get();
+}
+
+void ControllerScriptInterfaceLegacy::setValueByHandle(int handle, double newValue) {
+    ControlObjectScript* coScript = getControlObjectScript(handle);
+    if (coScript == nullptr) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control handle %1").arg(handle));
+        return;
+    }
+    if (util_isnan(newValue)) {
+        m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
+                "Script tried setting (%1, %2) to NotANumber (NaN)")
+                                                       .arg(coScript->getKey().group,
+                                                               coScript->getKey().item));
+        return;
+    }
+    setValueInternal(coScript, newValue);
+}
+
+double ControllerScriptInterfaceLegacy::getParameterByHandle(int handle) {
+    ControlObjectScript* coScript = getControlObjectScript(handle);
+    if (coScript == nullptr) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control handle %1 returning 0.0")
+                        .arg(handle));
+        return 0.0;
+    }
+    return coScript->getParameter();
+}
+
+void ControllerScriptInterfaceLegacy::setParameterByHandle(int handle, double newParameter) {
+    ControlObjectScript* coScript = getControlObjectScript(handle);
+    if (coScript == nullptr) {
+        m_pScriptEngineLegacy->logOrThrowError(
+                QStringLiteral("Unknown control handle %1").arg(handle));
+        return;
+    }
+    if (util_isnan(newParameter)) {
+        m_pScriptEngineLegacy->logOrThrowError(QStringLiteral(
+                "Script tried setting (%1, %2) to NotANumber (NaN)")
+                                                       .arg(coScript->getKey().group,
+                                                               coScript->getKey().item));
+        return;
+    }
+    setParameterInternal(coScript, newParameter);
+}
+
 void ControllerScriptInterfaceLegacy::reset(const QString& group, const QString& name) {
     ControlObjectScript* coScript = getControlObjectScript(group, name);
     if (coScript != nullptr) {
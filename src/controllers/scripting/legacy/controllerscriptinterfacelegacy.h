@@ -63,6 +63,14 @@ class ControllerScriptInterfaceLegacy : public QObject {
     Q_INVOKABLE void setParameter(const QString& group, const QString& name, double newValue);
     Q_INVOKABLE double getParameterForValue(
             const QString& group, const QString& name, double value);
+    // Resolves a control once for the *ByHandle() functions below, which
+    // skip looking up the group and name on every call. Returns -1 for
+    // unknown controls.
+    Q_INVOKABLE int getControlHandle(const QString& group, const QString& name);
+    Q_INVOKABLE double getValueByHandle(int handle);
+    Q_INVOKABLE void setValueByHandle(int handle, double newValue);
+    Q_INVOKABLE double getParameterByHandle(int handle);
+    Q_INVOKABLE void setParameterByHandle(int handle, double newParameter);
     Q_INVOKABLE void reset(const QString& group, const QString& name);
     Q_INVOKABLE double getDefaultValue(const QString& group, const QString& name);
     Q_INVOKABLE double getDefaultParameter(const QString& group, const QString& name);
@@ -131,6 +139,11 @@ class ControllerScriptInterfaceLegacy : public QObject {
 
     QHash<ConfigKey, ControlObjectScript*> m_controlCache;
     ControlObjectScript* getControlObjectScript(const QString& group, const QString& name);
+    // Not owned, the entries of m_controlCache indexed by ControlHandle
+    QVector<ControlObjectScript*> m_controlsByHandle;
+    ControlObjectScript* getControlObjectScript(int handle);
+    void setValueInternal(ControlObjectScript* coScript, double newValue);
+    void setParameterInternal(ControlObjectScript* coScript, double newParameter);
 
     SoftTakeoverCtrl m_st;
 
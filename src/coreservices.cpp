@@ -5,6 +5,7 @@
 #include <QProcess>
 #include <QProcessEnvironment>
 #include <QStandardPaths>
+#include <QtConcurrentRun>
 #include <QtGlobal>
 #include <gsl/pointers>
 
@@ -54,6 +55,7 @@
 #include "util/db/dbconnectionpooled.h"
 #include "util/font.h"
 #include "util/logger.h"
+#include "util/rtprofiler.h"
 #include "util/screensavermanager.h"
 #include "util/statsmanager.h"
 #include "util/time.h"
@@ -358,7 +360,8 @@ namespace mixxx {
 CoreServices::CoreServices(const CmdlineArgs& args, QApplication* pApp)
         : m_runtime_timer(QLatin1String("CoreServices::runtime")),
           m_cmdlineArgs(args),
-          m_isInitialized(false) {
+          m_isInitialized(false),
+          m_startLibraryScan(false) {
     m_runtime_timer.start();
     mixxx::Time::start();
     ScopedTimer t(QStringLiteral("CoreServices::CoreServices"));
@@ -371,6 +374,9 @@ CoreServices::CoreServices(const CmdlineArgs& args, QApplication* pApp)
     if (m_cmdlineArgs.getDeveloper()) {
         StatsManager::createInstance();
     }
+    if (m_cmdlineArgs.getEngineProfilerEnabled()) {
+        mixxx::RtProfiler::createInstance(m_cmdlineArgs.getEngineProfilePath());
+    }
     mixxx::Translations::initializeTranslations(
             m_pSettingsManager->settings(), pApp, m_cmdlineArgs.getLocale());
     initializeKeyboard();
@@ -386,6 +392,11 @@ CoreServices::~CoreServices() {
     CLEAR_AND_CHECK_DELETED(m_pKbdConfig);
     CLEAR_AND_CHECK_DELETED(m_pKbdConfigEmpty);
 
+    // The audio threads have been stopped in finalize()
+    if (m_cmdlineArgs.getEngineProfilerEnabled()) {
+        mixxx::RtProfiler::destroy();
+    }
+
     if (m_cmdlineArgs.getDeveloper()) {
         StatsManager::destroy();
     }
@@ -487,11 +498,21 @@ void CoreServices::initialize(QApplication* pApp) {
 
     QString resourcePath = pConfig->getResourcePath();
 
-    emit initializationProgressUpdate(0, tr("fonts"));
-
-    FontUtils::initializeFonts(resourcePath); // takes a long time
-
-    emit initializationProgressUpdate(10, tr("database"));
+    // Loading the fonts and discovering the effect plugins take a long time
+    // and are independent of all other subsystems. Both run on worker threads
+    // while the GUI thread continues with the following stages.
+    QFuture<void> fontsFuture = QtConcurrent::run([this, resourcePath] {
+        StartupTimeline::ConcurrentStage stage(&m_startupTimeline, QStringLiteral("fonts"));
+        FontUtils::initializeFonts(resourcePath);
+    });
+    QFuture<QList<EffectsBackendPointer>> pluginBackendsFuture = QtConcurrent::run([this] {
+        StartupTimeline::ConcurrentStage stage(
+                &m_startupTimeline, QStringLiteral("effect plugins"));
+        return EffectsBackendManager::createPluginBackends();
+    });
+
+    emit initializationProgressUpdate(0, tr("database"));
+    m_startupTimeline.beginStage(QStringLiteral("database"));
     m_pDbConnectionPool = MixxxDb(pConfig).connectionPool();
     if (!m_pDbConnectionPool) {
         exit(-1);
@@ -502,12 +523,22 @@ void CoreServices::initialize(QApplication* pApp) {
         exit(-1);
     }
 
+    // Initialize controller sub-system,
+    // but do not set up controllers until the end of the application startup.
+    // The controllers are enumerated on the controller thread while the
+    // remaining subsystems are created.
+    m_startupTimeline.beginStage(QStringLiteral("controllers"));
+    qDebug() << "Creating ControllerManager";
+    m_pControllerManager = std::make_shared<ControllerManager>(pConfig);
+
     m_pControlIndicatorTimer = std::make_shared<mixxx::ControlIndicatorTimer>(this);
 
     auto pChannelHandleFactory = std::make_shared<ChannelHandleFactory>();
 
     emit initializationProgressUpdate(20, tr("effects"));
-    m_pEffectsManager = std::make_shared<EffectsManager>(pConfig, pChannelHandleFactory);
+    m_startupTimeline.beginStage(QStringLiteral("effects"));
+    m_pEffectsManager = std::make_shared<EffectsManager>(
+            pConfig, pChannelHandleFactory, pluginBackendsFuture.result());
 
     m_pEngine = std::make_shared<EngineMixer>(
             pConfig,
@@ -520,6 +551,7 @@ void CoreServices::initialize(QApplication* pApp) {
 #endif
 
     emit initializationProgressUpdate(30, tr("audio interface"));
+    m_startupTimeline.beginStage(QStringLiteral("audio interface"));
     // Although m_pSoundManager is created here, m_pSoundManager->setupDevices()
     // needs to be called after m_pPlayerManager registers sound IO for each EngineChannel.
     m_pSoundManager = std::make_shared<SoundManager>(pConfig, m_pEngine.get());
@@ -540,6 +572,7 @@ void CoreServices::initialize(QApplication* pApp) {
 #endif
 
     emit initializationProgressUpdate(40, tr("decks"));
+    m_startupTimeline.beginStage(QStringLiteral("decks"));
     // Create the player manager. (long)
     m_pPlayerManager = std::make_shared<PlayerManager>(
             pConfig,
@@ -586,6 +619,7 @@ void CoreServices::initialize(QApplication* pApp) {
             &ScreensaverManager::slotCurrentPlayingDeckChanged);
 
     emit initializationProgressUpdate(50, tr("library"));
+    m_startupTimeline.beginStage(QStringLiteral("library"));
     CoverArtCache::createInstance();
     Clipboard::createInstance();
 
@@ -687,12 +721,8 @@ void CoreServices::initialize(QApplication* pApp) {
         }
     }
 
-    emit initializationProgressUpdate(60, tr("controllers"));
-    // Initialize controller sub-system,
-    // but do not set up controllers until the end of the application startup
-    // (long)
-    qDebug() << "Creating ControllerManager";
-    m_pControllerManager = std::make_shared<ControllerManager>(pConfig);
+    emit initializationProgressUpdate(60, tr("controls"));
+    m_startupTimeline.beginStage(QStringLiteral("controls"));
 
     // Scan the library for new files and directories
     bool rescan = m_cmdlineArgs.getRescanLibrary() ||
@@ -738,11 +768,8 @@ void CoreServices::initialize(QApplication* pApp) {
             this,
             &CoreServices::libraryScanSummary,
             Qt::UniqueConnection);
-    // Scan the library directory. Do this after the skinloader has
-    // loaded a skin, see issue #6625
-    if (rescan || musicDirAdded || m_pSettingsManager->shouldRescanLibrary()) {
-        m_pTrackCollectionManager->startLibraryAutoScan();
-    }
+    const bool startLibraryScan =
+            rescan || musicDirAdded || m_pSettingsManager->shouldRescanLibrary();
 
     // This has to be done before m_pSoundManager->setupDevices()
     // https://github.com/mixxxdj/mixxx/issues/9188
@@ -763,8 +790,17 @@ void CoreServices::initialize(QApplication* pApp) {
         }
     }
 
+    // The skin needs all fonts
+    m_startupTimeline.beginStage(QStringLiteral("waiting for fonts"));
+    fontsFuture.waitForFinished();
+
     m_isInitialized = true;
 
+    // Ends with finishStartup() after the skin has been loaded and the main
+    // window has been shown
+    m_startupTimeline.beginStage(QStringLiteral("main window"));
+    m_startLibraryScan = startLibraryScan;
+
     ControllerScriptEngineBase::registerPlayerManager(getPlayerManager());
 
 #ifdef MIXXX_USE_QML
@@ -799,6 +835,22 @@ void CoreServices::initializeQMLSingletons() {
 #endif
 }
 
+void CoreServices::finishStartup() {
+    if (!m_isInitialized) {
+        return;
+    }
+    m_startupTimeline.endStage();
+    // Scan the library directory. Do this after the skinloader has
+    // loaded a skin, see issue #6625
+    if (m_startLibraryScan) {
+        m_startLibraryScan = false;
+        m_startupTimeline.beginStage(QStringLiteral("library scan"));
+        m_pTrackCollectionManager->startLibraryAutoScan();
+        m_startupTimeline.endStage();
+    }
+    m_startupTimeline.logReport();
+}
+
 void CoreServices::initializeKeyboard() {
     UserSettingsPointer pConfig = m_pSettingsManager->settings();
     QString resourcePath = pConfig->getResourcePath();
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "preferences/settingsmanager.h"
+#include "util/startuptimeline.h"
 #include "util/timer.h"
 
 class QApplication;
@@ -40,6 +41,10 @@ class CoreServices : public QObject {
     /// The secondary long run which should be called after displaying the start up screen
     void initialize(QApplication* pApp);
 
+    /// Starts the deferred library scan and reports the startup timeline.
+    /// Called once the skin has been loaded and the main window is shown.
+    void finishStartup();
+
     std::shared_ptr<KeyboardEventFilter> getKeyboardEventFilter() const {
         return m_pKeyboardEventFilter;
     }
@@ -52,6 +57,10 @@ class CoreServices : public QObject {
         return m_pControlIndicatorTimer;
     }
 
+    std::shared_ptr<EngineMixer> getEngineMixer() const {
+        return m_pEngine;
+    }
+
     std::shared_ptr<SoundManager> getSoundManager() const {
         return m_pSoundManager;
     }
@@ -152,8 +161,10 @@ class CoreServices : public QObject {
     std::unique_ptr<ControlPushButton> m_pTouchShift;
 
     Timer m_runtime_timer;
+    StartupTimeline m_startupTimeline;
     const CmdlineArgs& m_cmdlineArgs;
     bool m_isInitialized;
+    bool m_startLibraryScan;
 };
 
 } // namespace mixxx
@@ -12,7 +12,8 @@
 #endif
 #include "effects/presets/effectpreset.h"
 
-EffectsBackendManager::EffectsBackendManager() {
+EffectsBackendManager::EffectsBackendManager(
+        std::optional<QList<EffectsBackendPointer>> pluginBackends) {
     m_pNumEffectsAvailable = std::make_unique<ControlObject>(
             ConfigKey("[Master]", "num_effectsavailable"));
     m_pNumEffectsAvailable->setReadOnly();
@@ -21,9 +22,21 @@ EffectsBackendManager::EffectsBackendManager() {
 #ifdef __AU_EFFECTS__
     addBackend(createAudioUnitBackend());
 #endif
+    if (!pluginBackends) {
+        pluginBackends = createPluginBackends();
+    }
+    for (const auto& pBackend : std::as_const(*pluginBackends)) {
+        addBackend(pBackend);
+    }
+}
+
+// static
+QList<EffectsBackendPointer> EffectsBackendManager::createPluginBackends() {
+    QList<EffectsBackendPointer> backends;
 #ifdef __LILV__
-    addBackend(EffectsBackendPointer(new LV2Backend()));
+    backends.append(EffectsBackendPointer(new LV2Backend()));
 #endif
+    return backends;
 }
 
 void EffectsBackendManager::addBackend(EffectsBackendPointer pBackend) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "effects/defs.h"
 
 class ControlObject;
@@ -9,7 +11,10 @@ class EffectProcessor;
 /// available EffectManifests, and creates EffectProcessors from EffectManifests.
 class EffectsBackendManager {
   public:
-    EffectsBackendManager();
+    /// The plugin backends are created by the constructor unless they
+    /// have been created in advance by createPluginBackends().
+    explicit EffectsBackendManager(
+            std::optional<QList<EffectsBackendPointer>> pluginBackends = std::nullopt);
     ~EffectsBackendManager() = default;
 
     const QList<EffectManifestPointer>& getManifests() const {
@@ -24,6 +29,11 @@ class EffectsBackendManager {
 
     std::unique_ptr<EffectProcessor> createProcessor(const EffectManifestPointer pManifest);
 
+    /// Discovers the installed plugins, which takes a long time with
+    /// many plugins. Does not access any controls and can be invoked on a
+    /// worker thread while the remaining subsystems are created.
+    static QList<EffectsBackendPointer> createPluginBackends();
+
   private:
     void addBackend(EffectsBackendPointer pEffectsBackend);
 
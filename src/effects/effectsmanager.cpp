@@ -23,7 +23,8 @@ const QString kEffectsXmlFile = QStringLiteral("effects.xml");
 
 EffectsManager::EffectsManager(
         UserSettingsPointer pConfig,
-        std::shared_ptr<ChannelHandleFactory> pChannelHandleFactory)
+        std::shared_ptr<ChannelHandleFactory> pChannelHandleFactory,
+        std::optional<QList<EffectsBackendPointer>> pluginBackends)
         : m_pConfig(pConfig),
           m_pChannelHandleFactory(pChannelHandleFactory),
           m_loEqFreq(ConfigKey(kMixerProfile, kLowEqFrequency), 0., 22040),
@@ -31,7 +32,8 @@ EffectsManager::EffectsManager(
           m_initializedFromEffectsXml(false) {
     qRegisterMetaType<EffectChainMixMode>("EffectChainMixMode");
 
-    m_pBackendManager = EffectsBackendManagerPointer(new EffectsBackendManager());
+    m_pBackendManager = EffectsBackendManagerPointer(
+            new EffectsBackendManager(std::move(pluginBackends)));
 
     auto [requestPipe, responsePipe] = makeTwoWayMessagePipe<EffectsRequest*,
             EffectsResponse>(kEffectMessagePipeFifoSize,
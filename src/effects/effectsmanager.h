@@ -20,8 +20,10 @@ class EngineEffectsManager;
 /// responsible for specific parts of the effects system.
 class EffectsManager {
   public:
+    /// See EffectsBackendManager for the optional plugin backends.
     EffectsManager(UserSettingsPointer pConfig,
-            std::shared_ptr<ChannelHandleFactory> pChannelHandleFactory);
+            std::shared_ptr<ChannelHandleFactory> pChannelHandleFactory,
+            std::optional<QList<EffectsBackendPointer>> pluginBackends = std::nullopt);
 
     virtual ~EffectsManager();
 
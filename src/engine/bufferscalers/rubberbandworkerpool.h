@@ -1,15 +1,14 @@
 #pragma once
 
-#include <QThreadPool>
-
 #include "audio/types.h"
+#include "engine/enginejobscheduler.h"
 #include "preferences/usersettings.h"
 #include "util/singleton.h"
 
 // RubberBandWorkerPool is a global pool manager for RubberBandWorkerPool. It
 // allows a the Engine thread to use a pool of agnostic RubberBandWorker which
 // can be distributed stretching job
-class RubberBandWorkerPool : public QThreadPool, public Singleton<RubberBandWorkerPool> {
+class RubberBandWorkerPool : public EngineJobScheduler, public Singleton<RubberBandWorkerPool> {
   public:
     const mixxx::audio::ChannelCount& channelPerWorker() const {
         return m_channelPerWorker;
@@ -19,7 +18,8 @@ class RubberBandWorkerPool : public QThreadPool, public Singleton<RubberBandWork
     RubberBandWorkerPool(UserSettingsPointer pConfig = nullptr);
 
   private:
-    ;
+    RubberBandWorkerPool(mixxx::audio::ChannelCount channelPerWorker);
+
     mixxx::audio::ChannelCount m_channelPerWorker;
 
     friend class Singleton<RubberBandWorkerPool>;
@@ -53,7 +53,7 @@ mixxx::audio::ChannelCount getChannelPerWorker(mixxx::audio::ChannelCount chCoun
     }
     auto channelPerWorker = pPool->channelPerWorker();
     // The task count includes all the thread in the pool + the engine thread
-    auto maxThreadCount = pPool->maxThreadCount() + 1;
+    auto maxThreadCount = pPool->numWorkers() + 1;
     VERIFY_OR_DEBUG_ASSERT(chCount % channelPerWorker == 0) {
         return mixxx::kEngineChannelOutputCount;
     }
@@ -182,20 +182,19 @@ void RubberBandWrapper::process(const float* const* input, size_t samples, bool
         return m_pInstances[0]->process(input, samples, isFinal);
     } else {
         RubberBandWorkerPool* pPool = RubberBandWorkerPool::instance();
-        for (auto& pInstance : m_pInstances) {
-            pInstance->set(input, samples, isFinal);
-            // We try to get the stretching job ran by the RBPool if there is a
-            // worker slot available
-            if (!pPool->tryStart(pInstance.get())) {
-                // Otherwise, it means the main thread should take care of the stretching
-                pInstance->run();
-            }
+        const auto pLastInstance = m_pInstances.end() - 1;
+        for (auto it = m_pInstances.begin(); it != pLastInstance; ++it) {
+            (*it)->set(input, samples, isFinal);
+            pPool->submit(it->get());
             input += m_channelPerWorker;
         }
-        // We always perform a wait, even for task that were ran in the main
-        // thread, so it resets the semaphore
-        for (auto& pInstance : m_pInstances) {
-            pInstance->waitReady();
+        // The calling thread takes care of the last stretching job instead of
+        // waiting for the pool to complete.
+        (*pLastInstance)->set(input, samples, isFinal);
+        (*pLastInstance)->run();
+        // Waiting also runs the jobs that no worker has picked up yet
+        for (auto it = m_pInstances.begin(); it != pLastInstance; ++it) {
+            pPool->wait(it->get());
         }
     }
 }
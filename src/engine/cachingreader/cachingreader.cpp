@@ -1,6 +1,8 @@
 #include "engine/cachingreader/cachingreader.h"
 
 #include <QtDebug>
+#include <algorithm>
+#include <cmath>
 
 #include "moc_cachingreader.cpp"
 #include "util/assert.h"
@@ -29,11 +31,66 @@ constexpr SINT kDefaultHintFrames = 1024;
 // CachingReader must be multiplied by the number of decks to calculate
 // the total amount!
 //
-// NOTE(uklotzde, 2019-09-05): Reduce this number to just few chunks
-// (kNumberOfCachedChunksInMemory = 1, 2, 3, ...) for testing purposes
-// to verify that the MRU/LRU cache works as expected. Even though
-// massive drop outs are expected to occur Mixxx should run reliably!
-constexpr SINT kNumberOfCachedChunksInMemory = 80;
+// NOTE(uklotzde, 2019-09-05): Configure just few chunks (e.g. with
+// [App],cache_seconds = 0.5) for testing purposes to verify that the
+// MRU/LRU cache works as expected. Even though massive drop outs are
+// expected to occur Mixxx should run reliably!
+constexpr SINT kDefaultNumberOfCachedChunks = 80;
+constexpr SINT kMinNumberOfCachedChunks = 2;
+// ~ 12 minutes at 48 kHz
+constexpr SINT kMaxNumberOfCachedChunks = 4096;
+
+// The configured cache duration is converted into a number of chunks at
+// this sample rate, because the sample rate of the tracks is not known
+// when the memory is allocated.
+constexpr double kCacheReferenceSampleRate = 48000.0;
+
+const QString kAppGroup = QStringLiteral("[App]");
+const QString kCacheSecondsKey = QStringLiteral("cache_seconds");
+
+SINT numberOfCachedChunksFromConfig(
+        const UserSettingsPointer& pConfig,
+        const QString& group) {
+    if (!pConfig) {
+        return kDefaultNumberOfCachedChunks;
+    }
+    // A per deck setting takes precedence over the setting for all decks
+    const double seconds = pConfig->getValue(ConfigKey(group, kCacheSecondsKey),
+            pConfig->getValue(ConfigKey(kAppGroup, kCacheSecondsKey), 0.0));
+    if (seconds <= 0.0) {
+        return kDefaultNumberOfCachedChunks;
+    }
+    const auto numberOfChunks = static_cast<SINT>(std::ceil(
+            seconds * kCacheReferenceSampleRate / CachingReaderChunk::kFrames));
+    return std::clamp(numberOfChunks, kMinNumberOfCachedChunks, kMaxNumberOfCachedChunks);
+}
+
+const QString kPreloadTrackKey = QStringLiteral("preload_track");
+const QString kPreloadTracksKey = QStringLiteral("preload_tracks");
+const QString kPreloadBudgetKey = QStringLiteral("preload_budget_mb");
+constexpr int kDefaultPreloadBudgetMB = 2048;
+
+// Returns 0 if preloading is disabled
+qint64 preloadBudgetBytesFromConfig(
+        const UserSettingsPointer& pConfig,
+        const QString& group) {
+    if (!pConfig) {
+        return 0;
+    }
+    // A per deck setting takes precedence over the setting for all decks
+    const bool preload = pConfig->getValue(ConfigKey(group, kPreloadTrackKey),
+            pConfig->getValue(ConfigKey(kAppGroup, kPreloadTracksKey), false));
+    if (!preload) {
+        return 0;
+    }
+    const int budgetMB = pConfig->getValue(
+            ConfigKey(kAppGroup, kPreloadBudgetKey), kDefaultPreloadBudgetMB);
+    return static_cast<qint64>(std::max(budgetMB, 0)) * 1024 * 1024;
+}
+
+int toProtection(Hint::Priority priority) {
+    return static_cast<int>(priority);
+}
 
 } // anonymous namespace
 
@@ -41,6 +98,7 @@ CachingReader::CachingReader(const QString& group,
         UserSettingsPointer config,
         mixxx::audio::ChannelCount maxSupportedChannel)
         : m_pConfig(config),
+          m_numberOfCachedChunks(numberOfCachedChunksFromConfig(config, group)),
           // Limit the number of in-flight requests to the worker. This should
           // prevent to overload the worker when it is not able to fetch those
           // requests from the FIFO timely. Otherwise outdated requests pile up
@@ -50,25 +108,38 @@ CachingReader::CachingReader(const QString& group,
           // buffer, where new requests replace old requests when full. Those
           // old requests need to be returned immediately to the CachingReader
           // that must take ownership and free them!!!
-          m_chunkReadRequestFIFO(kNumberOfCachedChunksInMemory / 4),
+          m_chunkReadRequestFIFO(std::max(m_numberOfCachedChunks / 4, SINT{1})),
           // The capacity of the back channel must be equal to the number of
           // allocated chunks, because the worker use writeBlocking(). Otherwise
           // the worker could get stuck in a hot loop!!!
-          m_readerStatusUpdateFIFO(kNumberOfCachedChunksInMemory),
+          m_readerStatusUpdateFIFO(m_numberOfCachedChunks),
           m_state(STATE_IDLE),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
           m_sampleBuffer(CachingReaderChunk::kFrames * maxSupportedChannel *
-                  kNumberOfCachedChunksInMemory),
+                  m_numberOfCachedChunks),
+          m_hintGeneration(0),
+          m_hitCount(0),
+          m_missCount(0),
+          m_underflowCount(0),
+          m_evictionCount(0),
+          m_rejectedHintCount(0),
+          m_pPreload(nullptr),
           m_worker(group,
                   &m_chunkReadRequestFIFO,
                   &m_readerStatusUpdateFIFO,
-                  maxSupportedChannel) {
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
+                  maxSupportedChannel,
+                  preloadBudgetBytesFromConfig(config, group),
+                  mixxx::DecodedAudioCache::create(config)) {
+    kLogger.debug()
+            << group
+            << "caches" << m_numberOfCachedChunks
+            << "chunks with" << maxSupportedChannel << "channels";
+    m_allocatedCachingReaderChunks.reserve(m_numberOfCachedChunks);
     // Divide up the allocated raw memory buffer into total_chunks
     // chunks. Initialize each chunk to hold nothing and add it to the free
     // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
+    for (SINT i = 0; i < m_numberOfCachedChunks; ++i) {
         CachingReaderChunkForOwner* c =
                 new CachingReaderChunkForOwner(
                         mixxx::SampleBuffer::WritableSlice(
@@ -95,9 +166,25 @@ CachingReader::CachingReader(const QString& group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    // Return all preloads to the worker before it is destroyed
+    releasePreload();
+    ReaderStatusUpdate update;
+    while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
+        auto* pPreload = update.takePreload();
+        if (pPreload) {
+            pPreload->releaseByReader();
+        }
+    }
     qDeleteAll(m_chunks);
 }
 
+void CachingReader::releasePreload() {
+    if (m_pPreload) {
+        m_pPreload->releaseByReader();
+        m_pPreload = nullptr;
+    }
+}
+
 void CachingReader::freeChunkFromList(CachingReaderChunkForOwner* pChunk) {
     pChunk->removeFromList(
             &m_mruCachingReaderChunk,
@@ -151,18 +238,41 @@ CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
     return pChunk;
 }
 
-CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkIndex) {
+CachingReaderChunkForOwner* CachingReader::allocateChunkEvictByPriority(
+        SINT chunkIndex, Hint::Priority priority) {
     auto* pChunk = allocateChunk(chunkIndex);
     if (!pChunk) {
-        if (m_lruCachingReaderChunk) {
-            freeChunk(m_lruCachingReaderChunk);
+        // Find the least recently used chunk with the lowest protection,
+        // starting at the LRU end of the list. Usually the LRU chunk is not
+        // protected and the search ends immediately.
+        const int maxProtection = toProtection(priority);
+        CachingReaderChunkForOwner* pVictim = nullptr;
+        int victimProtection = maxProtection + 1;
+        for (auto* pCandidate = m_lruCachingReaderChunk;
+                pCandidate;
+                pCandidate = pCandidate->getPrev()) {
+            const int protection = pCandidate->protection(m_hintGeneration);
+            if (protection < victimProtection) {
+                pVictim = pCandidate;
+                victimProtection = protection;
+                if (protection == 0) {
+                    break;
+                }
+            }
+        }
+        if (pVictim) {
+            freeChunk(pVictim);
+            m_evictionCount.fetch_add(1, std::memory_order_relaxed);
             pChunk = allocateChunk(chunkIndex);
+        } else if (m_lruCachingReaderChunk) {
+            // All chunks are more important than the requested one
+            m_rejectedHintCount.fetch_add(1, std::memory_order_relaxed);
         } else {
             kLogger.warning() << "No cached LRU chunk available for freeing";
         }
     }
     if (kLogger.traceEnabled()) {
-        kLogger.trace() << "allocateChunkExpireLRU" << chunkIndex << pChunk;
+        kLogger.trace() << "allocateChunkEvictByPriority" << chunkIndex << pChunk;
     }
     return pChunk;
 }
@@ -204,6 +314,16 @@ CachingReaderChunkForOwner* CachingReader::lookupChunkAndFreshen(SINT chunkIndex
     return pChunk;
 }
 
+CachingReader::Statistics CachingReader::statistics() const {
+    return Statistics{
+            m_hitCount.load(std::memory_order_relaxed),
+            m_missCount.load(std::memory_order_relaxed),
+            m_underflowCount.load(std::memory_order_relaxed),
+            m_evictionCount.load(std::memory_order_relaxed),
+            m_rejectedHintCount.load(std::memory_order_relaxed),
+    };
+}
+
 // Invoked from the UI thread!!
 #ifdef __STEM__
 void CachingReader::newTrack(TrackPointer pTrack, mixxx::StemChannelSelection stemMask) {
@@ -233,10 +353,27 @@ void CachingReader::newTrack(TrackPointer pTrack) {
 
 // Called from the engine thread
 void CachingReader::process() {
+    if (m_pPreload && atomicLoadRelaxed(m_state) != STATE_TRACK_LOADED) {
+        // Loading or unloading a track, the worker will free the preload
+        releasePreload();
+    }
     ReaderStatusUpdate update;
     while (m_readerStatusUpdateFIFO.read(&update, 1) == 1) {
         auto* pChunk = update.takeFromWorker();
-        if (pChunk) {
+        auto* pPreload = update.takePreload();
+        if (pPreload) {
+            DEBUG_ASSERT(update.status == TRACK_PRELOADED);
+            if (m_state.loadAcquire() != STATE_TRACK_LOADED) {
+                // The preload of the previous track
+                pPreload->releaseByReader();
+                continue;
+            }
+            DEBUG_ASSERT(!m_pPreload);
+            m_pPreload = pPreload;
+            m_readableFrameIndexRange = intersect(
+                    m_readableFrameIndexRange,
+                    update.readableFrameIndexRange());
+        } else if (pChunk) {
             // Result of a read request (with a chunk)
             DEBUG_ASSERT(atomicLoadRelaxed(m_state) != STATE_IDLE);
             DEBUG_ASSERT(
@@ -282,11 +419,13 @@ void CachingReader::process() {
                     DEBUG_ASSERT(atomicLoadRelaxed(m_state) == STATE_TRACK_LOADING);
                     freeAllChunks();
                 }
+                releasePreload();
                 // Reset the readable frame index range
                 m_readableFrameIndexRange = update.readableFrameIndexRange();
                 m_state.storeRelease(STATE_TRACK_LOADED);
             } else {
                 DEBUG_ASSERT(update.status == TRACK_UNLOADED);
+                releasePreload();
                 // This message could be processed later when a new
                 // track is already loading! In this case the TRACK_LOADED will
                 // be the very next status update.
@@ -448,8 +587,34 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
                 }
 
                 mixxx::IndexRange bufferedFrameIndexRange;
-                const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
-                if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                // Once the whole track is in memory the cached chunks are
+                // no longer needed.
+                const bool readFromPreload =
+                        m_pPreload && m_pPreload->channelCount() == channelCount;
+                const CachingReaderChunkForOwner* const pChunk =
+                        readFromPreload ? nullptr : lookupChunkAndFreshen(chunkIndex);
+                if (readFromPreload) {
+                    m_hitCount.fetch_add(1, std::memory_order_relaxed);
+                    // Read chunk by chunk like from the cache to reuse the
+                    // handling of unreadable frames below.
+                    const auto chunkFrameIndexRange = intersect(
+                            remainingFrameIndexRange,
+                            mixxx::IndexRange::forward(
+                                    chunkIndex * CachingReaderChunk::kFrames,
+                                    CachingReaderChunk::kFrames));
+                    if (reverse) {
+                        bufferedFrameIndexRange =
+                                m_pPreload->readBufferedSampleFramesReverse(
+                                        &buffer[samplesRemaining],
+                                        chunkFrameIndexRange);
+                    } else {
+                        bufferedFrameIndexRange =
+                                m_pPreload->readBufferedSampleFrames(
+                                        buffer,
+                                        chunkFrameIndexRange);
+                    }
+                } else if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                    m_hitCount.fetch_add(1, std::memory_order_relaxed);
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -470,6 +635,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
                     Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
+                    m_missCount.fetch_add(1, std::memory_order_relaxed);
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
                                 << "Cache miss for chunk with index"
@@ -486,6 +652,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
                         // the first required chunk. Inform the calling code that no
                         // data has been written into the buffer and to handle this
                         // situation appropriately.
+                        m_underflowCount.fetch_add(1, std::memory_order_relaxed);
                         return ReadResult::UNAVAILABLE;
                     }
                     // No more readable data available. Exit the loop and
@@ -533,6 +700,9 @@ CachingReader::ReadResult CachingReader::read(SINT startSample,
         SampleUtil::clear(buffer, samplesRemaining);
         result = ReadResult::PARTIALLY_AVAILABLE;
     }
+    if (result != ReadResult::AVAILABLE) {
+        m_underflowCount.fetch_add(1, std::memory_order_relaxed);
+    }
     return result;
 }
 
@@ -542,11 +712,21 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         return;
     }
 
+    // If the whole track is in memory, every read is a hit.
+    if (m_pPreload) {
+        return;
+    }
+
+    // Chunks that have not been hinted by this or the previous list of hints
+    // lose their protection.
+    ++m_hintGeneration;
+
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
 
     for (const auto& hint: hintList) {
+        const Hint::Priority priority = Hint::priorityOf(hint.type);
         SINT hintFrame = hint.frame;
         SINT hintFrameCount = hint.frameCount;
 
@@ -582,19 +762,22 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
             CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
             if (!pChunk) {
-                shouldWake = true;
-                pChunk = allocateChunkExpireLRU(chunkIndex);
+                pChunk = allocateChunkEvictByPriority(chunkIndex, priority);
                 if (!pChunk) {
-                    kLogger.warning()
-                            << "Failed to allocate chunk"
-                            << chunkIndex
-                            << "for read request";
+                    if (kLogger.traceEnabled()) {
+                        kLogger.trace()
+                                << "Failed to allocate chunk"
+                                << chunkIndex
+                                << "for read request";
+                    }
                     continue;
                 }
+                shouldWake = true;
+                pChunk->protect(toProtection(priority), m_hintGeneration);
                 // Do not insert the allocated chunk into the MRU/LRU list,
                 // because it will be handed over to the worker immediately
                 CachingReaderChunkReadRequest request;
-                request.giveToWorker(pChunk);
+                request.giveToWorker(pChunk, toProtection(priority));
                 if (kLogger.traceEnabled()) {
                     kLogger.trace()
                             << "Requesting read of chunk"
@@ -608,10 +791,13 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                     pChunk->takeFromWorker();
                     freeChunk(pChunk);
                 }
-            } else if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
-                // This will cause the chunk to be 'freshened' in the cache. The
-                // chunk will be moved to the end of the LRU list.
-                freshenChunk(pChunk);
+            } else {
+                pChunk->protect(toProtection(priority), m_hintGeneration);
+                if (pChunk->getState() == CachingReaderChunkForOwner::READY) {
+                    // This will cause the chunk to be 'freshened' in the cache. The
+                    // chunk will be moved to the end of the LRU list.
+                    freshenChunk(pChunk);
+                }
             }
         }
     }
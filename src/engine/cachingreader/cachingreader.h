@@ -5,6 +5,7 @@
 #include <QList>
 #include <QVarLengthArray>
 #include <QVector>
+#include <atomic>
 #include <list>
 
 #include "engine/cachingreader/cachingreaderworker.h"
@@ -18,26 +19,59 @@
 // the reader work thread.
 typedef struct Hint {
     enum class Type {
-        SlipPosition,     // prio 1 (so far unused Mixxx 2.3 priority for reference)
-        CurrentPosition,  // prio 1
-        LoopStartEnabled, // prio 2
-        MainCue,          // prio 10
-        HotCue,           // prio 10
-        LoopEndEnabled,   // prio 10
-        LoopStart,        // prio 10
-        FirstSound,
-        IntroStart,
-        IntroEnd,
-        OutroStart
+        SlipPosition,     // Priority::Playback
+        CurrentPosition,  // Priority::Playback
+        LoopStartEnabled, // Priority::Playback
+        MainCue,          // Priority::Cue
+        HotCue,           // Priority::Cue
+        LoopEndEnabled,   // Priority::Playback
+        LoopStart,        // Priority::Cue
+        FirstSound,       // Priority::Marker
+        IntroStart,       // Priority::Marker
+        IntroEnd,         // Priority::Marker
+        OutroStart        // Priority::Marker
     };
 
+    // How strongly the cached chunks referred to by a hint are protected
+    // against eviction, from the lowest to the highest priority. A chunk
+    // is only evicted in favor of a hint with the same or a higher
+    // priority, and chunks with the lowest priority are evicted first.
+    enum class Priority {
+        None = 0,
+        // Positions of track markers the user might jump to
+        Marker,
+        // Cue points and the start of the loop the user might jump to
+        Cue,
+        // Regions that are or will be played back soon
+        Playback,
+    };
+
+    static constexpr Priority priorityOf(Type type) {
+        switch (type) {
+        case Type::SlipPosition:
+        case Type::CurrentPosition:
+        case Type::LoopStartEnabled:
+        case Type::LoopEndEnabled:
+            return Priority::Playback;
+        case Type::MainCue:
+        case Type::HotCue:
+        case Type::LoopStart:
+            return Priority::Cue;
+        case Type::FirstSound:
+        case Type::IntroStart:
+        case Type::IntroEnd:
+        case Type::OutroStart:
+            return Priority::Marker;
+        }
+        return Priority::None;
+    }
+
     // The frame to ensure is present in memory.
     SINT frame;
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others.
+    // Determines the priority of the hint, see priorityOf().
     Type type;
 
     // for the default frame count in forward direction
@@ -74,8 +108,29 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least recently used chunks. When a chunk is "freshened" (i.e. accessed via
 // read or hinted via hintAndMaybeWake) then it is moved to the back of the
 // least-recently-used list. When a chunk needs to be allocated and there are no
-// free chunks then the least recently used chunk is free'd (see
-// allocateChunkExpireLRU).
+// free chunks then the least recently used chunk among those with the lowest
+// hint priority is free'd (see allocateChunkEvictByPriority). Chunks around
+// the play position and of enabled loops are thereby never evicted in favor
+// of cue or marker hints.
+//
+// The worker reads requested chunks in the order of their hint priority.
+// If several chunks are requested at once, e.g. after jumping to a hotcue,
+// they are decoded in parallel with separate audio sources of the track, so
+// the chunks of the play position are available after decoding a single
+// chunk instead of after the whole queue.
+//
+// The capacity of the cache is configured as a duration of audio, either per
+// deck with [ChannelN],cache_seconds or for all decks with
+// [App],cache_seconds. The memory required for this duration grows with the
+// number of channels, i.e. stem decks need 4 times the memory of stereo decks.
+//
+// Optionally the whole track is decoded into RAM in the background after
+// loading it, either per deck with [ChannelN],preload_track or for all
+// decks with [App],preload_tracks. Until decoding has completed the track
+// is streamed in chunks as usual, afterwards all reads are served from the
+// preloaded track without waking up the worker. If the memory of all
+// preloaded tracks would exceed [App],preload_budget_mb, the track is only
+// streamed in chunks.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -126,6 +181,35 @@ class CachingReader : public QObject {
         m_worker.setScheduler(pScheduler);
     }
 
+    struct Statistics {
+        // Chunks that were available when reading
+        quint64 hits;
+        // Chunks that were still missing or pending when reading
+        quint64 misses;
+        // Reads of the loaded track that returned PARTIALLY_AVAILABLE
+        // or UNAVAILABLE, i.e. could not be served completely
+        quint64 underflows;
+        // Chunks that have been freed to make room for a new chunk
+        quint64 evictions;
+        // Hinted chunks that could not be requested, because all
+        // cached chunks are protected by hints with a higher priority
+        quint64 rejectedHints;
+    };
+    // Returns a snapshot of the cache statistics since the construction.
+    // Thread-safe.
+    Statistics statistics() const;
+
+    // Whether the loaded track is still being decoded into RAM, see
+    // CachingReaderWorker::isPreloading(). Thread-safe.
+    bool isPreloading() const {
+        return m_worker.isPreloading();
+    }
+
+    // The number of chunks in memory. Constant after construction.
+    SINT numberOfCachedChunks() const {
+        return m_numberOfCachedChunks;
+    }
+
   signals:
     // Emitted once a new track is loaded and ready to be read from.
     void trackLoading();
@@ -138,6 +222,8 @@ class CachingReader : public QObject {
   private:
     const UserSettingsPointer m_pConfig;
 
+    const SINT m_numberOfCachedChunks;
+
     // Thread-safe FIFOs for communication between the engine callback and
     // reader thread.
     FIFO<CachingReaderChunkReadRequest> m_chunkReadRequestFIFO;
@@ -162,11 +248,17 @@ class CachingReader : public QObject {
     // Returns all allocated chunks to the free list
     void freeAllChunks();
 
+    // Returns the preloaded track to the worker
+    void releasePreload();
+
     // Gets a chunk from the free list. Returns nullptr if none available.
     CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
 
-    // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
-    CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
+    // Gets a chunk from the free list. If none is available the LRU chunk among
+    // those with the lowest protection is freed, unless it is protected with a
+    // higher priority than the given one.
+    CachingReaderChunkForOwner* allocateChunkEvictByPriority(
+            SINT chunkIndex, Hint::Priority priority);
 
     enum State {
         STATE_IDLE,
@@ -197,5 +289,19 @@ class CachingReader : public QObject {
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // Incremented for every list of hints. The protection of chunks by a
+    // hint expires if it has not been renewed by the next list of hints.
+    unsigned int m_hintGeneration;
+
+    // Only written from the engine thread
+    std::atomic<quint64> m_hitCount;
+    std::atomic<quint64> m_missCount;
+    std::atomic<quint64> m_underflowCount;
+    std::atomic<quint64> m_evictionCount;
+    std::atomic<quint64> m_rejectedHintCount;
+
+    // The whole track, if it has been preloaded. Borrowed from the worker.
+    CachingReaderPreload* m_pPreload;
+
     CachingReaderWorker m_worker;
 };
@@ -131,6 +131,8 @@ CachingReaderChunkForOwner::CachingReaderChunkForOwner(
         mixxx::SampleBuffer::WritableSlice sampleBuffer)
         : CachingReaderChunk(std::move(sampleBuffer)),
           m_state(FREE),
+          m_protectionPriority(0),
+          m_protectionGeneration(0),
           m_pPrev(nullptr),
           m_pNext(nullptr) {
 }
@@ -144,6 +146,7 @@ void CachingReaderChunkForOwner::init(SINT index) {
 
     CachingReaderChunk::init(index);
     m_state = READY;
+    m_protectionPriority = 0;
 }
 
 void CachingReaderChunkForOwner::free() {
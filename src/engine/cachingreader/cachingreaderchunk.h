@@ -143,9 +143,36 @@ public:
             CachingReaderChunkForOwner** ppHead,
             CachingReaderChunkForOwner** ppTail);
 
+    // The predecessor in the double-linked list, i.e. the neighbor
+    // in direction of the head.
+    CachingReaderChunkForOwner* getPrev() const noexcept {
+        return m_pPrev;
+    }
+
+    // Protects the chunk against eviction with the given priority. The
+    // protection expires unless it is renewed in the given or the next
+    // generation, see CachingReader::hintAndMaybeWake().
+    void protect(int priority, unsigned int generation) {
+        if (m_protectionGeneration != generation || m_protectionPriority < priority) {
+            m_protectionPriority = priority;
+            m_protectionGeneration = generation;
+        }
+    }
+    // Returns the priority of the protection that is still valid in the
+    // given generation or 0 if the chunk is unprotected.
+    int protection(unsigned int currentGeneration) const noexcept {
+        if (currentGeneration - m_protectionGeneration > 1) {
+            return 0;
+        }
+        return m_protectionPriority;
+    }
+
 private:
   State m_state;
 
+  int m_protectionPriority;
+  unsigned int m_protectionGeneration;
+
   CachingReaderChunkForOwner* m_pPrev; // previous item in double-linked list
   CachingReaderChunkForOwner* m_pNext; // next item in double-linked list
 };
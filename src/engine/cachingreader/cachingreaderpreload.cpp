@@ -0,0 +1,245 @@
+#include "engine/cachingreader/cachingreaderpreload.h"
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "util/assert.h"
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace {
+
+mixxx::Logger kLogger("CachingReaderPreload");
+
+// The same number of frames is decoded at once as for a single chunk, so the
+// worker keeps responding timely to chunk requests while preloading.
+constexpr SINT kFramesPerStep = CachingReaderChunk::kFrames;
+
+// The size of the memory pages that are touched for prefaulting
+constexpr SINT kPageSize = 4096;
+
+} // anonymous namespace
+
+// static
+std::atomic<qint64> CachingReaderPreload::s_allocatedBytes{0};
+
+// static
+mixxx::audio::ChannelCount CachingReaderPreload::bufferedChannelCount(
+        const mixxx::AudioSourcePointer& pAudioSource) {
+    // See CachingReaderChunk::bufferSampleFrames()
+    const auto channelCount = pAudioSource->getSignalInfo().getChannelCount();
+    if (channelCount % mixxx::audio::ChannelCount::stereo() != 0) {
+        return mixxx::audio::ChannelCount::stereo();
+    }
+    return channelCount;
+}
+
+// static
+bool CachingReaderPreload::reserveBudget(qint64 bytes, qint64 budgetBytes) {
+    qint64 allocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed);
+    do {
+        if (allocatedBytes + bytes > budgetBytes) {
+            kLogger.info()
+                    << "Not preloading" << bytes << "bytes, because"
+                    << allocatedBytes << "of" << budgetBytes
+                    << "bytes are already in use";
+            return false;
+        }
+    } while (!s_allocatedBytes.compare_exchange_weak(
+            allocatedBytes, allocatedBytes + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+// static
+std::unique_ptr<CachingReaderPreload> CachingReaderPreload::allocate(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        qint64 budgetBytes) {
+    VERIFY_OR_DEBUG_ASSERT(pAudioSource) {
+        return nullptr;
+    }
+    const auto frameIndexRange = pAudioSource->frameIndexRange();
+    const auto channelCount = bufferedChannelCount(pAudioSource);
+    const SINT sampleCount = CachingReaderChunk::frames2samples(
+            frameIndexRange.length(), channelCount);
+    const qint64 bytes = static_cast<qint64>(sampleCount) * sizeof(CSAMPLE);
+
+    // Reserve the memory before allocating it
+    if (!reserveBudget(bytes, budgetBytes)) {
+        return nullptr;
+    }
+    mixxx::SampleBuffer sampleBuffer(sampleCount);
+    if (sampleCount > 0 && !sampleBuffer.data()) {
+        kLogger.warning()
+                << "Failed to allocate" << bytes << "bytes for preloading"
+                << pAudioSource->getUrlString();
+        s_allocatedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return std::unique_ptr<CachingReaderPreload>(new CachingReaderPreload(
+            frameIndexRange, channelCount, std::move(sampleBuffer), nullptr, bytes));
+}
+
+// static
+std::unique_ptr<CachingReaderPreload> CachingReaderPreload::map(
+        mixxx::MappedSampleFramesPointer pMappedSampleFrames,
+        qint64 budgetBytes) {
+    VERIFY_OR_DEBUG_ASSERT(pMappedSampleFrames) {
+        return nullptr;
+    }
+    const auto frameIndexRange = pMappedSampleFrames->frameIndexRange();
+    const auto channelCount = pMappedSampleFrames->getSignalInfo().getChannelCount();
+    if (channelCount % mixxx::audio::ChannelCount::stereo() != 0) {
+        // Not readable by the engine without conversion
+        return nullptr;
+    }
+    const qint64 bytes = static_cast<qint64>(CachingReaderChunk::frames2samples(
+                                 frameIndexRange.length(), channelCount)) *
+            sizeof(CSAMPLE);
+    // Mapped pages stay resident as long as they are used, so
+    // they count like allocated memory.
+    if (!reserveBudget(bytes, budgetBytes)) {
+        return nullptr;
+    }
+    return std::unique_ptr<CachingReaderPreload>(new CachingReaderPreload(
+            frameIndexRange,
+            channelCount,
+            mixxx::SampleBuffer(),
+            std::move(pMappedSampleFrames),
+            bytes));
+}
+
+CachingReaderPreload::CachingReaderPreload(
+        mixxx::IndexRange frameIndexRange,
+        mixxx::audio::ChannelCount channelCount,
+        mixxx::SampleBuffer sampleBuffer,
+        mixxx::MappedSampleFramesPointer pMappedSampleFrames,
+        qint64 allocatedBytes)
+        : m_frameIndexRange(frameIndexRange),
+          m_channelCount(channelCount),
+          m_sampleBuffer(std::move(sampleBuffer)),
+          m_pMappedSampleFrames(std::move(pMappedSampleFrames)),
+          m_pSamples(m_pMappedSampleFrames
+                          ? m_pMappedSampleFrames->readableSampleFrames(frameIndexRange)
+                                    .readableData()
+                          : m_sampleBuffer.data()),
+          m_allocatedBytes(allocatedBytes),
+          m_bufferedFrameIndexRange(mixxx::IndexRange::forward(frameIndexRange.start(), 0)),
+          m_prefaultChecksum(0),
+          m_lentToReader(false) {
+}
+
+CachingReaderPreload::~CachingReaderPreload() {
+    DEBUG_ASSERT(!isLentToReader());
+    releaseBudget();
+}
+
+void CachingReaderPreload::releaseBudget() {
+    s_allocatedBytes.fetch_sub(m_allocatedBytes, std::memory_order_relaxed);
+    m_allocatedBytes = 0;
+}
+
+void CachingReaderPreload::prefaultNextSampleFrames() {
+    const auto frameIndexRange = intersect(
+            mixxx::IndexRange::forward(m_bufferedFrameIndexRange.end(), kFramesPerStep),
+            m_frameIndexRange);
+    const SINT firstSample = CachingReaderChunk::frames2samples(
+            frameIndexRange.start() - m_frameIndexRange.start(), m_channelCount);
+    const SINT endSample = firstSample +
+            CachingReaderChunk::frames2samples(frameIndexRange.length(), m_channelCount);
+    constexpr SINT kSamplesPerPage = kPageSize / sizeof(CSAMPLE);
+    for (SINT i = firstSample; i < endSample; i += kSamplesPerPage) {
+        m_prefaultChecksum += m_pSamples[i];
+    }
+    m_prefaultChecksum += m_pSamples[endSample - 1];
+    m_bufferedFrameIndexRange.growBack(frameIndexRange.length());
+    m_lastBufferedSampleFrames = mixxx::ReadableSampleFrames(frameIndexRange,
+            mixxx::SampleBuffer::ReadableSlice(
+                    m_pSamples + firstSample, endSample - firstSample));
+}
+
+bool CachingReaderPreload::bufferNextSampleFrames(
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer::WritableSlice tempOutputBuffer) {
+    DEBUG_ASSERT(!isComplete());
+    if (m_pMappedSampleFrames) {
+        prefaultNextSampleFrames();
+        return true;
+    }
+    const auto frameIndexRange = intersect(
+            mixxx::IndexRange::forward(m_bufferedFrameIndexRange.end(), kFramesPerStep),
+            m_frameIndexRange);
+    const SINT sampleOffset = CachingReaderChunk::frames2samples(
+            m_bufferedFrameIndexRange.length(), m_channelCount);
+    const auto writableSampleFrames = mixxx::WritableSampleFrames(
+            frameIndexRange,
+            mixxx::SampleBuffer::WritableSlice(
+                    m_sampleBuffer.data(sampleOffset),
+                    CachingReaderChunk::frames2samples(
+                            frameIndexRange.length(), m_channelCount)));
+    mixxx::ReadableSampleFrames readableSampleFrames;
+    if (pAudioSource->getSignalInfo().getChannelCount() != m_channelCount) {
+        mixxx::AudioSourceStereoProxy audioSourceProxy(
+                pAudioSource,
+                tempOutputBuffer);
+        readableSampleFrames = audioSourceProxy.readSampleFrames(writableSampleFrames);
+    } else {
+        readableSampleFrames = pAudioSource->readSampleFrames(writableSampleFrames);
+    }
+    if (readableSampleFrames.frameIndexRange() != frameIndexRange) {
+        // The gaps of unreadable audio data are handled by the chunks
+        kLogger.warning()
+                << "Failed to preload sample frames:"
+                << "expected =" << frameIndexRange
+                << ", actual =" << readableSampleFrames.frameIndexRange();
+        return false;
+    }
+    m_bufferedFrameIndexRange.growBack(frameIndexRange.length());
+    m_lastBufferedSampleFrames = readableSampleFrames;
+    return true;
+}
+
+mixxx::IndexRange CachingReaderPreload::readBufferedSampleFrames(
+        CSAMPLE* sampleBuffer,
+        const mixxx::IndexRange& frameIndexRange) const {
+    DEBUG_ASSERT(isLentToReader());
+    const auto copyableFrameIndexRange =
+            intersect(frameIndexRange, m_bufferedFrameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start(),
+                m_channelCount);
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start(),
+                m_channelCount);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length(), m_channelCount);
+        SampleUtil::copy(
+                sampleBuffer + dstSampleOffset,
+                m_pSamples + srcSampleOffset,
+                sampleCount);
+    }
+    return copyableFrameIndexRange;
+}
+
+mixxx::IndexRange CachingReaderPreload::readBufferedSampleFramesReverse(
+        CSAMPLE* reverseSampleBuffer,
+        const mixxx::IndexRange& frameIndexRange) const {
+    DEBUG_ASSERT(isLentToReader());
+    const auto copyableFrameIndexRange =
+            intersect(frameIndexRange, m_bufferedFrameIndexRange);
+    if (!copyableFrameIndexRange.empty()) {
+        const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - frameIndexRange.start(),
+                m_channelCount);
+        const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.start() - m_frameIndexRange.start(),
+                m_channelCount);
+        const SINT sampleCount = CachingReaderChunk::frames2samples(
+                copyableFrameIndexRange.length(), m_channelCount);
+        SampleUtil::copyReverse(
+                reverseSampleBuffer - dstSampleOffset - sampleCount,
+                m_pSamples + srcSampleOffset,
+                sampleCount,
+                m_channelCount);
+    }
+    return copyableFrameIndexRange;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "audio/types.h"
+#include "sources/audiosource.h"
+#include "sources/decodedaudiocache.h"
+#include "util/samplebuffer.h"
+
+// The decoded sample data of a whole track in a single contiguous buffer.
+//
+// The buffer is filled sequentially by the CachingReaderWorker in the
+// background, one chunk at a time. After it is complete, the worker hands
+// it over to the CachingReader that serves all reads from it. Ownership
+// stays with the worker, the CachingReader only borrows the buffer until it
+// calls releaseByReader(). This ensures that the memory is never freed on
+// the engine thread.
+//
+// Tracks from the DecodedAudioCache are not copied, instead the mapped
+// memory is used directly. Their pages are touched in the background so
+// that reading from the engine thread doesn't cause page faults.
+//
+// The memory of all preloaded tracks is accounted against a budget that
+// is shared between all decks.
+class CachingReaderPreload final {
+  public:
+    // Reserves and allocates the memory for all frames of the audio source.
+    // Returns nullptr if the memory would exceed the budget or if the
+    // allocation failed.
+    static std::unique_ptr<CachingReaderPreload> allocate(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            qint64 budgetBytes);
+    // Reserves the memory for the mapped frames of a cached track.
+    // Returns nullptr if the memory would exceed the budget.
+    static std::unique_ptr<CachingReaderPreload> map(
+            mixxx::MappedSampleFramesPointer pMappedSampleFrames,
+            qint64 budgetBytes);
+    ~CachingReaderPreload();
+
+    CachingReaderPreload(const CachingReaderPreload&) = delete;
+    CachingReaderPreload& operator=(const CachingReaderPreload&) = delete;
+
+    // The total memory of all preloaded tracks in bytes. Thread-safe.
+    static qint64 allocatedBytes() {
+        return s_allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    // The number of interleaved channels in the buffer, which might differ
+    // from the number of channels of the audio source.
+    mixxx::audio::ChannelCount channelCount() const {
+        return m_channelCount;
+    }
+
+    // The number of interleaved channels in the buffer for the given
+    // audio source.
+    static mixxx::audio::ChannelCount bufferedChannelCount(
+            const mixxx::AudioSourcePointer& pAudioSource);
+
+    // Worker only: Decodes the next frames of the track. Returns false
+    // if reading failed and the preload needs to be abandoned.
+    bool bufferNextSampleFrames(
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
+    // Worker only: The frames that have been decoded by the last
+    // invocation of bufferNextSampleFrames().
+    const mixxx::ReadableSampleFrames& lastBufferedSampleFrames() const {
+        return m_lastBufferedSampleFrames;
+    }
+    // Worker only
+    bool isComplete() const {
+        return m_bufferedFrameIndexRange.end() == m_frameIndexRange.end();
+    }
+
+    // Worker only: Lends the completely decoded buffer to the reader.
+    void lendToReader() {
+        DEBUG_ASSERT(isComplete());
+        m_lentToReader.store(true, std::memory_order_release);
+    }
+    // Worker only: The buffer must not be destroyed before the reader has
+    // released it.
+    bool isLentToReader() const {
+        return m_lentToReader.load(std::memory_order_acquire);
+    }
+    // Reader only: Returns the buffer to the worker. The reader must not
+    // access it afterwards.
+    void releaseByReader() {
+        m_lentToReader.store(false, std::memory_order_release);
+    }
+
+    // Worker only: Excludes the memory from the budget ahead of the
+    // destruction, when the buffer is no longer needed but still lent
+    // to the reader.
+    void releaseBudget();
+
+    // Reader only: Copies the requested sample frames as far as available
+    // and returns the range of frames that have been copied.
+    mixxx::IndexRange readBufferedSampleFrames(
+            CSAMPLE* sampleBuffer,
+            const mixxx::IndexRange& frameIndexRange) const;
+    mixxx::IndexRange readBufferedSampleFramesReverse(
+            CSAMPLE* reverseSampleBuffer,
+            const mixxx::IndexRange& frameIndexRange) const;
+
+  private:
+    CachingReaderPreload(
+            mixxx::IndexRange frameIndexRange,
+            mixxx::audio::ChannelCount channelCount,
+            mixxx::SampleBuffer sampleBuffer,
+            mixxx::MappedSampleFramesPointer pMappedSampleFrames,
+            qint64 allocatedBytes);
+
+    static bool reserveBudget(qint64 bytes, qint64 budgetBytes);
+
+    // Touches the next mapped pages instead of decoding
+    void prefaultNextSampleFrames();
+
+    static std::atomic<qint64> s_allocatedBytes;
+
+    const mixxx::IndexRange m_frameIndexRange;
+    const mixxx::audio::ChannelCount m_channelCount;
+    // Either the samples are owned or mapped
+    mixxx::SampleBuffer m_sampleBuffer;
+    const mixxx::MappedSampleFramesPointer m_pMappedSampleFrames;
+    const CSAMPLE* const m_pSamples;
+    qint64 m_allocatedBytes;
+
+    // Grows from the start of m_frameIndexRange while decoding
+    mixxx::IndexRange m_bufferedFrameIndexRange;
+    mixxx::ReadableSampleFrames m_lastBufferedSampleFrames;
+    // Prevents that the reads for touching the pages are optimized away
+    CSAMPLE m_prefaultChecksum;
+
+    std::atomic<bool> m_lentToReader;
+};
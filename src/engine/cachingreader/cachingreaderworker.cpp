@@ -1,7 +1,12 @@
 #include "engine/cachingreader/cachingreaderworker.h"
 
 #include <QAtomicInt>
+#include <QFuture>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtConcurrentRun>
 #include <QtDebug>
+#include <algorithm>
 
 #include "analyzer/analyzersilence.h"
 #include "moc_cachingreaderworker.cpp"
@@ -20,45 +25,271 @@ mixxx::Logger kLogger("CachingReaderWorker");
 // we need the last silence frame and the first sound frame
 constexpr SINT kNumSoundFrameToVerify = 2;
 
+// Shared by the workers of all decks
+Q_GLOBAL_STATIC(QThreadPool, s_decodeThreadPool);
+
+// -1 until overridden by setMaxParallelDecoders()
+std::atomic<int> s_maxParallelDecoders{-1};
+std::atomic<int> s_openParallelDecoders{0};
+
+int defaultMaxParallelDecoders() {
+    // Leave some cores to the engine and the workers of the decks
+    return std::clamp(QThread::idealThreadCount() / 2 - 1,
+            0,
+            CachingReaderWorker::kMaxParallelDecoders);
+}
+
+// Reserves one of the parallel decoders of all decks. Returns false if
+// all of them are in use.
+bool acquireParallelDecoder() {
+    const int maxParallelDecoders = CachingReaderWorker::maxParallelDecoders();
+    int openParallelDecoders = s_openParallelDecoders.load(std::memory_order_relaxed);
+    do {
+        if (openParallelDecoders >= maxParallelDecoders) {
+            return false;
+        }
+    } while (!s_openParallelDecoders.compare_exchange_weak(
+            openParallelDecoders, openParallelDecoders + 1, std::memory_order_relaxed));
+    return true;
+}
+
+void releaseParallelDecoder() {
+    const int openParallelDecoders =
+            s_openParallelDecoders.fetch_sub(1, std::memory_order_relaxed);
+    DEBUG_ASSERT(openParallelDecoders > 0);
+    Q_UNUSED(openParallelDecoders);
+}
+
+void updateDecodeThreadPool() {
+    s_decodeThreadPool->setMaxThreadCount(
+            std::max(CachingReaderWorker::maxParallelDecoders(), 1));
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+    s_decodeThreadPool->setThreadPriority(QThread::HighPriority);
+#endif
+}
+
 } // anonymous namespace
 
+// static
+int CachingReaderWorker::maxParallelDecoders() {
+    const int maxParallelDecoders = s_maxParallelDecoders.load(std::memory_order_relaxed);
+    if (maxParallelDecoders < 0) {
+        return defaultMaxParallelDecoders();
+    }
+    return maxParallelDecoders;
+}
+
+// static
+void CachingReaderWorker::setMaxParallelDecoders(int maxParallelDecoders) {
+    s_maxParallelDecoders.store(
+            std::clamp(maxParallelDecoders, 0, kMaxParallelDecoders),
+            std::memory_order_relaxed);
+    updateDecodeThreadPool();
+}
+
+// static
+int CachingReaderWorker::openParallelDecoders() {
+    return s_openParallelDecoders.load(std::memory_order_relaxed);
+}
+
 CachingReaderWorker::CachingReaderWorker(
         const QString& group,
         FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
         FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
-        mixxx::audio::ChannelCount maxSupportedChannel)
+        mixxx::audio::ChannelCount maxSupportedChannel,
+        qint64 preloadBudgetBytes,
+        std::shared_ptr<mixxx::DecodedAudioCache> pDecodedAudioCache)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
-          m_maxSupportedChannel(maxSupportedChannel) {
+          m_maxSupportedChannel(maxSupportedChannel),
+          m_preloadBudgetBytes(preloadBudgetBytes),
+          m_preloadPending(false),
+          m_preloading(false),
+          m_pDecodedAudioCache(std::move(pDecodedAudioCache)) {
+    m_parallelDecoders.resize(kMaxParallelDecoders);
+    updateDecodeThreadPool();
+}
+
+CachingReaderWorker::~CachingReaderWorker() {
+    // Leave the parallel decoders to the other decks
+    closeParallelDecoders();
+}
+
+void CachingReaderWorker::processReadRequests() {
+    DEBUG_ASSERT(m_readRequests.empty());
+    CachingReaderChunkReadRequest request;
+    while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        m_readRequests.push_back(request);
+    }
+    // Requests with the same priority are read in the order of the hints
+    std::stable_sort(m_readRequests.begin(),
+            m_readRequests.end(),
+            [](const CachingReaderChunkReadRequest& lhs,
+                    const CachingReaderChunkReadRequest& rhs) {
+                return lhs.priority > rhs.priority;
+            });
+
+    auto nextRequest = m_readRequests.cbegin();
+    while (nextRequest != m_readRequests.cend()) {
+        if (m_newTrackAvailable.loadAcquire()) {
+            // The results would be discarded anyway
+            for (; nextRequest != m_readRequests.cend(); ++nextRequest) {
+                const auto update = ReaderStatusUpdate::readDiscarded(nextRequest->chunk);
+                m_pReaderStatusFIFO->writeBlocking(&update, 1);
+            }
+            break;
+        }
+        const CachingReaderChunkReadRequest& mainRequest = *nextRequest++;
+
+        QVarLengthArray<CachingReaderChunkReadRequest, kMaxParallelDecoders> parallelRequests;
+        QVarLengthArray<QFuture<std::optional<ReaderStatusUpdate>>, kMaxParallelDecoders>
+                parallelResults;
+        for (auto& decoder : m_parallelDecoders) {
+            if (nextRequest == m_readRequests.cend()) {
+                break;
+            }
+            if (decoder.failed) {
+                continue;
+            }
+            if (!decoder.acquired) {
+                // The decoders of all decks are bounded, the remaining
+                // requests are read by the worker
+                if (!acquireParallelDecoder()) {
+                    break;
+                }
+                decoder.acquired = true;
+            }
+            const CachingReaderChunkReadRequest parallelRequest = *nextRequest++;
+            ParallelDecoder* pDecoder = &decoder;
+            parallelRequests.append(parallelRequest);
+            parallelResults.append(QtConcurrent::run(s_decodeThreadPool(),
+                    [this, parallelRequest, pDecoder] {
+                        return processParallelReadRequest(parallelRequest, pDecoder);
+                    }));
+        }
+
+        // The result of the most important request is available without
+        // waiting for the others, i.e. after decoding a single chunk.
+        finishReadRequest(mainRequest,
+                processReadRequest(mainRequest, m_pAudioSource, &m_tempReadBuffer));
+        for (int i = 0; i < parallelResults.size(); ++i) {
+            std::optional<ReaderStatusUpdate> update = parallelResults[i].result();
+            if (!update) {
+                update = processReadRequest(
+                        parallelRequests[i], m_pAudioSource, &m_tempReadBuffer);
+            }
+            finishReadRequest(parallelRequests[i], *update);
+        }
+    }
+    m_readRequests.clear();
+}
+
+void CachingReaderWorker::finishReadRequest(
+        const CachingReaderChunkReadRequest& request,
+        const ReaderStatusUpdate& update) {
+    if (update.status == CHUNK_READ_SUCCESS) {
+        verifyFirstSound(request.chunk, m_pAudioSource->getSignalInfo().getChannelCount());
+    }
+    m_pReaderStatusFIFO->writeBlocking(&update, 1);
+}
+
+std::optional<ReaderStatusUpdate> CachingReaderWorker::processParallelReadRequest(
+        const CachingReaderChunkReadRequest& request,
+        ParallelDecoder* pDecoder) const {
+    if (!pDecoder->pAudioSource) {
+        pDecoder->pAudioSource = openParallelAudioSource();
+        if (!pDecoder->pAudioSource) {
+            // Don't try again for this track
+            pDecoder->failed = true;
+            pDecoder->acquired = false;
+            releaseParallelDecoder();
+            return std::nullopt;
+        }
+        const SINT tempReadBufferSize =
+                pDecoder->pAudioSource->getSignalInfo().frames2samples(
+                        CachingReaderChunk::kFrames);
+        if (pDecoder->tempReadBuffer.size() != tempReadBufferSize) {
+            mixxx::SampleBuffer(tempReadBufferSize).swap(pDecoder->tempReadBuffer);
+        }
+    }
+    return processReadRequest(request, pDecoder->pAudioSource, &pDecoder->tempReadBuffer);
+}
+
+mixxx::AudioSourcePointer CachingReaderWorker::openParallelAudioSource() const {
+    DEBUG_ASSERT(m_pLoadedTrack);
+    DEBUG_ASSERT(m_pAudioSource);
+    mixxx::AudioSourcePointer pAudioSource;
+    if (std::dynamic_pointer_cast<mixxx::AudioSourceDecodedCache>(m_pAudioSource)) {
+        pAudioSource = m_pDecodedAudioCache->openAudioSource(m_pLoadedTrack, m_openParams);
+    } else {
+        pAudioSource = SoundSourceProxy(m_pLoadedTrack).openAudioSource(m_openParams);
+    }
+    if (!pAudioSource) {
+        kLogger.warning()
+                << m_group
+                << "Failed to open a parallel decoder for"
+                << m_pLoadedTrack->getFileInfo();
+        return nullptr;
+    }
+    // Chunks must be identical regardless of the decoder
+    if (pAudioSource->getSignalInfo() != m_pAudioSource->getSignalInfo() ||
+            pAudioSource->frameIndexRange() != m_pAudioSource->frameIndexRange()) {
+        kLogger.warning()
+                << m_group
+                << "Parallel decoder differs from the main decoder:"
+                << pAudioSource->getSignalInfo()
+                << pAudioSource->frameIndexRange();
+        pAudioSource->close();
+        return nullptr;
+    }
+    return pAudioSource;
 }
 
+void CachingReaderWorker::closeParallelDecoders() {
+    for (auto& decoder : m_parallelDecoders) {
+        if (decoder.pAudioSource) {
+            decoder.pAudioSource->close();
+            decoder.pAudioSource.reset();
+        }
+        if (decoder.acquired) {
+            decoder.acquired = false;
+            releaseParallelDecoder();
+        }
+        decoder.failed = false;
+    }
+}
+
+// May be called from the decode threads concurrently, each with its own
+// audio source and buffer
 ReaderStatusUpdate CachingReaderWorker::processReadRequest(
-        const CachingReaderChunkReadRequest& request) {
+        const CachingReaderChunkReadRequest& request,
+        const mixxx::AudioSourcePointer& pAudioSource,
+        mixxx::SampleBuffer* pTempReadBuffer) const {
     CachingReaderChunk* pChunk = request.chunk;
     DEBUG_ASSERT(pChunk);
 
     // Before trying to read any data we need to check if the audio source
     // is available and if any audio data that is needed by the chunk is
     // actually available.
-    auto chunkFrameIndexRange = pChunk->frameIndexRange(m_pAudioSource);
-    DEBUG_ASSERT(!m_pAudioSource ||
-            chunkFrameIndexRange.isSubrangeOf(m_pAudioSource->frameIndexRange()));
+    auto chunkFrameIndexRange = pChunk->frameIndexRange(pAudioSource);
+    DEBUG_ASSERT(!pAudioSource ||
+            chunkFrameIndexRange.isSubrangeOf(pAudioSource->frameIndexRange()));
     if (chunkFrameIndexRange.empty()) {
         ReaderStatusUpdate result;
-        result.init(CHUNK_READ_INVALID, pChunk, m_pAudioSource ? m_pAudioSource->frameIndexRange() : mixxx::IndexRange());
+        result.init(CHUNK_READ_INVALID, pChunk, pAudioSource ? pAudioSource->frameIndexRange() : mixxx::IndexRange());
         return result;
     }
 
     // Try to read the data required for the chunk from the audio source
     const mixxx::IndexRange bufferedFrameIndexRange = pChunk->bufferSampleFrames(
-            m_pAudioSource,
-            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
-    DEBUG_ASSERT(!m_pAudioSource ||
-            bufferedFrameIndexRange.isSubrangeOf(m_pAudioSource->frameIndexRange()));
+            pAudioSource,
+            mixxx::SampleBuffer::WritableSlice(*pTempReadBuffer));
+    DEBUG_ASSERT(!pAudioSource ||
+            bufferedFrameIndexRange.isSubrangeOf(pAudioSource->frameIndexRange()));
     // The readable frame range might have changed
-    chunkFrameIndexRange = intersect(chunkFrameIndexRange, m_pAudioSource->frameIndexRange());
+    chunkFrameIndexRange = intersect(chunkFrameIndexRange, pAudioSource->frameIndexRange());
     DEBUG_ASSERT(bufferedFrameIndexRange.empty() ||
             bufferedFrameIndexRange.isSubrangeOf(chunkFrameIndexRange));
 
@@ -84,13 +315,107 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     // to further checks whether a automatic offset adjustment is possible or a the
     // sample position metadata shall be treated as outdated.
     // Failures of the sanity check only result in an entry into the log at the moment.
-    verifyFirstSound(pChunk, m_pAudioSource->getSignalInfo().getChannelCount());
+    // See finishReadRequest().
 
     ReaderStatusUpdate result;
-    result.init(status, pChunk, m_pAudioSource ? m_pAudioSource->frameIndexRange() : mixxx::IndexRange());
+    result.init(status, pChunk, pAudioSource ? pAudioSource->frameIndexRange() : mixxx::IndexRange());
     return result;
 }
 
+void CachingReaderWorker::processPreload() {
+    if (m_preloadPending) {
+        m_preloadPending = false;
+        DEBUG_ASSERT(!m_pPreload);
+        // Continue with chunked streaming if the budget is exhausted
+        const auto pCachedAudioSource =
+                std::dynamic_pointer_cast<mixxx::AudioSourceDecodedCache>(
+                        m_pAudioSource);
+        if (pCachedAudioSource) {
+            m_pPreload = CachingReaderPreload::map(
+                    pCachedAudioSource->mappedSampleFrames(),
+                    m_preloadBudgetBytes);
+        } else {
+            m_pPreload = CachingReaderPreload::allocate(
+                    m_pAudioSource, m_preloadBudgetBytes);
+        }
+        if (!m_pPreload) {
+            m_pDecodedAudioCacheWriter.reset();
+            m_preloading.store(false, std::memory_order_release);
+        }
+        return;
+    }
+
+    DEBUG_ASSERT(m_pPreload && !m_pPreload->isComplete());
+    if (!m_pPreload->bufferNextSampleFrames(
+                m_pAudioSource,
+                mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer))) {
+        kLogger.warning()
+                << m_group
+                << "Continuing with chunked streaming after preloading failed";
+        m_pPreload.reset();
+        m_pDecodedAudioCacheWriter.reset();
+        m_preloading.store(false, std::memory_order_release);
+        return;
+    }
+    writePreloadToCache();
+    if (!m_pPreload->isComplete()) {
+        return;
+    }
+
+    kLogger.info()
+            << m_group
+            << "Preloaded the whole track,"
+            << CachingReaderPreload::allocatedBytes()
+            << "bytes are in use for preloaded tracks";
+    m_pPreload->lendToReader();
+    const auto update = ReaderStatusUpdate::trackPreloaded(
+            m_pPreload.get(),
+            m_pAudioSource->frameIndexRange());
+    m_pReaderStatusFIFO->writeBlocking(&update, 1);
+    m_preloading.store(false, std::memory_order_release);
+}
+
+void CachingReaderWorker::writePreloadToCache() {
+    if (!m_pDecodedAudioCacheWriter) {
+        return;
+    }
+    if (!m_pDecodedAudioCacheWriter->write(m_pPreload->lastBufferedSampleFrames())) {
+        m_pDecodedAudioCacheWriter.reset();
+        return;
+    }
+    if (m_pDecodedAudioCacheWriter->isComplete()) {
+        m_pDecodedAudioCacheWriter->commit();
+        m_pDecodedAudioCacheWriter.reset();
+    }
+}
+
+void CachingReaderWorker::retirePreload() {
+    m_preloadPending = false;
+    m_preloading.store(false, std::memory_order_release);
+    // Discards the incomplete cache file
+    m_pDecodedAudioCacheWriter.reset();
+    if (!m_pPreload) {
+        return;
+    }
+    if (m_pPreload->isLentToReader()) {
+        // The memory can be used for the next track, even though it
+        // will be freed only after the reader has released it.
+        m_pPreload->releaseBudget();
+        m_retiredPreloads.push_back(std::move(m_pPreload));
+    }
+    m_pPreload.reset();
+}
+
+void CachingReaderWorker::deleteReleasedPreloads() {
+    m_retiredPreloads.erase(
+            std::remove_if(m_retiredPreloads.begin(),
+                    m_retiredPreloads.end(),
+                    [](const auto& pPreload) {
+                        return !pPreload->isLentToReader();
+                    }),
+            m_retiredPreloads.end());
+}
+
 // WARNING: Always called from a different thread (GUI)
 #ifdef __STEM__
 void CachingReaderWorker::newTrack(TrackPointer pTrack, mixxx::StemChannelSelection stemMask) {
@@ -120,8 +445,9 @@ void CachingReaderWorker::run() {
 
     Event::start(m_tag);
     while (!m_stop.loadAcquire()) {
-        // Request is initialized by reading from FIFO
-        CachingReaderChunkReadRequest request;
+        if (!m_retiredPreloads.empty()) {
+            deleteReleasedPreloads();
+        }
         if (m_newTrackAvailable.loadAcquire()) {
 #ifdef __STEM__
             NewTrackRequest pLoadTrack;
@@ -146,10 +472,13 @@ void CachingReaderWorker::run() {
                 // here, the engine is already stopped
                 unloadTrack();
             }
-        } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
-            // Read the requested chunk and send the result
-            const ReaderStatusUpdate update = processReadRequest(request);
-            m_pReaderStatusFIFO->writeBlocking(&update, 1);
+        } else if (m_pChunkReadRequestFIFO->readAvailable()) {
+            // Read the requested chunks and send the results
+            processReadRequests();
+        } else if (m_preloadPending || (m_pPreload && !m_pPreload->isComplete())) {
+            // Decode the track in the background while there is
+            // nothing else to do
+            processPreload();
         } else {
             Event::end(m_tag);
             m_semaRun.acquire();
@@ -169,6 +498,11 @@ void CachingReaderWorker::discardAllPendingRequests() {
 void CachingReaderWorker::closeAudioSource() {
     discardAllPendingRequests();
 
+    retirePreload();
+
+    closeParallelDecoders();
+    m_pLoadedTrack.reset();
+
     if (m_pAudioSource) {
         // Closes open file handles of the old track.
         m_pAudioSource->close();
@@ -217,7 +551,12 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 #ifdef __STEM__
     config.setStemMask(stemMask);
 #endif
-    m_pAudioSource = SoundSourceProxy(pTrack).openAudioSource(config);
+    if (m_pDecodedAudioCache) {
+        m_pAudioSource = m_pDecodedAudioCache->openAudioSource(pTrack, config);
+    }
+    if (!m_pAudioSource) {
+        m_pAudioSource = SoundSourceProxy(pTrack).openAudioSource(config);
+    }
     if (!m_pAudioSource) {
         kLogger.warning()
                 << m_group
@@ -267,6 +606,9 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         return;
     }
 
+    m_pLoadedTrack = pTrack;
+    m_openParams = config;
+
     // Adjust the internal buffer
     const SINT tempReadBufferSize =
             m_pAudioSource->getSignalInfo().frames2samples(
@@ -294,6 +636,22 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // trackLoaded() signal
     DEBUG_ASSERT(!m_pChunkReadRequestFIFO->readAvailable());
 
+    // Until preloading has completed the track is streamed in chunks
+    m_preloadPending = m_preloadBudgetBytes > 0;
+    m_preloading.store(m_preloadPending, std::memory_order_release);
+    if (m_preloadPending && m_pDecodedAudioCache &&
+            !std::dynamic_pointer_cast<mixxx::AudioSourceDecodedCache>(
+                    m_pAudioSource)) {
+        m_pDecodedAudioCacheWriter = m_pDecodedAudioCache->createWriter(
+                pTrack,
+                config,
+                mixxx::audio::SignalInfo(
+                        CachingReaderPreload::bufferedChannelCount(m_pAudioSource),
+                        m_pAudioSource->getSignalInfo().getSampleRate()),
+                m_pAudioSource->getBitrate(),
+                m_pAudioSource->frameIndexRange());
+    }
+
     emit trackLoaded(
             pTrack,
             m_pAudioSource->getSignalInfo().getSampleRate(),
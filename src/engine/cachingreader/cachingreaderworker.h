@@ -2,12 +2,19 @@
 
 #include <QMutex>
 #include <QString>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "audio/frame.h"
 #include "audio/types.h"
 #include "engine/cachingreader/cachingreaderchunk.h"
+#include "engine/cachingreader/cachingreaderpreload.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
+#include "sources/decodedaudiocache.h"
 #include "track/track_decl.h"
 
 template<class DataType>
@@ -16,10 +23,13 @@ class FIFO;
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // Requests with a higher priority are read first, see Hint::Priority
+    int priority;
 
-    void giveToWorker(CachingReaderChunkForOwner* chunkForOwner) {
+    void giveToWorker(CachingReaderChunkForOwner* chunkForOwner, int priorityArg) {
         DEBUG_ASSERT(chunkForOwner);
         chunk = chunkForOwner;
+        priority = priorityArg;
         chunkForOwner->giveToWorker();
     }
 } CachingReaderChunkReadRequest;
@@ -31,12 +41,14 @@ enum ReaderStatus {
     CHUNK_READ_EOF,
     CHUNK_READ_INVALID,
     CHUNK_READ_DISCARDED, // response without frame index range!
+    TRACK_PRELOADED,
 };
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct ReaderStatusUpdate {
   private:
     CachingReaderChunk* chunk;
+    CachingReaderPreload* preload;
     SINT readableFrameIndexRangeStart;
     SINT readableFrameIndexRangeEnd;
 
@@ -49,6 +61,7 @@ typedef struct ReaderStatusUpdate {
             const mixxx::IndexRange& readableFrameIndexRangeArg) {
         status = statusArg;
         chunk = chunkArg;
+        preload = nullptr;
         readableFrameIndexRangeStart = readableFrameIndexRangeArg.start();
         readableFrameIndexRangeEnd = readableFrameIndexRangeArg.end();
     }
@@ -68,6 +81,17 @@ typedef struct ReaderStatusUpdate {
         return update;
     }
 
+    // The preload has been lent to the reader, see CachingReaderPreload
+    static ReaderStatusUpdate trackPreloaded(
+            CachingReaderPreload* pPreload,
+            const mixxx::IndexRange& readableFrameIndexRange) {
+        DEBUG_ASSERT(pPreload);
+        ReaderStatusUpdate update;
+        update.init(TRACK_PRELOADED, nullptr, readableFrameIndexRange);
+        update.preload = pPreload;
+        return update;
+    }
+
     static ReaderStatusUpdate trackUnloaded() {
         ReaderStatusUpdate update;
         update.init(TRACK_UNLOADED, nullptr, mixxx::IndexRange());
@@ -85,6 +109,10 @@ typedef struct ReaderStatusUpdate {
         return pChunk;
     }
 
+    CachingReaderPreload* takePreload() {
+        return std::exchange(preload, nullptr);
+    }
+
     mixxx::IndexRange readableFrameIndexRange() const {
         return mixxx::IndexRange::between(
                 readableFrameIndexRangeStart,
@@ -96,12 +124,27 @@ class CachingReaderWorker : public EngineWorker {
     Q_OBJECT
 
   public:
+    /// Upper bound of the decoders that read chunks in parallel to the
+    /// workers of all decks.
+    static constexpr int kMaxParallelDecoders = 3;
+
+    /// The number of decoders that read chunks in parallel to the workers
+    /// of all decks. They are opened on demand and each keeps the file of
+    /// its track open until the track is unloaded. Depends on the number
+    /// of CPU cores unless overridden.
+    static int maxParallelDecoders();
+    static void setMaxParallelDecoders(int maxParallelDecoders);
+    /// The number of parallel decoders of all decks that are in use.
+    static int openParallelDecoders();
+
     // Construct a CachingReader with the given group.
     CachingReaderWorker(const QString& group,
             FIFO<CachingReaderChunkReadRequest>* pChunkReadRequestFIFO,
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO,
-            mixxx::audio::ChannelCount maxSupportedChannel);
-    ~CachingReaderWorker() override = default;
+            mixxx::audio::ChannelCount maxSupportedChannel,
+            qint64 preloadBudgetBytes = 0,
+            std::shared_ptr<mixxx::DecodedAudioCache> pDecodedAudioCache = nullptr);
+    ~CachingReaderWorker() override;
 
     // Request to load a new track. wake() must be called afterwards.
 #ifdef __STEM__
@@ -116,6 +159,13 @@ class CachingReaderWorker : public EngineWorker {
 
     void quitWait();
 
+    // Whether the loaded track is still being decoded into RAM. The
+    // preloaded track is handed over to the reader when this becomes false,
+    // unless preloading was not possible. Thread-safe.
+    bool isPreloading() const {
+        return m_preloading.load(std::memory_order_acquire);
+    }
+
   signals:
     // Emitted once a new track is loaded and ready to be read from.
     void trackLoading();
@@ -167,14 +217,58 @@ class CachingReaderWorker : public EngineWorker {
     void loadTrack(const TrackPointer& pTrack);
 #endif
 
+    /// A separate audio source of the loaded track for reading chunks
+    /// in parallel, opened on first use.
+    struct ParallelDecoder {
+        mixxx::AudioSourcePointer pAudioSource;
+        mixxx::SampleBuffer tempReadBuffer;
+        // Counted in openParallelDecoders()
+        bool acquired = false;
+        bool failed = false;
+    };
+
+    /// Reads all pending chunk requests, the most important first. The
+    /// worker reads the most important request of each round itself, while
+    /// the following requests are read in parallel by the decode threads.
+    void processReadRequests();
     ReaderStatusUpdate processReadRequest(
-            const CachingReaderChunkReadRequest& request);
+            const CachingReaderChunkReadRequest& request,
+            const mixxx::AudioSourcePointer& pAudioSource,
+            mixxx::SampleBuffer* pTempReadBuffer) const;
+    /// Runs in a decode thread. Returns std::nullopt if the decoder is not
+    /// available and the request must be read by the worker instead.
+    std::optional<ReaderStatusUpdate> processParallelReadRequest(
+            const CachingReaderChunkReadRequest& request,
+            ParallelDecoder* pDecoder) const;
+    mixxx::AudioSourcePointer openParallelAudioSource() const;
+    void closeParallelDecoders();
+    void finishReadRequest(
+            const CachingReaderChunkReadRequest& request,
+            const ReaderStatusUpdate& update);
+
+    /// Decodes the next frames of the track into the preload buffer
+    /// and hands the buffer over to the reader when complete.
+    void processPreload();
+    /// Keeps the preload buffer of the closed track until the reader
+    /// has released it.
+    void retirePreload();
+    void deleteReleasedPreloads();
+    /// Stores the preloaded frames in the DecodedAudioCache.
+    void writePreloadToCache();
 
     void verifyFirstSound(const CachingReaderChunk* pChunk,
             mixxx::audio::ChannelCount channelCount);
 
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
+    // For opening the parallel decoders of the loaded track
+    TrackPointer m_pLoadedTrack;
+    mixxx::AudioSource::OpenParams m_openParams;
+
+    // Pending requests sorted by priority, only used in processReadRequests()
+    std::vector<CachingReaderChunkReadRequest> m_readRequests;
+    // Owned by the decode threads while reading
+    std::vector<ParallelDecoder> m_parallelDecoders;
 
     mixxx::audio::FramePos m_firstSoundFrameToVerify;
 
@@ -185,5 +279,21 @@ class CachingReaderWorker : public EngineWorker {
     // The maximum number of channel that this reader can support
     mixxx::audio::ChannelCount m_maxSupportedChannel;
 
+    // Decode the whole track into RAM if the memory of all preloaded
+    // tracks stays within this budget. Disabled if 0.
+    const qint64 m_preloadBudgetBytes;
+    // Set after loading a track until the preload has been allocated
+    // or is not possible.
+    bool m_preloadPending;
+    std::atomic<bool> m_preloading;
+    std::unique_ptr<CachingReaderPreload> m_pPreload;
+    std::vector<std::unique_ptr<CachingReaderPreload>> m_retiredPreloads;
+
+    // Tracks that are decoded for preloading are stored in the cache
+    // while decoding, if enabled. Cached tracks are preloaded without
+    // decoding.
+    const std::shared_ptr<mixxx::DecodedAudioCache> m_pDecodedAudioCache;
+    std::unique_ptr<mixxx::DecodedAudioCacheWriter> m_pDecodedAudioCacheWriter;
+
     QAtomicInt m_stop;
 };
@@ -1,9 +1,184 @@
 #include "engine/channelmixer.h"
 
+#include <utility>
+
 #include "engine/effects/engineeffectsmanager.h"
+#include "util/math.h"
 #include "util/sample.h"
 #include "util/timer.h"
 
+namespace {
+
+// Number of samples that are mixed per pass over the output buffer. The
+// block of the output buffer stays in the L1 cache while the inputs of all
+// channels are added to it, instead of streaming the whole output buffer
+// through the cache once per channel.
+constexpr SINT kMixBlockSamples = 512;
+
+// Channels with a constant gain are added in passes of up to this many
+// inputs, see SampleUtil::add3WithGain()
+constexpr int kMaxInputsPerPass = 3;
+
+struct ChannelGain {
+    EngineMixer::ChannelInfo* pChannelInfo;
+    CSAMPLE_GAIN oldGain;
+    CSAMPLE_GAIN newGain;
+    bool fadeout;
+};
+
+typedef QVarLengthArray<ChannelGain, kPreallocatedChannels> ChannelGains;
+
+ChannelGain calculateChannelGain(const EngineMixer::GainCalculator& gainCalculator,
+        EngineMixer::ChannelInfo* pChannelInfo,
+        QVarLengthArray<EngineMixer::GainCache, kPreallocatedChannels>* channelGainCache) {
+    EngineMixer::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
+    CSAMPLE_GAIN oldGain = gainCache.m_gain;
+    CSAMPLE_GAIN newGain;
+    bool fadeout = gainCache.m_fadeout ||
+            (pChannelInfo->m_pChannel &&
+                    !pChannelInfo->m_pChannel->isActive());
+    if (fadeout) {
+        newGain = 0;
+        gainCache.m_fadeout = false;
+    } else {
+        newGain = gainCalculator.getGain(pChannelInfo);
+    }
+    gainCache.m_gain = newGain;
+    return ChannelGain{pChannelInfo, oldGain, newGain, fadeout};
+}
+
+// The ramping gain at the given offset into the buffer. Splitting a ramp
+// at these points into blocks yields the same gain for each frame as
+// ramping the whole buffer with SampleUtil::applyRampingGain().
+inline CSAMPLE_GAIN rampingGainAt(const ChannelGain& channelGain,
+        SINT sampleOffset,
+        SINT numSamples) {
+    return channelGain.oldGain +
+            (channelGain.newGain - channelGain.oldGain) * sampleOffset / numSamples;
+}
+
+// Adds up to kMaxInputsPerPass inputs with a constant gain to pDest in
+// a single pass, overwriting pDest if it has not been initialized yet.
+void mixInputsWithGain(CSAMPLE* pDest,
+        const CSAMPLE* const* pSrc,
+        const CSAMPLE_GAIN* gain,
+        int numInputs,
+        bool* pDestInitialized,
+        SINT numSamples) {
+    const bool add = *pDestInitialized;
+    switch (numInputs) {
+    case 0:
+        return;
+    case 1:
+        if (add) {
+            SampleUtil::addWithGain(pDest, pSrc[0], gain[0], numSamples);
+        } else {
+            SampleUtil::copyWithGain(pDest, pSrc[0], gain[0], numSamples);
+        }
+        break;
+    case 2:
+        if (add) {
+            SampleUtil::add2WithGain(pDest, pSrc[0], gain[0], pSrc[1], gain[1], numSamples);
+        } else {
+            SampleUtil::copy2WithGain(pDest, pSrc[0], gain[0], pSrc[1], gain[1], numSamples);
+        }
+        break;
+    case 3:
+        if (add) {
+            SampleUtil::add3WithGain(pDest,
+                    pSrc[0],
+                    gain[0],
+                    pSrc[1],
+                    gain[1],
+                    pSrc[2],
+                    gain[2],
+                    numSamples);
+        } else {
+            SampleUtil::copy3WithGain(pDest,
+                    pSrc[0],
+                    gain[0],
+                    pSrc[1],
+                    gain[1],
+                    pSrc[2],
+                    gain[2],
+                    numSamples);
+        }
+        break;
+    default:
+        DEBUG_ASSERT(!"Unreachable: Too many inputs for a single pass");
+        return;
+    }
+    *pDestInitialized = true;
+}
+
+// Mixes the channels that don't need any postfader effect processing into
+// pOutput, overwriting its previous content. The output is processed block
+// by block and consecutive channels with a constant gain are added in a
+// single pass over each block. If applyGainInPlace is set the gain is
+// applied to the channel buffers like EngineEffectsManager::processPostFaderInPlace()
+// does.
+void mixChannelsWithRampingGain(CSAMPLE* pOutput,
+        const ChannelGains& channelGains,
+        SINT numSamples,
+        bool applyGainInPlace) {
+    for (SINT blockStart = 0; blockStart < numSamples; blockStart += kMixBlockSamples) {
+        const SINT blockEnd = math_min(blockStart + kMixBlockSamples, numSamples);
+        const SINT blockSamples = blockEnd - blockStart;
+        CSAMPLE* pDest = pOutput + blockStart;
+        bool destInitialized = false;
+
+        const CSAMPLE* pendingSrc[kMaxInputsPerPass];
+        CSAMPLE_GAIN pendingGain[kMaxInputsPerPass];
+        int numPending = 0;
+        for (const ChannelGain& channelGain : channelGains) {
+            CSAMPLE* pSrc = channelGain.pChannelInfo->m_pBuffer.data() + blockStart;
+            CSAMPLE_GAIN oldGain = rampingGainAt(channelGain, blockStart, numSamples);
+            CSAMPLE_GAIN newGain = rampingGainAt(channelGain, blockEnd, numSamples);
+            if (applyGainInPlace) {
+                SampleUtil::applyRampingGain(pSrc, oldGain, newGain, blockSamples);
+                // Add the channel buffer as is, unless it has been cleared
+                if (oldGain != CSAMPLE_GAIN_ZERO || newGain != CSAMPLE_GAIN_ZERO) {
+                    oldGain = CSAMPLE_GAIN_ONE;
+                    newGain = CSAMPLE_GAIN_ONE;
+                }
+            }
+            if (oldGain != newGain) {
+                if (destInitialized) {
+                    SampleUtil::addWithRampingGain(
+                            pDest, pSrc, oldGain, newGain, blockSamples);
+                } else {
+                    SampleUtil::copyWithRampingGain(
+                            pDest, pSrc, oldGain, newGain, blockSamples);
+                    destInitialized = true;
+                }
+            } else if (oldGain != CSAMPLE_GAIN_ZERO) {
+                pendingSrc[numPending] = pSrc;
+                pendingGain[numPending] = oldGain;
+                if (++numPending == kMaxInputsPerPass) {
+                    mixInputsWithGain(pDest,
+                            pendingSrc,
+                            pendingGain,
+                            numPending,
+                            &destInitialized,
+                            blockSamples);
+                    numPending = 0;
+                }
+            }
+        }
+        mixInputsWithGain(pDest,
+                pendingSrc,
+                pendingGain,
+                numPending,
+                &destInitialized,
+                blockSamples);
+        if (!destInitialized) {
+            SampleUtil::clear(pDest, blockSamples);
+        }
+    }
+}
+
+} // anonymous namespace
+
 // static
 void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator& gainCalculator,
         const QVarLengthArray<EngineMixer::ChannelInfo*, kPreallocatedChannels>& activeChannels,
@@ -14,30 +189,34 @@ void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator&
         mixxx::audio::SampleRate sampleRate,
         EngineEffectsManager* pEngineEffectsManager) {
     // Signal flow overview:
-    // 1. Clear pOutput buffer
-    // 2. Calculate gains for each channel
-    // 3. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
+    // 1. Calculate gains for each channel
+    // 2. Mix all channels without any enabled postfader effects into pOutput,
+    //    overwriting the pOutput buffer from the last engine callback
+    // 3. Pass each remaining channel's calculated gain and input buffer to
+    //    pEngineEffectsManager, which then:
     //     A) Copies each channel input buffer to a temporary buffer
     //     B) Applies gain to the temporary buffer
     //     C) Processes effects on the temporary buffer
     //     D) Mixes the temporary buffer into pOutput
     // The original channel input buffers are not modified.
-    SampleUtil::clear(pOutput, bufferSize);
     ScopedTimer t(QStringLiteral("EngineMixer::applyEffectsAndMixChannels"));
+    ChannelGains bypassedChannels;
+    ChannelGains processedChannels;
     for (auto* pChannelInfo : activeChannels) {
-        EngineMixer::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
-        CSAMPLE_GAIN oldGain = gainCache.m_gain;
-        CSAMPLE_GAIN newGain;
-        bool fadeout = gainCache.m_fadeout ||
-                (pChannelInfo->m_pChannel &&
-                        !pChannelInfo->m_pChannel->isActive());
-        if (fadeout) {
-            newGain = 0;
-            gainCache.m_fadeout = false;
+        const ChannelGain channelGain =
+                calculateChannelGain(gainCalculator, pChannelInfo, channelGainCache);
+        if (pEngineEffectsManager->bypassPostFader(pChannelInfo->m_handle, outputHandle)) {
+            bypassedChannels.append(channelGain);
         } else {
-            newGain = gainCalculator.getGain(pChannelInfo);
+            processedChannels.append(channelGain);
         }
-        gainCache.m_gain = newGain;
+    }
+    mixChannelsWithRampingGain(pOutput,
+            bypassedChannels,
+            static_cast<SINT>(bufferSize),
+            /*applyGainInPlace*/ false);
+    for (const ChannelGain& channelGain : std::as_const(processedChannels)) {
+        EngineMixer::ChannelInfo* pChannelInfo = channelGain.pChannelInfo;
         pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
                 outputHandle,
                 pChannelInfo->m_pBuffer.data(),
@@ -45,9 +224,9 @@ void ChannelMixer::applyEffectsAndMixChannels(const EngineMixer::GainCalculator&
                 bufferSize,
                 sampleRate,
                 pChannelInfo->m_features,
-                oldGain,
-                newGain,
-                fadeout);
+                channelGain.oldGain,
+                channelGain.newGain,
+                channelGain.fadeout);
     }
 }
 
@@ -64,35 +243,40 @@ void ChannelMixer::applyEffectsInPlaceAndMixChannels(
         EngineEffectsManager* pEngineEffectsManager) {
     // Signal flow overview:
     // 1. Calculate gains for each channel
-    // 2. Pass each channel's calculated gain and input buffer to pEngineEffectsManager, which then:
+    // 2. Apply the calculated gain to the buffers of all channels without any
+    //    enabled postfader effects and mix them to make pOutput, overwriting
+    //    the pOutput buffer from the last engine callback
+    // 3. Pass each remaining channel's calculated gain and input buffer to pEngineEffectsManager, which then:
     //    A) Applies the calculated gain to the channel buffer, modifying the original input buffer
     //    B) Applies effects to the buffer, modifying the original input buffer
-    // 4. Mix the channel buffers together to make pOutput, overwriting the pOutput buffer from the last engine callback
+    // 4. Mix the remaining channel buffers into pOutput
     ScopedTimer t(QStringLiteral("EngineMixer::applyEffectsInPlaceAndMixChannels"));
-    SampleUtil::clear(pOutput, bufferSize);
+    ChannelGains bypassedChannels;
+    ChannelGains processedChannels;
     for (auto* pChannelInfo : activeChannels) {
-        EngineMixer::GainCache& gainCache = (*channelGainCache)[pChannelInfo->m_index];
-        CSAMPLE_GAIN oldGain = gainCache.m_gain;
-        CSAMPLE_GAIN newGain;
-        bool fadeout = gainCache.m_fadeout ||
-                (pChannelInfo->m_pChannel &&
-                        !pChannelInfo->m_pChannel->isActive());
-        if (fadeout) {
-            newGain = 0;
-            gainCache.m_fadeout = false;
+        const ChannelGain channelGain =
+                calculateChannelGain(gainCalculator, pChannelInfo, channelGainCache);
+        if (pEngineEffectsManager->bypassPostFader(pChannelInfo->m_handle, outputHandle)) {
+            bypassedChannels.append(channelGain);
         } else {
-            newGain = gainCalculator.getGain(pChannelInfo);
+            processedChannels.append(channelGain);
         }
-        gainCache.m_gain = newGain;
+    }
+    mixChannelsWithRampingGain(pOutput,
+            bypassedChannels,
+            static_cast<SINT>(bufferSize),
+            /*applyGainInPlace*/ true);
+    for (const ChannelGain& channelGain : std::as_const(processedChannels)) {
+        EngineMixer::ChannelInfo* pChannelInfo = channelGain.pChannelInfo;
         pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
                 outputHandle,
                 pChannelInfo->m_pBuffer.data(),
                 bufferSize,
                 sampleRate,
                 pChannelInfo->m_features,
-                oldGain,
-                newGain,
-                fadeout);
+                channelGain.oldGain,
+                channelGain.newGain,
+                channelGain.fadeout);
         SampleUtil::add(pOutput, pChannelInfo->m_pBuffer.data(), bufferSize);
     }
 }
@@ -2,6 +2,7 @@
 
 #include <QStringView>
 
+#include "control/controlaudiotaperpot.h"
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
 #include "engine/controls/bpmcontrol.h"
@@ -9,9 +10,11 @@
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/enginebuffer.h"
 #include "engine/enginepregain.h"
+#include "engine/enginestemequalizer.h"
 #include "moc_enginedeck.cpp"
 #include "track/track.h"
 #include "util/assert.h"
+#include "util/defs.h"
 #include "util/sample.h"
 
 EngineDeck::EngineDeck(
@@ -81,6 +84,26 @@ EngineDeck::EngineDeck(
         pMuteButton->setButtonMode(mixxx::control::ButtonMode::PowerWindow);
         m_stemMute.push_back(std::move(pMuteButton));
     }
+
+    if (!m_pConfig->getValue(ConfigKey("[Mixer Profile]", "stem_eq"), false)) {
+        return;
+    }
+    // Allocate everything up front, the stem EQ runs in the engine thread
+    m_pStemEqualizer = std::make_unique<EngineStemEqualizer>(
+            mixxx::audio::SampleRate::fromDouble(m_sampleRate.get()));
+    m_stemPlanes = mixxx::SampleBuffer(mixxx::kMaxSupportedStems * kMaxEngineSamples);
+    m_stemEqLow.reserve(mixxx::kMaxSupportedStems);
+    m_stemEqMid.reserve(mixxx::kMaxSupportedStems);
+    m_stemEqHigh.reserve(mixxx::kMaxSupportedStems);
+    for (int stemIdx = 0; stemIdx < mixxx::kMaxSupportedStems; stemIdx++) {
+        const QString stemGroup = getGroupForStem(getGroup(), stemIdx);
+        m_stemEqLow.emplace_back(std::make_unique<ControlAudioTaperPot>(
+                ConfigKey(stemGroup, QStringLiteral("eq_low")), -20, 12, 0.5));
+        m_stemEqMid.emplace_back(std::make_unique<ControlAudioTaperPot>(
+                ConfigKey(stemGroup, QStringLiteral("eq_mid")), -20, 12, 0.5));
+        m_stemEqHigh.emplace_back(std::make_unique<ControlAudioTaperPot>(
+                ConfigKey(stemGroup, QStringLiteral("eq_high")), -20, 12, 0.5));
+    }
 #endif
 }
 
@@ -97,6 +120,15 @@ void EngineDeck::slotTrackLoaded(TrackPointer pNewTrack,
             m_stemGain[stemIdx]->set(1.0);
             m_stemMute[stemIdx]->set(0.0);
         }
+        for (const auto& pEqKnob : m_stemEqLow) {
+            pEqKnob->reset();
+        }
+        for (const auto& pEqKnob : m_stemEqMid) {
+            pEqKnob->reset();
+        }
+        for (const auto& pEqKnob : m_stemEqHigh) {
+            pEqKnob->reset();
+        }
     }
     m_stemClonedState = false;
     if (pNewTrack) {
@@ -151,6 +183,11 @@ void EngineDeck::processStem(CSAMPLE* pOut, const std::size_t bufferSize) {
         return;
     }
 
+    if (m_pStemEqualizer) {
+        processStemPlanes(pOut, pIn, bufferSize, stemCount, sampleRate, pEngineEffectsManager);
+        return;
+    }
+
     // We will now mix each stem (stereo channel) into a single "output"
     // stereo channel. In order to mix the steam, we will use the engine
     // effect manager so we can also apply the individual stem quick FX
@@ -197,6 +234,66 @@ void EngineDeck::processStem(CSAMPLE* pOut, const std::size_t bufferSize) {
     SampleUtil::mixMultichannelToStereo(pOut, pIn, numFrames, chCount);
 }
 
+void EngineDeck::processStemPlanes(CSAMPLE* pOut,
+        const CSAMPLE* pIn,
+        const std::size_t bufferSize,
+        unsigned int stemCount,
+        mixxx::audio::SampleRate sampleRate,
+        EngineEffectsManager* pEngineEffectsManager) {
+    VERIFY_OR_DEBUG_ASSERT(stemCount <= mixxx::kMaxSupportedStems &&
+            stemCount <= m_stems.size() &&
+            bufferSize <= kMaxEngineSamples) {
+        SampleUtil::clear(pOut, bufferSize);
+        return;
+    }
+    const SINT numFrames = bufferSize / mixxx::kEngineChannelOutputCount;
+
+    // Every stem gets its own stereo buffer, so the EQ can filter all of
+    // them in one pass and the effects can process them in place without
+    // extracting and inserting each stem from the multi-channel buffer.
+    CSAMPLE* stemPlanes[mixxx::kMaxSupportedStems];
+    EngineStemEqualizer::Gains stemEqGains[mixxx::kMaxSupportedStems];
+    for (unsigned int stemIdx = 0; stemIdx < stemCount; stemIdx++) {
+        stemPlanes[stemIdx] = m_stemPlanes.data(stemIdx * bufferSize);
+        stemEqGains[stemIdx].low = static_cast<CSAMPLE_GAIN>(m_stemEqLow[stemIdx]->get());
+        stemEqGains[stemIdx].mid = static_cast<CSAMPLE_GAIN>(m_stemEqMid[stemIdx]->get());
+        stemEqGains[stemIdx].high = static_cast<CSAMPLE_GAIN>(m_stemEqHigh[stemIdx]->get());
+    }
+    SampleUtil::copyMultiToStereoPlanes(stemPlanes, pIn, numFrames, m_pBuffer->getChannelCount());
+
+    m_pStemEqualizer->process(stemPlanes, stemEqGains, stemCount, sampleRate, bufferSize);
+
+    GroupFeatureState featureState;
+    collectFeatures(&featureState);
+    SampleUtil::clear(pOut, bufferSize);
+    for (unsigned int stemIdx = 0; stemIdx < stemCount; stemIdx++) {
+        const CSAMPLE_GAIN stemGain = m_stemMute[stemIdx]->toBool()
+                ? CSAMPLE_GAIN_ZERO
+                : static_cast<CSAMPLE_GAIN>(m_stemGain[stemIdx]->get());
+        if (pEngineEffectsManager->bypassPostFader(
+                    m_stems[stemIdx].handle(), m_pEffectsManager->getMainHandle())) {
+            // No quick effect, apply the gain while mixing
+            SampleUtil::addWithRampingGain(pOut,
+                    stemPlanes[stemIdx],
+                    m_stemsGainCache[stemIdx],
+                    stemGain,
+                    bufferSize);
+        } else {
+            pEngineEffectsManager->processPostFaderInPlace(m_stems[stemIdx].handle(),
+                    m_pEffectsManager->getMainHandle(),
+                    stemPlanes[stemIdx],
+                    bufferSize,
+                    sampleRate,
+                    featureState,
+                    m_stemsGainCache[stemIdx],
+                    stemGain,
+                    false);
+            SampleUtil::add(pOut, stemPlanes[stemIdx], bufferSize);
+        }
+        m_stemsGainCache[stemIdx] = stemGain;
+    }
+}
+
 void EngineDeck::cloneStemState(const EngineDeck* deckToClone) {
     VERIFY_OR_DEBUG_ASSERT(deckToClone) {
         return;
@@ -215,6 +312,14 @@ void EngineDeck::cloneStemState(const EngineDeck* deckToClone) {
         m_stemGain[stemIdx]->set(deckToClone->m_stemGain[stemIdx]->get());
         m_stemMute[stemIdx]->set(deckToClone->m_stemMute[stemIdx]->get());
     }
+    // The stem EQ is enabled for all decks or none
+    for (std::size_t stemIdx = 0; stemIdx < m_stemEqLow.size() &&
+            stemIdx < deckToClone->m_stemEqLow.size();
+            stemIdx++) {
+        m_stemEqLow[stemIdx]->set(deckToClone->m_stemEqLow[stemIdx]->get());
+        m_stemEqMid[stemIdx]->set(deckToClone->m_stemEqMid[stemIdx]->get());
+        m_stemEqHigh[stemIdx]->set(deckToClone->m_stemEqHigh[stemIdx]->get());
+    }
     m_stemClonedState = true;
 }
 #endif
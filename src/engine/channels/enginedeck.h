@@ -11,6 +11,9 @@
 class EnginePregain;
 class EngineBuffer;
 class EngineMixer;
+class EngineEffectsManager;
+class EngineStemEqualizer;
+class ControlAudioTaperPot;
 class ControlPushButton;
 class ControlPotmeter;
 
@@ -88,6 +91,14 @@ class EngineDeck : public EngineChannel, public AudioDestination {
 #ifdef __STEM__
     // Process multiple channels and mix them together into the passed buffer
     void processStem(CSAMPLE* pOutput, const std::size_t bufferSize);
+    // Equalize, process and mix the stems in planar layout, one stereo
+    // buffer per stem
+    void processStemPlanes(CSAMPLE* pOutput,
+            const CSAMPLE* pIn,
+            const std::size_t bufferSize,
+            unsigned int stemCount,
+            mixxx::audio::SampleRate sampleRate,
+            EngineEffectsManager* pEngineEffectsManager);
 #endif
 
     std::vector<ChannelHandleAndGroup> m_stems;
@@ -104,6 +115,13 @@ class EngineDeck : public EngineChannel, public AudioDestination {
     std::vector<std::unique_ptr<ControlPotmeter>> m_stemGain;
     std::vector<std::unique_ptr<ControlPushButton>> m_stemMute;
     bool m_stemClonedState;
+
+    // Optional per stem EQ, only created if enabled in the config
+    std::unique_ptr<EngineStemEqualizer> m_pStemEqualizer;
+    std::vector<std::unique_ptr<ControlAudioTaperPot>> m_stemEqLow;
+    std::vector<std::unique_ptr<ControlAudioTaperPot>> m_stemEqMid;
+    std::vector<std::unique_ptr<ControlAudioTaperPot>> m_stemEqHigh;
+    mixxx::SampleBuffer m_stemPlanes;
 #endif
 
     // Begin vinyl passthrough fields
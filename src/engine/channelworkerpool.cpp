@@ -0,0 +1,159 @@
+#include "engine/channelworkerpool.h"
+
+#ifdef __LINUX__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <QtDebug>
+
+#include "util/assert.h"
+
+namespace {
+
+constexpr int kJobIndexBits = 32;
+constexpr quint64 kJobIndexMask = (quint64{1} << kJobIndexBits) - 1;
+
+// After this many unsuccessful polls the engine thread yields the CPU while
+// waiting for jobs that are still being processed by a worker.
+constexpr int kSpinCountBeforeYield = 1000;
+
+constexpr quint64 packJobCursor(int jobCount, int jobIndex) {
+    return (static_cast<quint64>(jobCount) << kJobIndexBits) |
+            static_cast<quint64>(jobIndex);
+}
+
+} // namespace
+
+class ChannelWorkerPool::Worker : public QThread {
+  public:
+    Worker(ChannelWorkerPool* pPool, int workerIndex)
+            : m_pPool(pPool),
+              m_workerIndex(workerIndex) {
+        setObjectName(QStringLiteral("ChannelWorker %1").arg(workerIndex + 1));
+    }
+
+  protected:
+    void run() override {
+        m_pPool->workerLoop(m_workerIndex);
+    }
+
+  private:
+    ChannelWorkerPool* const m_pPool;
+    const int m_workerIndex;
+};
+
+ChannelWorkerPool::ChannelWorkerPool(int numWorkers)
+        : m_wakeSema(0),
+          m_bQuit(false),
+          m_pFunction(nullptr),
+          m_pContext(nullptr),
+          m_jobCursor(packJobCursor(0, 0)),
+          m_pendingJobs(0) {
+    DEBUG_ASSERT(numWorkers >= 0);
+    m_workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        auto pWorker = std::make_unique<Worker>(this, i);
+        pWorker->start(QThread::TimeCriticalPriority);
+        m_workers.push_back(std::move(pWorker));
+    }
+    qDebug() << "ChannelWorkerPool: processing engine channels with"
+             << numWorkers << "worker thread(s)";
+}
+
+ChannelWorkerPool::~ChannelWorkerPool() {
+    m_bQuit.store(true);
+    m_wakeSema.release(static_cast<int>(m_workers.size()));
+    for (const auto& pWorker : m_workers) {
+        pWorker->wait();
+    }
+}
+
+// static
+int ChannelWorkerPool::defaultNumWorkers() {
+    return qMax(0, QThread::idealThreadCount() - 1);
+}
+
+void ChannelWorkerPool::run(JobFunction pFunction, void* pContext, int jobCount) {
+    VERIFY_OR_DEBUG_ASSERT(pFunction && jobCount >= 0) {
+        return;
+    }
+    if (jobCount == 0) {
+        return;
+    }
+    const int numWorkersToWake = qMin(numWorkers(), jobCount - 1);
+    if (numWorkersToWake == 0) {
+        // Nothing to gain from waking up a worker.
+        for (int i = 0; i < jobCount; ++i) {
+            pFunction(pContext, i);
+        }
+        return;
+    }
+
+    DEBUG_ASSERT(m_pendingJobs.load(std::memory_order_acquire) == 0);
+    m_pFunction = pFunction;
+    m_pContext = pContext;
+    m_pendingJobs.store(jobCount, std::memory_order_relaxed);
+    // Publishes the parameters above to all threads that claim a job.
+    m_jobCursor.store(packJobCursor(jobCount, 0), std::memory_order_release);
+    m_wakeSema.release(numWorkersToWake);
+
+    processJobs();
+
+    // Wait for the jobs that have been claimed by the workers.
+    int spinCount = 0;
+    while (m_pendingJobs.load(std::memory_order_acquire) > 0) {
+        if (++spinCount >= kSpinCountBeforeYield) {
+            QThread::yieldCurrentThread();
+            spinCount = 0;
+        }
+    }
+}
+
+void ChannelWorkerPool::processJobs() {
+    while (true) {
+        const quint64 cursor = m_jobCursor.fetch_add(1, std::memory_order_acq_rel);
+        const int jobCount = static_cast<int>(cursor >> kJobIndexBits);
+        const int jobIndex = static_cast<int>(cursor & kJobIndexMask);
+        if (jobIndex >= jobCount) {
+            return;
+        }
+        m_pFunction(m_pContext, jobIndex);
+        m_pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ChannelWorkerPool::workerLoop(int workerIndex) {
+#ifdef __LINUX__
+    // Use the same real-time policy as the engine thread, so a worker cannot
+    // be preempted by ordinary threads while the engine thread waits for it.
+    struct sched_param spm = {0};
+    spm.sched_priority = 1;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &spm)) {
+        qWarning() << "ChannelWorkerPool: Failed bumping priority of worker"
+                   << workerIndex;
+    }
+    // Pin the workers to distinct cores, so they neither migrate while
+    // processing a buffer nor compete with each other for the same core.
+    const int numCores = QThread::idealThreadCount();
+    if (numCores > 1) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(1 + (workerIndex % (numCores - 1)), &cpuSet);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet)) {
+            qWarning() << "ChannelWorkerPool: Failed pinning worker"
+                       << workerIndex;
+        }
+    }
+#else
+    Q_UNUSED(workerIndex);
+#endif
+
+    while (true) {
+        m_wakeSema.acquire();
+        if (m_bQuit.load()) {
+            return;
+        }
+        processJobs();
+    }
+}
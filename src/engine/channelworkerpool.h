@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// ChannelWorkerPool distributes independent units of engine work (usually
+/// the processing of one EngineChannel each) over a fixed set of real-time
+/// threads that are spawned up front.
+///
+/// The engine thread that calls run() takes part in the processing and only
+/// returns after all jobs have completed, so for the caller a call to run()
+/// has the same post-conditions as a plain loop over all jobs. run() neither
+/// allocates nor locks; idle workers are woken through a semaphore and the
+/// engine thread spins for the last outstanding jobs.
+class ChannelWorkerPool {
+  public:
+    /// Called exactly once for each job index in [0, jobCount).
+    using JobFunction = void (*)(void* pContext, int jobIndex);
+
+    /// Spawns `numWorkers` threads. With zero workers run() processes all
+    /// jobs on the calling thread.
+    explicit ChannelWorkerPool(int numWorkers);
+    ~ChannelWorkerPool();
+
+    ChannelWorkerPool(const ChannelWorkerPool&) = delete;
+    ChannelWorkerPool& operator=(const ChannelWorkerPool&) = delete;
+
+    int numWorkers() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    /// Processes jobs 0 to jobCount - 1 and blocks until all of them have
+    /// completed. Must only be called from one thread at a time.
+    void run(JobFunction pFunction, void* pContext, int jobCount);
+
+    /// The number of worker threads that is reasonable on this machine,
+    /// leaving one core to the engine thread.
+    static int defaultNumWorkers();
+
+  private:
+    class Worker;
+
+    // Claims and processes jobs until no job is left.
+    void processJobs();
+    // Entry point of the worker threads.
+    void workerLoop(int workerIndex);
+
+    std::vector<std::unique_ptr<QThread>> m_workers;
+    QSemaphore m_wakeSema;
+    std::atomic<bool> m_bQuit;
+
+    // Parameters of the current run. Written by run() before the job cursor
+    // is published with release semantics.
+    JobFunction m_pFunction;
+    void* m_pContext;
+
+    // The upper 32 bits contain the number of jobs of the current run and the
+    // lower 32 bits the index of the next unclaimed job. Packing both into a
+    // single atomic guarantees that a worker that wakes up late can never
+    // claim a job of the next run with a job count of the previous one.
+    std::atomic<quint64> m_jobCursor;
+    std::atomic<int> m_pendingJobs;
+};
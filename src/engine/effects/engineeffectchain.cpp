@@ -12,7 +12,9 @@ EngineEffectChain::EngineEffectChain(const QString& group,
           m_mixMode(EffectChainMixMode::DrySlashWet),
           m_dMix(0),
           m_buffer1(kMaxEngineSamples),
-          m_buffer2(kMaxEngineSamples) {
+          m_buffer2(kMaxEngineSamples),
+          m_profilerStage(mixxx::RtProfiler::registerStage(
+                  QStringLiteral("EngineEffectChain::process %1").arg(group))) {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 
@@ -180,6 +182,7 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         const GroupFeatureState& groupFeatures,
         bool fadeout) {
     DEBUG_ASSERT(numSamples <= kMaxEngineSamples);
+    mixxx::RtProfilerScope profilerScope(m_profilerStage);
 
     // Compute the effective enable state from the channel input routing switch and
     // the chain's enable state. When either of these are turned on/off, send the
@@ -320,11 +323,64 @@ bool EngineEffectChain::process(const ChannelHandle& inputHandle,
         channelStatus.enableState = EffectEnableState::Enabling;
     }
 
+    updateChainEnableState();
+
+    return processingOccured;
+}
+
+bool EngineEffectChain::isDisabledForChannel(const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) {
+    return m_chainStatusForChannelMatrix[inputHandle][outputHandle].enableState ==
+            EffectEnableState::Disabled;
+}
+
+void EngineEffectChain::skipDisabledChannel(const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) {
+    ChannelStatus& channelStatus = m_chainStatusForChannelMatrix[inputHandle][outputHandle];
+    DEBUG_ASSERT(channelStatus.enableState == EffectEnableState::Disabled);
+    channelStatus.oldMixKnob = m_dMix;
+    updateChainEnableState();
+}
+
+bool EngineEffectChain::mayProcessConcurrently(const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) const {
+    // updateChainEnableState() writes the chain state from whichever input
+    // channel is processed first
+    if (m_enableState == EffectEnableState::Enabling ||
+            m_enableState == EffectEnableState::Disabling) {
+        return false;
+    }
+    // ChannelHandleMap::operator[] would expand the matrix
+    if (!inputHandle.valid() || !outputHandle.valid() ||
+            inputHandle.handle() >= m_chainStatusForChannelMatrix.size() ||
+            outputHandle.handle() >=
+                    m_chainStatusForChannelMatrix.at(inputHandle).size()) {
+        return false;
+    }
+    // The effects and the intermediate buffers are shared by all input
+    // channels the chain is enabled for
+    if (m_chainStatusForChannelMatrix.at(inputHandle).at(outputHandle).enableState ==
+            EffectEnableState::Disabled) {
+        return true;
+    }
+    int handle = 0;
+    for (const auto& outputMap : m_chainStatusForChannelMatrix) {
+        if (handle++ == inputHandle.handle()) {
+            continue;
+        }
+        for (const ChannelStatus& channelStatus : outputMap) {
+            if (channelStatus.enableState != EffectEnableState::Disabled) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void EngineEffectChain::updateChainEnableState() {
     if (m_enableState == EffectEnableState::Disabling) {
         m_enableState = EffectEnableState::Disabled;
     } else if (m_enableState == EffectEnableState::Enabling) {
         m_enableState = EffectEnableState::Enabled;
     }
-
-    return processingOccured;
 }
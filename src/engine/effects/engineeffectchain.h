@@ -8,6 +8,7 @@
 #include "engine/effects/engineeffectsdelay.h"
 #include "engine/effects/message.h"
 #include "util/class.h"
+#include "util/rtprofiler.h"
 #include "util/samplebuffer.h"
 #include "util/types.h"
 
@@ -45,6 +46,29 @@ class EngineEffectChain final : public EffectsRequestHandler {
             const GroupFeatureState& groupFeatures,
             bool fadeout);
 
+    /// called from audio thread
+    /// Returns true if the chain is disabled for the input channel on the
+    /// output channel, i.e. if process() would not touch the audio.
+    bool isDisabledForChannel(const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle);
+
+    /// called from audio thread
+    /// Updates the state like process() does for a channel that the chain
+    /// is disabled for. Replaces process() if the caller mixes the channel
+    /// without passing its audio through the chain.
+    void skipDisabledChannel(const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle);
+
+    /// called from audio thread
+    /// Returns true if process() for the input channel on the output channel
+    /// only touches state of the chain that belongs to that input channel,
+    /// i.e. the chain enable switch is not ramping, the status of the channel
+    /// exists already, and the chain is not enabled for any other input
+    /// channel. Only then may the chain process the input channel
+    /// concurrently with other input channels.
+    bool mayProcessConcurrently(const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle) const;
+
   private:
     struct ChannelStatus {
         ChannelStatus()
@@ -64,6 +88,7 @@ class EngineEffectChain final : public EffectsRequestHandler {
     bool removeEffect(EngineEffect* pEffect, int iIndex);
     bool enableForInputChannel(ChannelHandle inputHandle);
     bool disableForInputChannel(ChannelHandle inputHandle);
+    void updateChainEnableState();
 
     QString m_group;
     EffectEnableState m_enableState;
@@ -74,6 +99,7 @@ class EngineEffectChain final : public EffectsRequestHandler {
     mixxx::SampleBuffer m_buffer2;
     ChannelHandleMap<ChannelHandleMap<ChannelStatus>> m_chainStatusForChannelMatrix;
     EngineEffectsDelay m_effectsDelay;
+    const mixxx::RtProfilerStage m_profilerStage;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
 };
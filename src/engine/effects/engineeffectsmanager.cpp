@@ -157,6 +157,37 @@ void EngineEffectsManager::processPostFaderAndMix(
             fadeout);
 }
 
+bool EngineEffectsManager::bypassPostFader(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) {
+    const QList<EngineEffectChain*>& chains =
+            m_chainsByStage.value(SignalProcessingStage::Postfader);
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain && !pChain->isDisabledForChannel(inputHandle, outputHandle)) {
+            return false;
+        }
+    }
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain) {
+            pChain->skipDisabledChannel(inputHandle, outputHandle);
+        }
+    }
+    return true;
+}
+
+bool EngineEffectsManager::mayProcessPreFaderConcurrently(
+        const ChannelHandle& inputHandle,
+        const ChannelHandle& outputHandle) const {
+    const QList<EngineEffectChain*>& chains =
+            m_chainsByStage.value(SignalProcessingStage::Prefader);
+    for (EngineEffectChain* pChain : chains) {
+        if (pChain && !pChain->mayProcessConcurrently(inputHandle, outputHandle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void EngineEffectsManager::processInner(
         const SignalProcessingStage stage,
         const ChannelHandle& inputHandle,
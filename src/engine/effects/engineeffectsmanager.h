@@ -65,6 +65,24 @@ class EngineEffectsManager final : public EffectsRequestHandler {
             CSAMPLE_GAIN newGain = CSAMPLE_GAIN_ONE,
             bool fadeout = false);
 
+    /// Checks if any postfader EngineEffectChain is enabled for the input
+    /// channel on the output channel. If none is, the chains are updated
+    /// like processPostFaderInPlace() and processPostFaderAndMix() would do
+    /// and true is returned. The caller is then responsible for applying the
+    /// gain and mixing the channel, e.g. together with other channels in a
+    /// single pass.
+    bool bypassPostFader(
+            const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle);
+
+    /// Checks if the prefader EngineEffectChains may process the input
+    /// channel on the output channel concurrently with other input channels,
+    /// see EngineEffectChain::mayProcessConcurrently(). Called from the
+    /// engine thread before the channels are processed.
+    bool mayProcessPreFaderConcurrently(
+            const ChannelHandle& inputHandle,
+            const ChannelHandle& outputHandle) const;
+
     bool processEffectsRequest(
             EffectsRequest& message,
             EffectsResponsePipe* pResponsePipe) override;
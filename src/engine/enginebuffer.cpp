@@ -90,9 +90,12 @@ EngineBuffer::EngineBuffer(const QString& group,
           m_startButton(nullptr),
           m_endButton(nullptr),
           m_bScalerOverride(false),
+          m_scaleProfilerStage(mixxx::RtProfiler::registerStage(
+                  QStringLiteral("EngineBuffer::scaleBuffer %1").arg(group))),
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
           m_iSyncModeQueued(static_cast<int>(SyncMode::Invalid)),
+          m_bSyncRequestsDeferred(false),
           m_slipQuitAndAdopt(0),
           m_bPlayAfterLoading(false),
           m_channelCount(mixxx::kEngineChannelOutputCount),
@@ -1128,7 +1131,11 @@ void EngineBuffer::processTrackLocked(
     // If the buffer is not paused, then scale the audio.
     if (!bCurBufferPaused) {
         // Perform scaling of Reader buffer into buffer.
-        const double framesRead = m_pScale->scaleBuffer(pOutput, bufferSize);
+        double framesRead;
+        {
+            mixxx::RtProfilerScope profilerScope(m_scaleProfilerStage);
+            framesRead = m_pScale->scaleBuffer(pOutput, bufferSize);
+        }
 
         // TODO(XXX): The result framesRead might not be an integer value.
         // Converting to samples here does not make sense. All positional
@@ -1331,6 +1338,9 @@ void EngineBuffer::processSlip(std::size_t bufferSize) {
 }
 
 void EngineBuffer::processSyncRequests() {
+    if (m_bSyncRequestsDeferred) {
+        return;
+    }
     SyncRequestQueued enable_request =
             static_cast<SyncRequestQueued>(
                     m_iEnableSyncQueued.fetchAndStoreRelease(SYNC_REQUEST_NONE));
@@ -1616,6 +1626,12 @@ void EngineBuffer::addControl(EngineControl* pControl) {
     pControl->setEngineBuffer(this);
 }
 
+bool EngineBuffer::isSyncParticipant() const {
+    return m_pSyncControl->isSynchronized() ||
+            m_iEnableSyncQueued.loadAcquire() != SYNC_REQUEST_NONE ||
+            static_cast<SyncMode>(m_iSyncModeQueued.loadAcquire()) != SyncMode::Invalid;
+}
+
 bool EngineBuffer::isTrackLoaded() const {
     if (m_pCurrentTrack) {
         return true;
@@ -1623,6 +1639,10 @@ bool EngineBuffer::isTrackLoaded() const {
     return false;
 }
 
+bool EngineBuffer::isTrackPreloading() const {
+    return m_pReader->isPreloading();
+}
+
 TrackPointer EngineBuffer::getLoadedTrack() const {
     return m_pCurrentTrack;
 }
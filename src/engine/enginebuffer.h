@@ -17,6 +17,7 @@
 #include "preferences/usersettings.h"
 #include "track/bpm.h"
 #include "track/track_decl.h"
+#include "util/rtprofiler.h"
 #include "util/types.h"
 
 #ifdef __RUBBERBAND__
@@ -140,6 +141,16 @@ class EngineBuffer : public EngineObject {
     void requestSyncPhase();
     void requestEnableSync(bool enabled);
     void requestSyncMode(SyncMode mode);
+    /// Returns true if this deck takes part in sync lock or a sync request is
+    /// queued for it. Such decks exchange state with EngineSync while being
+    /// processed and must not be processed concurrently with other decks.
+    bool isSyncParticipant() const;
+    /// While set, queued sync requests are not processed but kept for the
+    /// next callback. Set by EngineMixer while the deck is processed
+    /// concurrently, so that a deck only joins sync lock on the engine thread.
+    void setSyncRequestsDeferred(bool deferred) {
+        m_bSyncRequestsDeferred = deferred;
+    }
 
     // The process methods all run in the audio callback.
     void process(CSAMPLE* pOut, const std::size_t bufferSize) override;
@@ -152,6 +163,9 @@ class EngineBuffer : public EngineObject {
     mixxx::audio::FramePos queuedSeekPosition() const;
 
     bool isTrackLoaded() const;
+    /// Whether the loaded track is still being decoded into RAM, see
+    /// CachingReader. Thread-safe.
+    bool isTrackPreloading() const;
     TrackPointer getLoadedTrack() const;
     void ejectTrack();
 
@@ -472,10 +486,12 @@ class EngineBuffer : public EngineObject {
     bool m_bScalerChanged;
     // Indicates that dependency injection has taken place.
     bool m_bScalerOverride;
+    const mixxx::RtProfilerStage m_scaleProfilerStage;
 
     QAtomicInt m_iSeekPhaseQueued;
     QAtomicInt m_iEnableSyncQueued;
     QAtomicInt m_iSyncModeQueued;
+    bool m_bSyncRequestsDeferred;
     ControlValueAtomic<QueuedSeek> m_queuedSeek;
     bool m_previousBufferSeek = false;
 
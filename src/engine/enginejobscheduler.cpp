@@ -0,0 +1,273 @@
+#include "engine/enginejobscheduler.h"
+
+#include <QtDebug>
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace {
+
+// Capacity of the queue of each worker. The engine submits at most a few
+// jobs per deck and callback, so this is never exceeded in practice.
+constexpr int kJobQueueCapacity = 64;
+
+// Number of unsuccessful polls before an idle worker is parked. Spinning a
+// little keeps workers responsive between the bursts of jobs that are
+// submitted once per audio callback.
+constexpr int kIdleSpinCountBeforePark = 4000;
+
+// Number of unsuccessful polls before a waiting thread is parked.
+constexpr int kWaitSpinCountBeforePark = 1000;
+
+} // namespace
+
+EngineJob::EngineJob()
+        : m_state(State::Idle),
+          m_parkSema(0) {
+}
+
+void EngineJob::runAndComplete() {
+    m_state.store(State::Running, std::memory_order_release);
+    run();
+    if (m_state.exchange(State::Done, std::memory_order_acq_rel) ==
+            State::RunningAwaited) {
+        m_parkSema.release();
+    }
+}
+
+class EngineJobScheduler::Worker : public QThread {
+  public:
+    Worker(EngineJobScheduler* pScheduler, int workerIndex)
+            : m_pScheduler(pScheduler),
+              m_workerIndex(workerIndex) {
+        setObjectName(QStringLiteral("EngineJobWorker %1").arg(workerIndex + 1));
+    }
+
+  protected:
+    void run() override {
+        m_pScheduler->workerLoop(m_workerIndex);
+    }
+
+  private:
+    EngineJobScheduler* const m_pScheduler;
+    const int m_workerIndex;
+};
+
+EngineJobScheduler::JobQueue::JobQueue(int capacity)
+        : m_cells(std::make_unique<Cell[]>(roundUpToPowerOf2(capacity))),
+          m_mask(roundUpToPowerOf2(capacity) - 1),
+          m_enqueuePos(0),
+          m_dequeuePos(0) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].pJob = nullptr;
+    }
+}
+
+bool EngineJobScheduler::JobQueue::tryPush(EngineJob* pJob) {
+    Cell* pCell;
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        pCell = &m_cells[pos & m_mask];
+        const size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // full
+            return false;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    pCell->pJob = pJob;
+    pCell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+EngineJob* EngineJobScheduler::JobQueue::tryPop() {
+    Cell* pCell;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    while (true) {
+        pCell = &m_cells[pos & m_mask];
+        const size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // empty
+            return nullptr;
+        } else {
+            pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    EngineJob* pJob = pCell->pJob;
+    pCell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return pJob;
+}
+
+EngineJobScheduler::EngineJobScheduler(int numWorkers, QThread::Priority priority)
+        : m_nextQueue(0),
+          m_wakeSema(0),
+          m_numParked(0),
+          m_bQuit(false) {
+    DEBUG_ASSERT(numWorkers >= 0);
+    m_queues.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        m_queues.push_back(std::make_unique<JobQueue>(kJobQueueCapacity));
+    }
+    // All queues must exist before the first worker starts stealing
+    m_workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        auto pWorker = std::make_unique<Worker>(this, i);
+        pWorker->start(priority);
+        m_workers.push_back(std::move(pWorker));
+    }
+}
+
+EngineJobScheduler::~EngineJobScheduler() {
+    m_bQuit.store(true);
+    m_wakeSema.release(numWorkers());
+    for (const auto& pWorker : m_workers) {
+        pWorker->wait();
+    }
+}
+
+void EngineJobScheduler::submit(EngineJob* pJob) {
+    VERIFY_OR_DEBUG_ASSERT(pJob->m_state.load(std::memory_order_acquire) ==
+            EngineJob::State::Idle) {
+        return;
+    }
+    // Publishes everything the submitter has prepared for run()
+    pJob->m_state.store(EngineJob::State::Queued, std::memory_order_release);
+
+    const auto numQueues = static_cast<unsigned int>(m_queues.size());
+    if (numQueues > 0) {
+        const unsigned int firstQueue =
+                m_nextQueue.fetch_add(1, std::memory_order_relaxed);
+        for (unsigned int i = 0; i < numQueues; ++i) {
+            if (m_queues[(firstQueue + i) % numQueues]->tryPush(pJob)) {
+                // Pairs with the fence in workerLoop(): either the worker
+                // finds this job when checking again before it parks, or
+                // we see that it is parked and wake it up.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wakeWorker();
+                return;
+            }
+        }
+    }
+    // No worker available
+    pJob->runAndComplete();
+}
+
+void EngineJobScheduler::wait(EngineJob* pJob) {
+    const auto numQueues = static_cast<unsigned int>(m_queues.size());
+    const int firstQueue = numQueues > 0
+            ? static_cast<int>(m_nextQueue.load(std::memory_order_relaxed) % numQueues)
+            : 0;
+    int spinCount = 0;
+    while (true) {
+        const EngineJob::State state = pJob->m_state.load(std::memory_order_acquire);
+        if (state == EngineJob::State::Done) {
+            break;
+        }
+        VERIFY_OR_DEBUG_ASSERT(state != EngineJob::State::Idle) {
+            // never submitted
+            return;
+        }
+        // Help instead of sitting idle
+        EngineJob* pQueuedJob = findJob(firstQueue);
+        if (pQueuedJob) {
+            pQueuedJob->runAndComplete();
+            spinCount = 0;
+            continue;
+        }
+        if (++spinCount < kWaitSpinCountBeforePark) {
+            continue;
+        }
+        spinCount = 0;
+        // Only a job that is running can be waited for by parking. A job that
+        // is still queued has just been taken by a worker and will be running
+        // in a moment.
+        auto expected = EngineJob::State::Running;
+        if (pJob->m_state.compare_exchange_strong(expected,
+                    EngineJob::State::RunningAwaited,
+                    std::memory_order_acq_rel)) {
+            pJob->m_parkSema.acquire();
+            DEBUG_ASSERT(pJob->m_state.load(std::memory_order_acquire) ==
+                    EngineJob::State::Done);
+            break;
+        }
+        QThread::yieldCurrentThread();
+    }
+    pJob->m_state.store(EngineJob::State::Idle, std::memory_order_release);
+}
+
+EngineJob* EngineJobScheduler::findJob(int queueIndex) {
+    const int numQueues = static_cast<int>(m_queues.size());
+    for (int i = 0; i < numQueues; ++i) {
+        EngineJob* pJob = m_queues[(queueIndex + i) % numQueues]->tryPop();
+        if (pJob) {
+            return pJob;
+        }
+    }
+    return nullptr;
+}
+
+void EngineJobScheduler::wakeWorker() {
+    int numParked = m_numParked.load(std::memory_order_seq_cst);
+    while (numParked > 0) {
+        if (m_numParked.compare_exchange_weak(numParked, numParked - 1)) {
+            m_wakeSema.release();
+            return;
+        }
+    }
+}
+
+void EngineJobScheduler::workerLoop(int workerIndex) {
+    int spinCount = 0;
+    while (!m_bQuit.load(std::memory_order_relaxed)) {
+        EngineJob* pJob = findJob(workerIndex);
+        if (pJob) {
+            pJob->runAndComplete();
+            spinCount = 0;
+            continue;
+        }
+        if (++spinCount < kIdleSpinCountBeforePark) {
+            continue;
+        }
+        spinCount = 0;
+
+        // Announce that we are about to park and check again, so a job that
+        // has been submitted in the meantime is not missed.
+        m_numParked.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        pJob = findJob(workerIndex);
+        if (!pJob) {
+            m_wakeSema.acquire();
+            continue;
+        }
+        // Revoke the announcement. If a submitter has already counted us as
+        // woken, it has released a token that must be consumed.
+        int numParked = m_numParked.load(std::memory_order_seq_cst);
+        bool revoked = false;
+        while (numParked > 0) {
+            if (m_numParked.compare_exchange_weak(numParked, numParked - 1)) {
+                revoked = true;
+                break;
+            }
+        }
+        if (!revoked) {
+            m_wakeSema.acquire();
+        }
+        pJob->runAndComplete();
+    }
+}
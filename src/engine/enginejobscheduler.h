@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// EngineJob is a unit of work that the engine can hand off to an
+/// EngineJobScheduler. Jobs are owned and pre-allocated by the submitter and
+/// can be submitted again as soon as EngineJobScheduler::wait() has returned,
+/// so submitting work never allocates.
+class EngineJob {
+  public:
+    EngineJob();
+    virtual ~EngineJob() = default;
+
+    EngineJob(const EngineJob&) = delete;
+    EngineJob& operator=(const EngineJob&) = delete;
+
+    /// Performs the work. Called exactly once per submission on an arbitrary
+    /// thread.
+    virtual void run() = 0;
+
+  private:
+    friend class EngineJobScheduler;
+
+    enum class State : int {
+        Idle = 0,
+        Queued,
+        Running,
+        // Running and the submitter is parked in EngineJobScheduler::wait()
+        RunningAwaited,
+        Done,
+    };
+
+    void runAndComplete();
+
+    std::atomic<State> m_state;
+    QSemaphore m_parkSema;
+};
+
+/// EngineJobScheduler runs EngineJobs on a fixed set of worker threads and is
+/// safe to use from the audio callback.
+///
+/// Every worker owns a bounded lock-free queue. Submitted jobs are spread
+/// over these queues, and a worker that runs out of jobs steals from the
+/// queues of the others. Idle workers spin for a while before they park, so
+/// under continuous load a submission neither allocates nor takes a lock.
+/// While the submitting thread waits for its jobs it runs queued jobs itself,
+/// so it never sits idle while work is pending.
+class EngineJobScheduler {
+  public:
+    explicit EngineJobScheduler(int numWorkers,
+            QThread::Priority priority = QThread::HighPriority);
+    virtual ~EngineJobScheduler();
+
+    EngineJobScheduler(const EngineJobScheduler&) = delete;
+    EngineJobScheduler& operator=(const EngineJobScheduler&) = delete;
+
+    int numWorkers() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    /// Queues a job for one of the workers. The job must not be queued or
+    /// running already. If all queues are full the job is run on the calling
+    /// thread immediately.
+    void submit(EngineJob* pJob);
+
+    /// Blocks until the given job has completed. Meanwhile the calling thread
+    /// runs queued jobs. If there is nothing left to do it spins for a short
+    /// time before it is parked until the job completes.
+    void wait(EngineJob* pJob);
+
+  private:
+    class Worker;
+
+    /// Bounded multi-producer/multi-consumer queue of job pointers based on
+    /// sequence numbers per cell, as described by Dmitry Vyukov.
+    class JobQueue {
+      public:
+        explicit JobQueue(int capacity);
+
+        bool tryPush(EngineJob* pJob);
+        EngineJob* tryPop();
+
+      private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            EngineJob* pJob;
+        };
+        std::unique_ptr<Cell[]> m_cells;
+        const size_t m_mask;
+        alignas(64) std::atomic<size_t> m_enqueuePos;
+        alignas(64) std::atomic<size_t> m_dequeuePos;
+    };
+
+    // Returns the next queued job, looking at the queue with the given index
+    // first and then at the queues of all other workers.
+    EngineJob* findJob(int queueIndex);
+    void wakeWorker();
+    void workerLoop(int workerIndex);
+
+    std::vector<std::unique_ptr<JobQueue>> m_queues;
+    std::vector<std::unique_ptr<QThread>> m_workers;
+    std::atomic<unsigned int> m_nextQueue;
+
+    // Parking of idle workers
+    QSemaphore m_wakeSema;
+    std::atomic<int> m_numParked;
+    std::atomic<bool> m_bQuit;
+};
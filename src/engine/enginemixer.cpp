@@ -9,6 +9,7 @@
 #include "control/controlpushbutton.h"
 #include "effects/effectsmanager.h"
 #include "engine/channelmixer.h"
+#include "engine/channelworkerpool.h"
 #include "engine/channels/enginechannel.h"
 #include "engine/effects/engineeffectsmanager.h"
 #include "engine/enginebuffer.h"
@@ -34,6 +35,8 @@ const QString kLegacyGroup = QStringLiteral("[Master]");
 const QString kMainGroup = QStringLiteral("[Main]");
 
 const ConfigKey kInternalClockBpmKey{QStringLiteral("[InternalClock]"), QStringLiteral("bpm")};
+const ConfigKey kChannelMultithreadingKey{kAppGroup, QStringLiteral("channel_multithreading")};
+const ConfigKey kChannelWorkerCountKey{kAppGroup, QStringLiteral("channel_worker_count")};
 } // namespace
 
 EngineMixer::EngineMixer(UserSettingsPointer pConfig,
@@ -52,6 +55,11 @@ EngineMixer::EngineMixer(UserSettingsPointer pConfig,
                   ConfigKey(group, "booth_enabled"))),
           m_pChannelHandleFactory(pChannelHandleFactory),
           m_pEngineEffectsManager(pEffectsManager->getEngineEffectsManager()),
+          m_channelBufferSize(0),
+          m_processProfilerStage(mixxx::RtProfiler::registerStage(
+                  QStringLiteral("EngineMixer::process"))),
+          m_sideChainProfilerStage(mixxx::RtProfiler::registerStage(
+                  QStringLiteral("EngineSideChain::writeSamples"))),
           m_outputBusBuffers({mixxx::SampleBuffer(kMaxEngineSamples),
                   mixxx::SampleBuffer(kMaxEngineSamples),
                   mixxx::SampleBuffer(kMaxEngineSamples)}),
@@ -164,6 +172,17 @@ EngineMixer::EngineMixer(UserSettingsPointer pConfig,
     m_bExternalRecordBroadcastInputConnected = false;
     m_pWorkerScheduler->start(QThread::HighPriority);
 
+    // Processing independent channels concurrently is opt-in, because effects
+    // and controllers of different channels might interact in ways that are
+    // only safe if all channels are processed on the engine thread.
+    if (pConfig->getValue(kChannelMultithreadingKey, false)) {
+        const int numWorkers = pConfig->getValue(kChannelWorkerCountKey,
+                ChannelWorkerPool::defaultNumWorkers());
+        if (numWorkers > 0) {
+            m_pChannelWorkerPool = std::make_unique<ChannelWorkerPool>(numWorkers);
+        }
+    }
+
     m_pSampleRate->addAlias(ConfigKey(group, QStringLiteral("samplerate")));
     m_pSampleRate->set(44100.);
 
@@ -242,6 +261,8 @@ void EngineMixer::processChannels(std::size_t bufferSize) {
     m_activeChannels.clear();
 
     // ScopedTimer timer(QStringLiteral("EngineMixer::processChannels"));
+    m_channelBufferSize = bufferSize;
+
     EngineChannel* pLeaderChannel = m_pEngineSync->getLeaderChannel();
     // Reserve the first place for the main channel which
     // should be processed first
@@ -318,18 +339,36 @@ void EngineMixer::processChannels(std::size_t bufferSize) {
         }
     }
 
-    // Now that the list is built and ordered, do the processing.
+    // Now that the list is built and ordered, do the processing. The sync
+    // leader and all other channels that interact with each other are
+    // processed in order on the engine thread. If enabled, the remaining
+    // channels are processed concurrently afterwards.
+    m_concurrentChannels.clear();
     for (int i = activeChannelsStartIndex; i < m_activeChannels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_activeChannels[i];
-        auto& pChannel = pChannelInfo->m_pChannel;
-        DEBUG_ASSERT(pChannelInfo->m_pBuffer.size() >= static_cast<SINT>(bufferSize));
-        pChannel->process(pChannelInfo->m_pBuffer.data(), bufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+        if (m_pChannelWorkerPool && i > 0 && mayProcessConcurrently(pChannelInfo)) {
+            m_concurrentChannels.append(pChannelInfo);
+        } else {
+            processChannel(pChannelInfo, bufferSize);
+        }
+    }
+    if (!m_concurrentChannels.isEmpty()) {
+        for (ChannelInfo* pChannelInfo : std::as_const(m_concurrentChannels)) {
+            EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+            if (pBuffer) {
+                // A sync request that is queued after mayProcessConcurrently()
+                // is processed with the next callback on the engine thread
+                pBuffer->setSyncRequestsDeferred(true);
+            }
+        }
+        m_pChannelWorkerPool->run(&EngineMixer::processConcurrentChannel,
+                this,
+                m_concurrentChannels.size());
+        for (ChannelInfo* pChannelInfo : std::as_const(m_concurrentChannels)) {
+            EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+            if (pBuffer) {
+                pBuffer->setSyncRequestsDeferred(false);
+            }
         }
     }
     // Do internal sync lock post-processing before the other
@@ -358,8 +397,45 @@ void EngineMixer::processChannels(std::size_t bufferSize) {
             });
 }
 
+void EngineMixer::processChannel(ChannelInfo* pChannelInfo, std::size_t bufferSize) {
+    mixxx::RtProfilerScope profilerScope(pChannelInfo->m_profilerStage);
+    auto& pChannel = pChannelInfo->m_pChannel;
+    DEBUG_ASSERT(pChannelInfo->m_pBuffer.size() >= static_cast<SINT>(bufferSize));
+    pChannel->process(pChannelInfo->m_pBuffer.data(), bufferSize);
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
+// static
+void EngineMixer::processConcurrentChannel(void* pContext, int jobIndex) {
+    auto* pMixer = static_cast<EngineMixer*>(pContext);
+    pMixer->processChannel(pMixer->m_concurrentChannels[jobIndex],
+            pMixer->m_channelBufferSize);
+}
+
+bool EngineMixer::mayProcessConcurrently(ChannelInfo* pChannelInfo) const {
+    // Synced decks read and update the shared state of EngineSync while
+    // being processed, so they stay on the engine thread.
+    const EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+    if (pBuffer && pBuffer->isSyncParticipant()) {
+        return false;
+    }
+    // Every channel runs all prefader chains, e.g. the equalizers of the
+    // other decks. These must not switch their enable state or share their
+    // effects between the concurrent channels.
+    return !m_pEngineEffectsManager ||
+            m_pEngineEffectsManager->mayProcessPreFaderConcurrently(
+                    pChannelInfo->m_handle, m_mainHandle.handle());
+}
+
 void EngineMixer::process(const std::size_t bufferSize) {
     DEBUG_ASSERT(bufferSize <= static_cast<int>(kMaxEngineSamples));
+    mixxx::RtProfilerScope profilerScope(m_processProfilerStage);
 
     static bool haveSetName = false;
     if (!haveSetName) {
@@ -730,6 +806,7 @@ void EngineMixer::process(const std::size_t bufferSize) {
         // EngineSideChain::receiveBuffer has copied the input buffer to m_pSidechainMix
         // via before (called by SoundManager::pushInputBuffers())
         if (m_pEngineSideChain) {
+            mixxx::RtProfilerScope sideChainProfilerScope(m_sideChainProfilerStage);
             m_pEngineSideChain->writeSamples(m_sidechainMix.data(), iFrames);
         }
 
@@ -856,6 +933,8 @@ void EngineMixer::addChannel(std::unique_ptr<EngineChannel> pChannel) {
     // take ownership of the pointer explicitly
     pChannelInfo->m_pChannel = std::move(pChannel);
     pChannelInfo->m_handle = m_pChannelHandleFactory->getOrCreateHandle(group);
+    pChannelInfo->m_profilerStage = mixxx::RtProfiler::registerStage(
+            QStringLiteral("EngineMixer::processChannel %1").arg(group));
     pChannelInfo->m_pVolumeControl = std::make_unique<ControlAudioTaperPot>(
             ConfigKey(group, "volume"), -20, 0, 1);
     pChannelInfo->m_pVolumeControl->setDefaultValue(1.0);
@@ -881,6 +960,7 @@ void EngineMixer::addChannel(std::unique_ptr<EngineChannel> pChannel) {
     m_activeBusChannels[EngineChannel::RIGHT].reserve(m_channels.size());
     m_activeHeadphoneChannels.reserve(m_channels.size());
     m_activeTalkoverChannels.reserve(m_channels.size());
+    m_concurrentChannels.reserve(m_channels.size());
 
     if (pBuffer != nullptr) {
         pBuffer->bindWorkers(m_pWorkerScheduler);
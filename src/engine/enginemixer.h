@@ -18,9 +18,11 @@
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
 #include "util/parented_ptr.h"
+#include "util/rtprofiler.h"
 #include "util/samplebuffer.h"
 #include "util/types.h"
 
+class ChannelWorkerPool;
 class EngineWorkerScheduler;
 class EngineVuMeter;
 class ControlPotmeter;
@@ -124,6 +126,7 @@ class EngineMixer : public QObject, public AudioSource {
         std::unique_ptr<ControlObject> m_pVolumeControl{nullptr};
         std::unique_ptr<ControlPushButton> m_pMuteControl{nullptr};
         GroupFeatureState m_features{};
+        mixxx::RtProfilerStage m_profilerStage{};
         int m_index;
     };
 
@@ -259,6 +262,14 @@ class EngineMixer : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(std::size_t bufferSize);
+    // Processes a single channel and collects its features for effects.
+    // May be called from any thread of m_pChannelWorkerPool.
+    void processChannel(ChannelInfo* pChannelInfo, std::size_t bufferSize);
+    // Job function of m_pChannelWorkerPool for m_concurrentChannels.
+    static void processConcurrentChannel(void* pContext, int jobIndex);
+    // Returns true if the channel only touches state that it owns while
+    // being processed.
+    bool mayProcessConcurrently(ChannelInfo* pChannelInfo) const;
 
     ChannelHandleFactoryPointer m_pChannelHandleFactory;
     void applyMainEffects(std::size_t bufferSize);
@@ -284,6 +295,15 @@ class EngineMixer : public QObject, public AudioSource {
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeBusChannels[3];
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeHeadphoneChannels;
     QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_activeTalkoverChannels;
+    // Active channels that are handed to m_pChannelWorkerPool.
+    QVarLengthArray<ChannelInfo*, kPreallocatedChannels> m_concurrentChannels;
+
+    // Only set if processing channels on multiple threads is enabled.
+    std::unique_ptr<ChannelWorkerPool> m_pChannelWorkerPool;
+    // Parameters of the current callback for the channel worker jobs.
+    std::size_t m_channelBufferSize;
+    const mixxx::RtProfilerStage m_processProfilerStage;
+    const mixxx::RtProfilerStage m_sideChainProfilerStage;
 
     mixxx::audio::SampleRate m_sampleRate;
 
@@ -0,0 +1,118 @@
+#include "engine/enginestemequalizer.h"
+
+#include "util/assert.h"
+#include "util/defs.h"
+#include "util/sample.h"
+
+EngineStemEqualizer::EngineStemEqualizer(mixxx::audio::SampleRate sampleRate)
+        : m_sampleRate(sampleRate.isValid() ? sampleRate : kStartupSampleRate),
+          m_lowDesign(m_sampleRate, kLoFreq),
+          m_bandDesign(m_sampleRate, kHiFreq),
+          m_lowBuffer(mixxx::kMaxSupportedStems * kMaxEngineSamples),
+          m_bandBuffer(mixxx::kMaxSupportedStems * kMaxEngineSamples),
+          m_highBuffer(mixxx::kMaxSupportedStems * kMaxEngineSamples),
+          m_unusedBuffer(kMaxEngineSamples) {
+    m_unusedBuffer.clear();
+    for (int stemIdx = 0; stemIdx < mixxx::kMaxSupportedStems; ++stemIdx) {
+        // Unity gain is the delayed dry signal
+        m_oldLow[stemIdx] = CSAMPLE_GAIN_ZERO;
+        m_oldMid[stemIdx] = CSAMPLE_GAIN_ZERO;
+        m_oldHigh[stemIdx] = CSAMPLE_GAIN_ONE;
+    }
+    setFilters(m_sampleRate);
+    m_filters.assumeSettled();
+}
+
+void EngineStemEqualizer::setFilters(mixxx::audio::SampleRate sampleRate) {
+    const int delayLow = m_lowDesign.setFrequencyCornersForIntDelay(
+            kLoFreq / sampleRate, kMaxDelay);
+    const int delayBand = m_bandDesign.setFrequencyCornersForIntDelay(
+            kHiFreq / sampleRate, kMaxDelay);
+    for (int stemIdx = 0; stemIdx < mixxx::kMaxSupportedStems; ++stemIdx) {
+        m_filters.setCoefs(2 * stemIdx, m_lowDesign);
+        m_filters.setCoefs(2 * stemIdx + 1, m_bandDesign);
+        // Compensate the group delay of the low pass filters in the
+        // pass band, so the bands can be subtracted from each other
+        m_bandDelays[stemIdx].setDelay((delayLow - delayBand) * 2);
+        m_highDelays[stemIdx].setDelay(delayLow * 2);
+    }
+}
+
+void EngineStemEqualizer::process(CSAMPLE* const* ppStems,
+        const Gains* pGains,
+        int stemCount,
+        mixxx::audio::SampleRate sampleRate,
+        std::size_t bufferSize) {
+    VERIFY_OR_DEBUG_ASSERT(stemCount >= 0 &&
+            stemCount <= mixxx::kMaxSupportedStems &&
+            bufferSize <= kMaxEngineSamples) {
+        return;
+    }
+    if (sampleRate.isValid() && m_sampleRate != sampleRate) {
+        m_sampleRate = sampleRate;
+        setFilters(sampleRate);
+    }
+
+    const CSAMPLE* filterInputs[kBandCount];
+    CSAMPLE* filterOutputs[kBandCount];
+    for (int stemIdx = 0; stemIdx < mixxx::kMaxSupportedStems; ++stemIdx) {
+        if (stemIdx >= stemCount) {
+            filterInputs[2 * stemIdx] = m_unusedBuffer.data();
+            filterInputs[2 * stemIdx + 1] = m_unusedBuffer.data();
+            filterOutputs[2 * stemIdx] = m_unusedBuffer.data();
+            filterOutputs[2 * stemIdx + 1] = m_unusedBuffer.data();
+            continue;
+        }
+        CSAMPLE* pBand = m_bandBuffer.data(stemIdx * bufferSize);
+        m_bandDelays[stemIdx].process(ppStems[stemIdx], pBand, bufferSize);
+        m_highDelays[stemIdx].process(ppStems[stemIdx],
+                m_highBuffer.data(stemIdx * bufferSize),
+                bufferSize);
+        filterInputs[2 * stemIdx] = ppStems[stemIdx];
+        filterInputs[2 * stemIdx + 1] = pBand;
+        filterOutputs[2 * stemIdx] = m_lowBuffer.data(stemIdx * bufferSize);
+        filterOutputs[2 * stemIdx + 1] = pBand;
+    }
+
+    // One pass for the low pass filters of all stems
+    m_filters.process(filterInputs, filterOutputs, bufferSize);
+
+    for (int stemIdx = 0; stemIdx < stemCount; ++stemIdx) {
+        // The dry signal represents the high gain, the band below high
+        // and the low band are added with the difference to the next band
+        const Gains& gains = pGains[stemIdx];
+        const CSAMPLE_GAIN low = gains.low - gains.mid;
+        const CSAMPLE_GAIN mid = gains.mid - gains.high;
+        const CSAMPLE_GAIN high = gains.high;
+        const CSAMPLE* pLow = m_lowBuffer.data(stemIdx * bufferSize);
+        const CSAMPLE* pBand = m_bandBuffer.data(stemIdx * bufferSize);
+        const CSAMPLE* pHigh = m_highBuffer.data(stemIdx * bufferSize);
+        if (low == m_oldLow[stemIdx] &&
+                mid == m_oldMid[stemIdx] &&
+                high == m_oldHigh[stemIdx]) {
+            SampleUtil::copy3WithGain(ppStems[stemIdx],
+                    pLow,
+                    low,
+                    pBand,
+                    mid,
+                    pHigh,
+                    high,
+                    static_cast<int>(bufferSize));
+        } else {
+            SampleUtil::copy3WithRampingGain(ppStems[stemIdx],
+                    pLow,
+                    m_oldLow[stemIdx],
+                    low,
+                    pBand,
+                    m_oldMid[stemIdx],
+                    mid,
+                    pHigh,
+                    m_oldHigh[stemIdx],
+                    high,
+                    static_cast<int>(bufferSize));
+            m_oldLow[stemIdx] = low;
+            m_oldMid[stemIdx] = mid;
+            m_oldHigh[stemIdx] = high;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "audio/types.h"
+#include "engine/engine.h"
+#include "engine/filters/enginefilterbessel4.h"
+#include "engine/filters/enginefilterdelay.h"
+#include "engine/filters/enginefilteriirbank.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+/// A three band equalizer for the stems of a stem deck that is applied to
+/// every stem before the stems are mixed down to stereo.
+///
+/// The stems are passed in planar layout, i.e. one stereo buffer per stem.
+/// The low pass filters of all stems run in a single EngineFilterIIRBank,
+/// so equalizing all stems is one pass over the buffers instead of one
+/// equalizer effect instance per stem. The filter structure and the
+/// crossover frequencies are the ones of the Bessel4 LV-Mix EQ.
+class EngineStemEqualizer {
+  public:
+    /// Linear gains of the bands, CSAMPLE_GAIN_ONE is unity gain
+    struct Gains {
+        CSAMPLE_GAIN low = CSAMPLE_GAIN_ONE;
+        CSAMPLE_GAIN mid = CSAMPLE_GAIN_ONE;
+        CSAMPLE_GAIN high = CSAMPLE_GAIN_ONE;
+    };
+
+    explicit EngineStemEqualizer(mixxx::audio::SampleRate sampleRate);
+
+    /// Equalizes the stereo buffers of stemCount stems in place, each with
+    /// bufferSize samples. This is real-time safe, all buffers are
+    /// allocated for the maximum engine buffer size up front.
+    void process(CSAMPLE* const* ppStems,
+            const Gains* pGains,
+            int stemCount,
+            mixxx::audio::SampleRate sampleRate,
+            std::size_t bufferSize);
+
+  private:
+    // Allows a 30 Hz filter at 97346 Hz, see LVMixEQEffectGroupState
+    static constexpr SINT kMaxDelay = 3300;
+    static constexpr double kLoFreq = 246;
+    static constexpr double kHiFreq = 2484;
+    // Used until the engine has a valid sample rate
+    static constexpr mixxx::audio::SampleRate kStartupSampleRate =
+            mixxx::audio::SampleRate(44100);
+    // The low and the band filter of each stem
+    static constexpr int kBandCount = 2 * mixxx::kMaxSupportedStems;
+
+    void setFilters(mixxx::audio::SampleRate sampleRate);
+
+    mixxx::audio::SampleRate m_sampleRate;
+
+    // Only used to design the coefficients of the filter bank
+    EngineFilterBessel4Low m_lowDesign;
+    EngineFilterBessel4Low m_bandDesign;
+
+    // Bands 2 * i and 2 * i + 1 are the low and band filter of stem i
+    EngineFilterIIRBank<4, IIR_LP, mixxx::kEngineChannelOutputCount, kBandCount> m_filters;
+    EngineFilterDelay<kMaxDelay> m_bandDelays[mixxx::kMaxSupportedStems];
+    EngineFilterDelay<kMaxDelay> m_highDelays[mixxx::kMaxSupportedStems];
+
+    // Planar buffers of all stems
+    mixxx::SampleBuffer m_lowBuffer;
+    mixxx::SampleBuffer m_bandBuffer;
+    mixxx::SampleBuffer m_highBuffer;
+    // Feeds the filters of missing stems
+    mixxx::SampleBuffer m_unusedBuffer;
+
+    // The gains of the filter outputs as applied to the previous buffer
+    CSAMPLE_GAIN m_oldLow[mixxx::kMaxSupportedStems];
+    CSAMPLE_GAIN m_oldMid[mixxx::kMaxSupportedStems];
+    CSAMPLE_GAIN m_oldHigh[mixxx::kMaxSupportedStems];
+};
@@ -27,6 +27,83 @@ enum IIRPass {
 };
 
 
+/// The values of N independent filters, e.g. for multiple channels or
+/// bands, that are processed at once. The element-wise operators are
+/// simple loops that the compiler turns into SIMD instructions.
+template<int N>
+struct IIRLanes {
+    double lane[N];
+
+    static IIRLanes broadcast(double value) {
+        IIRLanes result;
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            result.lane[i] = value;
+        }
+        return result;
+    }
+
+    double& operator[](int i) {
+        return lane[i];
+    }
+    double operator[](int i) const {
+        return lane[i];
+    }
+
+    IIRLanes& operator+=(const IIRLanes& other) {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            lane[i] += other.lane[i];
+        }
+        return *this;
+    }
+    IIRLanes& operator-=(const IIRLanes& other) {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            lane[i] -= other.lane[i];
+        }
+        return *this;
+    }
+    IIRLanes& operator*=(const IIRLanes& other) {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            lane[i] *= other.lane[i];
+        }
+        return *this;
+    }
+    IIRLanes& operator*=(double factor) {
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            lane[i] *= factor;
+        }
+        return *this;
+    }
+
+    IIRLanes operator-() const {
+        IIRLanes result;
+        // note: LOOP VECTORIZED.
+        for (int i = 0; i < N; ++i) {
+            result.lane[i] = -lane[i];
+        }
+        return result;
+    }
+    friend IIRLanes operator+(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs += rhs;
+    }
+    friend IIRLanes operator-(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs -= rhs;
+    }
+    friend IIRLanes operator*(IIRLanes lhs, const IIRLanes& rhs) {
+        return lhs *= rhs;
+    }
+    friend IIRLanes operator*(IIRLanes lhs, double factor) {
+        return lhs *= factor;
+    }
+    friend IIRLanes operator*(double factor, IIRLanes rhs) {
+        return rhs *= factor;
+    }
+};
+
 class EngineFilterIIRBase : public EngineObjectConstIn {
   public:
     virtual void assumeSettled() = 0;
@@ -85,14 +162,16 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     void initBuffers() {
         // Copy the current buffers into the old buffers
-        memcpy(m_oldBuf1, m_buf1, sizeof(m_buf1));
-        memcpy(m_oldBuf2, m_buf2, sizeof(m_buf2));
+        memcpy(m_oldBuf, m_buf, sizeof(m_buf));
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
     }
 
+    const double* coefs() const {
+        return m_coef;
+    }
+
     void setCoefs(const char* spec,
             std::size_t bufsize,
             double sampleRate,
@@ -239,8 +318,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput, const std::size_t bufferSize) {
         if (!m_doRamping) {
             for (std::size_t i = 0; i < bufferSize; i += 2) {
-                pOutput[i] = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                pOutput[i + 1] = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
+                const StereoLanes out = processSample(
+                        m_coef, m_buf, StereoLanes{{pIn[i], pIn[i + 1]}});
+                pOutput[i] = static_cast<CSAMPLE>(out[0]);
+                pOutput[i + 1] = static_cast<CSAMPLE>(out[1]);
             }
         } else {
             double cross_mix = 0.0;
@@ -257,31 +338,28 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                 // of the new filter but it turns out that this produces
                 // a gain drop due to the filter delay which is more
                 // conspicuous than the settling noise.
-                double old1;
-                double old2;
+                const StereoLanes in{{pIn[i], pIn[i + 1]}};
+                StereoLanes old;
                 if (!m_doStart) {
                     // Process old filter, but only if we do not do a fresh start
-                    old1 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf1, pIn[i]));
-                    old2 = static_cast<CSAMPLE>(processSample(m_oldCoef, m_oldBuf2, pIn[i + 1]));
+                    old = roundToSample(processSample(m_oldCoef, m_oldBuf, in));
                 } else {
                     if (m_startFromDry) {
-                        old1 = pIn[i];
-                        old2 = pIn[i + 1];
+                        old = in;
                     } else {
-                        old1 = 0;
-                        old2 = 0;
+                        old = StereoLanes::broadcast(0);
                     }
                 }
-                double new1 = static_cast<CSAMPLE>(processSample(m_coef, m_buf1, pIn[i]));
-                double new2 = static_cast<CSAMPLE>(processSample(m_coef, m_buf2, pIn[i + 1]));
+                const StereoLanes next = roundToSample(processSample(m_coef, m_buf, in));
 
                 if (i < bufferSize / 2) {
-                    pOutput[i] = static_cast<CSAMPLE>(old1);
-                    pOutput[i + 1] = static_cast<CSAMPLE>(old2);
+                    pOutput[i] = static_cast<CSAMPLE>(old[0]);
+                    pOutput[i + 1] = static_cast<CSAMPLE>(old[1]);
                 } else {
-                    pOutput[i] = static_cast<CSAMPLE>(new1 * cross_mix + old1 * (1.0 - cross_mix));
+                    pOutput[i] = static_cast<CSAMPLE>(
+                            next[0] * cross_mix + old[0] * (1.0 - cross_mix));
                     pOutput[i + 1] = static_cast<CSAMPLE>(
-                            new2 * cross_mix + old2 * (1.0 - cross_mix));
+                            next[1] * cross_mix + old[1] * (1.0 - cross_mix));
                     cross_mix += cross_inc;
                 }
             }
@@ -290,12 +368,26 @@ class EngineFilterIIR : public EngineFilterIIRBase {
         }
     }
 
+    /// Processes one sample of each lane. The coefficients C are either
+    /// double, shared by all lanes, or IIRLanes with separate coefficients
+    /// per lane. The sample type T is double or IIRLanes.
+    template<typename C, typename T>
+    static inline T processSample(const C* coef, T* buf, T val);
+
   protected:
-    inline double processSample(double* coef, double* buf, double val);
+    // Both channels are processed at once
+    typedef IIRLanes<2> StereoLanes;
+
+    static StereoLanes roundToSample(StereoLanes lanes) {
+        for (int i = 0; i < 2; ++i) {
+            lanes[i] = static_cast<CSAMPLE>(lanes[i]);
+        }
+        return lanes;
+    }
+
     inline void pauseFilterInner() {
         // Set the current buffers to 0
-        memset(m_buf1, 0, sizeof(m_buf1));
-        memset(m_buf2, 0, sizeof(m_buf2));
+        memset(m_buf, 0, sizeof(m_buf));
         m_doRamping = true;
         m_doStart = true;
     }
@@ -304,15 +396,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
     // Old coefficients needed for ramping
     double m_oldCoef[SIZE + 1];
 
-    // Channel 1 state
-    double m_buf1[SIZE];
-    // Old channel 1 buffer needed for ramping
-    double m_oldBuf1[SIZE];
-
-    // Channel 2 state
-    double m_buf2[SIZE];
-    // Old channel 2 buffer needed for ramping
-    double m_oldBuf2[SIZE];
+    // Channel state
+    StereoLanes m_buf[SIZE];
+    // Old channel buffer needed for ramping
+    StereoLanes m_oldBuf[SIZE];
 
     // Flag set to true if ramping needs to be done
     bool m_doRamping;
@@ -323,10 +410,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 };
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<2, IIR_LP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -337,10 +423,9 @@ inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<2, IIR_BP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = -tmp;
@@ -351,10 +436,9 @@ inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<2, IIR_HP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -365,10 +449,9 @@ inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<4, IIR_LP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -384,10 +467,9 @@ inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<8, IIR_BP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -414,10 +496,9 @@ inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<4, IIR_HP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir= val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -433,10 +514,9 @@ inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<8, IIR_LP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -463,10 +543,9 @@ inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
-                                                         double* buf,
-                                                         double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<16, IIR_BP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     buf[7] = buf[8]; buf[8] = buf[9]; buf[9] = buf[10]; buf[10] = buf[11];
@@ -515,10 +594,9 @@ inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<8, IIR_HP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -546,10 +624,9 @@ inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
 
 // IIR_LP and IIR_HP use the same processSample routine
 template<>
-inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<5, IIR_BP>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = coef[2] * tmp;
@@ -560,10 +637,9 @@ inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<4, IIR_LPMO>::processSample(const C* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= tmp;
@@ -586,10 +662,9 @@ inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<4, IIR_HPMO>::processSample(const C* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= -tmp;
@@ -611,10 +686,9 @@ inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<2, IIR_LP2>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -632,10 +706,9 @@ inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename C, typename T>
+inline T EngineFilterIIR<2, IIR_HP2>::processSample(const C* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * -coef[0]; // swap gain to be in phase with LP2
     iir -= coef[1] * tmp; fir = -tmp;
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstring>
+
+#include "engine/filters/enginefilteriir.h"
+#include "util/assert.h"
+#include "util/types.h"
+
+/// Filters CHANNELS interleaved channels with BANDS filters of the same
+/// structure but individual coefficients, e.g. the low pass filters of
+/// multiple bands of an equalizer or the same filter for all channels of
+/// a stem deck.
+///
+/// All CHANNELS * BANDS recursions run in the lanes of a single IIRLanes
+/// value instead of one EngineFilterIIR per band and channel pair. The
+/// results and the coefficient ramping of each band are the same as
+/// with EngineFilterIIR.
+template<unsigned int SIZE, enum IIRPass PASS, int CHANNELS, int BANDS = 1>
+class EngineFilterIIRBank {
+  public:
+    static constexpr int kLaneCount = CHANNELS * BANDS;
+    typedef IIRLanes<kLaneCount> Lanes;
+
+    EngineFilterIIRBank() {
+        memset(m_coef, 0, sizeof(m_coef));
+        memset(m_oldCoef, 0, sizeof(m_oldCoef));
+        memset(m_oldBuf, 0, sizeof(m_oldBuf));
+        for (int band = 0; band < BANDS; ++band) {
+            m_doRamping[band] = false;
+            m_doStart[band] = false;
+            m_startFromDry[band] = false;
+            pauseFilter(band);
+        }
+    }
+
+    /// Takes over the coefficients of a filter that has been designed
+    /// by one of the EngineFilterIIR subclasses.
+    void setCoefs(int band, const EngineFilterIIR<SIZE, PASS>& filter) {
+        setCoefs(band, filter.coefs());
+    }
+
+    /// Sets the SIZE + 1 coefficients as designed by fid_design_coef()
+    /// and starts ramping from the previous coefficients.
+    void setCoefs(int band, const double* pCoefs) {
+        VERIFY_OR_DEBUG_ASSERT(band >= 0 && band < BANDS) {
+            return;
+        }
+        for (unsigned int i = 0; i <= SIZE; ++i) {
+            for (int lane = band * CHANNELS; lane < (band + 1) * CHANNELS; ++lane) {
+                m_oldCoef[i][lane] = m_coef[i][lane];
+                m_coef[i][lane] = pCoefs[i];
+            }
+        }
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            for (int lane = band * CHANNELS; lane < (band + 1) * CHANNELS; ++lane) {
+                m_oldBuf[i][lane] = m_buf[i][lane];
+                m_buf[i][lane] = 0;
+            }
+        }
+        m_doRamping[band] = true;
+    }
+
+    /// See EngineFilterIIR::pauseFilter()
+    void pauseFilter(int band) {
+        VERIFY_OR_DEBUG_ASSERT(band >= 0 && band < BANDS) {
+            return;
+        }
+        if (m_doStart[band]) {
+            return;
+        }
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            for (int lane = band * CHANNELS; lane < (band + 1) * CHANNELS; ++lane) {
+                m_buf[i][lane] = 0;
+            }
+        }
+        m_doRamping[band] = true;
+        m_doStart[band] = true;
+    }
+
+    /// See EngineFilterIIR::setStartFromDry()
+    void setStartFromDry(int band, bool val) {
+        VERIFY_OR_DEBUG_ASSERT(band >= 0 && band < BANDS) {
+            return;
+        }
+        m_startFromDry[band] = val;
+    }
+
+    void assumeSettled() {
+        for (int band = 0; band < BANDS; ++band) {
+            m_doRamping[band] = false;
+            m_doStart[band] = false;
+        }
+    }
+
+    /// Filters the input of each band, which may point to the same
+    /// buffer, into the output of the band. In-place processing is
+    /// supported. All buffers have bufferSize interleaved samples of
+    /// CHANNELS channels.
+    void process(const CSAMPLE* const* ppInputs,
+            CSAMPLE* const* ppOutputs,
+            std::size_t bufferSize) {
+        const std::size_t frames = bufferSize / CHANNELS;
+        bool doRamping = false;
+        for (int band = 0; band < BANDS; ++band) {
+            doRamping = doRamping || m_doRamping[band];
+        }
+        if (!doRamping) {
+            for (std::size_t frame = 0; frame < frames; ++frame) {
+                const Lanes out = processSample(m_coef, m_buf, readFrame(ppInputs, frame));
+                writeFrame(ppOutputs, frame, out);
+            }
+            return;
+        }
+
+        // The same cross fade as in EngineFilterIIR::process() for
+        // the lanes of the ramping bands. The other lanes run the
+        // old filter with the current coefficients and state, which
+        // yields the same result.
+        Lanes dryGain = Lanes::broadcast(0);
+        Lanes oldGain = Lanes::broadcast(1);
+        for (int band = 0; band < BANDS; ++band) {
+            for (int lane = band * CHANNELS; lane < (band + 1) * CHANNELS; ++lane) {
+                if (!m_doRamping[band]) {
+                    for (unsigned int i = 0; i <= SIZE; ++i) {
+                        m_oldCoef[i][lane] = m_coef[i][lane];
+                    }
+                    for (unsigned int i = 0; i < SIZE; ++i) {
+                        m_oldBuf[i][lane] = m_buf[i][lane];
+                    }
+                } else if (m_doStart[band]) {
+                    oldGain[lane] = 0;
+                    dryGain[lane] = m_startFromDry[band] ? 1 : 0;
+                }
+            }
+        }
+        double crossMix = 0.0;
+        const double crossInc = 2.0 * CHANNELS / static_cast<double>(bufferSize);
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            const bool fading = frame * CHANNELS >= bufferSize / 2;
+            const Lanes in = readFrame(ppInputs, frame);
+            Lanes old = roundToSample(processSample(m_oldCoef, m_oldBuf, in));
+            // Either the old filter or the dry signal or silence
+            old = old * oldGain + in * dryGain;
+            const Lanes next = roundToSample(processSample(m_coef, m_buf, in));
+            Lanes out;
+            for (int band = 0; band < BANDS; ++band) {
+                for (int lane = band * CHANNELS; lane < (band + 1) * CHANNELS; ++lane) {
+                    if (!m_doRamping[band]) {
+                        out[lane] = next[lane];
+                    } else if (!fading) {
+                        out[lane] = old[lane];
+                    } else {
+                        out[lane] = next[lane] * crossMix + old[lane] * (1.0 - crossMix);
+                    }
+                }
+            }
+            if (fading) {
+                crossMix += crossInc;
+            }
+            writeFrame(ppOutputs, frame, out);
+        }
+        for (int band = 0; band < BANDS; ++band) {
+            m_doRamping[band] = false;
+            m_doStart[band] = false;
+        }
+    }
+
+  private:
+    static Lanes processSample(const Lanes* coef, Lanes* buf, Lanes val) {
+        return EngineFilterIIR<SIZE, PASS>::processSample(coef, buf, val);
+    }
+
+    static Lanes roundToSample(Lanes lanes) {
+        for (int lane = 0; lane < kLaneCount; ++lane) {
+            lanes[lane] = static_cast<CSAMPLE>(lanes[lane]);
+        }
+        return lanes;
+    }
+
+    static Lanes readFrame(const CSAMPLE* const* ppInputs, std::size_t frame) {
+        Lanes lanes;
+        for (int band = 0; band < BANDS; ++band) {
+            const CSAMPLE* pIn = ppInputs[band] + frame * CHANNELS;
+            for (int channel = 0; channel < CHANNELS; ++channel) {
+                lanes[band * CHANNELS + channel] = pIn[channel];
+            }
+        }
+        return lanes;
+    }
+
+    static void writeFrame(CSAMPLE* const* ppOutputs, std::size_t frame, const Lanes& lanes) {
+        for (int band = 0; band < BANDS; ++band) {
+            CSAMPLE* pOut = ppOutputs[band] + frame * CHANNELS;
+            for (int channel = 0; channel < CHANNELS; ++channel) {
+                pOut[channel] = static_cast<CSAMPLE>(lanes[band * CHANNELS + channel]);
+            }
+        }
+    }
+
+    Lanes m_coef[SIZE + 1];
+    // Old coefficients needed for ramping
+    Lanes m_oldCoef[SIZE + 1];
+
+    Lanes m_buf[SIZE];
+    // Old buffers needed for ramping
+    Lanes m_oldBuf[SIZE];
+
+    // Flags per band, see EngineFilterIIR
+    bool m_doRamping[BANDS];
+    bool m_doStart[BANDS];
+    bool m_startFromDry[BANDS];
+};
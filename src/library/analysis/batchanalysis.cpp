@@ -0,0 +1,308 @@
+#include "library/analysis/batchanalysis.h"
+
+#include <QDir>
+#include <QSqlQuery>
+#include <utility>
+
+#include "analyzer/analyzerscheduledtrack.h"
+#include "analyzer/analyzerthread.h"
+#include "library/dao/trackschema.h"
+#include "library/mixxxlibraryfeature.h"
+#include "library/queryutil.h"
+#include "library/searchquery.h"
+#include "library/searchqueryparser.h"
+#include "library/trackcollection.h"
+#include "library/trackcollectionmanager.h"
+#include "moc_batchanalysis.cpp"
+#include "track/track.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("BatchAnalysis");
+
+const QString kJournalFileName = QStringLiteral("batch_analysis.journal");
+
+// Analyzed tracks are saved when either limit is reached. Up to
+// kFlushTracksCount analyzed tracks are lost when the process is
+// killed.
+constexpr int kFlushTracksCount = 100;
+constexpr int kFlushIntervalMillis = 10 * 1000;
+
+AnalyzerModeFlags getAnalyzerModeFlags(const UserSettingsPointer& pConfig) {
+    // Same as for the batch analysis in the library, but the CPU time
+    // of each analyzer is reported at the end
+    int modeFlags = AnalyzerModeFlags::WithBeats | AnalyzerModeFlags::MeasureCpuTime;
+    if (pConfig->getValue<bool>(
+                ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"),
+                true)) {
+        modeFlags |= AnalyzerModeFlags::WithWaveform;
+    }
+    return static_cast<AnalyzerModeFlags>(modeFlags);
+}
+
+} // namespace
+
+class BatchAnalysis::Environment final : public TrackAnalysisSchedulerEnvironment {
+  public:
+    explicit Environment(BatchAnalysis* pBatchAnalysis)
+            : m_pBatchAnalysis(pBatchAnalysis) {
+        DEBUG_ASSERT(m_pBatchAnalysis);
+    }
+    ~Environment() final = default;
+
+    TrackPointer loadTrackById(TrackId trackId) const final {
+        TrackPointer pTrack =
+                m_pBatchAnalysis->m_pTrackCollectionManager->getTrackById(trackId);
+        if (pTrack) {
+            // Keep the track in memory until it is saved with the
+            // next batch, see flush()
+            m_pBatchAnalysis->m_loadedTracks.insert(trackId, pTrack);
+        }
+        return pTrack;
+    }
+
+  private:
+    BatchAnalysis* const m_pBatchAnalysis;
+};
+
+BatchAnalysis::BatchAnalysis(UserSettingsPointer pConfig,
+        TrackCollectionManager* pTrackCollectionManager,
+        DbConnectionPoolPtr pDbConnectionPool,
+        const QString& query,
+        int numWorkerThreads)
+        : m_pConfig(std::move(pConfig)),
+          m_pTrackCollectionManager(pTrackCollectionManager),
+          m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_query(query),
+          m_numWorkerThreads(numWorkerThreads),
+          m_pScheduler(TrackAnalysisScheduler::NullPointer()),
+          m_totalTracksCount(0),
+          m_skippedTracksCount(0),
+          m_savedTracksCount(0),
+          m_failedTracksCount(0),
+          m_audioSeconds(0) {
+    DEBUG_ASSERT(m_pTrackCollectionManager);
+    DEBUG_ASSERT(m_numWorkerThreads > 0);
+    m_journal.setFileName(QDir(m_pConfig->getSettingsPath())
+                                  .filePath(kJournalFileName));
+    m_flushTimer.setInterval(kFlushIntervalMillis);
+    connect(&m_flushTimer,
+            &QTimer::timeout,
+            this,
+            &BatchAnalysis::slotFlushTimeout);
+}
+
+BatchAnalysis::~BatchAnalysis() {
+    m_pScheduler.reset();
+    flush();
+}
+
+bool BatchAnalysis::start() {
+    readJournal();
+    QList<AnalyzerScheduledTrack> tracks;
+    if (!queryTracks(&tracks)) {
+        return false;
+    }
+    m_totalTracksCount = static_cast<int>(tracks.size());
+    kLogger.info() << "Analyzing" << m_totalTracksCount << "tracks with"
+                   << m_numWorkerThreads << "threads," << m_skippedTracksCount
+                   << "tracks have been analyzed by a previous run";
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        kLogger.warning() << "Failed to open the journal" << m_journal.fileName()
+                          << m_journal.errorString();
+        return false;
+    }
+
+    m_timer.start();
+    if (tracks.isEmpty()) {
+        QMetaObject::invokeMethod(this, &BatchAnalysis::slotFinished, Qt::QueuedConnection);
+        return true;
+    }
+
+    m_pScheduler = TrackAnalysisScheduler::createInstance(
+            std::make_unique<const Environment>(this),
+            m_numWorkerThreads,
+            m_pDbConnectionPool,
+            m_pConfig,
+            getAnalyzerModeFlags(m_pConfig));
+    connect(m_pScheduler.get(),
+            &TrackAnalysisScheduler::trackProgress,
+            this,
+            &BatchAnalysis::slotTrackProgress);
+    connect(m_pScheduler.get(),
+            &TrackAnalysisScheduler::finished,
+            this,
+            &BatchAnalysis::slotFinished);
+    m_pScheduler->scheduleTracks(tracks);
+    m_pScheduler->resume();
+    m_flushTimer.start();
+    return true;
+}
+
+bool BatchAnalysis::queryTracks(QList<AnalyzerScheduledTrack>* pTracks) {
+    TrackCollection* pTrackCollection = m_pTrackCollectionManager->internalCollection();
+    // The view is created by MixxxLibraryFeature
+    QString queryString = QStringLiteral(
+            "SELECT %1 FROM library_cache_view WHERE %2=0 AND %3=0")
+                                  .arg(LIBRARYTABLE_ID,
+                                          LIBRARYTABLE_MIXXXDELETED,
+                                          TRACKLOCATIONSTABLE_FSDELETED);
+    if (!m_query.isEmpty()) {
+        SearchQueryParser parser(pTrackCollection,
+                MixxxLibraryFeature::searchColumns());
+        parser.setSearchIndexEnabled(true);
+        const QString filter = parser.parseQuery(m_query, QString())->toSql();
+        if (!filter.isEmpty()) {
+            queryString += QStringLiteral(" AND (%1)").arg(filter);
+        }
+    }
+    queryString += QStringLiteral(" ORDER BY %1").arg(LIBRARYTABLE_ID);
+
+    QSqlQuery query(pTrackCollection->database());
+    query.setForwardOnly(true);
+    if (!query.exec(queryString)) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    while (query.next()) {
+        const TrackId trackId(query.value(0));
+        if (m_journaledTrackIds.contains(trackId)) {
+            ++m_skippedTracksCount;
+            continue;
+        }
+        pTracks->append(AnalyzerScheduledTrack(trackId));
+    }
+    return true;
+}
+
+void BatchAnalysis::readJournal() {
+    if (!m_journal.exists()) {
+        return;
+    }
+    if (!m_journal.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        kLogger.warning() << "Failed to read the journal" << m_journal.fileName()
+                          << m_journal.errorString();
+        return;
+    }
+    QList<QByteArray> lines = m_journal.readAll().split('\n');
+    m_journal.close();
+    // The last line is either empty or incomplete if the process was
+    // killed while writing it
+    lines.removeLast();
+    for (const auto& line : std::as_const(lines)) {
+        bool ok = false;
+        const int value = line.toInt(&ok);
+        if (ok) {
+            m_journaledTrackIds.insert(TrackId(QVariant(value)));
+        }
+    }
+}
+
+void BatchAnalysis::slotTrackProgress(TrackId trackId, AnalyzerProgress analyzerProgress) {
+    if (analyzerProgress != kAnalyzerProgressDone &&
+            analyzerProgress != kAnalyzerProgressUnknown) {
+        return;
+    }
+    TrackPointer pTrack = m_loadedTracks.take(trackId);
+    VERIFY_OR_DEBUG_ASSERT(pTrack) {
+        return;
+    }
+    if (analyzerProgress == kAnalyzerProgressUnknown) {
+        kLogger.warning() << "Failed to analyze" << pTrack->getLocation();
+        ++m_failedTracksCount;
+    } else {
+        m_audioSeconds += pTrack->getDuration();
+    }
+    m_finishedTracks.push_back(std::move(pTrack));
+    if (static_cast<int>(m_finishedTracks.size()) >= kFlushTracksCount) {
+        flush();
+    }
+}
+
+void BatchAnalysis::slotFlushTimeout() {
+    flush();
+    logProgress();
+}
+
+void BatchAnalysis::flush() {
+    if (m_finishedTracks.empty()) {
+        return;
+    }
+    QStringList trackIds;
+    trackIds.reserve(static_cast<int>(m_finishedTracks.size()));
+    for (const auto& pTrack : m_finishedTracks) {
+        trackIds.append(pTrack->getId().toString());
+    }
+    // Releasing the last reference saves the modified tracks
+    // synchronously in the main thread, all within a single
+    // transaction
+    TrackDAO& trackDao = m_pTrackCollectionManager->internalCollection()->getTrackDAO();
+    trackDao.beginBatchUpdate();
+    m_finishedTracks.clear();
+    if (!trackDao.finishBatchUpdate()) {
+        kLogger.warning() << "Failed to save" << trackIds.size() << "analyzed tracks";
+        // Analyze the tracks again when resuming
+        return;
+    }
+    m_savedTracksCount += trackIds.size();
+
+    // Record the tracks only after they have been saved
+    if (m_journal.isOpen()) {
+        m_journal.write(trackIds.join(QChar('\n')).toUtf8());
+        m_journal.write("\n");
+        m_journal.flush();
+    }
+}
+
+void BatchAnalysis::slotFinished() {
+    if (m_pScheduler) {
+        // The scheduler emits finished() again when the worker
+        // threads exit
+        m_pScheduler->disconnect(this);
+        m_pScheduler.reset();
+    }
+    m_flushTimer.stop();
+    flush();
+    if (m_journal.isOpen()) {
+        m_journal.close();
+    }
+    // All tracks have been analyzed, the next run starts from scratch
+    m_journal.remove();
+    logSummary();
+    emit finished();
+}
+
+void BatchAnalysis::logProgress() const {
+    const double seconds = m_timer.elapsed().toDoubleSeconds();
+    if (seconds <= 0) {
+        return;
+    }
+    kLogger.info() << "Analyzed" << m_savedTracksCount << "of" << m_totalTracksCount
+                   << "tracks:" << m_savedTracksCount / seconds << "tracks/s,"
+                   << m_audioSeconds / 3600 / seconds << "audio hours/s ="
+                   << m_audioSeconds / seconds << "x real time";
+}
+
+void BatchAnalysis::logSummary() const {
+    logProgress();
+    kLogger.info() << "Finished after" << m_timer.elapsed().formatSecondsWithUnit()
+                   << "with" << m_failedTracksCount << "failed tracks";
+    const QMap<QString, Duration> cpuTimes = AnalyzerThread::analyzerCpuTimes();
+    Duration totalCpuTime;
+    for (const auto& cpuTime : cpuTimes) {
+        totalCpuTime += cpuTime;
+    }
+    const double totalCpuSeconds = totalCpuTime.toDoubleSeconds();
+    for (auto it = cpuTimes.constBegin(); it != cpuTimes.constEnd(); ++it) {
+        const double cpuSeconds = it.value().toDoubleSeconds();
+        kLogger.info() << "CPU time of" << it.key() << "analyzer:"
+                       << it.value().formatSecondsWithUnit() << "="
+                       << (totalCpuSeconds > 0 ? 100 * cpuSeconds / totalCpuSeconds : 0)
+                       << "%";
+    }
+}
+
+} // namespace mixxx
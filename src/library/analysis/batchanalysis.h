@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "analyzer/analyzerprogress.h"
+#include "analyzer/trackanalysisscheduler.h"
+#include "preferences/usersettings.h"
+#include "track/track_decl.h"
+#include "track/trackid.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/performancetimer.h"
+
+class TrackCollectionManager;
+
+namespace mixxx {
+
+/// Analyzes all tracks of the library that match a search query without
+/// a user interface, e.g. for preparing a large library on a server.
+///
+/// Analyzed tracks are kept in memory and saved in batches to reduce the
+/// number of database writes. The ids of saved tracks are appended to a
+/// journal file in the settings directory, so that an interrupted run
+/// continues with the remaining tracks. The journal is deleted after all
+/// tracks have been analyzed.
+class BatchAnalysis : public QObject {
+    Q_OBJECT
+  public:
+    BatchAnalysis(UserSettingsPointer pConfig,
+            TrackCollectionManager* pTrackCollectionManager,
+            DbConnectionPoolPtr pDbConnectionPool,
+            const QString& query,
+            int numWorkerThreads);
+    ~BatchAnalysis() override;
+
+    /// Schedules all matching tracks that have not been analyzed by a
+    /// previous, interrupted run. Returns false if the tracks could
+    /// not be queried. finished() is emitted after all tracks have been
+    /// analyzed.
+    bool start();
+
+    /// Tracks that have been analyzed by a previous run
+    int skippedTracksCount() const {
+        return m_skippedTracksCount;
+    }
+
+    /// Tracks that have been saved after the analysis, including
+    /// the failed tracks
+    int savedTracksCount() const {
+        return m_savedTracksCount;
+    }
+
+    int failedTracksCount() const {
+        return m_failedTracksCount;
+    }
+
+  signals:
+    void finished();
+
+  private slots:
+    void slotTrackProgress(TrackId trackId, AnalyzerProgress analyzerProgress);
+    void slotFinished();
+    void slotFlushTimeout();
+
+  private:
+    class Environment;
+
+    bool queryTracks(QList<AnalyzerScheduledTrack>* pTracks);
+    void readJournal();
+    // Saves the finished tracks and records them in the journal
+    void flush();
+    void logProgress() const;
+    void logSummary() const;
+
+    const UserSettingsPointer m_pConfig;
+    TrackCollectionManager* const m_pTrackCollectionManager;
+    const DbConnectionPoolPtr m_pDbConnectionPool;
+    const QString m_query;
+    const int m_numWorkerThreads;
+
+    TrackAnalysisScheduler::Pointer m_pScheduler;
+
+    // Tracks are loaded by the scheduler and released in batches
+    // after the analysis has finished
+    QHash<TrackId, TrackPointer> m_loadedTracks;
+    std::vector<TrackPointer> m_finishedTracks;
+
+    QFile m_journal;
+    QSet<TrackId> m_journaledTrackIds;
+
+    QTimer m_flushTimer;
+    PerformanceTimer m_timer;
+
+    int m_totalTracksCount;
+    int m_skippedTracksCount;
+    int m_savedTracksCount;
+    int m_failedTracksCount;
+    // The duration of all analyzed tracks
+    double m_audioSeconds;
+};
+
+} // namespace mixxx
@@ -1,5 +1,6 @@
 #include "library/basetrackcache.h"
 
+#include "library/dao/trackcollationkeys.h"
 #include "library/queryutil.h"
 #include "library/searchquery.h"
 #include "library/searchqueryparser.h"
@@ -29,8 +30,10 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCache(std::move(columns)),
           m_pQueryParser(std::make_unique<SearchQueryParser>(
                   pTrackCollection, std::move(searchColumns))),
+          m_pCollationKeys(nullptr),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_columnarIndex(&m_trackInfo, &m_collator),
           m_database(pTrackCollection->database()) {
 }
 
@@ -39,6 +42,16 @@ BaseTrackCache::~BaseTrackCache() {
     // in header file
 }
 
+void BaseTrackCache::setSearchIndexEnabled(bool enabled) {
+    m_pQueryParser->setSearchIndexEnabled(enabled);
+}
+
+void BaseTrackCache::setCollationKeys(TrackCollationKeys* pCollationKeys) {
+    m_pCollationKeys = pCollationKeys;
+    m_columnCache.setCollationKeysEnabled(pCollationKeys != nullptr);
+    m_columnarIndex.setCollationKeys(pCollationKeys);
+}
+
 int BaseTrackCache::columnCount() const {
     return m_columnCount;
 }
@@ -83,6 +96,7 @@ void BaseTrackCache::slotTracksRemoved(const QSet<TrackId>& trackIds) {
     }
     for (const auto& trackId : std::as_const(trackIds)) {
         m_trackInfo.remove(trackId);
+        m_columnarIndex.removeRow(trackId);
         m_dirtyTracks.remove(trackId);
     }
 }
@@ -176,6 +190,7 @@ bool BaseTrackCache::updateTrackInIndex(
         for (int i = 0; i < numColumns; ++i) {
             record[i] = getTrackValueForColumn(pTrack, i);
         }
+        m_columnarIndex.updateRow(trackId);
         if (m_bIsCaching) {
             replaceRecentTrack(trackId, pTrack);
         }
@@ -227,6 +242,7 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
                 record[i] = query.value(i);
             }
         }
+        m_columnarIndex.updateRow(trackId);
     }
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
@@ -249,6 +265,7 @@ void BaseTrackCache::buildIndex() {
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
     m_trackInfo.clear();
+    m_columnarIndex.clear();
     if (m_bIsCaching) {
         resetRecentTrack();
     }
@@ -497,41 +514,71 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         filter.prepend("WHERE ");
     }
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
+    PerformanceTimer timer;
+    timer.start();
 
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
+    std::vector<ColumnarTrackIndex::SortColumn> columnarSortColumns;
+    const bool sortInMemory = getColumnarSortColumns(
+            sortColumns, columnOffset, orderByClause, &columnarSortColumns);
 
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
+    m_trackOrder.resize(0); // keeps allocated memory
+    trackToIndex->clear();
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+    if (sortInMemory && filter.isEmpty()) {
+        // All tracks of the table are in the index
+        m_trackOrder = m_columnarIndex.trackIds();
+    } else {
+        // Only filter with SQL and omit the ORDER BY if sorting in memory
+        QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+                                      .arg(m_idColumn,
+                                              m_tableName,
+                                              filter,
+                                              sortInMemory ? QString() : orderByClause);
+
+        if (sDebug) {
+            qDebug() << this << "select() executing:" << queryString;
+        }
 
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+        QSqlQuery query(m_database);
+        // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+        // won't allocate a giant in-memory table that we won't use at all.
+        query.setForwardOnly(true);
+        query.prepare(queryString);
 
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
+
+        int idColumn = query.record().indexOf(m_idColumn);
+        int rows = query.size();
+
+        if (sDebug) {
+            qDebug() << "Rows returned:" << rows;
+        }
+
+        if (rows > 0) {
+            m_trackOrder.reserve(rows);
+        }
+
+        while (query.next()) {
+            m_trackOrder.append(TrackId(query.value(idColumn)));
+        }
     }
 
-    m_trackOrder.resize(0); // keeps allocated memory
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
+    if (sortInMemory) {
+        m_columnarIndex.sort(&m_trackOrder,
+                columnarSortColumns,
+                m_columnCache.keyNotation());
     }
 
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
+    }
+
+    if (sDebug) {
+        qDebug() << this << "filterAndSort took" << timer.elapsed().debugMillisWithUnit()
+                 << (sortInMemory ? "sorting in memory" : "sorting with SQL");
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -547,6 +594,11 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         return;
     }
 
+    // Check the collation keys and the sort columns only once instead of
+    // for every comparison of the insertion sort below
+    std::vector<CollatedSortColumn> collatedColumns =
+            collatedSortColumns(sortColumns, columnOffset);
+
     for (TrackId trackId : std::as_const(dirtyTracks)) {
         // Only get the track if it is in the cache.
         // Tracks that are not cached in memory cannot be dirty.
@@ -579,8 +631,11 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
 
             // Figure out where it is supposed to sort. The table is sorted by
             // the sort column, so we can binary search.
-            int insertRow = findSortInsertionPoint(
-                    pTrack, sortColumns, columnOffset, m_trackOrder);
+            int insertRow = findSortInsertionPoint(pTrack,
+                    sortColumns,
+                    columnOffset,
+                    m_trackOrder,
+                    &collatedColumns);
 
             if (sDebug) {
                 qDebug() << this
@@ -611,16 +666,58 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     }
 }
 
+std::vector<BaseTrackCache::CollatedSortColumn> BaseTrackCache::collatedSortColumns(
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset) const {
+    std::vector<CollatedSortColumn> collatedColumns(sortColumns.size());
+    if (!m_pCollationKeys || !m_pCollationKeys->reloadIfModified()) {
+        return collatedColumns;
+    }
+    for (int i = 0; i < sortColumns.size(); ++i) {
+        collatedColumns[i].enabled = TrackCollationKeys::columns().contains(
+                columnNameForFieldIndex(sortColumns[i].m_column - columnOffset));
+    }
+    return collatedColumns;
+}
+
+std::optional<qint64> BaseTrackCache::collationSortKey(TrackId trackId,
+        const QVariant& value,
+        CollatedSortColumn* pCollatedSortColumn) const {
+    DEBUG_ASSERT(pCollatedSortColumn->enabled);
+    auto it = pCollatedSortColumn->sortKeys.find(trackId);
+    if (it == pCollatedSortColumn->sortKeys.end()) {
+        qint64 sortKey;
+        std::optional<qint64> optionalSortKey;
+        // Modified values might not have a sort key yet
+        if (m_pCollationKeys->cachedSortKey(
+                    TrackCollationKeys::foldValue(value.toString()), &sortKey)) {
+            optionalSortKey = sortKey;
+        }
+        it = pCollatedSortColumn->sortKeys.insert(trackId, optionalSortKey);
+    }
+    return it.value();
+}
+
 int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
         const QList<SortColumn>& sortColumns,
         const int columnOffset,
-        const QVector<TrackId>& trackIds) const {
+        const QVector<TrackId>& trackIds,
+        std::vector<CollatedSortColumn>* pCollatedSortColumns) const {
     QList<QVariant> trackValues;
     if (sortColumns.isEmpty()) {
         return 0;
     }
-    for (const auto& sc: sortColumns) {
-        trackValues.append(getTrackValueForColumn(pTrack, sc.m_column - columnOffset));
+    DEBUG_ASSERT(pCollatedSortColumns->size() ==
+            static_cast<std::size_t>(sortColumns.size()));
+    std::vector<std::optional<qint64>> trackSortKeys(sortColumns.size());
+    for (int i = 0; i < sortColumns.size(); ++i) {
+        trackValues.append(getTrackValueForColumn(
+                pTrack, sortColumns[i].m_column - columnOffset));
+        if ((*pCollatedSortColumns)[i].enabled) {
+            trackSortKeys[i] = collationSortKey(pTrack->getId(),
+                    trackValues.last(),
+                    &(*pCollatedSortColumns)[i]);
+        }
     }
 
     int min = 0;
@@ -649,11 +746,26 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
             QVariant tableValue =
                     data(otherTrackId, sortColumns[i].m_column - columnOffset);
 
-            compare = compareColumnValues(
-                    sortColumns[i].m_column - columnOffset,
-                    sortColumns[i].m_order,
-                    trackValues[i],
-                    tableValue);
+            std::optional<qint64> tableSortKey;
+            if (trackSortKeys[i]) {
+                tableSortKey = collationSortKey(otherTrackId,
+                        tableValue,
+                        &(*pCollatedSortColumns)[i]);
+            }
+            if (tableSortKey) {
+                compare = *trackSortKeys[i] < *tableSortKey
+                        ? -1
+                        : (*trackSortKeys[i] > *tableSortKey ? 1 : 0);
+                if (sortColumns[i].m_order == Qt::DescendingOrder) {
+                    compare = -compare;
+                }
+            } else {
+                compare = compareColumnValues(
+                        sortColumns[i].m_column - columnOffset,
+                        sortColumns[i].m_order,
+                        trackValues[i],
+                        tableValue);
+            }
 
             if (compare != 0) {
                 break;
@@ -674,6 +786,46 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
     return min;
 }
 
+bool BaseTrackCache::getColumnarSortColumns(
+        const QList<SortColumn>& sortColumns,
+        const int columnOffset,
+        const QString& orderByClause,
+        std::vector<ColumnarTrackIndex::SortColumn>* pColumnarSortColumns) const {
+    // The ORDER BY clause is constructed by BaseSqlTableModel::setSort()
+    // from the sort columns. It is empty if the result is not sorted
+    // by a column of this table.
+    if (orderByClause.isEmpty()) {
+        return true;
+    }
+    if (orderByClause.contains(QStringLiteral("RANDOM()"))) {
+        return false;
+    }
+    for (const auto& sc : sortColumns) {
+        int column;
+        if (sc.m_column == 0) {
+            // The id column of the table model
+            column = 0;
+        } else if (sc.m_column - columnOffset >= 1) {
+            column = sc.m_column - columnOffset;
+        } else {
+            // Other columns of the table model are skipped
+            continue;
+        }
+        VERIFY_OR_DEBUG_ASSERT(column < columnCount()) {
+            return false;
+        }
+        const auto sortType = m_columnCache.columnSortTypeForFieldIndex(column);
+        const int valueColumn = sortType == ColumnCache::SortType::Key
+                ? fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID)
+                : column;
+        if (valueColumn < 0) {
+            return false;
+        }
+        pColumnarSortColumns->push_back({column, sortType, valueColumn, sc.m_order});
+    }
+    return true;
+}
+
 int BaseTrackCache::compareColumnValues(int sortColumn,
         Qt::SortOrder sortOrder,
         const QVariant& val1,
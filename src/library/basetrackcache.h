@@ -9,7 +9,10 @@
 #include <QStringList>
 #include <QVector>
 #include <memory>
+#include <optional>
+#include <vector>
 
+#include "library/columnartrackindex.h"
 #include "library/columncache.h"
 #include "track/track_decl.h"
 #include "track/trackid.h"
@@ -17,6 +20,7 @@
 #include "util/string.h"
 
 class SearchQueryParser;
+class TrackCollationKeys;
 class TrackCollection;
 
 class SortColumn {
@@ -75,6 +79,14 @@ class BaseTrackCache : public QObject {
     virtual bool isCached(TrackId trackId) const;
     virtual void ensureCached(TrackId trackId);
 
+    /// Search with the full-text search index of the library. Only
+    /// applicable if the ids of the table are library track ids.
+    void setSearchIndexEnabled(bool enabled);
+
+    /// Sort with the persistent collation keys of the library. Only
+    /// applicable if the ids of the table are library track ids.
+    void setCollationKeys(TrackCollationKeys* pCollationKeys);
+
   signals:
     void tracksChanged(const QSet<TrackId>& trackIds);
 
@@ -98,10 +110,29 @@ class BaseTrackCache : public QObject {
     void updateTracksInIndex(const QSet<TrackId>& trackIds);
     QVariant getTrackValueForColumn(TrackPointer pTrack, int column) const;
 
+    // The collation keys of a text sort column, resolved at most
+    // once per row during filterAndSort()
+    struct CollatedSortColumn {
+        bool enabled = false;
+        QHash<TrackId, std::optional<qint64>> sortKeys;
+    };
+    std::vector<CollatedSortColumn> collatedSortColumns(
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset) const;
+    std::optional<qint64> collationSortKey(TrackId trackId,
+            const QVariant& value,
+            CollatedSortColumn* pCollatedSortColumn) const;
+
     int findSortInsertionPoint(TrackPointer pTrack,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
-                               const QVector<TrackId>& trackIds) const;
+                               const QVector<TrackId>& trackIds,
+                               std::vector<CollatedSortColumn>* pCollatedSortColumns) const;
+    bool getColumnarSortColumns(
+            const QList<SortColumn>& sortColumns,
+            const int columnOffset,
+            const QString& orderByClause,
+            std::vector<ColumnarTrackIndex::SortColumn>* pColumnarSortColumns) const;
     int compareColumnValues(int sortColumn,
             Qt::SortOrder sortOrder,
             const QVariant& val1,
@@ -112,11 +143,12 @@ class BaseTrackCache : public QObject {
     const int m_columnCount;
     const QString m_columnsJoined;
 
-    const ColumnCache m_columnCache;
+    ColumnCache m_columnCache;
 
     const std::unique_ptr<SearchQueryParser> m_pQueryParser;
 
     const mixxx::StringCollator m_collator;
+    TrackCollationKeys* m_pCollationKeys;
 
     // Temporary storage for filterAndSort()
 
@@ -137,6 +169,7 @@ class BaseTrackCache : public QObject {
     bool m_bIndexBuilt;
     bool m_bIsCaching;
     QHash<TrackId, QVector<QVariant>> m_trackInfo;
+    ColumnarTrackIndex m_columnarIndex;
     QSqlDatabase m_database;
 
     DISALLOW_COPY_AND_ASSIGN(BaseTrackCache);
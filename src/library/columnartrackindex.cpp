@@ -0,0 +1,372 @@
+#include "library/columnartrackindex.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "library/dao/trackcollationkeys.h"
+
+namespace {
+
+constexpr int kNullCode = -1;
+constexpr int kNumberCode = -2;
+
+// NULL values sort first, then numbers and then strings like in SQLite
+constexpr int kNullGroup = 0;
+constexpr int kNumberGroup = 1;
+constexpr int kStringGroup = 2;
+
+bool isNumeric(const QVariant& value) {
+    switch (value.userType()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool hasNumbers(ColumnCache::SortType sortType) {
+    return sortType != ColumnCache::SortType::NoCase &&
+            sortType != ColumnCache::SortType::NoCaseLexicographic;
+}
+
+// Like the SQL function lower() that only converts ASCII characters
+QString toLowerAscii(QString string) {
+    for (auto& ch : string) {
+        if (ch >= QChar('A') && ch <= QChar('Z')) {
+            ch = QChar(ch.unicode() + ('a' - 'A'));
+        }
+    }
+    return string;
+}
+
+// Like CAST(value AS INTEGER) in SQLite that converts the leading
+// integer of a string and 0 if there is none
+double toInteger(const QVariant& value) {
+    if (isNumeric(value)) {
+        return std::trunc(value.toDouble());
+    }
+    const QString string = value.toString();
+    int pos = 0;
+    while (pos < string.size() && string.at(pos).isSpace()) {
+        ++pos;
+    }
+    double sign = 1;
+    if (pos < string.size() && (string.at(pos) == '-' || string.at(pos) == '+')) {
+        if (string.at(pos) == '-') {
+            sign = -1;
+        }
+        ++pos;
+    }
+    double result = 0;
+    while (pos < string.size() && string.at(pos) >= QChar('0') &&
+            string.at(pos) <= QChar('9')) {
+        result = result * 10 + string.at(pos).digitValue();
+        ++pos;
+    }
+    return sign * result;
+}
+
+} // anonymous namespace
+
+ColumnarTrackIndex::ColumnarTrackIndex(
+        const Records* pRecords,
+        const mixxx::StringCollator* pCollator)
+        : m_pRecords(pRecords),
+          m_pCollator(pCollator),
+          m_pCollationKeys(nullptr) {
+    DEBUG_ASSERT(m_pRecords);
+    DEBUG_ASSERT(m_pCollator);
+}
+
+void ColumnarTrackIndex::setCollationKeys(TrackCollationKeys* pCollationKeys) {
+    m_pCollationKeys = pCollationKeys;
+    for (auto& [columnIndex, column] : m_columns) {
+        column.ranksValid = false;
+    }
+}
+
+void ColumnarTrackIndex::clear() {
+    m_rowByTrackId.clear();
+    m_trackIdByRow.clear();
+    m_freeRows.clear();
+    m_columns.clear();
+}
+
+void ColumnarTrackIndex::updateRow(TrackId trackId) {
+    const auto recordIt = m_pRecords->constFind(trackId);
+    if (recordIt == m_pRecords->constEnd()) {
+        removeRow(trackId);
+        return;
+    }
+    int row = m_rowByTrackId.value(trackId, -1);
+    if (row < 0) {
+        if (m_freeRows.empty()) {
+            row = static_cast<int>(m_trackIdByRow.size());
+            m_trackIdByRow.push_back(trackId);
+            for (auto& [columnIndex, column] : m_columns) {
+                column.codes.push_back(kNullCode);
+                if (hasNumbers(column.sortType)) {
+                    column.numbers.push_back(0);
+                }
+            }
+        } else {
+            row = m_freeRows.back();
+            m_freeRows.pop_back();
+            m_trackIdByRow[row] = trackId;
+        }
+        m_rowByTrackId.insert(trackId, row);
+    }
+    for (auto& [columnIndex, column] : m_columns) {
+        encodeValue(&column, row, recordIt.value().value(column.valueColumn));
+    }
+}
+
+void ColumnarTrackIndex::removeRow(TrackId trackId) {
+    const auto it = m_rowByTrackId.find(trackId);
+    if (it == m_rowByTrackId.end()) {
+        return;
+    }
+    const int row = it.value();
+    m_rowByTrackId.erase(it);
+    m_trackIdByRow[row] = TrackId();
+    m_freeRows.push_back(row);
+}
+
+QVector<TrackId> ColumnarTrackIndex::trackIds() const {
+    QVector<TrackId> trackIds;
+    trackIds.reserve(m_rowByTrackId.size());
+    for (auto it = m_rowByTrackId.constBegin(); it != m_rowByTrackId.constEnd(); ++it) {
+        trackIds.append(it.key());
+    }
+    return trackIds;
+}
+
+ColumnarTrackIndex::Column* ColumnarTrackIndex::encodedColumn(
+        const SortColumn& sortColumn) {
+    auto it = m_columns.find(sortColumn.column);
+    if (it != m_columns.end()) {
+        if (it->second.sortType == sortColumn.sortType &&
+                it->second.valueColumn == sortColumn.valueColumn) {
+            return &it->second;
+        }
+        m_columns.erase(it);
+    }
+    Column& column = m_columns[sortColumn.column];
+    column.sortType = sortColumn.sortType;
+    column.valueColumn = sortColumn.valueColumn;
+    column.codes.resize(m_trackIdByRow.size(), kNullCode);
+    if (hasNumbers(column.sortType)) {
+        column.numbers.resize(m_trackIdByRow.size());
+    }
+    for (int row = 0; row < static_cast<int>(m_trackIdByRow.size()); ++row) {
+        const TrackId trackId = m_trackIdByRow[row];
+        if (!trackId.isValid()) {
+            continue;
+        }
+        const auto recordIt = m_pRecords->constFind(trackId);
+        VERIFY_OR_DEBUG_ASSERT(recordIt != m_pRecords->constEnd()) {
+            continue;
+        }
+        encodeValue(&column, row, recordIt.value().value(column.valueColumn));
+    }
+    return &column;
+}
+
+void ColumnarTrackIndex::encodeValue(
+        Column* pColumn, int row, const QVariant& value) const {
+    if (value.isNull()) {
+        pColumn->codes[row] = kNullCode;
+        return;
+    }
+    QString string;
+    switch (pColumn->sortType) {
+    case ColumnCache::SortType::NoCase:
+    case ColumnCache::SortType::NoCaseLexicographic:
+        string = toLowerAscii(value.toString());
+        break;
+    case ColumnCache::SortType::Integer:
+        pColumn->codes[row] = kNumberCode;
+        pColumn->numbers[row] = toInteger(value);
+        return;
+    case ColumnCache::SortType::Key:
+        pColumn->codes[row] = kNumberCode;
+        pColumn->numbers[row] = value.toInt();
+        return;
+    case ColumnCache::SortType::Default:
+        if (isNumeric(value)) {
+            pColumn->codes[row] = kNumberCode;
+            pColumn->numbers[row] = value.toDouble();
+            return;
+        }
+        if (value.userType() == QMetaType::QDateTime) {
+            // Same format as in the database
+            string = value.toDateTime().toUTC().toString(Qt::ISODateWithMs);
+        } else {
+            string = value.toString();
+        }
+        break;
+    }
+    auto codeIt = pColumn->codeByString.constFind(string);
+    if (codeIt == pColumn->codeByString.constEnd()) {
+        codeIt = pColumn->codeByString.insert(string, pColumn->strings.size());
+        pColumn->strings.append(string);
+        pColumn->ranksValid = false;
+    }
+    pColumn->codes[row] = codeIt.value();
+}
+
+void ColumnarTrackIndex::updateRanks(Column* pColumn) const {
+    if (pColumn->ranksValid) {
+        return;
+    }
+    const auto& strings = pColumn->strings;
+    std::vector<int> order(strings.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<int> comparisons(strings.size());
+    std::vector<qint64> collationKeys;
+    if (pColumn->sortType == ColumnCache::SortType::NoCaseLexicographic &&
+            m_pCollationKeys &&
+            m_pCollationKeys->sortKeys(strings, &collationKeys)) {
+        // The persistent keys of the library are already in the
+        // collation order
+        std::sort(order.begin(), order.end(), [&collationKeys](int lhs, int rhs) {
+            return collationKeys[lhs] < collationKeys[rhs];
+        });
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            comparisons[i] = collationKeys[order[i - 1]] == collationKeys[order[i]] ? 0 : -1;
+        }
+    } else if (pColumn->sortType == ColumnCache::SortType::NoCaseLexicographic) {
+        // Comparing precomputed sort keys is much faster than
+        // comparing the strings with the collator
+        std::vector<QCollatorSortKey> sortKeys;
+        sortKeys.reserve(strings.size());
+        for (const auto& string : strings) {
+            sortKeys.push_back(m_pCollator->sortKey(string));
+        }
+        std::sort(order.begin(), order.end(), [&sortKeys](int lhs, int rhs) {
+            return sortKeys[lhs].compare(sortKeys[rhs]) < 0;
+        });
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            comparisons[i] = sortKeys[order[i - 1]].compare(sortKeys[order[i]]);
+        }
+    } else {
+        std::sort(order.begin(), order.end(), [&strings](int lhs, int rhs) {
+            return strings[lhs] < strings[rhs];
+        });
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            comparisons[i] = strings[order[i - 1]].compare(strings[order[i]]);
+        }
+    }
+    pColumn->ranks.resize(strings.size());
+    int rank = 0;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        if (comparisons[i] != 0) {
+            rank = static_cast<int>(i);
+        }
+        pColumn->ranks[order[i]] = rank;
+    }
+    pColumn->ranksValid = true;
+}
+
+std::vector<ColumnarTrackIndex::SortKey> ColumnarTrackIndex::sortKeys(
+        const Column& column,
+        const std::vector<int>& rows,
+        KeyUtils::KeyNotation keyNotation) const {
+    std::vector<double> keyOrder;
+    if (column.sortType == ColumnCache::SortType::Key) {
+        for (int key = 0; key <= mixxx::track::io::key::ChromaticKey_MAX; ++key) {
+            keyOrder.push_back(KeyUtils::keyToCircleOfFifthsOrder(
+                    static_cast<mixxx::track::io::key::ChromaticKey>(key),
+                    keyNotation));
+        }
+    }
+    std::vector<SortKey> sortKeys;
+    sortKeys.reserve(rows.size());
+    for (const int row : rows) {
+        const int code = column.codes[row];
+        if (code == kNullCode) {
+            sortKeys.push_back({kNullGroup, 0});
+        } else if (code == kNumberCode) {
+            double value = column.numbers[row];
+            if (column.sortType == ColumnCache::SortType::Key) {
+                // The SQL CASE expression yields NULL for invalid keys
+                const auto key = static_cast<int>(value);
+                if (key < 0 || key >= static_cast<int>(keyOrder.size())) {
+                    sortKeys.push_back({kNullGroup, 0});
+                    continue;
+                }
+                value = keyOrder[key];
+            }
+            sortKeys.push_back({kNumberGroup, value});
+        } else {
+            sortKeys.push_back({kStringGroup, static_cast<double>(column.ranks[code])});
+        }
+    }
+    return sortKeys;
+}
+
+void ColumnarTrackIndex::sort(QVector<TrackId>* pTrackIds,
+        const std::vector<SortColumn>& sortColumns,
+        KeyUtils::KeyNotation keyNotation) {
+    DEBUG_ASSERT(pTrackIds);
+    if (sortColumns.empty()) {
+        return;
+    }
+    std::vector<int> rows;
+    rows.reserve(pTrackIds->size());
+    QVector<TrackId> missingTrackIds;
+    for (const auto& trackId : std::as_const(*pTrackIds)) {
+        const int row = m_rowByTrackId.value(trackId, -1);
+        if (row < 0) {
+            missingTrackIds.append(trackId);
+        } else {
+            rows.push_back(row);
+        }
+    }
+
+    std::vector<std::vector<SortKey>> keysByColumn;
+    std::vector<bool> descending;
+    keysByColumn.reserve(sortColumns.size());
+    descending.reserve(sortColumns.size());
+    for (const auto& sortColumn : sortColumns) {
+        Column* pColumn = encodedColumn(sortColumn);
+        updateRanks(pColumn);
+        keysByColumn.push_back(sortKeys(*pColumn, rows, keyNotation));
+        descending.push_back(sortColumn.order == Qt::DescendingOrder);
+    }
+
+    std::vector<int> order(rows.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(),
+            order.end(),
+            [&keysByColumn, &descending](int lhs, int rhs) {
+                for (std::size_t i = 0; i < keysByColumn.size(); ++i) {
+                    const SortKey& lhsKey = keysByColumn[i][lhs];
+                    const SortKey& rhsKey = keysByColumn[i][rhs];
+                    int result = 0;
+                    if (lhsKey.group != rhsKey.group) {
+                        result = lhsKey.group < rhsKey.group ? -1 : 1;
+                    } else if (lhsKey.value != rhsKey.value) {
+                        result = lhsKey.value < rhsKey.value ? -1 : 1;
+                    }
+                    if (result != 0) {
+                        return descending[i] ? result > 0 : result < 0;
+                    }
+                }
+                return false;
+            });
+
+    pTrackIds->resize(0);
+    for (const int index : order) {
+        pTrackIds->append(m_trackIdByRow[rows[index]]);
+    }
+    pTrackIds->append(missingTrackIds);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QHash>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <map>
+#include <vector>
+
+#include "library/columncache.h"
+#include "track/keyutils.h"
+#include "track/trackid.h"
+#include "util/string.h"
+
+class TrackCollationKeys;
+
+/// Typed, column-oriented copy of the values of BaseTrackCache for sorting
+/// the whole library in memory.
+///
+/// Each column that has been sorted by is encoded once into contiguous
+/// arrays and then kept up to date: strings are dictionary encoded and
+/// ranked with precomputed collation sort keys, numbers are stored as
+/// doubles. Sorting compares these plain values instead of QVariants and
+/// strings. The order is the same as for the SQL returned by
+/// ColumnCache::columnSortForFieldIndex().
+class ColumnarTrackIndex final {
+  public:
+    using Records = QHash<TrackId, QVector<QVariant>>;
+
+    struct SortColumn {
+        int column;
+        ColumnCache::SortType sortType;
+        /// The column that contains the value for sorting, i.e. the
+        /// key_id column for SortType::Key and otherwise the column
+        /// itself.
+        int valueColumn;
+        Qt::SortOrder order;
+    };
+
+    /// The records are owned by BaseTrackCache and must outlive the index.
+    ColumnarTrackIndex(
+            const Records* pRecords,
+            const mixxx::StringCollator* pCollator);
+
+    /// Rank strings by their persistent collation keys if available
+    /// instead of computing the collation sort keys.
+    void setCollationKeys(TrackCollationKeys* pCollationKeys);
+
+    void clear();
+
+    /// Must be invoked after the record of a track has been
+    /// inserted or modified.
+    void updateRow(TrackId trackId);
+    void removeRow(TrackId trackId);
+
+    int size() const {
+        return m_rowByTrackId.size();
+    }
+
+    /// All tracks in the index in no particular order.
+    QVector<TrackId> trackIds() const;
+
+    /// Stable sort of the given tracks. Tracks that are not in the
+    /// index are moved to the end.
+    void sort(QVector<TrackId>* pTrackIds,
+            const std::vector<SortColumn>& sortColumns,
+            KeyUtils::KeyNotation keyNotation);
+
+  private:
+    struct Column {
+        ColumnCache::SortType sortType;
+        int valueColumn;
+        // Per row: an index into strings or one of the negative
+        // codes for NULL and numbers
+        std::vector<int> codes;
+        // Per row, only used for numbers
+        std::vector<double> numbers;
+        // The dictionary of all strings that have been encoded
+        QStringList strings;
+        QHash<QString, int> codeByString;
+        // The sort rank of each string, equal strings have the same rank
+        std::vector<int> ranks;
+        bool ranksValid = false;
+    };
+
+    struct SortKey {
+        int group;
+        double value;
+    };
+
+    Column* encodedColumn(const SortColumn& sortColumn);
+    void encodeValue(Column* pColumn, int row, const QVariant& value) const;
+    void updateRanks(Column* pColumn) const;
+    std::vector<SortKey> sortKeys(
+            const Column& column,
+            const std::vector<int>& rows,
+            KeyUtils::KeyNotation keyNotation) const;
+
+    const Records* const m_pRecords;
+    const mixxx::StringCollator* const m_pCollator;
+    TrackCollationKeys* m_pCollationKeys;
+
+    QHash<TrackId, int> m_rowByTrackId;
+    std::vector<TrackId> m_trackIdByRow;
+    std::vector<int> m_freeRows;
+
+    // Encoded on first use and indexed by column
+    std::map<int, Column> m_columns;
+};
@@ -3,6 +3,7 @@
 #include <QCoreApplication>
 
 #include "library/dao/playlistdao.h"
+#include "library/dao/trackcollationkeys.h"
 #include "library/dao/trackschema.h"
 #include "library/library_prefs.h"
 #include "moc_columncache.cpp"
@@ -14,6 +15,7 @@ const QString kSortInt = QStringLiteral("cast(%1 as integer)");
 const QString kSortNoCase = QStringLiteral("lower(%1)");
 const QString kSortNoCaseLex = mixxx::DbConnection::collateLexicographically(
         QStringLiteral("lower(%1)"));
+const QString kSortCollationKey = TrackCollationKeys::sortSql(QStringLiteral("%1"));
 
 struct ColumnProperties {
     const QString* pName;
@@ -228,27 +230,67 @@ void ColumnCache::setColumns(QStringList columns) {
     }
 
     m_columnSortByIndex.clear();
+    m_columnSortTypeByIndex.clear();
     // Add the columns that requires a special sort
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ARTIST, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TITLE, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ALBUM, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ALBUMARTIST, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_YEAR, kSortNoCase);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_GENRE, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_COMPOSER, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_GROUPING, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TRACKNUMBER, kSortInt);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_FILETYPE, kSortNoCase);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_COMMENT, kSortNoCaseLex);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_BITRATE, kSortInt);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_SAMPLERATE, kSortInt);
-    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TIMESPLAYED, kSortInt);
+    const QString& sortCollated = m_collationKeysEnabled ? kSortCollationKey : kSortNoCaseLex;
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ARTIST,
+            sortCollated,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TITLE,
+            sortCollated,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ALBUM,
+            sortCollated,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_ALBUMARTIST,
+            sortCollated,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_YEAR,
+            kSortNoCase,
+            SortType::NoCase);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_GENRE,
+            sortCollated,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_COMPOSER,
+            kSortNoCaseLex,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_GROUPING,
+            kSortNoCaseLex,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TRACKNUMBER,
+            kSortInt,
+            SortType::Integer);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_FILETYPE,
+            kSortNoCase,
+            SortType::NoCase);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_COMMENT,
+            kSortNoCaseLex,
+            SortType::NoCaseLexicographic);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_BITRATE,
+            kSortInt,
+            SortType::Integer);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_SAMPLERATE,
+            kSortInt,
+            SortType::Integer);
+    insertColumnSortByEnum(COLUMN_LIBRARYTABLE_TIMESPLAYED,
+            kSortInt,
+            SortType::Integer);
 
-    insertColumnSortByEnum(COLUMN_TRACKLOCATIONSTABLE_LOCATION, kSortNoCase);
+    insertColumnSortByEnum(COLUMN_TRACKLOCATIONSTABLE_LOCATION,
+            kSortNoCase,
+            SortType::NoCase);
 
     slotSetKeySortOrder(m_pKeyNotationCP->get());
 }
 
+void ColumnCache::setCollationKeysEnabled(bool enabled) {
+    if (m_collationKeysEnabled == enabled) {
+        return;
+    }
+    m_collationKeysEnabled = enabled;
+    setColumns(m_columnsByIndex);
+}
+
 void ColumnCache::slotSetKeySortOrder(double notationValue) {
     const int keyColumnIndex = m_columnIndexByEnum[COLUMN_LIBRARYTABLE_KEY];
     if (keyColumnIndex < 0) {
@@ -278,6 +320,7 @@ void ColumnCache::slotSetKeySortOrder(double notationValue) {
 
     // Replace the existing sort order
     m_columnSortByIndex[keyColumnIndex] = keySortSQL;
+    m_columnSortTypeByIndex[keyColumnIndex] = SortType::Key;
 }
 
 const QString& ColumnCache::columnName(Column column) const {
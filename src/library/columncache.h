@@ -74,11 +74,31 @@ class ColumnCache : public QObject {
         NUM_COLUMNS
     };
 
+    /// How the values of a column are ordered, corresponding to the
+    /// SQL returned by columnSortForFieldIndex()
+    enum class SortType {
+        /// The plain column value
+        Default,
+        /// The column value cast to an integer
+        Integer,
+        /// The lowercase column value
+        NoCase,
+        /// The lowercase column value with the locale-aware collation
+        NoCaseLexicographic,
+        /// The position of the key_id value in the circle of fifths
+        Key,
+    };
+
     ColumnCache();
     explicit ColumnCache(QStringList columns);
 
     void setColumns(QStringList columns);
 
+    /// Sort the text columns with persistent sort keys by these keys
+    /// instead of the collation function. Only applicable if the table
+    /// contains the values of the library table.
+    void setCollationKeysEnabled(bool enabled);
+
     inline int fieldIndex(Column column) const {
         if (static_cast<size_t>(column) >= std::size(m_columnIndexByEnum)) {
             return -1;
@@ -111,6 +131,10 @@ class ColumnCache : public QObject {
         return format.arg(columnNameForFieldIndex(index));
     }
 
+    SortType columnSortTypeForFieldIndex(int index) const {
+        return m_columnSortTypeByIndex.value(index, SortType::Default);
+    }
+
     KeyUtils::KeyNotation keyNotation() const {
         return KeyUtils::keyNotationFromNumericValue(
                 m_pKeyNotationCP->get());
@@ -124,18 +148,21 @@ class ColumnCache : public QObject {
   private:
     void insertColumnSortByEnum(
             Column column,
-            const QString& sortFormat) {
+            const QString& sortFormat,
+            SortType sortType) {
         int index = fieldIndex(column);
         if (index < 0) {
             return;
         }
         DEBUG_ASSERT(!m_columnSortByIndex.contains(index));
         m_columnSortByIndex.insert(index, sortFormat);
+        m_columnSortTypeByIndex.insert(index, sortType);
     }
 
 
     QStringList m_columnsByIndex;
     QMap<int, QString> m_columnSortByIndex;
+    QMap<int, SortType> m_columnSortTypeByIndex;
     QMap<QString, int> m_columnIndexByName;
     // A mapping from column enum to logical index.
     // Columns in the enums but not in the table are marked by -1
@@ -143,5 +170,7 @@ class ColumnCache : public QObject {
     // m_columnIndexByName but without a corresponding enum.
     int m_columnIndexByEnum[NUM_COLUMNS];
 
+    bool m_collationKeysEnabled = false;
+
     ControlProxy* m_pKeyNotationCP;
 };
@@ -1,5 +1,6 @@
 #include "library/dao/analysisdao.h"
 
+#include <QSaveFile>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QtDebug>
@@ -17,6 +18,18 @@ const QString AnalysisDao::s_analysisTableName = "track_analysis";
 // CPU time so I think we should stick with the default. rryan 4/3/2012
 constexpr int kCompressionLevel = -1;
 
+namespace {
+
+int checksum(const QByteArray& data) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(data);
+#else
+    return qChecksum(data.constData(), data.length());
+#endif
+}
+
+} // anonymous namespace
+
 AnalysisDao::AnalysisDao(UserSettingsPointer pConfig)
         : m_pConfig(pConfig) {
     QDir storagePath = getAnalysisStoragePath();
@@ -81,19 +94,38 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         info.type = static_cast<AnalysisType>(query->value(typeColumn).toInt());
         info.description = query->value(descriptionColumn).toString();
         info.version = query->value(versionColumn).toString();
-        int checksum = query->value(dataChecksumColumn).toInt();
+        const int dataChecksum = query->value(dataChecksumColumn).toInt();
         QString dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
-        const QByteArray compressedData = loadDataFromFile(dataPath);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        const int file_checksum = qChecksum(
-                compressedData);
-#else
-        const int file_checksum = qChecksum(
-                compressedData.constData(),
-                compressedData.length());
-#endif
-        if (checksum != file_checksum) {
+        QFile file(dataPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "WARNING: Missing analysis" << dataPath;
+            continue;
+        }
+        const QByteArray header = file.peek(Waveform::kCompactHeaderSize);
+        if (Waveform::isCompactFormat(header)) {
+            // The whole file is checked through a mapping without copying
+            // it. The pages stay cached for mapping the records later.
+            const qint64 fileSize = file.size();
+            const uchar* pMapped = file.map(0, fileSize);
+            const int fileChecksum = pMapped
+                    ? checksum(QByteArray::fromRawData(
+                              reinterpret_cast<const char*>(pMapped),
+                              static_cast<int>(fileSize)))
+                    : checksum(file.readAll());
+            if (dataChecksum != fileChecksum) {
+                qDebug() << "WARNING: Corrupt analysis loaded from" << dataPath
+                         << "length" << fileSize;
+                continue;
+            }
+            file.close();
+            info.compactDataPath = dataPath;
+            bytes += static_cast<int>(fileSize);
+            analyses.append(info);
+            continue;
+        }
+        const QByteArray compressedData = file.readAll();
+        if (dataChecksum != checksum(compressedData)) {
             qDebug() << "WARNING: Corrupt analysis loaded from" << dataPath
                      << "length" << compressedData.length();
             continue;
@@ -121,14 +153,55 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     time.start();
 
     const QByteArray compressedData = qCompress(info->data, kCompressionLevel);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    const int checksum = qChecksum(
-            compressedData);
-#else
-    const int checksum = qChecksum(
-            compressedData.constData(),
-            compressedData.length());
-#endif
+    const bool success = saveAnalysisData(info, compressedData, checksum(compressedData));
+    if (success) {
+        qDebug() << "AnalysisDAO saved analysis" << info->analysisId
+                 << QString("%1 (%2 compressed)")
+                            .arg(QString::number(info->data.length()),
+                                    QString::number(compressedData.length()))
+                 << "bytes for track"
+                 << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
+    }
+    return success;
+}
+
+bool AnalysisDao::saveWaveformAnalysis(AnalysisInfo* info, const Waveform& waveform) {
+    if (!m_database.isOpen() || info == nullptr) {
+        return false;
+    }
+
+    if (!info->trackId.isValid()) {
+        qDebug() << "Can't save analysis since trackId is invalid.";
+        return false;
+    }
+    PerformanceTimer time;
+    time.start();
+
+    // Unlike other analyses waveforms are stored uncompressed, see
+    // Waveform::toCompactByteArray()
+    const QByteArray data = waveform.toCompactByteArray();
+    const bool success = saveAnalysisData(info, data, checksum(data));
+    if (success) {
+        qDebug() << "AnalysisDAO saved waveform analysis" << info->analysisId
+                 << data.length() << "bytes for track"
+                 << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
+    }
+    return success;
+}
+
+void AnalysisDao::upgradeWaveformAnalysis(
+        const AnalysisInfo& analysis, const Waveform& waveform) {
+    if (!analysis.compactDataPath.isEmpty() || waveform.getDataSize() == 0) {
+        return;
+    }
+    AnalysisInfo upgraded = analysis;
+    upgraded.data.clear();
+    if (!saveWaveformAnalysis(&upgraded, waveform)) {
+        qDebug() << "WARNING: Failed to upgrade waveform analysis" << analysis.analysisId;
+    }
+}
+
+bool AnalysisDao::saveAnalysisData(AnalysisInfo* info, const QByteArray& fileData, int dataChecksum) {
     QSqlQuery query(m_database);
     if (info->analysisId == -1) {
         query.prepare(QString(
@@ -140,7 +213,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         query.bindValue(":type", info->type);
         query.bindValue(":description", info->description);
         query.bindValue(":version", info->version);
-        query.bindValue(":data_checksum", checksum);
+        query.bindValue(":data_checksum", dataChecksum);
 
         if (!query.exec()) {
             LOG_FAILED_QUERY(query) << "couldn't save new analysis";
@@ -162,7 +235,7 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         query.bindValue(":type", info->type);
         query.bindValue(":description", info->description);
         query.bindValue(":version", info->version);
-        query.bindValue(":data_checksum", checksum);
+        query.bindValue(":data_checksum", dataChecksum);
 
         if (!query.exec()) {
             LOG_FAILED_QUERY(query) << "couldn't update existing analysis";
@@ -172,16 +245,10 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
 
     QString dataPath = getAnalysisStoragePath().absoluteFilePath(
         QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
+    if (!saveDataToFile(dataPath, fileData)) {
         qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
         return false;
     }
-
-    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
-             << "bytes for track"
-             << info->trackId << "in" << time.elapsed().debugMillisWithUnit();
     return true;
 }
 
@@ -262,57 +329,26 @@ QDir AnalysisDao::getAnalysisStoragePath() const {
     return dir.absolutePath().append("/");
 }
 
-QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
-    QFile file(filename);
-    if (!file.exists()) {
-        return QByteArray();
-    }
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QByteArray();
-    }
-    return file.readAll();
-}
-
 bool AnalysisDao::deleteFile(const QString& fileName) const {
     QFile file(fileName);
     return file.remove();
 }
 
 bool AnalysisDao::saveDataToFile(const QString& fileName, const QByteArray& data) const {
-    QFile file(fileName);
-
-    // If the file exists, do the right thing. Write to a temp file, unlink the
-    // existing file, and then move the temp file to the real file's name.
-    if (file.exists()) {
-        QString tempFileName = fileName + ".tmp";
-        QFile tempFile(tempFileName);
-        if (!tempFile.open(QIODevice::WriteOnly)) {
-            return false;
-        }
-        int bytesWritten = tempFile.write(data);
-        if (bytesWritten == -1 || bytesWritten != data.length()) {
-            return false;
-        }
-        tempFile.close();
-        if (!file.remove()) {
-            return false;
-        }
-        if (!tempFile.rename(fileName)) {
-            return false;
-        }
-        return true;
-    }
-
-    // If the file doesn't exist, just create a new file and write the data.
+    // QSaveFile writes to a unique temporary file in the same directory and
+    // replaces the existing file on commit(). The analyzer and the worker
+    // thread of OverviewCache that upgrades old analyses might save the same
+    // file concurrently.
+    QSaveFile file(fileName);
     if (!file.open(QIODevice::WriteOnly)) {
         return false;
     }
-    int bytesWritten = file.write(data);
-    if (bytesWritten == -1 || bytesWritten != data.length()) {
+    const qint64 bytesWritten = file.write(data);
+    if (bytesWritten != data.length()) {
+        file.cancelWriting();
         return false;
     }
-    file.close();
-    return true;
+    return file.commit();
 }
 
 void AnalysisDao::saveTrackAnalyses(
@@ -340,8 +376,7 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
-    bool success = saveAnalysis(&analysis);
+    bool success = saveWaveformAnalysis(&analysis, *pWaveform);
     if (success) {
         pWaveform->setSaveState(Waveform::SaveState::Saved);
     }
@@ -355,9 +390,8 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
 
-    success = saveAnalysis(&analysis);
+    success = saveWaveformAnalysis(&analysis, *pWaveSummary);
     if (success) {
         pWaveSummary->setSaveState(Waveform::SaveState::Saved);
     }
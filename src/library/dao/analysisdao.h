@@ -30,6 +30,9 @@ class AnalysisDao : public DAO {
         QString description;
         QString version;
         QByteArray data;
+        // Set instead of data if the waveform is stored in the compact
+        // format, which is memory-mapped when loading it.
+        QString compactDataPath;
     };
 
     explicit AnalysisDao(UserSettingsPointer pConfig);
@@ -48,6 +51,11 @@ class AnalysisDao : public DAO {
     QList<AnalysisInfo> getAnalysesForTrackByType(TrackId trackId, AnalysisType type);
     QList<AnalysisInfo> getAnalysesForTrack(TrackId trackId);
     bool saveAnalysis(AnalysisInfo* analysis);
+    // Stores the waveform in the compact format instead of data
+    bool saveWaveformAnalysis(AnalysisInfo* analysis, const Waveform& waveform);
+    // Rewrites a waveform that has been loaded from the legacy format
+    // in the compact format
+    void upgradeWaveformAnalysis(const AnalysisInfo& analysis, const Waveform& waveform);
     bool deleteAnalysis(const int analysisId);
     void deleteAnalyses(const QList<TrackId>& trackIds);
     bool deleteAnalysesForTrack(TrackId trackId);
@@ -59,8 +67,8 @@ class AnalysisDao : public DAO {
 
   private:
     QDir getAnalysisStoragePath() const;
-    QByteArray loadDataFromFile(const QString& fileName) const;
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
+    bool saveAnalysisData(AnalysisInfo* info, const QByteArray& fileData, int dataChecksum);
     bool deleteFile(const QString& filename) const;
     QList<AnalysisInfo> loadAnalysesFromQuery(TrackId trackId, QSqlQuery* query);
 
@@ -19,6 +19,9 @@ inline constexpr mixxx::cache_key_signed_t dbHash(mixxx::cache_key_t hash) {
     return mixxx::signedCacheKey(hash);
 }
 
+// Directory names cannot contain the path separator
+const QChar kSubdirectorySeparator = QLatin1Char('/');
+
 } // anonymous namespace
 
 QHash<QString, mixxx::cache_key_t> LibraryHashDAO::getDirectoryHashes() {
@@ -185,3 +188,61 @@ QStringList LibraryHashDAO::getDeletedDirectories() {
     }
     return result;
 }
+
+QHash<QString, DirectoryJournalEntry> LibraryHashDAO::getDirectoryJournal() {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare("SELECT directory_path, modified_ns, inode, subdirectories "
+                  "FROM DirectoryJournal");
+    QHash<QString, DirectoryJournalEntry> journal;
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return journal;
+    }
+    while (query.next()) {
+        DirectoryJournalEntry entry;
+        entry.modifiedNs = query.value(1).toLongLong();
+        entry.inode = query.value(2).toLongLong();
+        const QString subdirectories = query.value(3).toString();
+        if (!subdirectories.isEmpty()) {
+            entry.subdirectories = subdirectories.split(kSubdirectorySeparator);
+        }
+        journal.insert(query.value(0).toString(), std::move(entry));
+    }
+    return journal;
+}
+
+void LibraryHashDAO::saveDirectoryJournalEntry(const QString& dirPath,
+        const DirectoryJournalEntry& entry) {
+    QSqlQuery query(m_database);
+    query.prepare("REPLACE INTO DirectoryJournal "
+                  "(directory_path, modified_ns, inode, subdirectories) "
+                  "VALUES (:directory_path, :modified_ns, :inode, :subdirectories)");
+    query.bindValue(":directory_path", dirPath);
+    query.bindValue(":modified_ns", entry.modifiedNs);
+    query.bindValue(":inode", entry.inode);
+    query.bindValue(":subdirectories", entry.subdirectories.join(kSubdirectorySeparator));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "Saving directory journal entry failed.";
+    }
+}
+
+void LibraryHashDAO::removeDirectoryJournalEntries(const QStringList& dirPaths) {
+    // The list might be too long for a single statement
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM DirectoryJournal WHERE directory_path=:directory_path");
+    for (const auto& dirPath : dirPaths) {
+        query.bindValue(":directory_path", dirPath);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return;
+        }
+    }
+}
+
+void LibraryHashDAO::clearDirectoryJournal() {
+    QSqlQuery query(m_database);
+    if (!query.exec("DELETE FROM DirectoryJournal")) {
+        LOG_FAILED_QUERY(query);
+    }
+}
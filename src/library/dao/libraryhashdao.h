@@ -3,10 +3,22 @@
 #include <QObject>
 #include <QHash>
 #include <QString>
+#include <QStringList>
 
 #include "library/dao/dao.h"
 #include "util/cache.h"
 
+/// The state of a directory when it has been scanned the last time.
+///
+/// The modification time and the inode of a directory only change if
+/// entries are added, removed, or renamed. If both are unchanged the
+/// directory doesn't need to be listed again.
+struct DirectoryJournalEntry {
+    qint64 modifiedNs = 0;
+    qint64 inode = 0;
+    QStringList subdirectories;
+};
+
 class LibraryHashDAO : public DAO {
   public:
     ~LibraryHashDAO() override = default;
@@ -23,4 +35,10 @@ class LibraryHashDAO : public DAO {
     void updateDirectoryStatuses(const QStringList& dirPaths,
                                  const bool deleted, const bool verified);
     QStringList getDeletedDirectories();
+
+    QHash<QString, DirectoryJournalEntry> getDirectoryJournal();
+    void saveDirectoryJournalEntry(const QString& dirPath,
+            const DirectoryJournalEntry& entry);
+    void removeDirectoryJournalEntries(const QStringList& dirPaths);
+    void clearDirectoryJournal();
 };
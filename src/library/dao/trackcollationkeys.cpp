@@ -0,0 +1,425 @@
+#include "library/dao/trackcollationkeys.h"
+
+#include <QLocale>
+#include <QSqlQuery>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "library/dao/settingsdao.h"
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "util/db/dbconnection.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackCollationKeys");
+
+const QString kTableName = QStringLiteral("library_collation_keys");
+
+const QString kLocaleSettingsKey =
+        QStringLiteral("mixxx.library.collation_keys.locale");
+const QString kRevisionSettingsKey =
+        QStringLiteral("mixxx.library.collation_keys.revision");
+
+// Leaves room for 32 bisections at the same position before all keys
+// need to be renumbered
+constexpr qint64 kSortKeyStride = qint64{1} << 32;
+
+// The collation depends on the locale and on the ICU version of Qt
+QString collationLocale() {
+    return QStringLiteral("%1 %2").arg(QLocale().name(), qVersion());
+}
+
+} // anonymous namespace
+
+void TrackCollationKeys::initialize(const QSqlDatabase& database) {
+    DAO::initialize(database);
+    m_loaded = false;
+    addMissingKeys();
+}
+
+bool TrackCollationKeys::addMissingKeys() {
+    SettingsDAO settings(m_database);
+    const QString locale = collationLocale();
+    if (settings.getValue(kLocaleSettingsKey) == locale &&
+            queryValues(QString(), true).isEmpty()) {
+        return true;
+    }
+    if (!beginModification()) {
+        return false;
+    }
+    // Checked again, another connection might have added the keys
+    // in the meantime
+    if (settings.getValue(kLocaleSettingsKey) != locale) {
+        kLogger.info() << "Collation locale changed to" << locale;
+        return endModification(rebuild(queryValues(QString(), false)) &&
+                settings.setValue(kLocaleSettingsKey, locale));
+    }
+    const QStringList missingValues = queryValues(QString(), true);
+    if (missingValues.isEmpty()) {
+        return endModification(true);
+    }
+    kLogger.info() << "Adding" << missingValues.size() << "missing sort keys";
+    if (missingValues.size() > static_cast<int>(m_entries.size())) {
+        // Sorting all values at once is faster than inserting them
+        // one by one
+        return endModification(rebuild(queryValues(QString(), false)));
+    }
+    for (const auto& value : missingValues) {
+        if (!insertValue(value)) {
+            return endModification(false);
+        }
+    }
+    return endModification(true);
+}
+
+bool TrackCollationKeys::updateTracks(const QList<TrackId>& trackIds) {
+    if (trackIds.isEmpty()) {
+        return true;
+    }
+    if (!reloadIfModified()) {
+        return false;
+    }
+    QStringList trackIdList;
+    trackIdList.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        trackIdList.append(trackId.toString());
+    }
+    const QStringList values = queryValues(
+            QStringLiteral("WHERE id IN (%1)").arg(trackIdList.join(QChar(','))),
+            false);
+    // Usually all values have a key already
+    if (std::all_of(values.begin(), values.end(), [this](const QString& value) {
+            return m_sortKeyByValue.contains(value);
+        })) {
+        return true;
+    }
+    if (!beginModification()) {
+        return false;
+    }
+    for (const auto& value : values) {
+        // The keys might have been reloaded
+        if (m_sortKeyByValue.contains(value)) {
+            continue;
+        }
+        if (!insertValue(value)) {
+            return endModification(false);
+        }
+    }
+    return endModification(true);
+}
+
+bool TrackCollationKeys::sortKey(const QString& foldedValue, qint64* pSortKey) {
+    DEBUG_ASSERT(pSortKey);
+    if (!reloadIfModified()) {
+        return false;
+    }
+    return cachedSortKey(foldedValue, pSortKey);
+}
+
+bool TrackCollationKeys::cachedSortKey(
+        const QString& foldedValue, qint64* pSortKey) const {
+    DEBUG_ASSERT(pSortKey);
+    DEBUG_ASSERT(m_loaded);
+    const auto it = m_sortKeyByValue.constFind(foldedValue);
+    if (it == m_sortKeyByValue.constEnd()) {
+        return false;
+    }
+    *pSortKey = it.value();
+    return true;
+}
+
+bool TrackCollationKeys::sortKeys(
+        const QStringList& foldedValues, std::vector<qint64>* pSortKeys) {
+    DEBUG_ASSERT(pSortKeys);
+    if (!reloadIfModified()) {
+        return false;
+    }
+    pSortKeys->clear();
+    pSortKeys->reserve(foldedValues.size());
+    for (const auto& value : foldedValues) {
+        const auto it = m_sortKeyByValue.constFind(value);
+        if (it == m_sortKeyByValue.constEnd()) {
+            return false;
+        }
+        pSortKeys->push_back(it.value());
+    }
+    return true;
+}
+
+bool TrackCollationKeys::load() {
+    PerformanceTimer timer;
+    timer.start();
+    const QString revision = queryRevision();
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec(QStringLiteral("SELECT value,sort_key FROM %1 ORDER BY sort_key")
+                            .arg(kTableName))) {
+        LOG_FAILED_QUERY(query);
+        m_loaded = false;
+        return false;
+    }
+    m_entries.clear();
+    m_sortKeyByValue.clear();
+    while (query.next()) {
+        Entry entry{query.value(0).toString(), query.value(1).toLongLong()};
+        m_sortKeyByValue.insert(entry.value, entry.sortKey);
+        m_entries.push_back(std::move(entry));
+    }
+    m_revision = revision;
+    m_loaded = true;
+    kLogger.debug() << "Loaded" << m_entries.size() << "sort keys in"
+                    << timer.elapsed().debugMillisWithUnit();
+    return true;
+}
+
+bool TrackCollationKeys::reloadIfModified() {
+    if (m_loaded && queryRevision() == m_revision) {
+        return true;
+    }
+    return load();
+}
+
+bool TrackCollationKeys::rebuild(const QStringList& values) {
+    PerformanceTimer timer;
+    timer.start();
+    // Comparing precomputed sort keys is much faster than
+    // comparing the strings with the collator
+    std::vector<QCollatorSortKey> collatorKeys;
+    collatorKeys.reserve(values.size());
+    for (const auto& value : values) {
+        collatorKeys.push_back(m_collator.sortKey(value));
+    }
+    std::vector<int> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&collatorKeys](int lhs, int rhs) {
+        return collatorKeys[lhs].compare(collatorKeys[rhs]) < 0;
+    });
+
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral("DELETE FROM %1").arg(kTableName))) {
+        LOG_FAILED_QUERY(query);
+        m_loaded = false;
+        return false;
+    }
+    m_entries.clear();
+    m_sortKeyByValue.clear();
+    m_entries.reserve(values.size());
+    query.prepare(QStringLiteral("INSERT INTO %1 (value,sort_key) VALUES (:value,:key)")
+                          .arg(kTableName));
+    qint64 sortKey = 0;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        // Values that are equal for the collator share a key
+        if (i == 0 || collatorKeys[order[i - 1]].compare(collatorKeys[order[i]]) != 0) {
+            sortKey += kSortKeyStride;
+        }
+        const QString& value = values[order[i]];
+        query.bindValue(":value", value);
+        query.bindValue(":key", sortKey);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            m_loaded = false;
+            return false;
+        }
+        m_entries.push_back({value, sortKey});
+        m_sortKeyByValue.insert(value, sortKey);
+    }
+    m_loaded = true;
+    kLogger.info() << "Rebuilding" << m_entries.size() << "sort keys took"
+                   << timer.elapsed().formatMillisWithUnit();
+    return true;
+}
+
+bool TrackCollationKeys::insertValue(const QString& value) {
+    DEBUG_ASSERT(m_loaded);
+    DEBUG_ASSERT(!m_sortKeyByValue.contains(value));
+    const auto it = std::lower_bound(m_entries.begin(),
+            m_entries.end(),
+            value,
+            [this](const Entry& entry, const QString& value) {
+                return m_collator.compare(entry.value, value) < 0;
+            });
+    qint64 sortKey;
+    if (it != m_entries.end() && m_collator.compare(it->value, value) == 0) {
+        sortKey = it->sortKey;
+    } else if (m_entries.empty()) {
+        sortKey = kSortKeyStride;
+    } else if (it == m_entries.begin()) {
+        sortKey = it->sortKey - kSortKeyStride;
+    } else if (it == m_entries.end()) {
+        sortKey = std::prev(it)->sortKey + kSortKeyStride;
+    } else {
+        const qint64 prevSortKey = std::prev(it)->sortKey;
+        if (it->sortKey - prevSortKey < 2) {
+            // No gap left
+            QStringList values;
+            values.reserve(static_cast<int>(m_entries.size()) + 1);
+            for (const auto& entry : m_entries) {
+                values.append(entry.value);
+            }
+            values.append(value);
+            return rebuild(values);
+        }
+        sortKey = prevSortKey + (it->sortKey - prevSortKey) / 2;
+    }
+    if (!writeSortKey(value, sortKey)) {
+        return false;
+    }
+    m_entries.insert(it, {value, sortKey});
+    m_sortKeyByValue.insert(value, sortKey);
+    return true;
+}
+
+bool TrackCollationKeys::writeSortKey(const QString& value, qint64 sortKey) const {
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO %1 (value,sort_key) VALUES (:value,:key)")
+                          .arg(kTableName));
+    query.bindValue(":value", value);
+    query.bindValue(":key", sortKey);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+bool TrackCollationKeys::beginModification() {
+    QSqlQuery query(m_database);
+    // A savepoint, because tracks are usually added or updated within
+    // an enclosing transaction. Outside of a transaction it starts one.
+    if (!query.exec(QStringLiteral("SAVEPOINT collation_keys"))) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    // Incrementing the revision first acquires the write lock of the
+    // database like BEGIN IMMEDIATE. No other connection can modify the
+    // keys until the savepoint is released, i.e. the keys that are
+    // reloaded below stay valid.
+    const QString expectedRevision = QString::number(m_revision.toLongLong() + 1);
+    if (!incrementRevision()) {
+        endModification(false);
+        return false;
+    }
+    const QString revision = queryRevision();
+    if (m_loaded && revision == expectedRevision) {
+        m_revision = revision;
+        return true;
+    }
+    if (!load()) {
+        endModification(false);
+        return false;
+    }
+    return true;
+}
+
+bool TrackCollationKeys::endModification(bool success) {
+    QSqlQuery query(m_database);
+    if (!success) {
+        if (!query.exec(QStringLiteral("ROLLBACK TO SAVEPOINT collation_keys"))) {
+            LOG_FAILED_QUERY(query);
+        }
+        // Discard the modifications that have been rolled back
+        m_loaded = false;
+    }
+    if (!query.exec(QStringLiteral("RELEASE SAVEPOINT collation_keys"))) {
+        LOG_FAILED_QUERY(query);
+        m_loaded = false;
+        return false;
+    }
+    return success;
+}
+
+bool TrackCollationKeys::incrementRevision() const {
+    // Incremented in the database, because the cached revision
+    // might be outdated
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral(
+            "INSERT OR IGNORE INTO settings (name,value) VALUES (:name,'0')"));
+    query.bindValue(":name", kRevisionSettingsKey);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    query.prepare(QStringLiteral(
+            "UPDATE settings SET value=CAST(value AS INTEGER)+1 WHERE name=:name"));
+    query.bindValue(":name", kRevisionSettingsKey);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+QString TrackCollationKeys::queryRevision() const {
+    return SettingsDAO(m_database).getValue(kRevisionSettingsKey);
+}
+
+QStringList TrackCollationKeys::queryValues(
+        const QString& whereClause, bool missingOnly) const {
+    QStringList selects;
+    selects.reserve(columns().size());
+    for (const auto& column : columns()) {
+        selects.append(QStringLiteral("SELECT lower(%1) AS value FROM %2 %3")
+                               .arg(column, LIBRARY_TABLE, whereClause));
+    }
+    QString queryString = QStringLiteral("SELECT value FROM (%1) WHERE value IS NOT NULL")
+                                  .arg(selects.join(QStringLiteral(" UNION ")));
+    if (missingOnly) {
+        queryString += QStringLiteral(" AND value NOT IN (SELECT value FROM %1)")
+                               .arg(kTableName);
+    }
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    QStringList values;
+    if (!query.exec(queryString)) {
+        LOG_FAILED_QUERY(query);
+        return values;
+    }
+    while (query.next()) {
+        values.append(query.value(0).toString());
+    }
+    return values;
+}
+
+// static
+const QStringList& TrackCollationKeys::columns() {
+    static const QStringList kColumns = {
+            LIBRARYTABLE_ARTIST,
+            LIBRARYTABLE_TITLE,
+            LIBRARYTABLE_ALBUM,
+            LIBRARYTABLE_ALBUMARTIST,
+            LIBRARYTABLE_GENRE,
+    };
+    return kColumns;
+}
+
+// static
+QString TrackCollationKeys::foldValue(QString value) {
+    for (auto& ch : value) {
+        if (ch >= QChar('A') && ch <= QChar('Z')) {
+            ch = QChar(ch.unicode() + ('a' - 'A'));
+        }
+    }
+    return value;
+}
+
+// static
+QString TrackCollationKeys::sortSql(const QString& column) {
+    // Without kTableName that might not be initialized yet
+    // when invoked during static initialization.
+    // If any value of the column has no key, all values are compared
+    // with the collator like ColumnarTrackIndex does. Otherwise they
+    // would be sorted like NULL. The collation only applies to strings,
+    // not to the integer keys.
+    return mixxx::DbConnection::collateLexicographically(QStringLiteral(
+            "(CASE WHEN EXISTS(SELECT 1 FROM library WHERE lower(%1) NOT IN "
+            "(SELECT value FROM library_collation_keys)) "
+            "THEN lower(%1) "
+            "ELSE (SELECT sort_key FROM library_collation_keys WHERE value=lower(%1)) "
+            "END)")
+                    .arg(column));
+}
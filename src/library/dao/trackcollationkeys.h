@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include "library/dao/dao.h"
+#include "track/trackid.h"
+#include "util/string.h"
+
+/// Persistent collation sort keys for the text columns of the library
+/// that are sorted most often.
+///
+/// Each distinct lowercase value of these columns is mapped to an integer
+/// that reflects its position in the locale-aware order of StringCollator.
+/// Sorting by the integers yields the same order as comparing the strings
+/// with the collation function, but neither SQLite nor BaseTrackCache need
+/// to invoke QCollator for every comparison.
+///
+/// Keys are assigned with gaps in between. A new value gets the key in the
+/// middle of its neighbors, which requires only a binary search with the
+/// collator. All keys are renumbered when there is no gap left or the locale
+/// has changed.
+///
+/// The keys are shared by all database connections. A revision counter in
+/// the settings table detects modifications by other connections.
+class TrackCollationKeys : public DAO {
+  public:
+    ~TrackCollationKeys() override = default;
+
+    /// Adds the missing keys, e.g. for tracks that were added
+    /// by an older version of Mixxx.
+    void initialize(const QSqlDatabase& database) override;
+
+    /// Adds the missing keys for the current values of the given tracks.
+    bool updateTracks(const QList<TrackId>& trackIds);
+
+    /// Looks up the key of a value that has been folded with foldValue().
+    /// Returns false if the value has no key yet.
+    bool sortKey(const QString& foldedValue, qint64* pSortKey);
+
+    /// Looks up the keys of multiple values at once. Returns false
+    /// if any of the values has no key yet.
+    bool sortKeys(const QStringList& foldedValues, std::vector<qint64>* pSortKeys);
+
+    /// Reloads the keys if another connection has modified them.
+    /// Needs to be invoked once before a series of cachedSortKey()
+    /// lookups. Returns false if the keys could not be loaded.
+    bool reloadIfModified();
+
+    /// Looks up the key of a folded value like sortKey(), but without
+    /// checking the revision of the keys in the database.
+    bool cachedSortKey(const QString& foldedValue, qint64* pSortKey) const;
+
+    /// The columns of the library table with keys.
+    static const QStringList& columns();
+
+    /// Folds the value like the SQL function lower(), i.e. only
+    /// ASCII characters are converted.
+    static QString foldValue(QString value);
+
+    /// Returns an SQL expression that yields the key of the column
+    /// or NULL if the column is NULL. If any value has no key yet, it
+    /// yields the collated lowercase value instead.
+    static QString sortSql(const QString& column);
+
+  private:
+    struct Entry {
+        QString value;
+        qint64 sortKey;
+    };
+
+    bool addMissingKeys();
+    bool load();
+    bool rebuild(const QStringList& values);
+    bool insertValue(const QString& value);
+    bool writeSortKey(const QString& value, qint64 sortKey) const;
+    /// Locks the keys of all connections and reloads them if needed.
+    /// Must be followed by endModification().
+    bool beginModification();
+    /// Commits the modifications if successful or discards them
+    /// otherwise. Returns success.
+    bool endModification(bool success);
+    bool incrementRevision() const;
+    QString queryRevision() const;
+    QStringList queryValues(const QString& whereClause, bool missingOnly) const;
+
+    const mixxx::StringCollator m_collator;
+
+    // Ordered by sort key
+    std::vector<Entry> m_entries;
+    QHash<QString, qint64> m_sortKeyByValue;
+    QString m_revision;
+    bool m_loaded = false;
+};
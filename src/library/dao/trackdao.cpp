@@ -121,6 +121,12 @@ TrackDAO::~TrackDAO() {
     addTracksFinish(true);
 }
 
+void TrackDAO::initialize(const QSqlDatabase& database) {
+    DAO::initialize(database);
+    m_searchIndex.initialize(database);
+    m_collationKeys.initialize(database);
+}
+
 void TrackDAO::finish() {
     kLogger.debug() << "finish()";
 
@@ -353,7 +359,7 @@ QString TrackDAO::getTrackLocation(TrackId trackId) const {
     return trackLocation;
 }
 
-bool TrackDAO::saveTrack(Track* pTrack) const {
+bool TrackDAO::saveTrack(Track* pTrack) {
     VERIFY_OR_DEBUG_ASSERT(pTrack) {
         return false;
     }
@@ -400,6 +406,10 @@ void TrackDAO::slotDatabaseTracksRelocated(const QList<RelocatedTrack>& relocate
     }
     DEBUG_ASSERT(removedTrackIds.size() <= changedTrackIds.size());
     DEBUG_ASSERT(!removedTrackIds.intersects(changedTrackIds));
+    // The locations have been modified on another database connection
+    m_searchIndex.removeTracks(removedTrackIds.values());
+    m_searchIndex.updateTracks(changedTrackIds.values());
+    m_collationKeys.updateTracks(changedTrackIds.values());
     if (!removedTrackIds.isEmpty()) {
         emit tracksRemoved(removedTrackIds);
     }
@@ -544,6 +554,20 @@ void TrackDAO::addTracksPrepare() {
             "WHERE location=:location");
 }
 
+void TrackDAO::addTracksCommit() {
+    VERIFY_OR_DEBUG_ASSERT(m_pTransaction) {
+        return;
+    }
+    if (!m_pTransaction->commit()) {
+        return;
+    }
+    // The prepared queries remain valid for the new transaction
+    m_pTransaction = std::make_unique<SqlTransaction>(m_database);
+
+    emit tracksAdded(m_tracksAddedSet);
+    m_tracksAddedSet.clear();
+}
+
 void TrackDAO::addTracksFinish(bool rollback) {
     if (m_pTransaction) {
         if (rollback) {
@@ -854,6 +878,8 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
         }
         pTrack->initId(trackId);
         pTrack->setDateAdded(trackDateAdded);
+        m_searchIndex.updateTracks({trackId});
+        m_collationKeys.updateTracks({trackId});
 
         m_analysisDao.saveTrackAnalyses(
                 trackId,
@@ -1116,6 +1142,9 @@ bool TrackDAO::onPurgingTracks(
             return false;
         }
     }
+    if (!m_searchIndex.removeTracks(trackIds)) {
+        return false;
+    }
     {
         // invalidate the hash in LibraryHash,
         // in case the file was not deleted to detect it on a rescan
@@ -1679,15 +1708,71 @@ TrackPointer TrackDAO::getTrackByRef(
 }
 
 // Saves a track's info back to the database
-bool TrackDAO::updateTrack(const Track& track) const {
-    const TrackId trackId = track.getId();
-    DEBUG_ASSERT(trackId.isValid());
-
+bool TrackDAO::updateTrack(const Track& track) {
     kLogger.debug() << "Updating track in database"
-                    << trackId
+                    << track.getId()
                     << track.getLocation();
 
+    if (m_pBatchUpdateTransaction) {
+        // A savepoint nested into the transaction of the batch
+        // allows to discard only the modifications of this track
+        QSqlQuery query(m_database);
+        if (!query.exec(QStringLiteral("SAVEPOINT update_track"))) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+        const bool success = writeTrack(track);
+        if (!success &&
+                !query.exec(QStringLiteral("ROLLBACK TO SAVEPOINT update_track"))) {
+            LOG_FAILED_QUERY(query);
+        }
+        if (!query.exec(QStringLiteral("RELEASE SAVEPOINT update_track"))) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+        return success;
+    }
+
     SqlTransaction transaction(m_database);
+    if (!writeTrack(track)) {
+        return false;
+    }
+    transaction.commit();
+    return true;
+}
+
+void TrackDAO::beginBatchUpdate() {
+    VERIFY_OR_DEBUG_ASSERT(!m_pBatchUpdateTransaction && !m_pTransaction) {
+        return;
+    }
+    auto pTransaction = std::make_unique<SqlTransaction>(m_database);
+    if (!*pTransaction) {
+        // Tracks are updated in separate transactions
+        kLogger.warning() << "Failed to begin batch update";
+        return;
+    }
+    m_pBatchUpdateTransaction = std::move(pTransaction);
+}
+
+bool TrackDAO::finishBatchUpdate() {
+    if (!m_pBatchUpdateTransaction) {
+        // Failed to begin the batch update, tracks have been
+        // updated separately
+        return true;
+    }
+    const bool committed = m_pBatchUpdateTransaction->commit();
+    if (!committed) {
+        kLogger.warning() << "Failed to commit batch update";
+    }
+    // Rolls back the transaction if it could not be committed
+    m_pBatchUpdateTransaction.reset();
+    return committed;
+}
+
+bool TrackDAO::writeTrack(const Track& track) {
+    const TrackId trackId = track.getId();
+    DEBUG_ASSERT(trackId.isValid());
+
     // PerformanceTimer time;
     // time.start();
 
@@ -1762,6 +1847,12 @@ bool TrackDAO::updateTrack(const Track& track) const {
         return false;
     }
 
+    if (!m_searchIndex.updateTracks({trackId})) {
+        return false;
+    }
+    // Missing sort keys only affect the order and are added on startup
+    m_collationKeys.updateTracks({trackId});
+
     // kLogger.debug() << "Update track took : " <<
     // time.elapsed().formatMillisWithUnit() << "Now updating cues";
     // time.start();
@@ -1771,7 +1862,6 @@ bool TrackDAO::updateTrack(const Track& track) const {
             track.getWaveformSummary());
     m_cueDao.saveTrackCues(
             trackId, track.getCuePoints());
-    transaction.commit();
 
     // kLogger.debug() << "Update track in database took: " <<
     // time.elapsed().formatMillisWithUnit(); time.start();
@@ -7,6 +7,8 @@
 #include <memory>
 
 #include "library/dao/dao.h"
+#include "library/dao/trackcollationkeys.h"
+#include "library/dao/tracksearchindex.h"
 #include "library/relocatedtrack.h"
 #include "preferences/usersettings.h"
 #include "track/globaltrackcache.h"
@@ -45,8 +47,18 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
             UserSettingsPointer pConfig);
     ~TrackDAO() override;
 
+    void initialize(const QSqlDatabase& database) override;
+
     void finish();
 
+    const TrackSearchIndex& searchIndex() const {
+        return m_searchIndex;
+    }
+
+    TrackCollationKeys& collationKeys() {
+        return m_collationKeys;
+    }
+
     QList<TrackId> resolveTrackIds(
             const QList<QUrl>& urls,
             ResolveTrackIdFlags flags = ResolveTrackIdFlag::ResolveOnly);
@@ -76,7 +88,7 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
             volatile const bool* pCancel) const;
 
     // Only used by friend class TrackCollection, but public for testing!
-    bool saveTrack(Track* pTrack) const;
+    bool saveTrack(Track* pTrack);
 
     /// Update the play counter properties according to the corresponding
     /// aggregated properties obtained from the played history.
@@ -161,9 +173,22 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     TrackPointer addTracksAddFile(
             const QString& filePath,
             bool unremove);
+    /// Commits the tracks that have been added so far and continues
+    /// with a new transaction. Keeps the transactions of long running
+    /// imports reasonably small.
+    void addTracksCommit();
     void addTracksFinish(bool rollback = false);
 
-    bool updateTrack(const Track& track) const;
+    bool updateTrack(const Track& track);
+
+    /// Saves all tracks that are updated until finishBatchUpdate() in a
+    /// single transaction instead of committing each track separately.
+    /// The failed update of a track only discards the modifications of
+    /// this track. The database connection must not be used for other
+    /// transactions in between, e.g. by processing events.
+    void beginBatchUpdate();
+    /// Returns false if the updated tracks could not be committed.
+    bool finishBatchUpdate();
 
     void hideAllTracks(const QDir& rootDir) const;
 
@@ -199,6 +224,9 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     // Callback for GlobalTrackCache
     mixxx::FileAccess relocateCachedTrack(TrackId trackId) override;
 
+    // Writes the track within the current transaction
+    bool writeTrack(const Track& track);
+
     CueDAO& m_cueDao;
     PlaylistDAO& m_playlistDao;
     AnalysisDao& m_analysisDao;
@@ -206,12 +234,16 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
 
     const UserSettingsPointer m_pConfig;
 
+    TrackSearchIndex m_searchIndex;
+    TrackCollationKeys m_collationKeys;
+
     std::unique_ptr<QSqlQuery> m_pQueryTrackLocationInsert;
     std::unique_ptr<QSqlQuery> m_pQueryTrackLocationSelect;
     std::unique_ptr<QSqlQuery> m_pQueryLibraryInsert;
     std::unique_ptr<QSqlQuery> m_pQueryLibraryUpdate;
     std::unique_ptr<QSqlQuery> m_pQueryLibrarySelect;
     std::unique_ptr<SqlTransaction> m_pTransaction;
+    std::unique_ptr<SqlTransaction> m_pBatchUpdateTransaction;
     int m_trackLocationIdColumn;
     int m_queryLibraryIdColumn;
     int m_queryLibraryMixxxDeletedColumn;
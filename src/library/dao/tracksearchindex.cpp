@@ -0,0 +1,207 @@
+#include "library/dao/tracksearchindex.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "library/dao/trackschema.h"
+#include "library/queryutil.h"
+#include "util/db/dbconnection.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+
+namespace {
+
+const mixxx::Logger kLogger("TrackSearchIndex");
+
+const QString kTableName = QStringLiteral("library_fts");
+
+// The trigram tokenizer only matches substrings of at least 3 characters
+constexpr int kMinArgumentLength = 3;
+
+QString joinTrackIds(const QList<TrackId>& trackIds) {
+    QStringList trackIdList;
+    trackIdList.reserve(trackIds.size());
+    for (const auto& trackId : trackIds) {
+        trackIdList.append(trackId.toString());
+    }
+    return trackIdList.join(QChar(','));
+}
+
+// The columns are indexed with the same values as in library_cache_view
+QString sourceColumn(const QString& column) {
+    if (column == LIBRARYTABLE_LOCATION) {
+        return QStringLiteral(TRACKLOCATIONS_TABLE ".") + TRACKLOCATIONSTABLE_LOCATION;
+    }
+    return QStringLiteral(LIBRARY_TABLE ".") + column;
+}
+
+const QString kSourceTables = QStringLiteral(
+        "library INNER JOIN track_locations "
+        "ON library.location=track_locations.id");
+
+} // anonymous namespace
+
+void TrackSearchIndex::initialize(const QSqlDatabase& database) {
+    DAO::initialize(database);
+    m_available = create();
+    if (!m_available) {
+        kLogger.info()
+                << "Full-text search index is not available,"
+                << "searching without index";
+        return;
+    }
+    if (isOutOfSync()) {
+        m_available = rebuild();
+    }
+}
+
+bool TrackSearchIndex::create() const {
+#ifdef __SQLITE3__
+    // Searching is case sensitive, because the indexed values and
+    // search terms are both folded by DbConnection
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral(
+                "CREATE VIRTUAL TABLE IF NOT EXISTS %1 USING fts5(%2,"
+                "tokenize='trigram case_sensitive 1')")
+                            .arg(kTableName, columns().join(QChar(','))))) {
+        // Expected for SQLite without FTS5 or the trigram tokenizer
+        kLogger.info() << "Failed to create full-text search index:"
+                       << query.lastError().text();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // __SQLITE3__
+}
+
+bool TrackSearchIndex::isOutOfSync() const {
+    // Only detects added or purged tracks. Modified values will be
+    // updated when the track is saved the next time.
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral(
+                "SELECT "
+                "(SELECT COUNT(*) FROM %1)<>(SELECT COUNT(*) FROM %2) OR "
+                "(SELECT MAX(library.id) FROM %1) IS NOT (SELECT MAX(rowid) FROM %2)")
+                            .arg(kSourceTables, kTableName)) ||
+            !query.next()) {
+        LOG_FAILED_QUERY(query);
+        return true;
+    }
+    return query.value(0).toBool();
+}
+
+bool TrackSearchIndex::rebuild() const {
+    kLogger.info() << "Rebuilding full-text search index";
+    PerformanceTimer timer;
+    timer.start();
+    SqlTransaction transaction(m_database);
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral("DELETE FROM %1").arg(kTableName))) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    if (!insertTracks(QString()) || !transaction.commit()) {
+        return false;
+    }
+    kLogger.info() << "Rebuilding full-text search index took"
+                   << timer.elapsed().formatMillisWithUnit();
+    return true;
+}
+
+bool TrackSearchIndex::insertTracks(const QString& whereClause) const {
+    QStringList sourceColumns;
+    sourceColumns.reserve(columns().size());
+    for (const auto& column : columns()) {
+        sourceColumns.append(mixxx::DbConnection::latinLow(sourceColumn(column)));
+    }
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral(
+                "INSERT INTO %1(rowid,%2) SELECT library.id,%3 FROM %4 %5")
+                            .arg(kTableName,
+                                    columns().join(QChar(',')),
+                                    sourceColumns.join(QChar(',')),
+                                    kSourceTables,
+                                    whereClause))) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+bool TrackSearchIndex::updateTracks(const QList<TrackId>& trackIds) const {
+    if (!m_available || trackIds.isEmpty()) {
+        return true;
+    }
+    if (!removeTracks(trackIds)) {
+        return false;
+    }
+    return insertTracks(QStringLiteral("WHERE library.id IN (%1)")
+                                .arg(joinTrackIds(trackIds)));
+}
+
+bool TrackSearchIndex::removeTracks(const QList<TrackId>& trackIds) const {
+    if (!m_available || trackIds.isEmpty()) {
+        return true;
+    }
+    QSqlQuery query(m_database);
+    if (!query.exec(QStringLiteral("DELETE FROM %1 WHERE rowid IN (%2)")
+                            .arg(kTableName, joinTrackIds(trackIds)))) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return true;
+}
+
+// static
+const QStringList& TrackSearchIndex::columns() {
+    static const QStringList kColumns = {
+            LIBRARYTABLE_ARTIST,
+            LIBRARYTABLE_TITLE,
+            LIBRARYTABLE_ALBUM,
+            LIBRARYTABLE_ALBUMARTIST,
+            LIBRARYTABLE_GENRE,
+            LIBRARYTABLE_GROUPING,
+            LIBRARYTABLE_COMMENT,
+            LIBRARYTABLE_LOCATION,
+    };
+    return kColumns;
+}
+
+// static
+bool TrackSearchIndex::canMatch(const QStringList& columns, const QString& argument) {
+    if (columns.isEmpty()) {
+        return false;
+    }
+    for (const auto& column : columns) {
+        if (!TrackSearchIndex::columns().contains(column)) {
+            return false;
+        }
+    }
+    // LIKE treats '%' and '_' as wildcards and TextFilterNode appends a
+    // wildcard to a trailing space
+    if (argument.contains(QChar('%')) || argument.contains(QChar('_')) ||
+            argument.isEmpty() || argument.back().isSpace()) {
+        return false;
+    }
+    return argument.toUcs4().size() >= kMinArgumentLength;
+}
+
+// static
+QString TrackSearchIndex::filterSql(
+        const QSqlDatabase& database,
+        const QStringList& columns,
+        const QString& argument) {
+    DEBUG_ASSERT(canMatch(columns, argument));
+    // Quoting the argument as a phrase matches it as a substring
+    QString phrase = argument;
+    phrase.replace(QChar('"'), QStringLiteral("\"\""));
+    phrase = QChar('"') + phrase + QChar('"');
+    if (columns.size() < TrackSearchIndex::columns().size()) {
+        phrase = QStringLiteral("{%1}:%2").arg(columns.join(QChar(' ')), phrase);
+    }
+    FieldEscaper escaper(database);
+    return QStringLiteral("%1 IN (SELECT rowid FROM %2 WHERE %2 MATCH %3)")
+            .arg(LIBRARYTABLE_ID, kTableName, escaper.escapeString(phrase));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "library/dao/dao.h"
+#include "track/trackid.h"
+
+/// Full-text index over the text columns of the library that are searched
+/// by default.
+///
+/// The index is an FTS5 table with the trigram tokenizer. It stores the
+/// accent and case folded values of the columns with the track id as rowid.
+/// Substring searches with at least 3 characters are answered from the index
+/// instead of evaluating the custom LIKE function for every track.
+///
+/// The index is optional. It is not available if SQLite has been built
+/// without FTS5 or is too old for the trigram tokenizer (3.34). The owning
+/// TrackDAO keeps it in sync with the library tables.
+class TrackSearchIndex : public DAO {
+  public:
+    ~TrackSearchIndex() override = default;
+
+    /// Creates the index if it does not exist yet and rebuilds it if it
+    /// is out of sync with the library, e.g. after an older version of
+    /// Mixxx has added or removed tracks.
+    void initialize(const QSqlDatabase& database) override;
+
+    bool isAvailable() const {
+        return m_available;
+    }
+
+    /// Replaces the indexed values of the given tracks with their
+    /// current values from the library.
+    bool updateTracks(const QList<TrackId>& trackIds) const;
+    bool removeTracks(const QList<TrackId>& trackIds) const;
+
+    /// The indexed columns of the library view.
+    static const QStringList& columns();
+
+    /// Checks if a substring search for a folded argument in the given
+    /// columns yields the same results as the LIKE expressions of
+    /// TextFilterNode.
+    static bool canMatch(const QStringList& columns, const QString& argument);
+
+    /// Returns an SQL condition on the track id that matches all tracks
+    /// that contain the folded argument in any of the given columns.
+    static QString filterSql(
+            const QSqlDatabase& database,
+            const QStringList& columns,
+            const QString& argument);
+
+  private:
+    bool create() const;
+    bool isOutOfSync() const;
+    bool rebuild() const;
+    bool insertTracks(const QString& whereClause) const;
+
+    bool m_available = false;
+};
@@ -0,0 +1,397 @@
+#include "library/externallibraryimportcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QtDebug>
+#include <utility>
+
+#include "library/queryutil.h"
+#include "library/treeitem.h"
+#include "util/assert.h"
+#include "util/cache.h"
+
+namespace {
+
+// Increment whenever the imported data or the tree format changes
+constexpr quint32 kPlaylistTreeVersion = 1;
+constexpr int kMaxPlaylistTreeDepth = 64;
+const QString kImportHashColumn = QStringLiteral("import_hash");
+
+QString hashFileContents(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+void writePlaylistTree(QDataStream& out, const TreeItem& item) {
+    out << static_cast<qint32>(item.childRows());
+    for (const TreeItem* pChild : item.children()) {
+        out << pChild->getLabel() << pChild->getData();
+        writePlaylistTree(out, *pChild);
+    }
+}
+
+bool readPlaylistTree(QDataStream& in, TreeItem* pItem, int depth) {
+    qint32 childCount = 0;
+    in >> childCount;
+    if (in.status() != QDataStream::Ok || childCount < 0 || depth > kMaxPlaylistTreeDepth) {
+        return false;
+    }
+    for (qint32 i = 0; i < childCount; ++i) {
+        QString label;
+        QVariant data;
+        in >> label >> data;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        TreeItem* pChild = pItem->appendChild(std::move(label), std::move(data));
+        if (!readPlaylistTree(in, pChild, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readPlaylistTree(const QByteArray& playlistTree, TreeItem* pParent) {
+    QDataStream in(playlistTree);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 version = 0;
+    in >> version;
+    if (version != kPlaylistTreeVersion) {
+        return false;
+    }
+    return readPlaylistTree(in, pParent, 0) && in.atEnd();
+}
+
+mixxx::cache_key_signed_t hashValues(const QVariantList& values) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto& value : values) {
+        // The marker distinguishes a null value from an empty string
+        hash.addData(QByteArray(1, value.isNull() ? '\0' : '\1'));
+        hash.addData(value.toString().toUtf8());
+        hash.addData(QByteArray(1, '\x1f'));
+    }
+    return mixxx::signedCacheKey(mixxx::cacheKeyFromMessageDigest(hash.result()));
+}
+
+} // anonymous namespace
+
+ExternalLibraryImportCache::ExternalLibraryImportCache(
+        const QSqlDatabase& database,
+        const QString& feature,
+        const QStringList& sourcePaths)
+        : m_database(database),
+          m_feature(feature),
+          m_sourcePaths(sourcePaths) {
+    DEBUG_ASSERT(!m_sourcePaths.isEmpty());
+}
+
+bool ExternalLibraryImportCache::isUpToDate() {
+    QSqlQuery query(m_database);
+    query.prepare(
+            "SELECT file_size, modified_ms, content_hash, playlist_tree "
+            "FROM ExternalLibraryImport "
+            "WHERE feature=:feature AND source_path=:source_path");
+    bool upToDate = true;
+    m_fingerprints.clear();
+    m_playlistTree.clear();
+    for (const auto& sourcePath : m_sourcePaths) {
+        const QFileInfo fileInfo(sourcePath);
+        ExternalLibrarySourceFingerprint fingerprint;
+        fingerprint.fileSize = fileInfo.size();
+        fingerprint.modifiedMs = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        query.bindValue(":feature", m_feature);
+        query.bindValue(":source_path", sourcePath);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+        if (!query.next()) {
+            upToDate = false;
+            fingerprint.contentHash = hashFileContents(sourcePath);
+        } else if (query.value(0).toLongLong() == fingerprint.fileSize &&
+                query.value(1).toLongLong() == fingerprint.modifiedMs) {
+            fingerprint.contentHash = query.value(2).toString();
+        } else {
+            // E.g. the file has been saved again without changes
+            fingerprint.contentHash = hashFileContents(sourcePath);
+            if (!fingerprint.contentHash.isEmpty() &&
+                    fingerprint.contentHash == query.value(2).toString()) {
+                // Avoid hashing the file again next time
+                updateFileStatus(sourcePath, fingerprint);
+            } else {
+                upToDate = false;
+            }
+        }
+        if (m_fingerprints.isEmpty() && query.isValid()) {
+            m_playlistTree = query.value(3).toByteArray();
+        }
+        m_fingerprints.append(std::move(fingerprint));
+    }
+    return upToDate;
+}
+
+void ExternalLibraryImportCache::updateFileStatus(const QString& sourcePath,
+        const ExternalLibrarySourceFingerprint& fingerprint) {
+    QSqlQuery query(m_database);
+    query.prepare(
+            "UPDATE ExternalLibraryImport "
+            "SET file_size=:file_size, modified_ms=:modified_ms "
+            "WHERE feature=:feature AND source_path=:source_path");
+    query.bindValue(":file_size", fingerprint.fileSize);
+    query.bindValue(":modified_ms", fingerprint.modifiedMs);
+    query.bindValue(":feature", m_feature);
+    query.bindValue(":source_path", sourcePath);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+}
+
+bool ExternalLibraryImportCache::restorePlaylistTree(TreeItem* pParent) const {
+    VERIFY_OR_DEBUG_ASSERT(pParent) {
+        return false;
+    }
+    // Validate the tree before modifying pParent
+    TreeItem tree;
+    if (!readPlaylistTree(m_playlistTree, &tree)) {
+        qWarning() << "Failed to restore the cached playlist tree of" << m_feature;
+        return false;
+    }
+    return readPlaylistTree(m_playlistTree, pParent);
+}
+
+bool ExternalLibraryImportCache::save(const TreeItem* pPlaylistRoot) {
+    VERIFY_OR_DEBUG_ASSERT(m_fingerprints.size() == m_sourcePaths.size()) {
+        return false;
+    }
+    QByteArray playlistTree;
+    if (pPlaylistRoot) {
+        QDataStream out(&playlistTree, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << kPlaylistTreeVersion;
+        writePlaylistTree(out, *pPlaylistRoot);
+    }
+
+    // Replaces the previous import of the feature, which might have
+    // been imported from different source files
+    invalidate();
+    QSqlQuery query(m_database);
+    query.prepare(
+            "INSERT INTO ExternalLibraryImport "
+            "(feature, source_path, file_size, modified_ms, content_hash, playlist_tree) "
+            "VALUES (:feature, :source_path, :file_size, :modified_ms, "
+            ":content_hash, :playlist_tree)");
+    for (int i = 0; i < m_sourcePaths.size(); ++i) {
+        const ExternalLibrarySourceFingerprint& fingerprint = m_fingerprints[i];
+        if (fingerprint.contentHash.isEmpty()) {
+            // The file could not be read, don't cache the import
+            invalidate();
+            return false;
+        }
+        query.bindValue(":feature", m_feature);
+        query.bindValue(":source_path", m_sourcePaths[i]);
+        query.bindValue(":file_size", fingerprint.fileSize);
+        query.bindValue(":modified_ms", fingerprint.modifiedMs);
+        query.bindValue(":content_hash", fingerprint.contentHash);
+        // The tree is stored with the first source path
+        query.bindValue(":playlist_tree", i == 0 ? QVariant(playlistTree) : QVariant());
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ExternalLibraryImportCache::invalidate() {
+    QSqlQuery query(m_database);
+    query.prepare("DELETE FROM ExternalLibraryImport WHERE feature=:feature");
+    query.bindValue(":feature", m_feature);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+}
+
+// static
+void ExternalLibraryImportCache::invalidateAll(
+        const QSqlDatabase& database,
+        const QString& featurePrefix) {
+    QSqlQuery query(database);
+    query.prepare("SELECT feature FROM ExternalLibraryImport");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return;
+    }
+    QStringList features;
+    while (query.next()) {
+        const QString feature = query.value(0).toString();
+        if (feature.startsWith(featurePrefix) && !features.contains(feature)) {
+            features.append(feature);
+        }
+    }
+    query.prepare("DELETE FROM ExternalLibraryImport WHERE feature=:feature");
+    for (const auto& feature : std::as_const(features)) {
+        query.bindValue(":feature", feature);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return;
+        }
+    }
+}
+
+ExternalTrackTableUpdater::ExternalTrackTableUpdater(
+        const QSqlDatabase& database,
+        const QString& tableName,
+        const QString& keyColumn,
+        const QStringList& columns,
+        const QString& filterColumn,
+        const QVariant& filterValue)
+        : m_database(database),
+          m_tableName(tableName),
+          m_columns(columns),
+          m_keyIndex(columns.indexOf(keyColumn)),
+          m_filterColumn(filterColumn),
+          m_filterValue(filterValue),
+          m_unchangedCount(0),
+          m_insertedCount(0),
+          m_updatedCount(0),
+          m_removedCount(0) {
+    DEBUG_ASSERT(m_keyIndex >= 0);
+    DEBUG_ASSERT(!m_columns.contains(m_filterColumn));
+}
+
+bool ExternalTrackTableUpdater::begin() {
+    QStringList insertColumns = m_columns;
+    if (!m_filterColumn.isEmpty()) {
+        insertColumns.append(m_filterColumn);
+    }
+    insertColumns.append(kImportHashColumn);
+    QStringList placeholders;
+    for (int i = 0; i < insertColumns.size(); ++i) {
+        placeholders.append(QStringLiteral("?"));
+    }
+    m_insertQuery = QSqlQuery(m_database);
+    if (!m_insertQuery.prepare(
+                QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)")
+                        .arg(m_tableName,
+                                insertColumns.join(QLatin1Char(',')),
+                                placeholders.join(QLatin1Char(','))))) {
+        LOG_FAILED_QUERY(m_insertQuery);
+        return false;
+    }
+
+    QStringList assignments;
+    for (const auto& column : std::as_const(m_columns)) {
+        assignments.append(column + QStringLiteral("=?"));
+    }
+    assignments.append(kImportHashColumn + QStringLiteral("=?"));
+    m_updateQuery = QSqlQuery(m_database);
+    if (!m_updateQuery.prepare(
+                QStringLiteral("UPDATE %1 SET %2 WHERE id=?")
+                        .arg(m_tableName, assignments.join(QLatin1Char(','))))) {
+        LOG_FAILED_QUERY(m_updateQuery);
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    QString selectRows = QStringLiteral("SELECT id,%1,%2 FROM %3")
+                                 .arg(m_columns[m_keyIndex], kImportHashColumn, m_tableName);
+    if (!m_filterColumn.isEmpty()) {
+        selectRows += QStringLiteral(" WHERE %1=?").arg(m_filterColumn);
+    }
+    query.prepare(selectRows);
+    if (!m_filterColumn.isEmpty()) {
+        query.bindValue(0, m_filterValue);
+    }
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    m_rows.clear();
+    while (query.next()) {
+        // Rows without a hash have been imported by an older version
+        // and are always updated
+        m_rows.insert(query.value(1).toString(),
+                Row{query.value(0).toInt(),
+                        query.value(2).isNull() ? 0 : query.value(2).toLongLong(),
+                        false});
+    }
+    return true;
+}
+
+int ExternalTrackTableUpdater::importTrack(const QVariantList& values) {
+    VERIFY_OR_DEBUG_ASSERT(values.size() == m_columns.size()) {
+        return -1;
+    }
+    const QString key = values[m_keyIndex].toString();
+    const qint64 importHash = hashValues(values);
+    const auto it = m_rows.find(key);
+    if (it != m_rows.end()) {
+        it->imported = true;
+        if (it->importHash == importHash) {
+            ++m_unchangedCount;
+            return it->id;
+        }
+        int pos = 0;
+        for (const auto& value : values) {
+            m_updateQuery.bindValue(pos++, value);
+        }
+        m_updateQuery.bindValue(pos++, importHash);
+        m_updateQuery.bindValue(pos++, it->id);
+        if (!m_updateQuery.exec()) {
+            LOG_FAILED_QUERY(m_updateQuery);
+            return -1;
+        }
+        it->importHash = importHash;
+        ++m_updatedCount;
+        return it->id;
+    }
+
+    int pos = 0;
+    for (const auto& value : values) {
+        m_insertQuery.bindValue(pos++, value);
+    }
+    if (!m_filterColumn.isEmpty()) {
+        m_insertQuery.bindValue(pos++, m_filterValue);
+    }
+    m_insertQuery.bindValue(pos++, importHash);
+    if (!m_insertQuery.exec()) {
+        LOG_FAILED_QUERY(m_insertQuery);
+        return -1;
+    }
+    const int id = m_insertQuery.lastInsertId().toInt();
+    m_rows.insert(key, Row{id, importHash, true});
+    ++m_insertedCount;
+    return id;
+}
+
+bool ExternalTrackTableUpdater::removeMissingTracks() {
+    QSqlQuery query(m_database);
+    query.prepare(QStringLiteral("DELETE FROM %1 WHERE id=?").arg(m_tableName));
+    for (auto it = m_rows.begin(); it != m_rows.end();) {
+        if (it->imported) {
+            ++it;
+            continue;
+        }
+        query.bindValue(0, it->id);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+            return false;
+        }
+        ++m_removedCount;
+        it = m_rows.erase(it);
+    }
+    return true;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class TreeItem;
+
+/// The state of a source file of an external library, e.g. the
+/// collection.nml of Traktor, when it has been imported.
+struct ExternalLibrarySourceFingerprint {
+    qint64 fileSize = -1;
+    qint64 modifiedMs = -1;
+    // Only computed if the size or the modification time differ
+    QString contentHash;
+};
+
+/// Persists which version of the source files of an external library
+/// has been imported into the tables of the feature, together with the
+/// playlist tree. If none of the source files has changed since the last
+/// import the tables are reused and the tree is restored instead of
+/// parsing the library again, also across sessions.
+///
+/// A source file is unchanged if its size and modification time are
+/// unchanged or if the hash of its contents is unchanged.
+///
+/// The tables of a feature contain a single import, so each feature must
+/// use a distinct name, e.g. one per Rekordbox device.
+class ExternalLibraryImportCache {
+  public:
+    /// The playlist tree is stored with the first source path.
+    ExternalLibraryImportCache(
+            const QSqlDatabase& database,
+            const QString& feature,
+            const QStringList& sourcePaths);
+
+    /// Reads the current state of all source files. Returns true if
+    /// none of them has changed since the last import.
+    bool isUpToDate();
+
+    /// Appends the children of the playlist tree of the last import
+    /// to pParent. Returns false if there is no valid tree.
+    bool restorePlaylistTree(TreeItem* pParent) const;
+
+    /// Records the state of the source files as read by isUpToDate()
+    /// after they have been imported successfully. Should be called
+    /// within the transaction of the import.
+    bool save(const TreeItem* pPlaylistRoot);
+
+    /// Forgets the last import of the feature, e.g. if the tables have
+    /// been modified by an import that has been canceled
+    void invalidate();
+
+    /// Forgets the imports of all features whose name starts with
+    /// featurePrefix, e.g. if their tables have been recreated.
+    static void invalidateAll(
+            const QSqlDatabase& database,
+            const QString& featurePrefix);
+
+  private:
+    void updateFileStatus(const QString& sourcePath,
+            const ExternalLibrarySourceFingerprint& fingerprint);
+
+    const QSqlDatabase m_database;
+    const QString m_feature;
+    const QStringList m_sourcePaths;
+    QVector<ExternalLibrarySourceFingerprint> m_fingerprints;
+    QByteArray m_playlistTree;
+};
+
+/// Updates a track table of an external library incrementally.
+///
+/// The existing rows are loaded once and identified by a key column of
+/// the source, e.g. the location. A hash of the imported values is stored
+/// with every row, so tracks that have not changed since the last import
+/// are neither inserted nor updated. The ids of unchanged tracks are
+/// stable and can be looked up without querying the database.
+class ExternalTrackTableUpdater {
+  public:
+    /// columns must contain keyColumn. If filterColumn is not empty only
+    /// the rows with filterValue are updated, e.g. the tracks of a single
+    /// device. The filter column must not be part of columns, it is set
+    /// automatically.
+    ExternalTrackTableUpdater(
+            const QSqlDatabase& database,
+            const QString& tableName,
+            const QString& keyColumn,
+            const QStringList& columns,
+            const QString& filterColumn = QString(),
+            const QVariant& filterValue = QVariant());
+
+    /// Loads the existing rows
+    bool begin();
+
+    /// The values are bound in the order of the columns. Returns the id
+    /// of the track or -1 on failure.
+    int importTrack(const QVariantList& values);
+
+    /// Returns the id of a track that has been imported or existed before
+    int trackId(const QString& key) const {
+        const auto it = m_rows.constFind(key);
+        return it == m_rows.constEnd() ? -1 : it->id;
+    }
+
+    /// Deletes all rows that have not been imported since begin()
+    bool removeMissingTracks();
+
+    int unchangedCount() const {
+        return m_unchangedCount;
+    }
+    int insertedCount() const {
+        return m_insertedCount;
+    }
+    int updatedCount() const {
+        return m_updatedCount;
+    }
+    int removedCount() const {
+        return m_removedCount;
+    }
+
+  private:
+    struct Row {
+        int id;
+        qint64 importHash;
+        bool imported;
+    };
+
+    const QSqlDatabase m_database;
+    const QString m_tableName;
+    const QStringList m_columns;
+    const int m_keyIndex;
+    const QString m_filterColumn;
+    const QVariant m_filterValue;
+
+    QSqlQuery m_insertQuery;
+    QSqlQuery m_updateQuery;
+    QHash<QString, Row> m_rows;
+
+    int m_unchangedCount;
+    int m_insertedCount;
+    int m_updatedCount;
+    int m_removedCount;
+};
@@ -2,8 +2,10 @@
 
 #include <QObject>
 #include <QSqlQuery>
+#include <QtDebug>
 #include <gsl/pointers>
 
+#include "library/externallibraryimportcache.h"
 #include "library/itunes/ituneslocalhosttoken.h"
 #include "library/itunes/itunespathmapping.h"
 #include "library/queryutil.h"
@@ -40,19 +42,38 @@ std::ostream& operator<<(std::ostream& os, const ITunesPlaylist& playlist) {
     return os;
 }
 
+ITunesDAO::ITunesDAO() = default;
+
+ITunesDAO::~ITunesDAO() = default;
+
 void ITunesDAO::initialize(const QSqlDatabase& database) {
-    m_insertTrackQuery = QSqlQuery(database);
+    m_isDatabaseInitialized = false;
     m_insertPlaylistQuery = QSqlQuery(database);
     m_insertPlaylistTrackQuery = QSqlQuery(database);
     m_applyPathMappingQuery = QSqlQuery(database);
 
-    m_insertTrackQuery.prepare(
-            "INSERT INTO itunes_library (id, artist, title, album, "
-            "album_artist, genre, grouping, year, duration, "
-            "location, rating, comment, tracknumber, bpm, bitrate) "
-            "VALUES (:id, :artist, :title, :album, :album_artist, "
-            ":genre, :grouping, :year, :duration, :location, "
-            ":rating, :comment, :tracknumber, :bpm, :bitrate)");
+    m_pTrackUpdater = std::make_unique<ExternalTrackTableUpdater>(database,
+            QStringLiteral("itunes_library"),
+            QStringLiteral("id"),
+            QStringList{"id",
+                    "artist",
+                    "title",
+                    "album",
+                    "album_artist",
+                    "genre",
+                    "grouping",
+                    "year",
+                    "duration",
+                    "location",
+                    "rating",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate"});
+    if (!m_pTrackUpdater->begin()) {
+        qWarning() << "Failed to load the existing iTunes tracks";
+        return;
+    }
 
     m_insertPlaylistQuery.prepare("INSERT INTO itunes_playlists (id, name) VALUES (:id, :name)");
 
@@ -69,29 +90,39 @@ void ITunesDAO::initialize(const QSqlDatabase& database) {
 
 bool ITunesDAO::importTrack(const ITunesTrack& track) {
     if (m_isDatabaseInitialized) {
-        QSqlQuery& query = m_insertTrackQuery;
-
-        query.bindValue(":id", track.id);
-        query.bindValue(":artist", track.artist);
-        query.bindValue(":title", track.title);
-        query.bindValue(":album", track.album);
-        query.bindValue(":album_artist", track.albumArtist);
-        query.bindValue(":genre", track.genre);
-        query.bindValue(":grouping", track.grouping);
-        query.bindValue(":year", track.year > 0 ? QVariant(track.year) : QVariant());
-        query.bindValue(":duration", track.duration);
-        query.bindValue(":location", track.location);
-        query.bindValue(":rating", track.rating);
-        query.bindValue(":comment", track.comment);
-        query.bindValue(":tracknumber",
-                track.trackNumber > 0 ? QVariant(track.trackNumber) : QVariant());
-        query.bindValue(":bpm", track.bpm);
-        query.bindValue(":bitrate", track.bitrate);
+        const int id = m_pTrackUpdater->importTrack({track.id,
+                track.artist,
+                track.title,
+                track.album,
+                track.albumArtist,
+                track.genre,
+                track.grouping,
+                track.year > 0 ? QVariant(track.year) : QVariant(),
+                track.duration,
+                track.location,
+                track.rating,
+                track.comment,
+                track.trackNumber > 0 ? QVariant(track.trackNumber) : QVariant(),
+                track.bpm,
+                track.bitrate});
+        if (id < 0) {
+            return false;
+        }
+    }
 
-        if (!query.exec()) {
-            LOG_FAILED_QUERY(query);
+    return true;
+}
+
+bool ITunesDAO::removeMissingTracks() {
+    if (m_isDatabaseInitialized) {
+        if (!m_pTrackUpdater->removeMissingTracks()) {
             return false;
         }
+        qDebug() << "iTunes tracks:"
+                 << m_pTrackUpdater->insertedCount() << "new,"
+                 << m_pTrackUpdater->updatedCount() << "changed,"
+                 << m_pTrackUpdater->unchangedCount() << "unchanged,"
+                 << m_pTrackUpdater->removedCount() << "removed";
     }
 
     return true;
@@ -6,10 +6,12 @@
 #include <QString>
 #include <gsl/pointers>
 #include <map>
+#include <memory>
 #include <ostream>
 
 #include "library/dao/dao.h"
 
+class ExternalTrackTableUpdater;
 class QSqlDatabase;
 struct ITunesPathMapping;
 class TreeItem;
@@ -86,13 +88,20 @@ std::ostream& operator<<(std::ostream& os, const ITunesPlaylist& playlist);
 /// A wrapper around the iTunes database tables. Keeps track of the
 /// playlist tree, deals with duplicate disambiguation and can export
 /// the tree afterwards.
+///
+/// The tracks are updated incrementally, i.e. tracks that have not changed
+/// since the last import are neither inserted nor updated.
 class ITunesDAO : public DAO {
   public:
-    ~ITunesDAO() override = default;
+    ITunesDAO();
+    ~ITunesDAO() override;
 
     void initialize(const QSqlDatabase& database) override;
 
     virtual bool importTrack(const ITunesTrack& track);
+    /// Deletes the tracks of the last import that have not been imported
+    /// again. Only call this if the whole library has been imported.
+    virtual bool removeMissingTracks();
     virtual bool importPlaylist(const ITunesPlaylist& playlist);
     virtual bool importPlaylistRelation(int parentId, int childId);
     virtual bool importPlaylistTrack(int playlistId, int trackId, int position);
@@ -113,7 +122,7 @@ class ITunesDAO : public DAO {
 
     // Note that these queries reference the database, which is expected
     // to outlive the DAO.
-    QSqlQuery m_insertTrackQuery;
+    std::unique_ptr<ExternalTrackTableUpdater> m_pTrackUpdater;
     QSqlQuery m_insertPlaylistQuery;
     QSqlQuery m_insertPlaylistTrackQuery;
     QSqlQuery m_applyPathMappingQuery;
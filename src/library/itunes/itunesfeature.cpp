@@ -14,6 +14,7 @@
 #include "library/baseexternaltrackmodel.h"
 #include "library/basetrackcache.h"
 #include "library/dao/settingsdao.h"
+#include "library/externallibraryimportcache.h"
 #include "library/itunes/itunesdao.h"
 #include "library/itunes/itunesimporter.h"
 #include "library/itunes/itunesplaylistmodel.h"
@@ -178,13 +179,6 @@ void ITunesFeature::activate(bool forceReload) {
     //qDebug("ITunesFeature::activate()");
     if (!m_isActivated || forceReload) {
 
-        //Delete all table entries of iTunes feature
-        ScopedTransaction transaction(m_database);
-        clearTable("itunes_playlist_tracks");
-        clearTable("itunes_library");
-        clearTable("itunes_playlists");
-        transaction.commit();
-
         emit showTrackModel(m_pITunesTrackModel);
 
         SettingsDAO settings(m_pTrackCollection->database());
@@ -276,7 +270,7 @@ void ITunesFeature::onRightClick(const QPoint& globalPos) {
     if (chosen == &useDefault) {
         SettingsDAO settings(m_database);
         settings.setValue(kItdbPathKey, QString());
-        activate(true); // clears tables before parsing
+        activate(true); // imports the library again
     } else if (chosen == &chooseNew) {
         SettingsDAO settings(m_database);
         QString dbfile = showOpenDialog();
@@ -293,7 +287,7 @@ void ITunesFeature::onRightClick(const QPoint& globalPos) {
         Sandbox::createSecurityToken(&dbFileInfo);
 
         settings.setValue(kItdbPathKey, dbfile);
-        activate(true); // clears tables before parsing
+        activate(true); // imports the library again
     }
 }
 
@@ -346,9 +340,45 @@ TreeItem* ITunesFeature::importLibrary() {
 
     ScopedTransaction transaction(m_database);
 
+    // Only the import of an XML library can be reused, the native
+    // importers provide no means to detect changes
+    std::unique_ptr<ExternalLibraryImportCache> pImportCache;
+    if (isNativeImporterUsed()) {
+        // The import of a previously used XML library no longer
+        // matches the tables
+        ExternalLibraryImportCache(m_database, QStringLiteral("itunes"), QStringList{m_dbfile})
+                .invalidate();
+        //Delete all table entries of iTunes feature
+        clearTable("itunes_playlist_tracks");
+        clearTable("itunes_library");
+        clearTable("itunes_playlists");
+    } else {
+        pImportCache = std::make_unique<ExternalLibraryImportCache>(
+                m_database, QStringLiteral("itunes"), QStringList{m_dbfile});
+        if (pImportCache->isUpToDate()) {
+            std::unique_ptr<TreeItem> pRootItem = TreeItem::newRoot(this);
+            if (pImportCache->restorePlaylistTree(pRootItem.get())) {
+                transaction.commit();
+                qDebug() << "iTunes library is unchanged, reusing the last import";
+                return pRootItem.release();
+            }
+        }
+        // Only the playlists are rebuilt, the tracks are updated incrementally
+        clearTable("itunes_playlist_tracks");
+        clearTable("itunes_playlists");
+    }
+
     std::unique_ptr<ITunesImporter> importer = makeImporter();
     ITunesImport iTunesImport = importer->importLibrary();
 
+    if (pImportCache) {
+        if (iTunesImport.isComplete && iTunesImport.playlistRoot) {
+            pImportCache->save(iTunesImport.playlistRoot.get());
+        } else {
+            pImportCache->invalidate();
+        }
+    }
+
     // Even if an error occurred, commit the transaction. The file may have been
     // half-parsed.
     transaction.commit();
@@ -7,6 +7,8 @@ class ITunesFeature;
 
 struct ITunesImport {
     std::unique_ptr<TreeItem> playlistRoot;
+    // Whether the whole library has been imported without errors
+    bool isComplete = false;
 };
 
 class ITunesImporter {
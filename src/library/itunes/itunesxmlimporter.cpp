@@ -112,6 +112,8 @@ ITunesImport ITunesXMLImporter::importLibrary() {
         qDebug() << "line:" << m_xml.lineNumber()
                  << "column:" << m_xml.columnNumber()
                  << "error:" << m_xml.errorString();
+    } else if (isTracksParsed && !canceled()) {
+        iTunesImport.isComplete = m_dao->removeMissingTracks();
     }
 
     if (isMusicFolderLocatedAfterTracks) {
@@ -18,6 +18,11 @@ const ConfigKey mixxx::library::prefs::kRescanOnStartupConfigKey =
                 mixxx::library::prefs::kConfigGroup,
                 QStringLiteral("RescanOnStartup")};
 
+const ConfigKey mixxx::library::prefs::kIncrementalRescanConfigKey =
+        ConfigKey{
+                mixxx::library::prefs::kConfigGroup,
+                QStringLiteral("IncrementalRescan")};
+
 const ConfigKey mixxx::library::prefs::kShowScanSummaryConfigKey =
         ConfigKey{
                 mixxx::library::prefs::kConfigGroup,
@@ -24,6 +24,20 @@
 #include "widget/wlibrarysidebar.h"
 #endif
 
+// static
+QStringList MixxxLibraryFeature::searchColumns() {
+    return {
+            LIBRARYTABLE_ARTIST,
+            LIBRARYTABLE_ALBUM,
+            LIBRARYTABLE_ALBUMARTIST,
+            TRACKLOCATIONSTABLE_LOCATION,
+            LIBRARYTABLE_GROUPING,
+            LIBRARYTABLE_COMMENT,
+            LIBRARYTABLE_TITLE,
+            LIBRARYTABLE_GENRE,
+            LIBRARYTABLE_CRATE};
+}
+
 MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
         UserSettingsPointer pConfig)
         : LibraryFeature(pLibrary, pConfig, QStringLiteral("tracks")),
@@ -76,17 +90,6 @@ MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
             LIBRARYTABLE_COVERART_DIGEST,
             LIBRARYTABLE_COVERART_HASH,
             LIBRARYTABLE_WAVESUMMARYHEX};
-    QStringList searchColumns = {
-            LIBRARYTABLE_ARTIST,
-            LIBRARYTABLE_ALBUM,
-            LIBRARYTABLE_ALBUMARTIST,
-            TRACKLOCATIONSTABLE_LOCATION,
-            LIBRARYTABLE_GROUPING,
-            LIBRARYTABLE_COMMENT,
-            LIBRARYTABLE_TITLE,
-            LIBRARYTABLE_GENRE,
-            LIBRARYTABLE_CRATE};
-
     QStringList qualifiedTableColumns;
     for (const auto& col : columns) {
         qualifiedTableColumns.append(mixxx::trackschema::tableForColumn(col) +
@@ -109,8 +112,11 @@ MixxxLibraryFeature::MixxxLibraryFeature(Library* pLibrary,
             std::move(tableName),
             std::move(idColumn),
             std::move(columns),
-            std::move(searchColumns),
+            searchColumns(),
             true);
+    pBaseTrackCache->setSearchIndexEnabled(true);
+    pBaseTrackCache->setCollationKeys(
+            &m_pTrackCollection->getTrackDAO().collationKeys());
     m_pBaseTrackCache = QSharedPointer<BaseTrackCache>(pBaseTrackCache);
     m_pTrackCollection->connectTrackSource(m_pBaseTrackCache);
 
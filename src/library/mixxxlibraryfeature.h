@@ -27,6 +27,10 @@ class MixxxLibraryFeature final : public LibraryFeature {
                         UserSettingsPointer pConfig);
     ~MixxxLibraryFeature() override = default;
 
+    /// The columns of library_cache_view that are searched by
+    /// unqualified search terms.
+    static QStringList searchColumns();
+
     QVariant title() override;
     bool dropAccept(const QList<QUrl>& urls, QObject* pSource) override;
     bool dragMoveAccept(const QList<QUrl>& urls) override;
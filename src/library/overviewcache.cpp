@@ -172,6 +172,8 @@ OverviewCache::FutureResult OverviewCache::prepareOverview(
     if (!analyses.isEmpty()) {
         ConstWaveformPointer pLoadedTrackWaveformSummary = ConstWaveformPointer(
                 WaveformFactory::loadWaveformFromAnalysis(analyses.first()));
+        // Loading the compact format is much faster
+        analysisDao.upgradeWaveformAnalysis(analyses.first(), *pLoadedTrackWaveformSummary);
 
         if (!pLoadedTrackWaveformSummary.isNull()) {
             QImage image = waveformOverviewRenderer::render(
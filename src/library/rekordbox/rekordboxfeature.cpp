@@ -4,15 +4,20 @@
 #include <rekordbox_anlz.h>
 #include <rekordbox_pdb.h>
 
+#include <QHash>
 #include <QMap>
 #include <QMessageBox>
+#include <QSet>
 #include <QSettings>
+#include <QSqlRecord>
 #include <QString>
 #include <QTextCodec>
 #include <QtDebug>
+#include <utility>
 
 #include "engine/engine.h"
 #include "library/dao/trackschema.h"
+#include "library/externallibraryimportcache.h"
 #include "library/library.h"
 #include "library/queryutil.h"
 #include "library/rekordbox/rekordboxconstants.h"
@@ -43,6 +48,25 @@ const QString kRekordboxPlaylistTracksTable = QStringLiteral("rekordbox_playlist
 
 const QString kPdbPath = QStringLiteral("PIONEER/rekordbox/export.pdb");
 const QString kPLaylistPathDelimiter = QStringLiteral("-->");
+// The import of each device is cached separately
+const QString kImportCacheFeaturePrefix = QStringLiteral("rekordbox:");
+const QStringList kRekordboxTrackColumns = {
+        QStringLiteral("rb_id"),
+        QStringLiteral("artist"),
+        QStringLiteral("title"),
+        QStringLiteral("album"),
+        QStringLiteral("year"),
+        QStringLiteral("genre"),
+        QStringLiteral("comment"),
+        QStringLiteral("tracknumber"),
+        QStringLiteral("bpm"),
+        QStringLiteral("bitrate"),
+        QStringLiteral("duration"),
+        QStringLiteral("location"),
+        QStringLiteral("rating"),
+        QStringLiteral("key"),
+        QStringLiteral("analyze_path"),
+        QStringLiteral("color")};
 
 enum class IDForColor : uint8_t {
     Pink = 1,
@@ -96,7 +120,8 @@ bool createLibraryTable(QSqlDatabase& database, const QString& tableName) {
             "    rating INTEGER,"
             "    analyze_path TEXT UNIQUE,"
             "    device TEXT,"
-            "    color INTEGER"
+            "    color INTEGER,"
+            "    import_hash INTEGER"
             ");");
 
     if (!query.exec()) {
@@ -161,6 +186,22 @@ bool dropTable(QSqlDatabase& database, const QString& tableName) {
     return true;
 }
 
+// The tables are kept across sessions to reuse the imports of unchanged
+// devices. Tables created by older versions are recreated.
+void createTables(QSqlDatabase& database) {
+    ScopedTransaction transaction(database);
+    if (!database.record(kRekordboxLibraryTable).contains(QStringLiteral("import_hash"))) {
+        dropTable(database, kRekordboxPlaylistTracksTable);
+        dropTable(database, kRekordboxPlaylistsTable);
+        dropTable(database, kRekordboxLibraryTable);
+        ExternalLibraryImportCache::invalidateAll(database, kImportCacheFeaturePrefix);
+    }
+    createLibraryTable(database, kRekordboxLibraryTable);
+    createPlaylistsTable(database, kRekordboxPlaylistsTable);
+    createPlaylistTracksTable(database, kRekordboxPlaylistTracksTable);
+    transaction.commit();
+}
+
 // This function is executed in a separate thread other than the main thread
 // The returned list owns the pointers, but we can't use a unique_ptr because
 // the result is passed by a const reference inside QFuture and than copied
@@ -350,16 +391,15 @@ mixxx::RgbColor colorFromID(int colorID) {
 }
 
 void insertTrack(
-        QSqlDatabase& database,
         rekordbox_pdb_t::track_row_t* track,
-        QSqlQuery& query,
+        ExternalTrackTableUpdater* pTrackUpdater,
+        QHash<uint32_t, int>* pTrackIdsByRbId,
         QSqlQuery& queryInsertIntoDevicePlaylistTracks,
         QMap<uint32_t, QString>& artistsMap,
         QMap<uint32_t, QString>& albumsMap,
         QMap<uint32_t, QString>& genresMap,
         QMap<uint32_t, QString>& keysMap,
         const QString& devicePath,
-        const QString& device,
         int audioFilesCount) {
     int rbID = static_cast<int>(track->id());
     QString title = getText(track->title());
@@ -377,45 +417,28 @@ void insertTrack(
     QString tracknumber = QString::number(track->track_number());
     QString anlzPath = devicePath + getText(track->analyze_path());
 
-    query.bindValue(":rb_id", rbID);
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-    query.bindValue(":analyze_path", anlzPath);
-    query.bindValue(":device", device);
-    query.bindValue(":color",
+    // The values are in the order of kRekordboxTrackColumns
+    const int trackID = pTrackUpdater->importTrack({rbID,
+            artist,
+            title,
+            album,
+            year,
+            genre,
+            comment,
+            tracknumber,
+            bpm,
+            bitrate,
+            playtime,
+            location,
+            rating,
+            key,
+            anlzPath,
             mixxx::RgbColor::toQVariant(
-                    colorFromID(static_cast<int>(track->color_id()))));
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
-
-    int trackID = -1;
-    QSqlQuery finderQuery(database);
-    finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-            " where rb_id=:rb_id and device=:device");
-    finderQuery.bindValue(":rb_id", rbID);
-    finderQuery.bindValue(":device", device);
-
-    if (!finderQuery.exec()) {
-        LOG_FAILED_QUERY(finderQuery)
-                << "rbID:" << rbID;
-    }
-
-    if (finderQuery.next()) {
-        trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
+                    colorFromID(static_cast<int>(track->color_id())))});
+    if (trackID < 0) {
+        qWarning() << "Failed to import Rekordbox track" << rbID << location;
     }
+    pTrackIdsByRbId->insert(track->id(), trackID);
 
     // Insert into device all tracks playlist
     queryInsertIntoDevicePlaylistTracks.bindValue(":track_id", trackID);
@@ -437,7 +460,7 @@ void buildPlaylistTree(
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
         const QString& playlistPath,
-        const QString& device);
+        const QHash<uint32_t, int>& trackIdsByRbId);
 
 QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* deviceItem) {
     QString device = deviceItem->getLabel();
@@ -467,16 +490,36 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
     QThread* thisThread = QThread::currentThread();
     thisThread->setPriority(QThread::LowPriority);
 
+    mixxx::FileInfo fileInfo(dbPath);
+    if (!Sandbox::askForAccess(&fileInfo)) {
+        return QString();
+    }
+
     ScopedTransaction transaction(database);
 
-    QSqlQuery query(database);
-    query.prepare("INSERT INTO " + kRekordboxLibraryTable +
-            " (rb_id, artist, title, album, year,"
-            "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-            "rating,key,analyze_path,device,color) VALUES (:rb_id, :artist, "
-            ":title, :album, :year,:genre,"
-            ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-            ":rating,:key,:analyze_path,:device,:color)");
+    ExternalLibraryImportCache importCache(
+            database, kImportCacheFeaturePrefix + device, {dbPath});
+    if (importCache.isUpToDate() && importCache.restorePlaylistTree(deviceItem)) {
+        // The tables still contain the last import of the unchanged device
+        transaction.commit();
+        qDebug() << "Rekordbox device" << device << "is unchanged, reusing the last import";
+        return devicePath;
+    }
+
+    // Only the playlists are rebuilt, the tracks are updated incrementally
+    clearDevicePlaylists(database, device, devicePath);
+    // The location is unique, while the ids of Rekordbox may be
+    // reassigned by a new export
+    ExternalTrackTableUpdater trackUpdater(database,
+            kRekordboxLibraryTable,
+            QStringLiteral("location"),
+            kRekordboxTrackColumns,
+            QStringLiteral("device"),
+            device);
+    if (!trackUpdater.begin()) {
+        return QString();
+    }
+    QHash<uint32_t, int> trackIdsByRbId;
 
     int audioFilesCount = 0;
 
@@ -491,10 +534,6 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
 
     queryInsertIntoDevicePlaylistTracks.bindValue(":playlist_id", playlistID);
 
-    mixxx::FileInfo fileInfo(dbPath);
-    if (!Sandbox::askForAccess(&fileInfo)) {
-        return QString();
-    }
     std::ifstream ifs(dbPath.toStdString(), std::ifstream::binary);
     kaitai::kstream ks(&ifs);
 
@@ -579,17 +618,17 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
                                                                 ->track_id();
                                     } break;
                                     case rekordbox_pdb_t::PAGE_TYPE_TRACKS: {
-                                        insertTrack(database,
+                                        insertTrack(
                                                 static_cast<rekordbox_pdb_t::track_row_t*>(
                                                         rowRef->body()),
-                                                query,
+                                                &trackUpdater,
+                                                &trackIdsByRbId,
                                                 queryInsertIntoDevicePlaylistTracks,
                                                 artistsMap,
                                                 albumsMap,
                                                 genresMap,
                                                 keysMap,
                                                 devicePath,
-                                                device,
                                                 audioFilesCount);
 
                                         audioFilesCount++;
@@ -642,11 +681,17 @@ QString parseDeviceDB(mixxx::DbConnectionPoolPtr dbConnectionPool, TreeItem* dev
                 playlistTreeMap,
                 playlistTrackMap,
                 devicePath,
-                device);
+                trackIdsByRbId);
     }
 
-    qDebug() << "Found: " << audioFilesCount << " audio files in Rekordbox device " << device;
+    trackUpdater.removeMissingTracks();
+    qDebug() << "Found: " << audioFilesCount << " audio files in Rekordbox device " << device
+             << "," << trackUpdater.insertedCount() << "new,"
+             << trackUpdater.updatedCount() << "changed,"
+             << trackUpdater.unchangedCount() << "unchanged,"
+             << trackUpdater.removedCount() << "removed";
 
+    importCache.save(deviceItem);
     transaction.commit();
 
     return devicePath;
@@ -661,7 +706,7 @@ void buildPlaylistTree(
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTreeMap,
         QMap<uint32_t, QMap<uint32_t, uint32_t>>& playlistTrackMap,
         const QString& playlistPath,
-        const QString& device) {
+        const QHash<uint32_t, int>& trackIdsByRbId) {
     for (uint32_t childIndex = 0;
             childIndex < (uint32_t)playlistTreeMap[parentID].size();
             childIndex++) {
@@ -719,23 +764,7 @@ void buildPlaylistTree(
                     trackIndex++) {
                 uint32_t rbTrackID = playlistTrackMap[childID][trackIndex];
 
-                int trackID = -1;
-                QSqlQuery finderQuery(database);
-                finderQuery.prepare("select id from " + kRekordboxLibraryTable +
-                        " where rb_id=:rb_id and device=:device");
-                finderQuery.bindValue(":rb_id", rbTrackID);
-                finderQuery.bindValue(":device", device);
-
-                if (!finderQuery.exec()) {
-                    LOG_FAILED_QUERY(finderQuery)
-                            << "rbTrackID:" << rbTrackID
-                            << "device:" << device;
-                    return;
-                }
-
-                if (finderQuery.next()) {
-                    trackID = finderQuery.value(finderQuery.record().indexOf("id")).toInt();
-                }
+                const int trackID = trackIdsByRbId.value(rbTrackID, -1);
 
                 queryInsertIntoPlaylistTracks.bindValue(":playlist_id", playlistID);
                 queryInsertIntoPlaylistTracks.bindValue(":track_id", trackID);
@@ -762,19 +791,43 @@ void buildPlaylistTree(
                     playlistTreeMap,
                     playlistTrackMap,
                     currentPath,
-                    device);
+                    trackIdsByRbId);
         }
     }
 }
 
-void clearDeviceTables(QSqlDatabase& database, TreeItem* child) {
-    ScopedTransaction transaction(database);
+// Deletes the playlists of a device before it is imported again. This
+// includes the playlists of a previous mount point of the device.
+void clearDevicePlaylists(QSqlDatabase& database,
+        const QString& device,
+        const QString& devicePath) {
+    QSet<int> playlistIDs;
 
-    int trackID = -1;
-    int playlistID = kInvalidPlaylistId;
-    QSqlQuery tracksQuery(database);
-    tracksQuery.prepare("select id from " + kRekordboxLibraryTable + " where device=:device");
-    tracksQuery.bindValue(":device", child->getLabel());
+    QSqlQuery playlistsQuery(database);
+    playlistsQuery.prepare("select id, name from " + kRekordboxPlaylistsTable);
+    if (!playlistsQuery.exec()) {
+        LOG_FAILED_QUERY(playlistsQuery);
+    }
+    const QString playlistPathPrefix = devicePath + kPLaylistPathDelimiter;
+    while (playlistsQuery.next()) {
+        const QString name = playlistsQuery.value(1).toString();
+        if (name == devicePath || name.startsWith(playlistPathPrefix)) {
+            playlistIDs.insert(playlistsQuery.value(0).toInt());
+        }
+    }
+
+    QSqlQuery playlistTracksQuery(database);
+    playlistTracksQuery.prepare("select distinct playlist_id from " +
+            kRekordboxPlaylistTracksTable + " where track_id in (select id from " +
+            kRekordboxLibraryTable + " where device=:device)");
+    playlistTracksQuery.bindValue(":device", device);
+    if (!playlistTracksQuery.exec()) {
+        LOG_FAILED_QUERY(playlistTracksQuery)
+                << "device:" << device;
+    }
+    while (playlistTracksQuery.next()) {
+        playlistIDs.insert(playlistTracksQuery.value(0).toInt());
+    }
 
     QSqlQuery deletePlaylistsQuery(database);
     deletePlaylistsQuery.prepare("delete from " + kRekordboxPlaylistsTable + " where id=:id");
@@ -783,56 +836,19 @@ void clearDeviceTables(QSqlDatabase& database, TreeItem* child) {
     deletePlaylistTracksQuery.prepare("delete from " +
             kRekordboxPlaylistTracksTable + " where playlist_id=:playlist_id");
 
-    if (!tracksQuery.exec()) {
-        LOG_FAILED_QUERY(tracksQuery)
-                << "device:" << child->getLabel();
-    }
-
-    while (tracksQuery.next()) {
-        trackID = tracksQuery.value(tracksQuery.record().indexOf("id")).toInt();
-
-        QSqlQuery playlistTracksQuery(database);
-        playlistTracksQuery.prepare("select playlist_id from " +
-                kRekordboxPlaylistTracksTable + " where track_id=:track_id");
-        playlistTracksQuery.bindValue(":track_id", trackID);
-
-        if (!playlistTracksQuery.exec()) {
-            LOG_FAILED_QUERY(playlistTracksQuery)
-                    << "trackID:" << trackID;
+    for (const int playlistID : std::as_const(playlistIDs)) {
+        deletePlaylistTracksQuery.bindValue(":playlist_id", playlistID);
+        if (!deletePlaylistTracksQuery.exec()) {
+            LOG_FAILED_QUERY(deletePlaylistTracksQuery)
+                    << "playlistID:" << playlistID;
         }
 
-        while (playlistTracksQuery.next()) {
-            playlistID = playlistTracksQuery
-                                 .value(playlistTracksQuery.record().indexOf(
-                                         "playlist_id"))
-                                 .toInt();
-
-            deletePlaylistsQuery.bindValue(":id", playlistID);
-
-            if (!deletePlaylistsQuery.exec()) {
-                LOG_FAILED_QUERY(deletePlaylistsQuery)
-                        << "playlistID:" << playlistID;
-            }
-
-            deletePlaylistTracksQuery.bindValue(":playlist_id", playlistID);
-
-            if (!deletePlaylistTracksQuery.exec()) {
-                LOG_FAILED_QUERY(deletePlaylistTracksQuery)
-                        << "playlistID:" << playlistID;
-            }
+        deletePlaylistsQuery.bindValue(":id", playlistID);
+        if (!deletePlaylistsQuery.exec()) {
+            LOG_FAILED_QUERY(deletePlaylistsQuery)
+                    << "playlistID:" << playlistID;
         }
     }
-
-    QSqlQuery deleteTracksQuery(database);
-    deleteTracksQuery.prepare("delete from " + kRekordboxLibraryTable + " where device=:device");
-    deleteTracksQuery.bindValue(":device", child->getLabel());
-
-    if (!deleteTracksQuery.exec()) {
-        LOG_FAILED_QUERY(deleteTracksQuery)
-                << "device:" << child->getLabel();
-    }
-
-    transaction.commit();
 }
 
 void setMemoryCue(TrackPointer track,
@@ -1388,17 +1404,7 @@ RekordboxFeature::RekordboxFeature(
     m_title = tr("Rekordbox");
 
     QSqlDatabase database = m_pTrackCollection->database();
-    ScopedTransaction transaction(database);
-    // Drop any leftover temporary Rekordbox database tables if they exist
-    dropTable(database, kRekordboxPlaylistTracksTable);
-    dropTable(database, kRekordboxPlaylistsTable);
-    dropTable(database, kRekordboxLibraryTable);
-
-    // Create new temporary Rekordbox database tables
-    createLibraryTable(database, kRekordboxLibraryTable);
-    createPlaylistsTable(database, kRekordboxPlaylistsTable);
-    createPlaylistTracksTable(database, kRekordboxPlaylistTracksTable);
-    transaction.commit();
+    createTables(database);
 
     connect(&m_devicesFutureWatcher,
             &QFutureWatcher<QList<TreeItem*>>::finished,
@@ -1415,14 +1421,6 @@ RekordboxFeature::RekordboxFeature(
 RekordboxFeature::~RekordboxFeature() {
     m_devicesFuture.waitForFinished();
     m_tracksFuture.waitForFinished();
-
-    // Drop temporary Rekordbox database tables on shutdown
-    QSqlDatabase database = m_pTrackCollection->database();
-    ScopedTransaction transaction(database);
-    dropTable(database, kRekordboxPlaylistTracksTable);
-    dropTable(database, kRekordboxPlaylistsTable);
-    dropTable(database, kRekordboxLibraryTable);
-    transaction.commit();
 }
 
 void RekordboxFeature::bindLibraryWidget(WLibrary* pLibraryWidget,
@@ -1580,23 +1578,11 @@ void RekordboxFeature::onRekordboxDevicesFound() {
     clearLastRightClickedIndex();
 
     TreeItem* root = m_pSidebarModel->getRootItem();
-    QSqlDatabase database = m_pTrackCollection->database();
 
+    // The tables of unmounted devices are kept to reuse them when the
+    // device is mounted again
     if (foundDevices.size() == 0) {
         // No Rekordbox devices found
-        ScopedTransaction transaction(database);
-
-        dropTable(database, kRekordboxPlaylistTracksTable);
-        dropTable(database, kRekordboxPlaylistsTable);
-        dropTable(database, kRekordboxLibraryTable);
-
-        // Create new temporary Rekordbox database tables
-        createLibraryTable(database, kRekordboxLibraryTable);
-        createPlaylistsTable(database, kRekordboxPlaylistsTable);
-        createPlaylistTracksTable(database, kRekordboxPlaylistTracksTable);
-
-        transaction.commit();
-
         if (root->childRows() > 0) {
             // Devices have since been unmounted
             m_pSidebarModel->removeRows(0, root->childRows());
@@ -1614,9 +1600,7 @@ void RekordboxFeature::onRekordboxDevicesFound() {
             }
 
             if (removeChild) {
-                // Device has since been unmounted, cleanup DB
-                clearDeviceTables(database, child);
-
+                // Device has since been unmounted
                 m_pSidebarModel->removeRows(deviceIndex, 1);
             }
         }
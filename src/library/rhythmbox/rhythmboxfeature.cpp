@@ -9,6 +9,7 @@
 
 #include "library/baseexternalplaylistmodel.h"
 #include "library/baseexternaltrackmodel.h"
+#include "library/externallibraryimportcache.h"
 #include "library/library.h"
 #include "library/queryutil.h"
 #include "library/trackcollection.h"
@@ -16,6 +17,23 @@
 #include "library/treeitem.h"
 #include "moc_rhythmboxfeature.cpp"
 
+namespace {
+
+// Returns the path of a file in the data folder of Rhythmbox or an empty
+// string if it does not exist
+QString findRhythmboxFile(const QString& fileName) {
+    for (const auto& folder : {QStringLiteral("/.gnome2/rhythmbox/"),
+                 QStringLiteral("/.local/share/rhythmbox/")}) {
+        const QString filePath = QDir::homePath() + folder + fileName;
+        if (QFile::exists(filePath)) {
+            return filePath;
+        }
+    }
+    return QString();
+}
+
+} // anonymous namespace
+
 RhythmboxFeature::RhythmboxFeature(Library* pLibrary, UserSettingsPointer pConfig)
         : BaseExternalLibraryFeature(pLibrary, pConfig, QStringLiteral("rhythmbox")),
           m_pSidebarModel(make_parented<TreeItemModel>(this)),
@@ -112,8 +130,7 @@ RhythmboxFeature::createPlaylistModelForPlaylist(const QVariant& playlist_name)
 }
 
 bool RhythmboxFeature::isSupported() {
-    return (QFile::exists(QDir::homePath() + "/.gnome2/rhythmbox/rhythmdb.xml") ||
-            QFile::exists(QDir::homePath() + "/.local/share/rhythmbox/rhythmdb.xml"));
+    return !findRhythmboxFile(QStringLiteral("rhythmdb.xml")).isEmpty();
 }
 
 QVariant RhythmboxFeature::title() {
@@ -158,12 +175,9 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     qDebug() << "importMusicCollection Thread Id: " << QThread::currentThread();
      // Try and open the Rhythmbox DB. An API call which tells us where
      // the file is would be nice.
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/rhythmdb.xml");
-    if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/rhythmdb.xml");
-        if (!db.exists()) {
-            return nullptr;
-        }
+    QFile db(findRhythmboxFile(QStringLiteral("rhythmdb.xml")));
+    if (db.fileName().isEmpty()) {
+        return nullptr;
     }
 
     mixxx::FileInfo fileInfo(db);
@@ -173,21 +187,46 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
         return nullptr;
     }
 
-    //Delete all table entries of Traktor feature
+    QStringList sourcePaths = {db.fileName()};
+    const QString playlistsPath = findRhythmboxFile(QStringLiteral("playlists.xml"));
+    if (!playlistsPath.isEmpty()) {
+        sourcePaths.append(playlistsPath);
+    }
+
+    // The tracks and playlists are imported within a single transaction
     ScopedTransaction transaction(m_database);
+    ExternalLibraryImportCache importCache(
+            m_database, QStringLiteral("rhythmbox"), sourcePaths);
+    if (importCache.isUpToDate()) {
+        std::unique_ptr<TreeItem> cachedRoot = TreeItem::newRoot(this);
+        if (importCache.restorePlaylistTree(cachedRoot.get())) {
+            transaction.commit();
+            qDebug() << "Rhythmbox music collection is unchanged, reusing the last import";
+            return cachedRoot.release();
+        }
+    }
+
+    // Only the playlists are rebuilt, the tracks are updated incrementally
     clearTable("rhythmbox_playlist_tracks");
-    clearTable("rhythmbox_library");
     clearTable("rhythmbox_playlists");
-    transaction.commit();
-
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO rhythmbox_library (artist, title, album, year, "
-                  "genre, comment, tracknumber, bpm, bitrate,"
-                  "duration, location, rating ) "
-                  "VALUES (:artist, :title, :album, :year, :genre, :comment, "
-                  ":tracknumber, :bpm, :bitrate, :duration, :location, :rating )");
-
+    ExternalTrackTableUpdater trackUpdater(m_database,
+            QStringLiteral("rhythmbox_library"),
+            QStringLiteral("location"),
+            {"artist",
+                    "title",
+                    "album",
+                    "year",
+                    "genre",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate",
+                    "duration",
+                    "location",
+                    "rating"});
+    if (!trackUpdater.begin()) {
+        return nullptr;
+    }
 
     QXmlStreamReader xml(&db);
     while (!xml.atEnd() && !m_cancelImport) {
@@ -196,11 +235,10 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
             QXmlStreamAttributes attr = xml.attributes();
             //Check if we really parse a track and not album art information
             if (attr.value("type").toString() == "song") {
-                importTrack(xml, query);
+                importTrack(xml, &trackUpdater);
             }
         }
     }
-    transaction.commit();
 
     if (xml.hasError()) {
         // do error handling
@@ -213,17 +251,31 @@ TreeItem* RhythmboxFeature::importMusicCollection() {
     if (m_cancelImport) {
         return nullptr;
     }
-    return importPlaylists();
+    trackUpdater.removeMissingTracks();
+    qDebug() << "Rhythmbox tracks:"
+             << trackUpdater.insertedCount() << "new,"
+             << trackUpdater.updatedCount() << "changed,"
+             << trackUpdater.unchangedCount() << "unchanged,"
+             << trackUpdater.removedCount() << "removed";
+
+    std::unique_ptr<TreeItem> rootItem;
+    if (!playlistsPath.isEmpty()) {
+        rootItem.reset(importPlaylists(playlistsPath, trackUpdater));
+    }
+    if (m_cancelImport) {
+        return nullptr;
+    }
+    if (rootItem) {
+        importCache.save(rootItem.get());
+    }
+    // Keep the imported tracks even if the playlists could not be imported
+    transaction.commit();
+    return rootItem.release();
 }
 
-TreeItem* RhythmboxFeature::importPlaylists() {
-    QFile db(QDir::homePath() + "/.gnome2/rhythmbox/playlists.xml");
-    if (!db.exists()) {
-        db.setFileName(QDir::homePath() + "/.local/share/rhythmbox/playlists.xml");
-        if (!db.exists()) {
-            return nullptr;
-        }
-    }
+TreeItem* RhythmboxFeature::importPlaylists(const QString& playlistsPath,
+        const ExternalTrackTableUpdater& trackUpdater) {
+    QFile db(playlistsPath);
     //Open file
     if (!db.open(QIODevice::ReadOnly)) {
         return nullptr;
@@ -268,9 +320,7 @@ TreeItem* RhythmboxFeature::importPlaylists() {
                 int playlist_id = query_insert_to_playlists.lastInsertId().toInt();
 
                 //Process playlist entries
-                ScopedTransaction transaction(m_database);
-                importPlaylist(xml, query_insert_to_playlist_tracks, playlist_id);
-                transaction.commit();
+                importPlaylist(xml, query_insert_to_playlist_tracks, playlist_id, trackUpdater);
             }
         }
     }
@@ -286,7 +336,7 @@ TreeItem* RhythmboxFeature::importPlaylists() {
     return rootItem.release();
 }
 
-void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void RhythmboxFeature::importTrack(QXmlStreamReader& xml, ExternalTrackTableUpdater* pUpdater) {
     QString title;
     QString artist;
     QString album;
@@ -362,32 +412,25 @@ void RhythmboxFeature::importTrack(QXmlStreamReader &xml, QSqlQuery &query) {
         return;
     }
 
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-
-    if (!success) {
-        qDebug() << "SQL Error in rhythmboxfeature.cpp: line" << __LINE__
-                 << " " << query.lastError();
-        return;
-    }
+    pUpdater->importTrack({artist,
+            title,
+            album,
+            year,
+            genre,
+            comment,
+            tracknumber,
+            bpm,
+            bitrate,
+            playtime,
+            location,
+            rating});
 }
 
 // reads all playlist entries and executes a SQL statement
-void RhythmboxFeature::importPlaylist(QXmlStreamReader &xml,
-                                      QSqlQuery &query_insert_to_playlist_tracks,
-                                      int playlist_id) {
+void RhythmboxFeature::importPlaylist(QXmlStreamReader& xml,
+        QSqlQuery& query_insert_to_playlist_tracks,
+        int playlist_id,
+        const ExternalTrackTableUpdater& trackUpdater) {
     int playlist_position = 1;
     while (!xml.atEnd()) {
         //read next XML element
@@ -396,28 +439,12 @@ void RhythmboxFeature::importPlaylist(QXmlStreamReader &xml,
             const auto fileInfo = mixxx::FileInfo::fromQUrl(xml.readElementText());
 
             //get the ID of the file in the rhythmbox_library table
-            int track_id = -1;
-            QSqlQuery finder_query(m_database);
-            finder_query.prepare("select id from rhythmbox_library where location=:path");
-            finder_query.bindValue(":path", fileInfo.location());
-            bool success = finder_query.exec();
-
-            if (success) {
-                const int idColumn = finder_query.record().indexOf("id");
-                while (finder_query.next()) {
-                    track_id = finder_query.value(idColumn).toInt();
-                }
-             } else {
-                qDebug() << "SQL Error in RhythmboxFeature.cpp: line"
-                         << __LINE__ << " " << finder_query.lastError();
-            }
+            const int track_id = trackUpdater.trackId(fileInfo.location());
 
             query_insert_to_playlist_tracks.bindValue(":playlist_id", playlist_id);
             query_insert_to_playlist_tracks.bindValue(":track_id", track_id);
             query_insert_to_playlist_tracks.bindValue(":position", playlist_position++);
-            success = query_insert_to_playlist_tracks.exec();
-
-            if (!success) {
+            if (!query_insert_to_playlist_tracks.exec()) {
                 qDebug() << "SQL Error in RhythmboxFeature.cpp: line" << __LINE__ << " "
                          << query_insert_to_playlist_tracks.lastError()
                          << "trackid" << track_id
@@ -10,6 +10,7 @@ class BaseExternalTrackModel;
 class BaseExternalPlaylistModel;
 class QXmlStreamReader;
 class BaseTrackCache;
+class ExternalTrackTableUpdater;
 
 class RhythmboxFeature : public BaseExternalLibraryFeature {
     Q_OBJECT
@@ -24,7 +25,8 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     // processes the music collection
     TreeItem* importMusicCollection();
     // processes the playlist entries
-    TreeItem* importPlaylists();
+    TreeItem* importPlaylists(const QString& playlistsPath,
+            const ExternalTrackTableUpdater& trackUpdater);
 
   public slots:
     void activate() override;
@@ -39,9 +41,12 @@ class RhythmboxFeature : public BaseExternalLibraryFeature {
     // Removes all rows from a given table
     void clearTable(const QString& table_name);
     // reads the properties of a track and executes a SQL statement
-    void importTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void importTrack(QXmlStreamReader& xml, ExternalTrackTableUpdater* pUpdater);
     // reads all playlist entries and executes a SQL statement
-    void importPlaylist(QXmlStreamReader &xml, QSqlQuery &query, int playlist_id);
+    void importPlaylist(QXmlStreamReader& xml,
+            QSqlQuery& query,
+            int playlist_id,
+            const ExternalTrackTableUpdater& trackUpdater);
 
     BaseExternalTrackModel* m_pRhythmboxTrackModel;
     BaseExternalPlaylistModel* m_pRhythmboxPlaylistModel;
@@ -10,14 +10,16 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
         const mixxx::cache_key_t newHash,
         const std::list<QFileInfo>& filesToImport,
         const std::list<QFileInfo>& possibleCovers,
-        SecurityTokenPointer pToken)
+        SecurityTokenPointer pToken,
+        std::optional<DirectoryJournalEntry> journalEntry)
         : ScannerTask(pScanner, scannerGlobal),
           m_dirPath(dirPath),
           m_prevHashExists(prevHashExists),
           m_newHash(newHash),
           m_filesToImport(filesToImport),
           m_possibleCovers(possibleCovers),
-          m_pToken(pToken) {
+          m_pToken(pToken),
+          m_journalEntry(std::move(journalEntry)) {
 }
 
 void ImportFilesTask::run() {
@@ -54,5 +56,12 @@ void ImportFilesTask::run() {
     }
     // Insert or update the hash in the database.
     emit directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash);
+    // Only journal the directory after all files have been imported
+    if (m_journalEntry) {
+        emit directoryJournaled(m_dirPath,
+                m_journalEntry->modifiedNs,
+                m_journalEntry->inode,
+                m_journalEntry->subdirectories);
+    }
     setSuccess(true);
 }
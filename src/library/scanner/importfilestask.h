@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QFileInfo>
+#include <optional>
 
 #include "util/sandbox.h"
 #include "library/scanner/scannertask.h"
@@ -17,7 +18,8 @@ class ImportFilesTask : public ScannerTask {
             const mixxx::cache_key_t newHash,
             const std::list<QFileInfo>& filesToImport,
             const std::list<QFileInfo>& possibleCovers,
-            SecurityTokenPointer pToken);
+            SecurityTokenPointer pToken,
+            std::optional<DirectoryJournalEntry> journalEntry = std::nullopt);
     virtual ~ImportFilesTask() {}
 
     virtual void run();
@@ -29,4 +31,5 @@ class ImportFilesTask : public ScannerTask {
     const std::list<QFileInfo> m_filesToImport;
     const std::list<QFileInfo> m_possibleCovers;
     SecurityTokenPointer m_pToken;
+    const std::optional<DirectoryJournalEntry> m_journalEntry;
 };
@@ -1,7 +1,9 @@
 #include "library/scanner/libraryscanner.h"
 
 #include "library/coverartutils.h"
+#include "library/dao/settingsdao.h"
 #include "library/library_decl.h"
+#include "library/library_prefs.h"
 #include "library/queryutil.h"
 #include "library/scanner/libraryscannerdlg.h"
 #include "library/scanner/recursivescandirectorytask.h"
@@ -25,6 +27,16 @@ constexpr int kScannerThreadPoolSize = 1;
 
 mixxx::Logger kLogger("LibraryScanner");
 
+// The number of new tracks after which the transaction of the scan is
+// committed at the next directory boundary.
+constexpr int kAddTracksBatchSize = 1000;
+
+// The supported file types when the directory journal has been written.
+// Directories that are unchanged according to the journal might contain
+// files that have not been supported before.
+const QString kJournalFileNamesRegexSettingsKey =
+        QStringLiteral("mixxx.library.scanner.journal_file_names_regex");
+
 QAtomicInt s_instanceCounter(0);
 
 // Returns the number of affected rows or -1 on error
@@ -99,10 +111,14 @@ LibraryScanner::LibraryScanner(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pConfig(pConfig),
           m_analysisDao(pConfig),
           m_trackDao(m_cueDao, m_playlistDao, m_analysisDao, m_libraryHashDao, pConfig),
           m_stateSema(1), // only one transaction is possible at a time
           m_state(IDLE),
+          m_numPreviouslyExistingTracks(0),
+          m_numRelocatedTracks(0),
+          m_numTracksAddedSinceCommit(0),
           m_manualScan(true) {
     // Move LibraryScanner to its own thread so that our signals/slots will
     // queue to our event loop.
@@ -211,10 +227,15 @@ void LibraryScanner::slotStartScan() {
                     QRegularExpression::CaseInsensitiveOption);
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
     m_numRelocatedTracks = 0;
+    m_numTracksAddedSinceCommit = 0;
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                              coverExtensionFilter, directoryBlacklist));
+            new ScannerGlobal(trackLocations,
+                    directoryHashes,
+                    loadDirectoryJournal(),
+                    extensionFilter,
+                    coverExtensionFilter,
+                    directoryBlacklist));
 
     m_scannerGlobal->startTimer();
 
@@ -274,6 +295,23 @@ void LibraryScanner::slotStartScan() {
     pWatcher->taskDone();
 }
 
+QHash<QString, DirectoryJournalEntry> LibraryScanner::loadDirectoryJournal() {
+    SettingsDAO settings(m_libraryHashDao.database());
+    const QString fileNamesRegex = SoundSourceProxy::getSupportedFileNamesRegex();
+    if (settings.getValue(kJournalFileNamesRegexSettingsKey) != fileNamesRegex) {
+        // All directories need to be listed again
+        kLogger.info() << "Supported file types have changed, discarding directory journal";
+        m_libraryHashDao.clearDirectoryJournal();
+        settings.setValue(kJournalFileNamesRegexSettingsKey, fileNamesRegex);
+        return {};
+    }
+    if (!m_pConfig->getValue(mixxx::library::prefs::kIncrementalRescanConfigKey, true)) {
+        // The journal is still updated for subsequent incremental scans
+        return {};
+    }
+    return m_libraryHashDao.getDirectoryJournal();
+}
+
 // is called when all tasks of the first stage are done (threads are finished)
 void LibraryScanner::slotFinishHashedScan() {
     kLogger.debug() << "slotFinishHashedScan";
@@ -384,6 +422,8 @@ void LibraryScanner::cleanUpScan() {
     // songs if you move a set of songs from directory A to B, then back to
     // A.
     m_libraryHashDao.removeDeletedDirectoryHashes();
+    m_libraryHashDao.removeDirectoryJournalEntries(
+            m_scannerGlobal->unvisitedJournalDirectories());
 
     transaction.commit();
 
@@ -566,6 +606,10 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             &ScannerTask::directoryUnchanged,
             this,
             &LibraryScanner::slotDirectoryUnchanged);
+    connect(pTask,
+            &ScannerTask::directoryJournaled,
+            this,
+            &LibraryScanner::slotDirectoryJournaled);
     connect(pTask,
             &ScannerTask::trackExists,
             this,
@@ -606,6 +650,11 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
     } else {
         m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
     }
+    // Commit in batches after all tracks of the directory have been added
+    if (m_numTracksAddedSinceCommit >= kAddTracksBatchSize) {
+        m_trackDao.addTracksCommit();
+        m_numTracksAddedSinceCommit = 0;
+    }
     emit progressHashing(directoryPath);
 }
 
@@ -618,6 +667,20 @@ void LibraryScanner::slotDirectoryUnchanged(const QString& directoryPath) {
     emit progressHashing(directoryPath);
 }
 
+void LibraryScanner::slotDirectoryJournaled(const QString& directoryPath,
+        qint64 modifiedNs,
+        qint64 inode,
+        const QStringList& subdirectories) {
+    ScopedTimer timer(QStringLiteral("LibraryScanner::slotDirectoryJournaled"));
+    if (!m_scannerGlobal || m_scannerGlobal->shouldCancel()) {
+        // The tracks of the directory might not have been added
+        return;
+    }
+    m_scannerGlobal->addJournaledDirectory(directoryPath);
+    m_libraryHashDao.saveDirectoryJournalEntry(directoryPath,
+            DirectoryJournalEntry{modifiedNs, inode, subdirectories});
+}
+
 void LibraryScanner::slotTrackExists(const QString& trackPath) {
     //kLogger.debug() << "slotTrackExists" << trackPath;
     ScopedTimer timer(QStringLiteral("LibraryScanner::slotTrackExists"));
@@ -659,6 +722,7 @@ void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
     if (m_scannerGlobal) {
         m_scannerGlobal->trackAdded(trackLocation);
     }
+    ++m_numTracksAddedSinceCommit;
     // Signal the main instance of TrackDAO, that there is
     // a new track in the database.
     emit trackAdded(pTrack);
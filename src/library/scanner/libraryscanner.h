@@ -73,6 +73,10 @@ class LibraryScanner : public QThread {
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
                                    bool newDirectory, mixxx::cache_key_t hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
+    void slotDirectoryJournaled(const QString& directoryPath,
+            qint64 modifiedNs,
+            qint64 inode,
+            const QStringList& subdirectories);
     void slotTrackExists(const QString& trackPath);
     void slotAddNewTrack(const QString& trackPath);
 
@@ -100,7 +104,10 @@ class LibraryScanner : public QThread {
 
     void cleanUpScan();
 
+    QHash<QString, DirectoryJournalEntry> loadDirectoryJournal();
+
     mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const UserSettingsPointer m_pConfig;
 
     // The pool of threads used for worker tasks.
     QThreadPool m_pool;
@@ -126,6 +133,7 @@ class LibraryScanner : public QThread {
     QSet<QString> m_previouslyMissingTracks;
     int m_numPreviouslyExistingTracks;
     int m_numRelocatedTracks;
+    int m_numTracksAddedSinceCommit;
 
     QList<mixxx::FileInfo> m_libraryRootDirs;
     QScopedPointer<LibraryScannerDlg> m_pProgressDlg;
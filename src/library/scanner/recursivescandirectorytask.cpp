@@ -1,14 +1,26 @@
 #include "library/scanner/recursivescandirectorytask.h"
 
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <optional>
 
 #include "library/scanner/importfilestask.h"
 #include "library/scanner/libraryscanner.h"
+#include "library/scanner/scannerutil.h"
 #include "moc_recursivescandirectorytask.cpp"
 #include "util/timer.h"
 
+namespace {
+
+// Modifications within the resolution of the file system timestamps
+// would not be detected if the directory has been modified very
+// recently. The directory is listed again during the next scan.
+constexpr qint64 kRacyModificationIntervalNs = qint64{2} * 1000 * 1000 * 1000;
+
+} // anonymous namespace
+
 RecursiveScanDirectoryTask::RecursiveScanDirectoryTask(
         LibraryScanner* pScanner,
         const ScannerGlobalPointer& scannerGlobal,
@@ -30,6 +42,35 @@ void RecursiveScanDirectoryTask::run() {
     //qDebug() << "Burn CPU";
     //for (int i = 0;i < 1000000000; i++) asm("nop");
 
+    const QString dirLocation = m_dirAccess.info().location();
+
+    // The directory must be stat'ed before listing it. Otherwise
+    // modifications in between would not be detected by the next scan.
+    qint64 modifiedNs = 0;
+    qint64 inode = 0;
+    std::optional<DirectoryJournalEntry> journalEntry;
+    if (ScannerUtil::statDirectory(dirLocation, &modifiedNs, &inode)) {
+        const DirectoryJournalEntry* pPrevEntry =
+                m_scannerGlobal->directoryJournalEntry(dirLocation);
+        if (pPrevEntry && pPrevEntry->modifiedNs == modifiedNs &&
+                pPrevEntry->inode == inode) {
+            // No entries have been added, removed, or renamed since the
+            // last scan, i.e. neither the hash nor the subdirectories
+            // have changed.
+            emit directoryUnchanged(dirLocation);
+            const auto dir = m_dirAccess.info().toQDir();
+            for (const auto& subdirName : pPrevEntry->subdirectories) {
+                scanSubdirectory(mixxx::FileInfo(dir, subdirName));
+            }
+            setSuccess(true);
+            return;
+        }
+        const qint64 nowNs = QDateTime::currentMSecsSinceEpoch() * 1000 * 1000;
+        if (nowNs - modifiedNs > kRacyModificationIntervalNs) {
+            journalEntry = DirectoryJournalEntry{modifiedNs, inode, QStringList()};
+        }
+    }
+
     // Note, we save on filesystem operations (and random work) by initializing
     // a QDirIterator with a QDir instead of a QString -- but it inherits its
     // Filter from the QDir so we have to set it first. If the QDir has not done
@@ -72,10 +113,8 @@ void RecursiveScanDirectoryTask::run() {
             }
         } else {
             // File is a directory
-            if (m_scannerGlobal->directoryBlacklisted(currentFile)) {
-                // Skip blacklisted directories like the iTunes Album
-                // Art Folder since it is probably a waste of time.
-                continue;
+            if (journalEntry) {
+                journalEntry->subdirectories.append(currentFileInfo.fileName());
             }
             dirsToScan.push_back(mixxx::FileInfo(std::move(currentFileInfo)));
         }
@@ -84,8 +123,6 @@ void RecursiveScanDirectoryTask::run() {
     // Calculate a hash of the directory's file list.
     const mixxx::cache_key_t newHash = mixxx::cacheKeyFromMessageDigest(hasher.result());
 
-    QString dirLocation = m_dirAccess.info().location();
-
     // Try to retrieve a hash from the last time that directory was scanned.
     const mixxx::cache_key_t prevHash = m_scannerGlobal->directoryHashInDatabase(dirLocation);
     const bool prevHashExists = mixxx::isValidCacheKey(prevHash);
@@ -104,30 +141,53 @@ void RecursiveScanDirectoryTask::run() {
                         newHash,
                         filesToImport,
                         possibleCovers,
-                        m_dirAccess.token()));
+                        m_dirAccess.token(),
+                        std::move(journalEntry)));
             } else {
                 emit directoryHashedAndScanned(dirLocation, !prevHashExists, newHash);
+                if (journalEntry) {
+                    emit directoryJournaled(dirLocation,
+                            journalEntry->modifiedNs,
+                            journalEntry->inode,
+                            journalEntry->subdirectories);
+                }
             }
         } else {
             emit directoryUnchanged(dirLocation);
+            if (journalEntry) {
+                emit directoryJournaled(dirLocation,
+                        journalEntry->modifiedNs,
+                        journalEntry->inode,
+                        journalEntry->subdirectories);
+            }
         }
     } else {
+        // Journaled when scanned again in the second stage
         m_scannerGlobal->addUnhashedDir(m_dirAccess);
     }
 
     // Process all of the sub-directories.
     for (const mixxx::FileInfo& dirInfo : dirsToScan) {
-        // Atomically test and mark the directory as scanned to avoid
-        // that the same directory is scanned multiple times by different
-        // tasks.
-        if (!m_scannerGlobal->testAndMarkDirectoryScanned(dirInfo.toQDir())) {
-            m_pScanner->queueTask(
-                    new RecursiveScanDirectoryTask(
-                            m_pScanner,
-                            m_scannerGlobal,
-                            mixxx::FileAccess(dirInfo, m_dirAccess.token()),
-                            m_scanUnhashed));
-        }
+        scanSubdirectory(dirInfo);
     }
     setSuccess(true);
 }
+
+void RecursiveScanDirectoryTask::scanSubdirectory(const mixxx::FileInfo& dirInfo) {
+    if (m_scannerGlobal->directoryBlacklisted(dirInfo.asQFileInfo().filePath())) {
+        // Skip blacklisted directories like the iTunes Album
+        // Art Folder since it is probably a waste of time.
+        return;
+    }
+    // Atomically test and mark the directory as scanned to avoid
+    // that the same directory is scanned multiple times by different
+    // tasks.
+    if (!m_scannerGlobal->testAndMarkDirectoryScanned(dirInfo.toQDir())) {
+        m_pScanner->queueTask(
+                new RecursiveScanDirectoryTask(
+                        m_pScanner,
+                        m_scannerGlobal,
+                        mixxx::FileAccess(dirInfo, m_dirAccess.token()),
+                        m_scanUnhashed));
+    }
+}
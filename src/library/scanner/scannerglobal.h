@@ -8,6 +8,7 @@
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "library/dao/libraryhashdao.h"
 #include "util/cache.h"
 #include "util/compatibility/qmutex.h"
 #include "util/fileaccess.h"
@@ -18,11 +19,13 @@ class ScannerGlobal {
   public:
     ScannerGlobal(const QSet<QString>& trackLocations,
             const QHash<QString, mixxx::cache_key_t>& directoryHashes,
+            const QHash<QString, DirectoryJournalEntry>& directoryJournal,
             const QRegularExpression& supportedExtensionsMatcher,
             const QRegularExpression& supportedCoverExtensionsMatcher,
             const QStringList& directoriesBlacklist)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
+              m_directoryJournal(directoryJournal),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
@@ -47,6 +50,16 @@ class ScannerGlobal {
         return m_directoryHashes.value(directoryPath, mixxx::invalidCacheKey());
     }
 
+    // Returns the journal entry of the last scan or nullptr if the directory
+    // has not been journaled. The journal is not modified during a scan.
+    const DirectoryJournalEntry* directoryJournalEntry(const QString& directoryPath) const {
+        const auto it = m_directoryJournal.constFind(directoryPath);
+        if (it == m_directoryJournal.constEnd()) {
+            return nullptr;
+        }
+        return &it.value();
+    }
+
     bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -123,6 +136,30 @@ class ScannerGlobal {
         return m_verifiedDirectories;
     }
 
+    void addJournaledDirectory(const QString& directory) {
+        m_journaledDirectories << directory;
+    }
+
+    // Journal entries of directories that have neither been verified
+    // nor journaled again by the scan, i.e. that have been deleted or
+    // are no longer part of the library.
+    QStringList unvisitedJournalDirectories() const {
+        QSet<QString> visitedDirectories;
+        for (const auto& directory : m_verifiedDirectories) {
+            visitedDirectories.insert(directory);
+        }
+        for (const auto& directory : m_journaledDirectories) {
+            visitedDirectories.insert(directory);
+        }
+        QStringList unvisitedDirectories;
+        for (auto it = m_directoryJournal.constBegin(); it != m_directoryJournal.constEnd(); ++it) {
+            if (!visitedDirectories.contains(it.key())) {
+                unvisitedDirectories << it.key();
+            }
+        }
+        return unvisitedDirectories;
+    }
+
     void addVerifiedTrack(const QString& trackLocation) {
         m_verifiedTracks << trackLocation;
     }
@@ -166,6 +203,7 @@ class ScannerGlobal {
 
     QSet<QString> m_trackLocations;
     QHash<QString, mixxx::cache_key_t> m_directoryHashes;
+    const QHash<QString, DirectoryJournalEntry> m_directoryJournal;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
     QRegularExpression m_supportedExtensionsMatcher;
@@ -193,6 +231,9 @@ class ScannerGlobal {
     // The list of directories verified by the scan.
     QStringList m_verifiedDirectories;
 
+    // The list of directories that have been listed and journaled by the scan.
+    QStringList m_journaledDirectories;
+
     // The list of tracks verified by the scan.
     QStringList m_verifiedTracks;
 
@@ -22,6 +22,10 @@ class ScannerTask : public QObject, public QRunnable {
     void directoryHashedAndScanned(const QString& directoryPath,
                                    bool newDirectory, mixxx::cache_key_t hash);
     void directoryUnchanged(const QString& directoryPath);
+    void directoryJournaled(const QString& directoryPath,
+            qint64 modifiedNs,
+            qint64 inode,
+            const QStringList& subdirectories);
     void trackExists(const QString& filePath);
     void addNewTrack(const QString& filePath);
 
@@ -0,0 +1,110 @@
+#include "library/scanner/scannerutil.h"
+
+#include <QFile>
+
+#ifndef __WINDOWS__
+#include <sys/stat.h>
+#endif
+#if defined(__LINUX__)
+#include <sys/vfs.h>
+#elif defined(__APPLE__) || defined(__BSD__)
+#include <sys/mount.h>
+#include <sys/param.h>
+#endif
+
+#include "util/assert.h"
+
+namespace {
+
+#ifndef __WINDOWS__
+enum class DirectoryStat {
+    Reliable,
+    // The inode numbers are generated by the client and may change
+    // when the share is mounted again, e.g. for CIFS without the
+    // serverino mount option. The modification time is maintained by
+    // the server.
+    UnstableInode,
+    // The inode numbers are synthesized, e.g. from the position of the
+    // entry on the volume, and the modification time of a directory is
+    // not updated reliably when its entries change
+    Unreliable,
+};
+
+DirectoryStat directoryStatOfFileSystem(const QString& dirPath) {
+#if defined(__LINUX__)
+    struct statfs fsStat;
+    if (::statfs(QFile::encodeName(dirPath).constData(), &fsStat) != 0) {
+        return DirectoryStat::Unreliable;
+    }
+    switch (static_cast<quint32>(fsStat.f_type)) {
+    case 0x6969:     // NFS_SUPER_MAGIC
+    case 0x517B:     // SMB_SUPER_MAGIC
+    case 0xFF534D42: // CIFS_SUPER_MAGIC
+    case 0xFE534D42: // SMB2_SUPER_MAGIC
+        return DirectoryStat::UnstableInode;
+    case 0x4d44:     // MSDOS_SUPER_MAGIC, i.e. FAT
+    case 0x2011BAB0: // EXFAT_SUPER_MAGIC
+    case 0x65735546: // FUSE_SUPER_MAGIC, e.g. NTFS-3G or SSHFS
+        return DirectoryStat::Unreliable;
+    default:
+        return DirectoryStat::Reliable;
+    }
+#elif defined(__APPLE__) || defined(__BSD__)
+    struct statfs fsStat;
+    if (::statfs(QFile::encodeName(dirPath).constData(), &fsStat) != 0) {
+        return DirectoryStat::Unreliable;
+    }
+    const QByteArray fsType(fsStat.f_fstypename);
+    if (fsType == "nfs" || fsType == "smbfs") {
+        return DirectoryStat::UnstableInode;
+    }
+    if (fsType == "msdos" || fsType == "msdosfs" || fsType == "exfat" ||
+            fsType == "afpfs" || fsType == "webdav" || fsType.startsWith("fuse") ||
+            fsType.startsWith("osxfuse") || fsType == "macfuse") {
+        return DirectoryStat::Unreliable;
+    }
+    return DirectoryStat::Reliable;
+#else
+    Q_UNUSED(dirPath);
+    return DirectoryStat::Reliable;
+#endif
+}
+#endif
+
+} // anonymous namespace
+
+// static
+bool ScannerUtil::statDirectory(const QString& dirPath,
+        qint64* pModifiedNs,
+        qint64* pInode) {
+    DEBUG_ASSERT(pModifiedNs);
+    DEBUG_ASSERT(pInode);
+#ifdef __WINDOWS__
+    // The modification time of directories on FAT volumes is not updated
+    // when their entries change
+    Q_UNUSED(dirPath);
+    Q_UNUSED(pModifiedNs);
+    Q_UNUSED(pInode);
+    return false;
+#else
+    const DirectoryStat directoryStat = directoryStatOfFileSystem(dirPath);
+    if (directoryStat == DirectoryStat::Unreliable) {
+        return false;
+    }
+    struct stat dirStat;
+    if (::stat(QFile::encodeName(dirPath).constData(), &dirStat) != 0 ||
+            !S_ISDIR(dirStat.st_mode)) {
+        return false;
+    }
+#ifdef __APPLE__
+    const struct timespec& modified = dirStat.st_mtimespec;
+#else
+    const struct timespec& modified = dirStat.st_mtim;
+#endif
+    *pModifiedNs = static_cast<qint64>(modified.tv_sec) * 1000000000 + modified.tv_nsec;
+    *pInode = directoryStat == DirectoryStat::UnstableInode
+            ? 0
+            : static_cast<qint64>(dirStat.st_ino);
+    return true;
+#endif
+}
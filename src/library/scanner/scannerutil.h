@@ -2,6 +2,7 @@
 
 #include <QDir>
 #include <QStandardPaths>
+#include <QString>
 #include <QStringList>
 
 // Library scanner utility methods.
@@ -27,6 +28,18 @@ class ScannerUtil {
         return blacklist;
     }
 
+    /// Reads the modification time in nanoseconds and the inode number
+    /// of a directory. Both change whenever an entry of the directory is
+    /// added, removed, or renamed. The inode is 0 on NFS and SMB shares,
+    /// where it may change between mounts, i.e. only the path and the
+    /// modification time identify the directory. Returns false if the
+    /// directory cannot be accessed or if its modification time is not
+    /// reliable, i.e. on Windows, on FAT and exFAT, and on FUSE file
+    /// systems.
+    static bool statDirectory(const QString& dirPath,
+            qint64* pModifiedNs,
+            qint64* pInode);
+
   private:
     ScannerUtil() {}
 };
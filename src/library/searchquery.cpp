@@ -4,6 +4,7 @@
 #include <QRegularExpression>
 
 #include "library/dao/trackschema.h"
+#include "library/dao/tracksearchindex.h"
 #include "library/queryutil.h"
 #include "library/trackset/crate/crateschema.h"
 #include "library/trackset/crate/cratestorage.h" // for CrateTrackSelectResult
@@ -231,6 +232,17 @@ QString TextFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+SearchIndexFilterNode::SearchIndexFilterNode(const QSqlDatabase& database,
+        const QStringList& sqlColumns,
+        const QString& argument)
+        : TextFilterNode(database, sqlColumns, argument) {
+    DEBUG_ASSERT(TrackSearchIndex::canMatch(m_sqlColumns, m_argument));
+}
+
+QString SearchIndexFilterNode::toSql() const {
+    return TrackSearchIndex::filterSql(m_database, m_sqlColumns, m_argument);
+}
+
 bool NullOrEmptyTextFilterNode::match(const TrackPointer& pTrack) const {
     if (!m_sqlColumns.isEmpty()) {
         // only use the major column
@@ -86,13 +86,27 @@ class TextFilterNode : public QueryNode {
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
 
-  private:
+  protected:
     QSqlDatabase m_database;
     QStringList m_sqlColumns;
     QString m_argument;
     StringMatch m_matchMode;
 };
 
+/// Matches substrings like TextFilterNode, but looks them up in the
+/// full-text search index of the library instead of scanning all tracks.
+///
+/// Only applicable if TrackSearchIndex::canMatch() returns true for the
+/// columns and the folded argument.
+class SearchIndexFilterNode : public TextFilterNode {
+  public:
+    SearchIndexFilterNode(const QSqlDatabase& database,
+            const QStringList& sqlColumns,
+            const QString& argument);
+
+    QString toSql() const override;
+};
+
 class NullOrEmptyTextFilterNode : public QueryNode {
   public:
     NullOrEmptyTextFilterNode(const QSqlDatabase& database,
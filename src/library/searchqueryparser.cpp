@@ -4,10 +4,12 @@
 #include <memory>
 #include <utility>
 
+#include "library/dao/tracksearchindex.h"
 #include "library/searchquery.h"
 #include "library/trackcollection.h"
 #include "track/keyutils.h"
 #include "util/assert.h"
+#include "util/db/dbconnection.h"
 
 namespace {
 
@@ -69,7 +71,8 @@ const QRegularExpression kSplitOnOrOperatorRegexp = QRegularExpression(
 
 SearchQueryParser::SearchQueryParser(TrackCollection* pTrackCollection, QStringList searchColumns)
         : m_pTrackCollection(pTrackCollection),
-          m_searchCrates(false) {
+          m_searchCrates(false),
+          m_searchIndexEnabled(false) {
     setSearchColumns(std::move(searchColumns));
 
     m_textFilters << "a" << "artist"
@@ -190,6 +193,23 @@ SearchQueryParser::TextArgumentResult SearchQueryParser::getTextArgument(QString
     return {argument, mode};
 }
 
+std::unique_ptr<QueryNode> SearchQueryParser::createSearchTermNode(
+        const QString& argument,
+        bool quoted) const {
+    // Quoted terms are still matched with LIKE
+    if (m_searchIndexEnabled && !quoted &&
+            m_pTrackCollection->getTrackDAO().searchIndex().isAvailable()) {
+        QString foldedArgument = argument;
+        mixxx::DbConnection::makeStringLatinLow(&foldedArgument);
+        if (TrackSearchIndex::canMatch(m_queryColumns, foldedArgument)) {
+            return std::make_unique<SearchIndexFilterNode>(
+                    m_pTrackCollection->database(), m_queryColumns, argument);
+        }
+    }
+    return std::make_unique<TextFilterNode>(
+            m_pTrackCollection->database(), m_queryColumns, argument);
+}
+
 void SearchQueryParser::parseTokens(QStringList tokens,
                                     AndNode* pQuery) const {
     while (tokens.size() > 0) {
@@ -297,6 +317,7 @@ void SearchQueryParser::parseTokens(QStringList tokens,
             }
             // Don't trigger on a lone minus sign.
             if (!token.isEmpty()) {
+                const bool quoted = token.startsWith("\"");
                 QString argument = getTextArgument(token, &tokens).argument;
                 // For untagged strings we search the track fields as well
                 // as the crate names the track is in. This allows the user
@@ -305,12 +326,10 @@ void SearchQueryParser::parseTokens(QStringList tokens,
                     auto gNode = std::make_unique<OrNode>();
                     gNode->addNode(std::make_unique<CrateFilterNode>(
                                     &m_pTrackCollection->crates(), argument));
-                    gNode->addNode(std::make_unique<TextFilterNode>(
-                            m_pTrackCollection->database(), m_queryColumns, argument));
+                    gNode->addNode(createSearchTermNode(argument, quoted));
                     pNode = std::move(gNode);
                 } else {
-                    pNode = std::make_unique<TextFilterNode>(
-                            m_pTrackCollection->database(), m_queryColumns, argument);
+                    pNode = createSearchTermNode(argument, quoted);
                 }
             }
         }
@@ -17,6 +17,13 @@ class SearchQueryParser {
 
     void setSearchColumns(QStringList searchColumns);
 
+    /// Look up unquoted search terms without a field prefix in the
+    /// full-text search index of the library if available. Only
+    /// applicable if the searched table uses library track ids.
+    void setSearchIndexEnabled(bool enabled) {
+        m_searchIndexEnabled = enabled;
+    }
+
     std::unique_ptr<QueryNode> parseQuery(
             const QString& query,
             const QString& extraFilter) const;
@@ -42,9 +49,14 @@ class SearchQueryParser {
             QStringList* tokens,
             bool removeLeadingEqualsSign = true) const;
 
+    std::unique_ptr<QueryNode> createSearchTermNode(
+            const QString& argument,
+            bool quoted) const;
+
     TrackCollection* m_pTrackCollection;
     QStringList m_queryColumns;
     bool m_searchCrates;
+    bool m_searchIndexEnabled;
     QStringList m_textFilters;
     QStringList m_numericFilters;
     QStringList m_specialFilters;
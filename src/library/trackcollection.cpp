@@ -559,7 +559,7 @@ bool TrackCollection::updateAutoDjCrate(
     return updateCrate(crate);
 }
 
-bool TrackCollection::saveTrack(Track* pTrack) const {
+bool TrackCollection::saveTrack(Track* pTrack) {
     DEBUG_ASSERT_QOBJECT_THREAD_AFFINITY(this);
 
     return m_trackDao.saveTrack(pTrack);
@@ -165,7 +165,7 @@ class TrackCollection : public QObject,
     DirectoryDAO::RemoveResult removeDirectory(const mixxx::FileInfo& rootDir);
     DirectoryDAO::RelocateResult relocateDirectory(const QString& oldDir, const QString& newDir);
 
-    bool saveTrack(Track* pTrack) const;
+    bool saveTrack(Track* pTrack);
 
     QSqlDatabase m_database;
 
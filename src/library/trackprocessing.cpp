@@ -2,9 +2,12 @@
 
 #include <QThread>
 
+#include "library/trackcollection.h"
 #include "library/trackcollectionmanager.h"
 #include "moc_trackprocessing.cpp"
+#include "track/track.h"
 #include "util/logger.h"
+#include "util/performancetimer.h"
 
 namespace mixxx {
 
@@ -12,6 +15,11 @@ namespace {
 
 const Logger kLogger("ModalTrackBatchProcessor");
 
+// Modified tracks are saved in batches that are committed when
+// either limit is reached
+constexpr int kSaveBatchMaxTracks = 100;
+constexpr Duration kSaveBatchMaxDuration = Duration::fromMillis(250);
+
 } // anonymous namespace
 
 int ModalTrackBatchProcessor::processTracks(
@@ -35,6 +43,27 @@ int ModalTrackBatchProcessor::processTracks(
             m_minimumProgressDuration,
             this);
     taskMonitor.registerTask(this);
+    // The progress dialog processes events and must not be updated
+    // while the transaction of a batch is pending
+    TrackDAO& trackDao = pTrackCollectionManager->internalCollection()->getTrackDAO();
+    int batchTrackCount = 0;
+    PerformanceTimer batchTimer;
+    QList<TrackPointer> batchSavedTracks;
+    const auto finishBatch = [&trackDao, &batchSavedTracks, &progressLabelText] {
+        if (!trackDao.finishBatchUpdate()) {
+            kLogger.warning()
+                    << progressLabelText
+                    << "failed to save"
+                    << batchSavedTracks.size()
+                    << "track(s)";
+            // The modifications have been rolled back. The tracks
+            // are saved again when they are released.
+            for (const auto& pTrack : std::as_const(batchSavedTracks)) {
+                pTrack->markDirty();
+            }
+        }
+        batchSavedTracks.clear();
+    };
     while (auto nextTrackPointer = pTrackPointerIterator->nextItem()) {
         const auto pTrack = *nextTrackPointer;
         VERIFY_OR_DEBUG_ASSERT(pTrack) {
@@ -52,10 +81,14 @@ int ModalTrackBatchProcessor::processTracks(
                     << "of"
                     << estimatedTotalCount
                     << "track(s)";
-            return finishedTrackCount;
+            break;
         }
-        switch (doProcessNextTrack(pTrack)) {
-        case ProcessNextTrackResult::AbortProcessing:
+        if (batchTrackCount == 0) {
+            trackDao.beginBatchUpdate();
+            batchTimer.start();
+        }
+        const auto result = doProcessNextTrack(pTrack);
+        if (result == ProcessNextTrackResult::AbortProcessing) {
             kLogger.info()
                     << progressLabelText
                     << "aborted while processing"
@@ -63,14 +96,20 @@ int ModalTrackBatchProcessor::processTracks(
                     << "of"
                     << estimatedTotalCount
                     << "track(s)";
-            return finishedTrackCount;
-        case ProcessNextTrackResult::ContinueProcessing:
             break;
-        case ProcessNextTrackResult::SaveTrackAndContinueProcessing:
+        }
+        if (result == ProcessNextTrackResult::SaveTrackAndContinueProcessing) {
             pTrackCollectionManager->saveTrack(pTrack);
-            break;
+            batchSavedTracks.append(pTrack);
         }
         ++finishedTrackCount;
+        ++batchTrackCount;
+        if (batchTrackCount < kSaveBatchMaxTracks &&
+                batchTimer.elapsed() < kSaveBatchMaxDuration) {
+            continue;
+        }
+        finishBatch();
+        batchTrackCount = 0;
         if (finishedTrackCount > estimatedTotalCount) {
             // Update the total count which cannot be less than the
             // number of already finished items plus the estimated number
@@ -89,6 +128,9 @@ int ModalTrackBatchProcessor::processTracks(
                                 static_cast<PercentageOfCompletion>(
                                         estimatedTotalCount));
     }
+    if (batchTrackCount > 0) {
+        finishBatch();
+    }
     return finishedTrackCount;
 }
 
@@ -9,6 +9,7 @@
 #include <QXmlStreamReader>
 #include <QtDebug>
 
+#include "library/externallibraryimportcache.h"
 #include "library/library.h"
 #include "library/librarytablemodel.h"
 #include "library/missing_hidden/missingtablemodel.h"
@@ -209,25 +210,51 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
     thisThread->setPriority(QThread::LowPriority);
     //Invisible root item of Traktor's child model
     TreeItem* root = nullptr;
-    //Delete all table entries of Traktor feature
+
+    mixxx::FileInfo fileInfo(file);
+    if (!Sandbox::askForAccess(&fileInfo)) {
+        qDebug() << "Cannot access Traktor music collection:" << file;
+        return nullptr;
+    }
+
     ScopedTransaction transaction(m_database);
+    ExternalLibraryImportCache importCache(m_database, QStringLiteral("traktor"), {file});
+    if (importCache.isUpToDate()) {
+        // The tables still contain the last import of the unchanged collection
+        std::unique_ptr<TreeItem> cachedRoot = TreeItem::newRoot(this);
+        if (importCache.restorePlaylistTree(cachedRoot.get())) {
+            transaction.commit();
+            qDebug() << "Traktor music collection is unchanged, reusing the last import";
+            return cachedRoot.release();
+        }
+    }
+
+    // Only the playlists are rebuilt, the tracks are updated incrementally
     clearTable("traktor_playlist_tracks");
-    clearTable("traktor_library");
     clearTable("traktor_playlists");
-    transaction.commit();
-
-    transaction.transaction();
-    QSqlQuery query(m_database);
-    query.prepare("INSERT INTO traktor_library (artist, title, album, year,"
-                  "genre,comment,tracknumber,bpm, bitrate,duration, location,"
-                  "rating,key) VALUES (:artist, :title, :album, :year,:genre,"
-                  ":comment, :tracknumber,:bpm, :bitrate,:duration, :location,"
-                  ":rating,:key)");
+    ExternalTrackTableUpdater trackUpdater(m_database,
+            QStringLiteral("traktor_library"),
+            QStringLiteral("location"),
+            {"artist",
+                    "title",
+                    "album",
+                    "year",
+                    "genre",
+                    "comment",
+                    "tracknumber",
+                    "bpm",
+                    "bitrate",
+                    "duration",
+                    "location",
+                    "rating",
+                    "key"});
+    if (!trackUpdater.begin()) {
+        return nullptr;
+    }
 
     //Parse Trakor XML file using SAX (for performance)
-    mixxx::FileInfo fileInfo(file);
     QFile traktor_file(file);
-    if (!Sandbox::askForAccess(&fileInfo) || !traktor_file.open(QIODevice::ReadOnly)) {
+    if (!traktor_file.open(QIODevice::ReadOnly)) {
         qDebug() << "Cannot open Traktor music collection: " << traktor_file.errorString();
         return nullptr;
     }
@@ -246,7 +273,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
             // Each "ENTRY" tag in <COLLECTION> represents a track
             if (inCollectionTag && xml.name() == QLatin1String("ENTRY")) {
                 //parse track
-                parseTrack(xml, query);
+                parseTrack(xml, &trackUpdater);
                 ++nAudioFiles; //increment number of files in the music collection
             }
             if (xml.name() == QLatin1String("PLAYLISTS")) {
@@ -259,7 +286,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
 
                 if (nodetype == "FOLDER" && name == "$ROOT") {
                     //process all playlists
-                    root = parsePlaylists(xml);
+                    root = parsePlaylists(xml, trackUpdater);
                     isRootFolderParsed = true;
                 }
             }
@@ -273,7 +300,7 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
             }
         }
     }
-    if (xml.hasError()) {
+    if (xml.hasError() || m_cancelImport) {
          // do error handling
          qDebug() << "Cannot process Traktor music collection";
          if (root) {
@@ -282,14 +309,25 @@ TreeItem* TraktorFeature::importLibrary(const QString& file) {
          return nullptr;
     }
 
-    qDebug() << "Found: " << nAudioFiles << " audio files in Traktor";
+    trackUpdater.removeMissingTracks();
+    qDebug() << "Found: " << nAudioFiles << " audio files in Traktor,"
+             << trackUpdater.insertedCount() << "new,"
+             << trackUpdater.updatedCount() << "changed,"
+             << trackUpdater.unchangedCount() << "unchanged,"
+             << trackUpdater.removedCount() << "removed";
+    if (!root) {
+        // A collection without any playlists, which must be cached as an
+        // empty tree to be reused
+        root = TreeItem::newRoot(this).release();
+    }
+    importCache.save(root);
     //initialize TraktorTableModel
     transaction.commit();
 
     return root;
 }
 
-void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
+void TraktorFeature::parseTrack(QXmlStreamReader& xml, ExternalTrackTableUpdater* pUpdater) {
     QString title;
     QString artist;
     QString album;
@@ -387,26 +425,19 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 
     // If we reach the end of ENTRY within the COLLECTION tag
     // Save parsed track to database
-    query.bindValue(":artist", artist);
-    query.bindValue(":title", title);
-    query.bindValue(":album", album);
-    query.bindValue(":genre", genre);
-    query.bindValue(":year", year);
-    query.bindValue(":duration", playtime);
-    query.bindValue(":location", location);
-    query.bindValue(":rating", rating);
-    query.bindValue(":comment", comment);
-    query.bindValue(":tracknumber", tracknumber);
-    query.bindValue(":key", key);
-    query.bindValue(":bpm", bpm);
-    query.bindValue(":bitrate", bitrate);
-
-    bool success = query.exec();
-    if (!success) {
-        qDebug() << "SQL Error in TraktorTableModel.cpp: line"
-                 << __LINE__ << " " << query.lastError();
-        return;
-    }
+    pUpdater->importTrack({artist,
+            title,
+            album,
+            year,
+            genre,
+            comment,
+            tracknumber,
+            bpm,
+            bitrate,
+            playtime,
+            location,
+            rating,
+            key});
 }
 
 // Purpose: Parsing all the folder and playlists of Traktor
@@ -414,7 +445,8 @@ void TraktorFeature::parseTrack(QXmlStreamReader &xml, QSqlQuery &query) {
 // playlist. A folder can contain folders and playlists. A playlist contains
 // entries but no folders. In other words, Traktor uses a tree structure to
 // organize music. Inner nodes represent folders while leaves are playlists.
-TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
+TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader& xml,
+        const ExternalTrackTableUpdater& trackUpdater) {
 
     qDebug() << "Process RootFolder";
     // Each playlist is unique and can be identified by a path in the
@@ -462,6 +494,7 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
                     // having path 'current_path'
                     parsePlaylistEntries(xml,
                             current_path,
+                            trackUpdater,
                             &query_insert_to_playlists,
                             &query_insert_to_playlist_tracks);
 
@@ -508,6 +541,7 @@ TreeItem* TraktorFeature::parsePlaylists(QXmlStreamReader &xml) {
 void TraktorFeature::parsePlaylistEntries(
         QXmlStreamReader& xml,
         const QString& playlist_path,
+        const ExternalTrackTableUpdater& trackUpdater,
         QSqlQuery* pQueryInsertIntoPlaylist,
         QSqlQuery* pQueryInsertIntoPlaylistTracks) {
     // In the database, the name of a playlist is specified by the unique path,
@@ -555,19 +589,7 @@ void TraktorFeature::parsePlaylistEntries(
                     #endif
 
                     //insert to database
-                    int track_id = -1;
-                    QSqlQuery finder_query(m_database);
-                    finder_query.prepare("select id from traktor_library where location=:path");
-                    finder_query.bindValue(":path", key);
-
-                    if (!finder_query.exec()) {
-                        LOG_FAILED_QUERY(finder_query) << "Could not get track id:" << key;
-                        continue;
-                    }
-
-                    if (finder_query.next()) {
-                        track_id = finder_query.value(finder_query.record().indexOf("id")).toInt();
-                    }
+                    const int track_id = trackUpdater.trackId(key);
 
                     pQueryInsertIntoPlaylistTracks->bindValue(":playlist_id", playlist_id);
                     pQueryInsertIntoPlaylistTracks->bindValue(":track_id", track_id);
@@ -11,6 +11,8 @@
 #include "library/baseexternalplaylistmodel.h"
 #include "library/treeitemmodel.h"
 
+class ExternalTrackTableUpdater;
+
 class TraktorTrackModel : public BaseExternalTrackModel {
     Q_OBJECT
   public:
@@ -51,12 +53,14 @@ class TraktorFeature : public BaseExternalLibraryFeature {
             const QVariant& data) override;
     TreeItem* importLibrary(const QString& file);
     // parses a track in the music collection
-    void parseTrack(QXmlStreamReader &xml, QSqlQuery &query);
+    void parseTrack(QXmlStreamReader& xml, ExternalTrackTableUpdater* pUpdater);
     // Iterates over all playliost and folders and constructs the childmodel
-    TreeItem* parsePlaylists(QXmlStreamReader &xml);
+    TreeItem* parsePlaylists(QXmlStreamReader& xml,
+            const ExternalTrackTableUpdater& trackUpdater);
     // processes a particular playlist
     void parsePlaylistEntries(QXmlStreamReader& xml,
             const QString& playlist_path,
+            const ExternalTrackTableUpdater& trackUpdater,
             QSqlQuery* pQueryInsertIntoPlaylist,
             QSqlQuery* pQueryInsertIntoPlaylistTracks);
     void clearTable(const QString& table_name);
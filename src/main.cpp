@@ -8,8 +8,10 @@
 #include <QThread>
 #include <QtDebug>
 #include <QtGlobal>
+#include <algorithm>
 #include <cstdio>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 #include "config.h"
@@ -28,6 +30,10 @@
 #if defined(__WINDOWS__)
 #include "nativeeventhandlerwin.h"
 #endif
+#include "library/analysis/batchanalysis.h"
+#include "library/library.h"
+#include "render/offlinerenderer.h"
+#include "render/renderscript.h"
 #include "sources/soundsourceproxy.h"
 #include "util/cmdlineargs.h"
 #include "util/console.h"
@@ -40,6 +46,8 @@ namespace {
 // Exit codes
 constexpr int kFatalErrorOnStartupExitCode = 1;
 constexpr int kParseCmdlineArgsErrorExitCode = 2;
+constexpr int kRenderErrorExitCode = 3;
+constexpr int kAnalyzeErrorExitCode = 4;
 
 constexpr char kScaleFactorEnvVar[] = "QT_SCALE_FACTOR";
 const QString kConfigGroup = QStringLiteral("[Config]");
@@ -56,6 +64,71 @@ const QString kNotifyMaxDbgTimeKey = QStringLiteral("notify_max_dbg_time");
 // An indicator that the QPixmapCache was too small.
 constexpr int kPixmapCacheLimitAt100PercentZoom = 32 * 1024; // 32 MByte
 
+/// Renders the script given with --render-script without a main window and
+/// without opening any sound device.
+int renderOffline(MixxxApplication* pApp,
+        const CmdlineArgs& args,
+        const std::shared_ptr<mixxx::CoreServices>& pCoreServices) {
+    QString errorMessage;
+    std::optional<mixxx::RenderScript> script =
+            mixxx::RenderScript::fromFile(args.getRenderScriptPath(), &errorMessage);
+    if (!script) {
+        qCritical() << "Invalid render script" << args.getRenderScriptPath()
+                    << errorMessage;
+        return kFatalErrorOnStartupExitCode;
+    }
+
+    // The renderer must be created before the decks
+    mixxx::OfflineRenderer renderer(pCoreServices,
+            std::move(*script),
+            args.getRenderOutputPath());
+    pCoreServices->initialize(pApp);
+    if (ErrorDialogHandler::instance()->checkError()) {
+        return kFatalErrorOnStartupExitCode;
+    }
+
+    // The main thread loads the tracks while the renderer is running
+    QObject::connect(&renderer,
+            &QThread::finished,
+            pApp,
+            &MixxxApplication::quit,
+            Qt::QueuedConnection);
+    renderer.start();
+    pApp->exec();
+    renderer.wait();
+    return renderer.succeeded() ? 0 : kRenderErrorExitCode;
+}
+
+/// Analyzes the library given with --analyze-library without a main window
+/// and without opening any sound device.
+int analyzeLibrary(MixxxApplication* pApp,
+        const CmdlineArgs& args,
+        const std::shared_ptr<mixxx::CoreServices>& pCoreServices) {
+    pCoreServices->initialize(pApp);
+    if (ErrorDialogHandler::instance()->checkError()) {
+        return kFatalErrorOnStartupExitCode;
+    }
+
+    const int numThreads = args.getAnalyzeThreads() > 0
+            ? args.getAnalyzeThreads()
+            : std::max(1, QThread::idealThreadCount());
+    mixxx::BatchAnalysis batchAnalysis(pCoreServices->getSettings(),
+            pCoreServices->getTrackCollectionManager().get(),
+            pCoreServices->getLibrary()->dbConnectionPool(),
+            args.getAnalyzeQuery(),
+            numThreads);
+    QObject::connect(&batchAnalysis,
+            &mixxx::BatchAnalysis::finished,
+            pApp,
+            &MixxxApplication::quit,
+            Qt::QueuedConnection);
+    if (!batchAnalysis.start()) {
+        return kAnalyzeErrorExitCode;
+    }
+    pApp->exec();
+    return 0;
+}
+
 int runMixxx(MixxxApplication* pApp, const CmdlineArgs& args) {
     CmdlineArgs::Instance().parseForUserFeedback();
 
@@ -73,6 +146,12 @@ int runMixxx(MixxxApplication* pApp, const CmdlineArgs& args) {
 #endif
     {
         auto pCoreServices = std::make_shared<mixxx::CoreServices>(args, pApp);
+        if (args.getRenderEnabled()) {
+            return renderOffline(pApp, args, pCoreServices);
+        }
+        if (args.getAnalyzeLibrary()) {
+            return analyzeLibrary(pApp, args, pCoreServices);
+        }
 
         // This scope ensures that `MixxxMainWindow` is destroyed *before*
         // CoreServices is shut down. Otherwise a debug assertion complaining about
@@ -120,6 +199,11 @@ int runMixxx(MixxxApplication* pApp, const CmdlineArgs& args) {
         } else {
             qDebug() << "Displaying main window";
             mainWindow.show();
+#ifndef MIXXX_USE_QOPENGL
+            // With QOpenGL this is done by MixxxMainWindow::initialize(),
+            // which loads the skin after the window has been shown
+            pCoreServices->finishStartup();
+#endif
 
             qDebug() << "Running Mixxx";
             exitCode = pApp->exec();
@@ -243,6 +327,12 @@ int main(int argc, char * argv[]) {
 
     adjustScaleFactor(&args);
 
+    // Offline rendering and analysis must work without a display
+    if ((args.getRenderEnabled() || args.getAnalyzeLibrary()) &&
+            qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("offscreen"));
+    }
+
     MixxxApplication app(argc, argv);
 
 #if defined(Q_OS_WIN)
@@ -183,9 +183,12 @@ void PlayerManager::bindToLibrary(Library* pLibrary) {
             &Library::slotLoadLocationToPlayer);
 
     DEBUG_ASSERT(!m_pTrackAnalysisScheduler);
+    // Tracks loaded to decks are analyzed urgently, using one thread per
+    // analyzer
     m_pTrackAnalysisScheduler = pLibrary->createTrackAnalysisScheduler(
             kNumberOfAnalyzerThreads,
-            AnalyzerModeFlags::WithWaveform);
+            static_cast<AnalyzerModeFlags>(
+                    AnalyzerModeFlags::WithWaveform | AnalyzerModeFlags::Pipelined));
 
     connect(m_pTrackAnalysisScheduler.get(), &TrackAnalysisScheduler::trackProgress,
             this, &PlayerManager::onTrackAnalysisProgress);
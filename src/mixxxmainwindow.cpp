@@ -453,6 +453,11 @@ void MixxxMainWindow::initialize() {
         // AutoDj is second from the top by default, all features collapsed).
         pLibrary->showAutoDJ();
     }
+
+#ifdef MIXXX_USE_QOPENGL
+    // The window has already been shown, see main.cpp
+    m_pCoreServices->finishStartup();
+#endif
 }
 
 MixxxMainWindow::~MixxxMainWindow() {
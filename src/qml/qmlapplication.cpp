@@ -115,6 +115,7 @@ QmlApplication::QmlApplication(
     loadQml(m_mainFilePath);
 
     m_pCoreServices->getControllerManager()->setUpDevices();
+    m_pCoreServices->finishStartup();
 
     connect(&m_autoReload,
             &QmlAutoReload::triggered,
@@ -0,0 +1,307 @@
+#include "render/offlinerenderer.h"
+
+#include <QFileInfo>
+#include <QSemaphore>
+#include <algorithm>
+#include <utility>
+
+#include "control/controlobject.h"
+#include "coreservices.h"
+#include "engine/channels/enginechannel.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginemixer.h"
+#include "mixer/basetrackplayer.h"
+#include "mixer/playermanager.h"
+#include "moc_offlinerenderer.cpp"
+#include "soundio/sounddevicenull.h"
+#include "soundio/soundmanager.h"
+#include "soundio/soundmanagerutil.h"
+#include "track/track.h"
+#include "util/logger.h"
+#include "util/performancetimer.h"
+#include "util/samplebuffer.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("OfflineRenderer");
+
+const ConfigKey kPreloadTracksConfigKey(
+        QStringLiteral("[App]"), QStringLiteral("preload_tracks"));
+
+// Loading and decoding a track into RAM must not take longer
+constexpr int kLoadTrackTimeoutMillis = 5 * 60 * 1000;
+constexpr unsigned long kPreloadPollIntervalMillis = 1;
+
+} // namespace
+
+OfflineRenderer::OfflineRenderer(std::shared_ptr<CoreServices> pCoreServices,
+        RenderScript script,
+        const QString& outputPath)
+        : m_pCoreServices(std::move(pCoreServices)),
+          m_script(std::move(script)),
+          m_outputPath(outputPath),
+          m_restorePreloadTracks(false),
+          m_succeeded(false) {
+    setObjectName(QStringLiteral("OfflineRenderer"));
+    UserSettingsPointer pConfig = m_pCoreServices->getSettings();
+    m_restorePreloadTracks = pConfig->exists(kPreloadTracksConfigKey);
+    m_preloadTracks = pConfig->getValueString(kPreloadTracksConfigKey);
+    pConfig->setValue(kPreloadTracksConfigKey, true);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    wait();
+    UserSettingsPointer pConfig = m_pCoreServices->getSettings();
+    if (m_restorePreloadTracks) {
+        pConfig->set(kPreloadTracksConfigKey, ConfigValue(m_preloadTracks));
+    } else {
+        pConfig->remove(kPreloadTracksConfigKey);
+    }
+}
+
+void OfflineRenderer::run() {
+    m_succeeded.store(render());
+}
+
+bool OfflineRenderer::render() {
+    std::shared_ptr<EngineMixer> pEngine = m_pCoreServices->getEngineMixer();
+    std::shared_ptr<SoundManager> pSoundManager = m_pCoreServices->getSoundManager();
+    VERIFY_OR_DEBUG_ASSERT(pEngine && pSoundManager) {
+        return false;
+    }
+
+    const SINT framesPerBuffer = m_script.framesPerBuffer();
+    SoundDeviceNull device(m_pCoreServices->getSettings(),
+            pSoundManager.get(),
+            m_script.sampleRate());
+    device.setConfigFramesPerBuffer(static_cast<unsigned int>(framesPerBuffer));
+    const AudioOutput mainOutput(AudioPathType::Main,
+            0,
+            mixxx::audio::ChannelCount::stereo());
+    if (device.addOutput(AudioOutputBuffer(mainOutput,
+                pEngine->buffer(mainOutput).data())) != SoundDeviceStatus::Ok) {
+        kLogger.warning() << "Failed to connect the main output";
+        return false;
+    }
+    pEngine->onOutputConnected(mainOutput);
+    if (device.open(true, 0) != SoundDeviceStatus::Ok) {
+        return false;
+    }
+
+    if (!m_outputPath.isEmpty() && !openOutput()) {
+        device.close();
+        return false;
+    }
+
+    kLogger.info() << "Rendering" << m_script.durationFrames() << "frames @"
+                   << m_script.sampleRate() << "Hz with" << framesPerBuffer
+                   << "frames/buffer";
+
+    mixxx::SampleBuffer output(framesPerBuffer * mixxx::audio::ChannelCount::stereo());
+    const QList<RenderScript::Event>& events = m_script.events();
+    auto nextEvent = events.cbegin();
+    bool ok = true;
+    PerformanceTimer timer;
+    mixxx::Duration loadDuration;
+    timer.start();
+    SINT frame = 0;
+    while (ok && frame < m_script.durationFrames()) {
+        while (nextEvent != events.cend() && nextEvent->frame <= frame) {
+            if (nextEvent->isLoad()) {
+                // Loading is excluded from the throughput
+                PerformanceTimer loadTimer;
+                loadTimer.start();
+                ok = loadTrack(nextEvent->group, nextEvent->location);
+                loadDuration += loadTimer.elapsed();
+            } else {
+                ok = applyEvent(*nextEvent);
+            }
+            if (!ok) {
+                break;
+            }
+            ++nextEvent;
+        }
+        if (!ok) {
+            break;
+        }
+        const SINT frames = std::min(framesPerBuffer, m_script.durationFrames() - frame);
+        device.process(output.data(), frames);
+        if (m_pEncoder) {
+            m_pEncoder->encodeBuffer(output.data(),
+                    frames * mixxx::audio::ChannelCount::stereo());
+        }
+        frame += frames;
+    }
+    const mixxx::Duration renderDuration = timer.elapsed() - loadDuration;
+
+    closeOutput();
+    device.close();
+    if (!ok) {
+        return false;
+    }
+
+    const double seconds = renderDuration.toDoubleSeconds();
+    if (seconds > 0) {
+        const double framesPerSecond = frame / seconds;
+        kLogger.info() << "Rendered" << frame << "frames in"
+                       << renderDuration.formatMillisWithUnit() << "="
+                       << framesPerSecond << "frames/s, "
+                       << framesPerSecond / m_script.sampleRate().toDouble()
+                       << "x real time";
+    }
+    return true;
+}
+
+bool OfflineRenderer::openOutput() {
+    const QString extension = QFileInfo(m_outputPath).suffix().toLower();
+    const QList<Encoder::Format> formats = EncoderFactory::getFactory().getFormats();
+    const auto format = std::find_if(formats.cbegin(),
+            formats.cend(),
+            [&extension](const Encoder::Format& format) {
+                return format.fileExtension == extension ||
+                        (extension == QLatin1String("aif") &&
+                                format.fileExtension == QLatin1String("aiff"));
+            });
+    if (format == formats.cend()) {
+        kLogger.warning() << "No encoder for the file extension" << extension;
+        return false;
+    }
+
+    m_outputFile.setFileName(m_outputPath);
+    if (!m_outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        kLogger.warning() << "Failed to open" << m_outputPath << m_outputFile.errorString();
+        return false;
+    }
+    m_pEncoder = EncoderFactory::getFactory().createRecordingEncoder(
+            *format, m_pCoreServices->getSettings(), this);
+    QString errorMessage;
+    if (!m_pEncoder || m_pEncoder->initEncoder(m_script.sampleRate(), &errorMessage) < 0) {
+        kLogger.warning() << "Failed to initialize the" << format->label
+                          << "encoder:" << errorMessage;
+        m_pEncoder.reset();
+        m_outputFile.close();
+        return false;
+    }
+    kLogger.info() << "Writing the main mix as" << format->label << "to" << m_outputPath;
+    return true;
+}
+
+void OfflineRenderer::closeOutput() {
+    if (m_pEncoder) {
+        m_pEncoder->flush();
+        m_pEncoder.reset();
+    }
+    if (m_outputFile.isOpen()) {
+        m_outputFile.close();
+    }
+}
+
+bool OfflineRenderer::applyEvent(const RenderScript::Event& event) {
+    const ConfigKey key(event.group, event.key);
+    if (!ControlObject::exists(key)) {
+        kLogger.warning() << "No control" << key;
+        return false;
+    }
+    ControlObject::set(key, event.value);
+    return true;
+}
+
+bool OfflineRenderer::loadTrack(const QString& group, const QString& location) {
+    kLogger.info() << "Loading" << location << "into" << group;
+    std::shared_ptr<PlayerManager> pPlayerManager = m_pCoreServices->getPlayerManager();
+    std::shared_ptr<EngineMixer> pEngine = m_pCoreServices->getEngineMixer();
+
+    // Signalled from the main thread when the track has been loaded or
+    // the deck has been emptied after loading failed. Destroying the
+    // context first disconnects the signals.
+    const QString expectedLocation = QFileInfo(location).absoluteFilePath();
+    QSemaphore loaded;
+    std::atomic<bool> loadedTrack(false);
+    EngineBuffer* pEngineBuffer = nullptr;
+    QObject context;
+    QMetaObject::invokeMethod(
+            pPlayerManager.get(),
+            [&] {
+                BaseTrackPlayer* pPlayer = pPlayerManager->getPlayer(group);
+                EngineChannel* pChannel = pEngine->getChannel(group);
+                pEngineBuffer = pChannel ? pChannel->getEngineBuffer() : nullptr;
+                if (!pPlayer || !pEngineBuffer) {
+                    return;
+                }
+                connect(
+                        pPlayer,
+                        &BaseTrackPlayer::newTrackLoaded,
+                        &context,
+                        [&](TrackPointer pTrack) {
+                            if (pTrack && pTrack->getLocation() == expectedLocation) {
+                                loadedTrack.store(true);
+                                loaded.release();
+                            }
+                        },
+                        Qt::DirectConnection);
+                connect(
+                        pPlayer,
+                        &BaseTrackPlayer::playerEmpty,
+                        &context,
+                        [&] {
+                            loaded.release();
+                        },
+                        Qt::DirectConnection);
+                pPlayerManager->slotLoadLocationToPlayer(location, group, false);
+            },
+            Qt::BlockingQueuedConnection);
+    if (!pEngineBuffer) {
+        kLogger.warning() << "No deck" << group;
+        return false;
+    }
+    if (!loaded.tryAcquire(1, kLoadTrackTimeoutMillis) || !loadedTrack.load()) {
+        kLogger.warning() << "Failed to load" << location;
+        return false;
+    }
+
+    // The preloaded track is handed over to the reader with the next
+    // engine callback
+    while (pEngineBuffer->isTrackPreloading()) {
+        QThread::msleep(kPreloadPollIntervalMillis);
+    }
+    return true;
+}
+
+// Called by the encoder from the render thread
+void OfflineRenderer::write(const unsigned char* header,
+        const unsigned char* body,
+        int headerLen,
+        int bodyLen) {
+    if (!m_outputFile.isOpen()) {
+        return;
+    }
+    if (headerLen > 0) {
+        m_outputFile.write(reinterpret_cast<const char*>(header), headerLen);
+    }
+    m_outputFile.write(reinterpret_cast<const char*>(body), bodyLen);
+}
+
+int OfflineRenderer::tell() {
+    if (!m_outputFile.isOpen()) {
+        return -1;
+    }
+    return static_cast<int>(m_outputFile.pos());
+}
+
+void OfflineRenderer::seek(int pos) {
+    if (!m_outputFile.isOpen()) {
+        return;
+    }
+    m_outputFile.seek(static_cast<qint64>(pos));
+}
+
+int OfflineRenderer::filelen() {
+    if (!m_outputFile.isOpen()) {
+        return 0;
+    }
+    return static_cast<int>(m_outputFile.size());
+}
+
+} // namespace mixxx
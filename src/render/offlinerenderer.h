@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "encoder/encoder.h"
+#include "encoder/encodercallback.h"
+#include "render/renderscript.h"
+
+class EngineMixer;
+class PlayerManager;
+class SoundManager;
+
+namespace mixxx {
+
+class CoreServices;
+
+/// Renders the main mix of a RenderScript offline and as fast as possible,
+/// without any audio hardware. This allows to benchmark the throughput of
+/// the whole engine and to render mixes on machines without a sound card.
+///
+/// The renderer drives the engine from its own thread through a
+/// SoundDeviceNull, like the callback thread of a real sound device. Tracks
+/// are loaded by the main thread, which must run the event loop while
+/// rendering. The main mix is written with the recording encoder for the
+/// extension of the output file, using the recording preferences.
+///
+/// To make the result independent of the speed of the disk, tracks are
+/// decoded into RAM completely before the rendering continues after loading
+/// them, see CachingReader. The renderer enables [App],preload_tracks until
+/// it is destroyed, so it must be created before the decks.
+class OfflineRenderer : public QThread, public EncoderCallback {
+    Q_OBJECT
+  public:
+    /// Without an output path the mix is only rendered, e.g. for benchmarks
+    OfflineRenderer(std::shared_ptr<CoreServices> pCoreServices,
+            RenderScript script,
+            const QString& outputPath);
+    ~OfflineRenderer() override;
+
+    /// Valid after the thread has finished
+    bool succeeded() const {
+        return m_succeeded.load();
+    }
+
+    // EncoderCallback
+    void write(const unsigned char* header,
+            const unsigned char* body,
+            int headerLen,
+            int bodyLen) override;
+    int tell() override;
+    void seek(int pos) override;
+    int filelen() override;
+
+  protected:
+    void run() override;
+
+  private:
+    bool render();
+    bool openOutput();
+    void closeOutput();
+    bool applyEvent(const RenderScript::Event& event);
+    bool loadTrack(const QString& group, const QString& location);
+
+    const std::shared_ptr<CoreServices> m_pCoreServices;
+    const RenderScript m_script;
+    const QString m_outputPath;
+
+    // The previous value of [App],preload_tracks
+    bool m_restorePreloadTracks;
+    QString m_preloadTracks;
+
+    EncoderPointer m_pEncoder;
+    QFile m_outputFile;
+
+    std::atomic<bool> m_succeeded;
+};
+
+} // namespace mixxx
@@ -0,0 +1,148 @@
+#include "render/renderscript.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+
+#include "soundio/soundmanagerconfig.h"
+#include "util/defs.h"
+
+namespace mixxx {
+
+namespace {
+
+const QString kSampleRateKey = QStringLiteral("sampleRate");
+const QString kFramesPerBufferKey = QStringLiteral("framesPerBuffer");
+const QString kDurationKey = QStringLiteral("duration");
+const QString kEventsKey = QStringLiteral("events");
+const QString kTimeKey = QStringLiteral("time");
+const QString kGroupKey = QStringLiteral("group");
+const QString kLoadKey = QStringLiteral("load");
+const QString kControlKey = QStringLiteral("key");
+const QString kValueKey = QStringLiteral("value");
+
+SINT secondsToFrames(double seconds, mixxx::audio::SampleRate sampleRate) {
+    return static_cast<SINT>(std::llround(seconds * sampleRate.toDouble()));
+}
+
+} // namespace
+
+RenderScript::RenderScript()
+        : m_sampleRate(SoundManagerConfig::kMixxxDefaultSampleRate),
+          m_framesPerBuffer(kDefaultFramesPerBuffer),
+          m_durationFrames(0) {
+}
+
+// static
+std::optional<RenderScript> RenderScript::fromFile(
+        const QString& filePath,
+        QString* pErrorMessage) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *pErrorMessage = QStringLiteral("Failed to open %1: %2")
+                                 .arg(filePath, file.errorString());
+        return std::nullopt;
+    }
+    return fromJson(file.readAll(), QFileInfo(filePath).absoluteDir(), pErrorMessage);
+}
+
+// static
+std::optional<RenderScript> RenderScript::fromJson(
+        const QByteArray& json,
+        const QDir& baseDir,
+        QString* pErrorMessage) {
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        *pErrorMessage = QStringLiteral("Invalid JSON at offset %1: %2")
+                                 .arg(QString::number(parseError.offset),
+                                         parseError.errorString());
+        return std::nullopt;
+    }
+    if (!document.isObject()) {
+        *pErrorMessage = QStringLiteral("The script must be a JSON object");
+        return std::nullopt;
+    }
+    const QJsonObject object = document.object();
+
+    RenderScript script;
+    if (object.contains(kSampleRateKey)) {
+        const int sampleRate = object.value(kSampleRateKey).toInt(0);
+        script.m_sampleRate = mixxx::audio::SampleRate(
+                static_cast<mixxx::audio::SampleRate::value_t>(std::max(sampleRate, 0)));
+        if (!script.m_sampleRate.isValid()) {
+            *pErrorMessage = QStringLiteral("Invalid sample rate: %1")
+                                     .arg(object.value(kSampleRateKey).toVariant().toString());
+            return std::nullopt;
+        }
+    }
+    if (object.contains(kFramesPerBufferKey)) {
+        script.m_framesPerBuffer = object.value(kFramesPerBufferKey).toInt(0);
+        if (script.m_framesPerBuffer <= 0 ||
+                script.m_framesPerBuffer > static_cast<SINT>(kMaxEngineFrames)) {
+            *pErrorMessage = QStringLiteral("The buffer size must be between 1 and %1 frames")
+                                     .arg(kMaxEngineFrames);
+            return std::nullopt;
+        }
+    }
+    const double duration = object.value(kDurationKey).toDouble(0.0);
+    if (!(duration > 0.0)) {
+        *pErrorMessage = QStringLiteral("The duration must be a positive number of seconds");
+        return std::nullopt;
+    }
+    script.m_durationFrames = secondsToFrames(duration, script.m_sampleRate);
+
+    const QJsonArray events = object.value(kEventsKey).toArray();
+    for (int i = 0; i < events.size(); ++i) {
+        const QJsonObject eventObject = events.at(i).toObject();
+        const double time = eventObject.value(kTimeKey).toDouble(-1.0);
+        if (!(time >= 0.0)) {
+            *pErrorMessage = QStringLiteral("Event %1: The time must be a "
+                                            "non-negative number of seconds")
+                                     .arg(i);
+            return std::nullopt;
+        }
+        Event event;
+        // Quantize to the start of the buffer that contains the event
+        const SINT frame = secondsToFrames(time, script.m_sampleRate);
+        event.frame = frame - frame % script.m_framesPerBuffer;
+        event.group = eventObject.value(kGroupKey).toString();
+        if (event.group.isEmpty()) {
+            *pErrorMessage = QStringLiteral("Event %1: The group is missing").arg(i);
+            return std::nullopt;
+        }
+        event.value = 0.0;
+        if (eventObject.contains(kLoadKey)) {
+            const QString location = eventObject.value(kLoadKey).toString();
+            if (location.isEmpty()) {
+                *pErrorMessage = QStringLiteral("Event %1: The track location is empty").arg(i);
+                return std::nullopt;
+            }
+            event.location = QDir::cleanPath(baseDir.absoluteFilePath(location));
+        } else {
+            event.key = eventObject.value(kControlKey).toString();
+            const QJsonValue value = eventObject.value(kValueKey);
+            if (event.key.isEmpty() || !value.isDouble()) {
+                *pErrorMessage = QStringLiteral(
+                        "Event %1: Either a track to load or a control "
+                        "key and a numeric value are required")
+                                         .arg(i);
+                return std::nullopt;
+            }
+            event.value = value.toDouble();
+        }
+        script.m_events.append(event);
+    }
+    std::stable_sort(script.m_events.begin(),
+            script.m_events.end(),
+            [](const Event& lhs, const Event& rhs) {
+                return lhs.frame < rhs.frame;
+            });
+    return script;
+}
+
+} // namespace mixxx
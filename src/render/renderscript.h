@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QList>
+#include <QString>
+#include <optional>
+
+#include "audio/types.h"
+#include "util/types.h"
+
+namespace mixxx {
+
+/// A scripted mix that is rendered by the OfflineRenderer, read from a JSON
+/// file like this:
+///
+///     {
+///         "sampleRate": 48000,
+///         "framesPerBuffer": 1024,
+///         "duration": 120.5,
+///         "events": [
+///             { "time": 0, "group": "[Channel1]", "load": "a.flac" },
+///             { "time": 0, "group": "[Channel1]", "key": "play", "value": 1 },
+///             { "time": 60, "group": "[Master]", "key": "crossfader", "value": 1 }
+///         ]
+///     }
+///
+/// All times are in seconds from the start of the mix. The sample rate and
+/// the buffer size are optional. Relative track locations are resolved
+/// against the directory of the script.
+///
+/// Like the input of controllers, events are only applied between engine
+/// callbacks, i.e. before the buffer that contains the time of the event.
+/// Events with the same time are applied in the order of the script.
+class RenderScript {
+  public:
+    static constexpr SINT kDefaultFramesPerBuffer = 1024;
+
+    struct Event {
+        // The first frame of the buffer before which the event is applied
+        SINT frame;
+        QString group;
+        // Either a track location to load or a control to set
+        QString location;
+        QString key;
+        double value;
+
+        bool isLoad() const {
+            return !location.isEmpty();
+        }
+    };
+
+    /// Returns std::nullopt and an error message if the script is invalid
+    static std::optional<RenderScript> fromJson(
+            const QByteArray& json,
+            const QDir& baseDir,
+            QString* pErrorMessage);
+    static std::optional<RenderScript> fromFile(
+            const QString& filePath,
+            QString* pErrorMessage);
+
+    mixxx::audio::SampleRate sampleRate() const {
+        return m_sampleRate;
+    }
+    SINT framesPerBuffer() const {
+        return m_framesPerBuffer;
+    }
+    SINT durationFrames() const {
+        return m_durationFrames;
+    }
+    /// Sorted by frame
+    const QList<Event>& events() const {
+        return m_events;
+    }
+
+  private:
+    RenderScript();
+
+    mixxx::audio::SampleRate m_sampleRate;
+    SINT m_framesPerBuffer;
+    SINT m_durationFrames;
+    QList<Event> m_events;
+};
+
+} // namespace mixxx
@@ -24,6 +24,7 @@
 #include "skin/legacy/colorschemeparser.h"
 #include "skin/legacy/launchimage.h"
 #include "skin/legacy/skincontext.h"
+#include "skin/legacy/skindocumentcache.h"
 #include "track/track.h"
 #include "util/assert.h"
 #include "util/cmdlineargs.h"
@@ -227,37 +228,11 @@ QDomElement LegacySkinParser::openSkin(const QString& skinPath) {
     }
 
     QString skinXmlPath = skinDir.filePath("skin.xml");
-    QFile skinXmlFile(skinXmlPath);
-
-    if (!skinXmlFile.open(QIODevice::ReadOnly)) {
-        qDebug() << "LegacySkinParser::openSkin - can't open file:" << skinXmlPath
-                 << "in directory:" << skinDir.path();
-        return QDomElement();
-    }
-
-    QDomDocument skin("skin");
-
-#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-    const auto parseResult = skin.setContent(&skinXmlFile);
-    if (!parseResult) {
-        qDebug() << "LegacySkinParser::openSkin - setContent failed see"
-                 << "line:" << parseResult.errorLine << "column:" << parseResult.errorColumn;
-        qDebug() << "LegacySkinParser::openSkin - message:" << parseResult.errorMessage;
-#else
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!skin.setContent(&skinXmlFile,&errorMessage,&errorLine,&errorColumn)) {
-        qDebug() << "LegacySkinParser::openSkin - setContent failed see"
-                 << "line:" << errorLine << "column:" << errorColumn;
-        qDebug() << "LegacySkinParser::openSkin - message:" << errorMessage;
-#endif
-        return QDomElement();
+    QDomElement skinDocument = SkinDocumentCache::documentElement(skinXmlPath);
+    if (skinDocument.isNull()) {
+        qDebug() << "LegacySkinParser::openSkin - can't open skin:" << skinXmlPath;
     }
-
-    skinXmlFile.close();
-    return skin.documentElement();
+    return skinDocument;
 }
 
 // static
@@ -1852,39 +1827,16 @@ QDomElement LegacySkinParser::loadTemplate(const QString& path) {
         return it.value();
     }
 
-    QFile templateFile(absolutePath);
-
-    if (!templateFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open template file:" << absolutePath;
-        return QDomElement();
-    }
-
-    QDomDocument tmpl("template");
-
-#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-    const auto parseResult = tmpl.setContent(&templateFile);
-    if (!parseResult) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << parseResult.errorLine
-                   << "column:" << parseResult.errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << parseResult.errorMessage;
-#else
-    QString errorMessage;
-    int errorLine;
-    int errorColumn;
-
-    if (!tmpl.setContent(&templateFile, &errorMessage,
-                         &errorLine, &errorColumn)) {
-        qWarning() << "LegacySkinParser::loadTemplate - setContent failed see"
-                   << absolutePath << "line:" << errorLine << "column:" << errorColumn;
-        qWarning() << "LegacySkinParser::loadTemplate - message:" << errorMessage;
-#endif
+    QDomElement templateElement = SkinDocumentCache::documentElement(absolutePath);
+    if (templateElement.isNull()) {
+        qWarning() << "LegacySkinParser::loadTemplate - failed to load template:"
+                   << absolutePath;
         return QDomElement();
     }
 
-    m_templateCache[absolutePath] = tmpl.documentElement();
+    m_templateCache[absolutePath] = templateElement;
     m_pContext->setSkinTemplatePath(templateFileInfo.absoluteDir().absolutePath());
-    return tmpl.documentElement();
+    return templateElement;
 }
 
 QList<QWidget*> LegacySkinParser::parseTemplate(const QDomElement& node) {
@@ -0,0 +1,246 @@
+#include "skin/legacy/skindocumentcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QVector>
+
+#include "util/cmdlineargs.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SkinDocumentCache");
+
+// "MXSD", the version must be incremented when the format changes
+constexpr quint32 kFileMagic = 0x4d585344;
+constexpr quint32 kFileVersion = 1;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_5_12;
+
+const QString kFileSuffix = QStringLiteral(".bin");
+
+enum class NodeType : quint8 {
+    Element = 0,
+    Text = 1,
+    CDATASection = 2,
+};
+
+struct Entry {
+    QDateTime lastModified;
+    qint64 size;
+    QDomDocument document;
+};
+
+QMutex s_mutex;
+QString s_cacheDirectory;
+QHash<QString, Entry> s_entries;
+
+void writeChildren(QDataStream* pStream, const QDomNode& parent) {
+    // Comments and processing instructions are not needed by the parser
+    QVector<QDomNode> children;
+    for (QDomNode child = parent.firstChild(); !child.isNull(); child = child.nextSibling()) {
+        if (child.isElement() || child.isText()) {
+            children.append(child);
+        }
+    }
+    *pStream << static_cast<quint32>(children.size());
+    for (const auto& child : std::as_const(children)) {
+        if (!child.isElement()) {
+            // isText() is also true for CDATA sections
+            *pStream << static_cast<quint8>(child.isCDATASection()
+                                    ? NodeType::CDATASection
+                                    : NodeType::Text)
+                     << child.nodeValue();
+            continue;
+        }
+        const QDomElement element = child.toElement();
+        *pStream << static_cast<quint8>(NodeType::Element) << element.tagName();
+        const QDomNamedNodeMap attributes = element.attributes();
+        *pStream << static_cast<quint32>(attributes.count());
+        for (int i = 0; i < attributes.count(); ++i) {
+            const QDomAttr attribute = attributes.item(i).toAttr();
+            *pStream << attribute.name() << attribute.value();
+        }
+        writeChildren(pStream, element);
+    }
+}
+
+bool readChildren(QDataStream* pStream, QDomDocument* pDocument, QDomNode* pParent) {
+    quint32 count;
+    *pStream >> count;
+    for (quint32 i = 0; i < count; ++i) {
+        quint8 type;
+        QString value;
+        *pStream >> type >> value;
+        // Stops early for truncated or corrupt files
+        if (pStream->status() != QDataStream::Ok) {
+            return false;
+        }
+        switch (static_cast<NodeType>(type)) {
+        case NodeType::Element: {
+            QDomElement element = pDocument->createElement(value);
+            quint32 attributeCount;
+            *pStream >> attributeCount;
+            for (quint32 j = 0; j < attributeCount; ++j) {
+                QString name;
+                QString attributeValue;
+                *pStream >> name >> attributeValue;
+                if (pStream->status() != QDataStream::Ok) {
+                    return false;
+                }
+                element.setAttribute(name, attributeValue);
+            }
+            pParent->appendChild(element);
+            if (!readChildren(pStream, pDocument, &element)) {
+                return false;
+            }
+            break;
+        }
+        case NodeType::Text:
+            pParent->appendChild(pDocument->createTextNode(value));
+            break;
+        case NodeType::CDATASection:
+            pParent->appendChild(pDocument->createCDATASection(value));
+            break;
+        default:
+            return false;
+        }
+    }
+    return pStream->status() == QDataStream::Ok;
+}
+
+QDomDocument readCompiledDocument(const QString& compiledPath) {
+    QFile file(compiledPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QDomDocument();
+    }
+    QDataStream stream(&file);
+    stream.setVersion(kStreamVersion);
+    quint32 magic;
+    quint32 version;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok ||
+            magic != kFileMagic ||
+            version != kFileVersion) {
+        return QDomDocument();
+    }
+    // A named document is valid, i.e. it can create nodes
+    QDomDocument document(QStringLiteral("skin"));
+    if (!readChildren(&stream, &document, &document) ||
+            document.documentElement().isNull()) {
+        kLogger.warning() << "Ignoring corrupt cache file" << compiledPath;
+        return QDomDocument();
+    }
+    return document;
+}
+
+void writeCompiledDocument(const QString& compiledPath, const QDomDocument& document) {
+    if (!QDir().mkpath(QFileInfo(compiledPath).absolutePath())) {
+        return;
+    }
+    // Never leaves a partially written file behind
+    QSaveFile file(compiledPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Failed to create cache file" << compiledPath;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(kStreamVersion);
+    stream << kFileMagic << kFileVersion;
+    writeChildren(&stream, document);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        kLogger.warning() << "Failed to write cache file" << compiledPath;
+    }
+}
+
+QDomDocument parseDocument(const QByteArray& content, const QString& filePath) {
+    QDomDocument document;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    const auto parseResult = document.setContent(content);
+    if (!parseResult) {
+        kLogger.warning() << "Failed to parse" << filePath
+                          << "line:" << parseResult.errorLine
+                          << "column:" << parseResult.errorColumn
+                          << "message:" << parseResult.errorMessage;
+#else
+    QString errorMessage;
+    int errorLine;
+    int errorColumn;
+    if (!document.setContent(content, &errorMessage, &errorLine, &errorColumn)) {
+        kLogger.warning() << "Failed to parse" << filePath
+                          << "line:" << errorLine
+                          << "column:" << errorColumn
+                          << "message:" << errorMessage;
+#endif
+        return QDomDocument();
+    }
+    return document;
+}
+
+QDomDocument loadDocument(const QByteArray& content,
+        const QString& filePath,
+        const QString& cacheDirectory) {
+    if (cacheDirectory.isEmpty() || CmdlineArgs::Instance().getDeveloper()) {
+        return parseDocument(content, filePath);
+    }
+    const QString compiledPath = QDir(cacheDirectory)
+                                         .filePath(QString::fromLatin1(
+                                                 QCryptographicHash::hash(content,
+                                                         QCryptographicHash::Sha1)
+                                                         .toHex()) +
+                                                 kFileSuffix);
+    QDomDocument document = readCompiledDocument(compiledPath);
+    if (!document.isNull()) {
+        return document;
+    }
+    document = parseDocument(content, filePath);
+    if (!document.isNull()) {
+        writeCompiledDocument(compiledPath, document);
+    }
+    return document;
+}
+
+} // anonymous namespace
+
+// static
+void SkinDocumentCache::setCacheDirectory(const QString& cacheDirectory) {
+    const auto locker = lockMutex(&s_mutex);
+    s_cacheDirectory = cacheDirectory;
+}
+
+// static
+QDomElement SkinDocumentCache::documentElement(const QString& filePath) {
+    const QFileInfo fileInfo(filePath);
+    const QString absolutePath = fileInfo.absoluteFilePath();
+    const QDateTime lastModified = fileInfo.lastModified();
+    const qint64 size = fileInfo.size();
+
+    const auto locker = lockMutex(&s_mutex);
+    const auto it = s_entries.constFind(absolutePath);
+    if (it != s_entries.constEnd() &&
+            it->lastModified == lastModified &&
+            it->size == size) {
+        return it->document.documentElement();
+    }
+
+    QFile file(absolutePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        kLogger.warning() << "Could not open" << absolutePath;
+        return QDomElement();
+    }
+    const QDomDocument document = loadDocument(file.readAll(), absolutePath, s_cacheDirectory);
+    if (document.isNull()) {
+        s_entries.remove(absolutePath);
+        return QDomElement();
+    }
+    s_entries.insert(absolutePath, Entry{lastModified, size, document});
+    return document.documentElement();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QDomElement>
+#include <QString>
+
+/// Caches the parsed XML documents of the legacy skins, i.e. skin.xml and
+/// all templates, for every LegacySkinParser.
+///
+/// The documents stay in memory and are only parsed again after the file
+/// has been modified, so a skin change or a template that is shared by
+/// multiple skins does not read and parse the same file again.
+///
+/// If a cache directory has been set, each document is also stored on disk
+/// in a compact binary form, named after the SHA-1 hash of the file
+/// contents. Restoring a document from this form is much faster than
+/// parsing the XML on the next start. The binary form has no line numbers,
+/// so it is bypassed in developer mode where skin warnings must point to
+/// the XML source.
+class SkinDocumentCache {
+  public:
+    static void setCacheDirectory(const QString& cacheDirectory);
+
+    /// Returns the document element of the XML file or a null element
+    /// if the file could not be read or parsed.
+    static QDomElement documentElement(const QString& filePath);
+};
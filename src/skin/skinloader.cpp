@@ -11,10 +11,12 @@
 #include "skin/legacy/launchimage.h"
 #include "skin/legacy/legacyskin.h"
 #include "skin/legacy/legacyskinparser.h"
+#include "skin/legacy/skindocumentcache.h"
 #include "util/debug.h"
 #include "util/timer.h"
 
 const QString kSkinsDirName = QStringLiteral("skins");
+const QString kSkinCacheDirName = QStringLiteral("skincache");
 
 namespace mixxx {
 namespace skin {
@@ -26,6 +28,8 @@ SkinLoader::SkinLoader(UserSettingsPointer pConfig)
           m_spinnyCoverControlsCreated(false),
           m_micDuckingControlsCreated(false),
           m_numMicsEnabled(1) {
+    SkinDocumentCache::setCacheDirectory(
+            QDir(m_pConfig->getSettingsPath()).filePath(kSkinCacheDirName));
 }
 
 SkinLoader::~SkinLoader() {
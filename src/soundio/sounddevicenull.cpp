@@ -0,0 +1,76 @@
+#include "soundio/sounddevicenull.h"
+
+#include "control/controlobject.h"
+#include "soundio/soundmanager.h"
+#include "soundio/soundmanagerconfig.h"
+#include "util/logger.h"
+#include "util/trace.h"
+
+namespace {
+
+const mixxx::Logger kLogger("SoundDeviceNull");
+
+const QString kAppGroup = QStringLiteral("[App]");
+
+} // namespace
+
+SoundDeviceNull::SoundDeviceNull(UserSettingsPointer config,
+        SoundManager* sm,
+        mixxx::audio::SampleRate sampleRate)
+        : SoundDevice(config, sm),
+          m_isOpen(false) {
+    // Setting parent class members:
+    m_hostAPI = QStringLiteral("None");
+    setSampleRate(sampleRate);
+    m_deviceId.name = QStringLiteral("Null");
+    m_strDisplayName = QObject::tr("Offline rendering");
+    m_numInputChannels = mixxx::audio::ChannelCount();
+    m_numOutputChannels = mixxx::audio::ChannelCount::stereo();
+}
+
+SoundDeviceStatus SoundDeviceNull::open(bool isClkRefDevice, int syncBuffers) {
+    Q_UNUSED(syncBuffers);
+    VERIFY_OR_DEBUG_ASSERT(isClkRefDevice) {
+        return SoundDeviceStatus::Error;
+    }
+    kLogger.debug() << "open:" << m_configFramesPerBuffer << "frames/buffer @"
+                    << m_sampleRate << "Hz";
+
+    // There is no output latency, every buffer is rendered on demand
+    ControlObject::set(ConfigKey(kAppGroup, QStringLiteral("output_latency_ms")), 0.0);
+    ControlObject::set(ConfigKey(kAppGroup, QStringLiteral("samplerate")), m_sampleRate);
+    m_isOpen = true;
+    return SoundDeviceStatus::Ok;
+}
+
+SoundDeviceStatus SoundDeviceNull::close() {
+    m_isOpen = false;
+    return SoundDeviceStatus::Ok;
+}
+
+mixxx::audio::SampleRate SoundDeviceNull::getDefaultSampleRate() const {
+    return SoundManagerConfig::kMixxxDefaultSampleRate;
+}
+
+void SoundDeviceNull::readProcess(SINT framesPerBuffer) {
+    Q_UNUSED(framesPerBuffer);
+}
+
+void SoundDeviceNull::writeProcess(SINT framesPerBuffer) {
+    Q_UNUSED(framesPerBuffer);
+}
+
+void SoundDeviceNull::process(CSAMPLE* pOutput, SINT framesPerBuffer) {
+    DEBUG_ASSERT(m_isOpen);
+    Trace trace("SoundDeviceNull::process");
+
+    // The same sequence as the callback of a clock reference device,
+    // see SoundDevicePortAudio::callbackProcessClkRef()
+    m_pSoundManager->readProcess(framesPerBuffer);
+    m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
+    composeOutputBuffer(pOutput,
+            framesPerBuffer,
+            0,
+            m_numOutputChannels);
+    m_pSoundManager->writeProcess(framesPerBuffer);
+}
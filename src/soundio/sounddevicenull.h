@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+
+#include "soundio/sounddevice.h"
+#include "util/types.h"
+
+class SoundManager;
+
+/// A sound device without any hardware. Instead of being driven by the
+/// callback of an audio API, the owner calls process() to render the next
+/// buffer as fast as possible, e.g. for rendering a mix offline.
+///
+/// The device only has outputs. It must be opened as the clock reference,
+/// because nothing else drives the engine.
+class SoundDeviceNull : public SoundDevice {
+  public:
+    SoundDeviceNull(UserSettingsPointer config,
+            SoundManager* sm,
+            mixxx::audio::SampleRate sampleRate);
+    ~SoundDeviceNull() override = default;
+
+    SoundDeviceStatus open(bool isClkRefDevice, int syncBuffers) override;
+    bool isOpen() const override {
+        return m_isOpen;
+    }
+    SoundDeviceStatus close() override;
+    void readProcess(SINT framesPerBuffer) override;
+    void writeProcess(SINT framesPerBuffer) override;
+    QString getError() const override {
+        return QString();
+    }
+
+    mixxx::audio::SampleRate getDefaultSampleRate() const override;
+
+    /// Processes the engine like the callback of a clock reference device
+    /// and writes framesPerBuffer interleaved stereo frames to pOutput.
+    void process(CSAMPLE* pOutput, SINT framesPerBuffer);
+
+  private:
+    bool m_isOpen;
+};
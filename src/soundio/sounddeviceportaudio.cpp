@@ -17,6 +17,7 @@
 #include "util/fifo.h"
 #include "util/math.h"
 #include "util/sample.h"
+#include "util/rtprofiler.h"
 #include "util/timer.h"
 #include "util/trace.h"
 #include "waveform/visualplayposition.h"
@@ -126,6 +127,18 @@ SoundDevicePortAudio::SoundDevicePortAudio(UserSettingsPointer config,
         m_deviceId.name = deviceInfo->name;
     }
     m_deviceId.portAudioIndex = devIndex;
+    m_callbackProfilerStage = mixxx::RtProfiler::registerStage(
+            QStringLiteral("SoundDevicePortAudio::callbackProcessClkRef %1")
+                    .arg(m_deviceId.debugName()));
+    m_prepareProfilerStage = mixxx::RtProfiler::registerStage(
+            QStringLiteral("SoundDevicePortAudio::callbackProcess prepare %1")
+                    .arg(m_deviceId.debugName()));
+    m_outputProfilerStage = mixxx::RtProfiler::registerStage(
+            QStringLiteral("SoundDevicePortAudio::callbackProcess output %1")
+                    .arg(m_deviceId.debugName()));
+    m_writeProfilerStage = mixxx::RtProfiler::registerStage(
+            QStringLiteral("SoundDevicePortAudio::writeProcess %1")
+                    .arg(m_deviceId.debugName()));
     m_strDisplayName = QString::fromUtf8(deviceInfo->name);
     m_numInputChannels = mixxx::audio::ChannelCount(m_deviceInfo->maxInputChannels);
     m_numOutputChannels = mixxx::audio::ChannelCount(m_deviceInfo->maxOutputChannels);
@@ -666,6 +679,7 @@ void SoundDevicePortAudio::writeProcess(SINT framesPerBuffer) {
     if (!pStream) {
         return;
     }
+    mixxx::RtProfilerScope profilerScope(m_writeProfilerStage);
     if (m_outputParams.channelCount && m_outputFifo) {
         int outChunkSize = framesPerBuffer * m_outputParams.channelCount;
         int writeAvailable = m_outputFifo->writeAvailable();
@@ -962,6 +976,7 @@ int SoundDevicePortAudio::callbackProcessClkRef(
 
     Trace trace("SoundDevicePortAudio::callbackProcessClkRef %1",
             m_deviceId.debugName());
+    mixxx::RtProfilerScope profilerScope(m_callbackProfilerStage);
 
     //qDebug() << "SoundDevicePortAudio::callbackProcess:" << m_deviceId;
 
@@ -1073,12 +1088,14 @@ int SoundDevicePortAudio::callbackProcessClkRef(
     {
         ScopedTimer t(QStringLiteral("SoundDevicePortAudio::callbackProcess prepare %1"),
                 m_deviceId.debugName());
+        mixxx::RtProfilerScope prepareProfilerScope(m_prepareProfilerStage);
         m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
     }
 
     if (out) {
         ScopedTimer t(QStringLiteral("SoundDevicePortAudio::callbackProcess output %1"),
                 m_deviceId.debugName());
+        mixxx::RtProfilerScope outputProfilerScope(m_outputProfilerStage);
 
         if (m_outputParams.channelCount <= 0) {
             qWarning()
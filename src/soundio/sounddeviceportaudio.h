@@ -12,6 +12,7 @@
 #include "util/duration.h"
 #include "util/fifo.h"
 #include "util/performancetimer.h"
+#include "util/rtprofiler.h"
 
 class SoundManager;
 
@@ -91,6 +92,10 @@ class SoundDevicePortAudio : public SoundDevice {
     PerformanceTimer m_clkRefTimer;
     PaTime m_lastCallbackEntrytoDacSecs;
     std::atomic<int> m_callbackResult;
+    mixxx::RtProfilerStage m_callbackProfilerStage;
+    mixxx::RtProfilerStage m_prepareProfilerStage;
+    mixxx::RtProfilerStage m_outputProfilerStage;
+    mixxx::RtProfilerStage m_writeProfilerStage;
     std::mutex m_finishedMutex;
     std::condition_variable m_finishedCV;
     bool m_bFinished;
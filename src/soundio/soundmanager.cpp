@@ -61,6 +61,8 @@ SoundManager::SoundManager(UserSettingsPointer pConfig,
           m_pErrorDevice(nullptr),
           m_underflowHappened(0),
           m_underflowUpdateCount(0),
+          m_underflowProfilerStage(mixxx::RtProfiler::registerStage(
+                  QStringLiteral("SoundManager::underflowHappened"))),
           m_audioLatencyOverloadCount(kAppGroup, QStringLiteral("audio_latency_overload_count")),
           m_audioLatencyOverload(kAppGroup, QStringLiteral("audio_latency_overload")) {
     // TODO(xxx) some of these ControlObject are not needed by soundmanager, or are unused here.
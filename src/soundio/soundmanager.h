@@ -13,6 +13,7 @@
 #include "soundio/sounddevice.h"
 #include "soundio/soundmanagerconfig.h"
 #include "util/cmdlineargs.h"
+#include "util/rtprofiler.h"
 #include "util/types.h"
 
 class EngineMixer;
@@ -103,6 +104,8 @@ class SoundManager : public QObject {
 
     void underflowHappened(int code) {
         m_underflowHappened = 1;
+        // Marks the xrun in the trace of the engine profiler
+        mixxx::RtProfiler::recordInstant(m_underflowProfilerStage);
         // Disable the engine warnings by default, because printing a warning is a
         // locking function that will make the problem worse
         if (CmdlineArgs::Instance().getDeveloper()) {
@@ -160,6 +163,7 @@ class SoundManager : public QObject {
 
     QAtomicInt m_underflowHappened;
     int m_underflowUpdateCount;
+    const mixxx::RtProfilerStage m_underflowProfilerStage;
     PollingControlProxy m_audioLatencyOverloadCount;
     PollingControlProxy m_audioLatencyOverload;
 };
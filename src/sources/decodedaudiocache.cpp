@@ -0,0 +1,426 @@
+#include "sources/decodedaudiocache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QMutex>
+#include <cstring>
+#include <type_traits>
+
+#include "track/track.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+#include "util/sample.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("DecodedAudioCache");
+
+const QString kConfigGroup = QStringLiteral("[DecodedAudioCache]");
+const QString kMaxSizeKey = QStringLiteral("max_size_mb");
+
+const QString kFileSuffix = QStringLiteral(".pcm");
+
+constexpr char kMagic[8] = {'M', 'I', 'X', 'X', 'X', 'P', 'C', 'M'};
+constexpr quint32 kByteOrderMark = 0x01020304;
+constexpr quint32 kVersion = 1;
+
+// Keeps the samples aligned for SIMD instructions
+constexpr qint64 kSampleDataOffset = 64;
+
+struct FileHeader {
+    char magic[sizeof(kMagic)];
+    // Files are written in native byte order
+    quint32 byteOrderMark;
+    quint32 version;
+    quint32 channelCount;
+    quint32 requestedChannelCount;
+    quint32 sampleRate;
+    quint32 bitrate;
+    qint64 firstFrameIndex;
+    qint64 frameCount;
+};
+static_assert(sizeof(FileHeader) <= kSampleDataOffset);
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+
+// Serializes the eviction of files by multiple writers
+QMutex s_evictionMutex;
+
+void evictLeastRecentlyUsedFiles(const QDir& directory, qint64 maxSizeBytes) {
+    const auto locker = lockMutex(&s_evictionMutex);
+    // Sorted by modification time with the most recently used file first,
+    // see touchFile()
+    const auto fileInfos = directory.entryInfoList(
+            QStringList{QStringLiteral("*") + kFileSuffix},
+            QDir::Files,
+            QDir::Time);
+    qint64 totalSizeBytes = 0;
+    for (const auto& fileInfo : fileInfos) {
+        totalSizeBytes += fileInfo.size();
+        if (totalSizeBytes <= maxSizeBytes) {
+            continue;
+        }
+        // Files that are still mapped might not be removable on all
+        // platforms. They will be removed by the next eviction.
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            kLogger.debug()
+                    << "Evicted" << fileInfo.fileName();
+        }
+    }
+}
+
+// Marks the file as recently used
+void touchFile(const QString& filePath) {
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+}
+
+// Decoding the file again with the requested number of channels would
+// result in the same signal that has been cached.
+bool isCompatible(
+        audio::ChannelCount requestedChannelCount,
+        const MappedSampleFrames& mappedSampleFrames) {
+    const auto cachedRequestedChannelCount = mappedSampleFrames.getRequestedChannelCount();
+    if (requestedChannelCount == cachedRequestedChannelCount) {
+        return true;
+    }
+    // The cached signal has fewer channels than requested, i.e. it
+    // has not been downmixed.
+    const auto cachedChannelCount = mappedSampleFrames.getSignalInfo().getChannelCount();
+    if (cachedRequestedChannelCount.isValid() &&
+            cachedChannelCount >= cachedRequestedChannelCount) {
+        return false;
+    }
+    return !requestedChannelCount.isValid() ||
+            requestedChannelCount >= cachedChannelCount;
+}
+
+} // anonymous namespace
+
+// static
+MappedSampleFramesPointer MappedSampleFrames::map(const QString& filePath) {
+    auto pMapped = std::shared_ptr<MappedSampleFrames>(new MappedSampleFrames());
+    pMapped->m_file.setFileName(filePath);
+    if (!pMapped->m_file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    const qint64 fileSize = pMapped->m_file.size();
+    if (fileSize < kSampleDataOffset) {
+        kLogger.warning() << "Truncated file" << filePath;
+        return nullptr;
+    }
+    const uchar* pData = pMapped->m_file.map(0, fileSize);
+    if (!pData) {
+        kLogger.warning()
+                << "Failed to map file"
+                << filePath
+                << pMapped->m_file.errorString();
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, pData, sizeof(header));
+    const auto channelCount = audio::ChannelCount::fromInt(
+            static_cast<int>(header.channelCount));
+    const auto sampleRate = audio::SampleRate(
+            static_cast<audio::SampleRate::value_t>(header.sampleRate));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.byteOrderMark != kByteOrderMark ||
+            header.version != kVersion ||
+            !channelCount.isValid() ||
+            !sampleRate.isValid() ||
+            header.frameCount < 0 ||
+            fileSize != kSampleDataOffset +
+                            header.frameCount * channelCount *
+                                    static_cast<qint64>(sizeof(CSAMPLE))) {
+        kLogger.warning() << "Invalid file" << filePath;
+        return nullptr;
+    }
+
+    pMapped->m_pSamples = reinterpret_cast<const CSAMPLE*>(pData + kSampleDataOffset);
+    pMapped->m_signalInfo = audio::SignalInfo(channelCount, sampleRate);
+    pMapped->m_bitrate = audio::Bitrate(header.bitrate);
+    pMapped->m_requestedChannelCount = audio::ChannelCount::fromInt(
+            static_cast<int>(header.requestedChannelCount));
+    pMapped->m_frameIndexRange = IndexRange::forward(
+            static_cast<SINT>(header.firstFrameIndex),
+            static_cast<SINT>(header.frameCount));
+    return pMapped;
+}
+
+MappedSampleFrames::~MappedSampleFrames() {
+    // Closing the file also unmaps it
+    m_file.close();
+}
+
+ReadableSampleFrames MappedSampleFrames::readableSampleFrames(
+        IndexRange frameIndexRange) const {
+    const auto readableFrameIndexRange = intersect(frameIndexRange, m_frameIndexRange);
+    if (readableFrameIndexRange.empty()) {
+        return ReadableSampleFrames(readableFrameIndexRange);
+    }
+    return ReadableSampleFrames(
+            readableFrameIndexRange,
+            SampleBuffer::ReadableSlice(
+                    m_pSamples +
+                            m_signalInfo.frames2samples(
+                                    readableFrameIndexRange.start() -
+                                    m_frameIndexRange.start()),
+                    m_signalInfo.frames2samples(readableFrameIndexRange.length())));
+}
+
+AudioSourceDecodedCache::AudioSourceDecodedCache(
+        const QUrl& url,
+        MappedSampleFramesPointer pMappedSampleFrames)
+        : AudioSource(url),
+          m_pMappedSampleFrames(std::move(pMappedSampleFrames)) {
+    DEBUG_ASSERT(m_pMappedSampleFrames);
+}
+
+AudioSourceDecodedCache::~AudioSourceDecodedCache() {
+    close();
+}
+
+void AudioSourceDecodedCache::close() {
+    // Nothing to do. The file is unmapped when the last reference
+    // to the mapped sample frames is dropped.
+}
+
+AudioSource::OpenResult AudioSourceDecodedCache::tryOpen(
+        OpenMode /*mode*/,
+        const OpenParams& /*params*/) {
+    if (!initChannelCountOnce(m_pMappedSampleFrames->getSignalInfo().getChannelCount()) ||
+            !initSampleRateOnce(m_pMappedSampleFrames->getSignalInfo().getSampleRate()) ||
+            !initFrameIndexRangeOnce(m_pMappedSampleFrames->frameIndexRange())) {
+        return OpenResult::Failed;
+    }
+    if (m_pMappedSampleFrames->getBitrate().isValid()) {
+        initBitrateOnce(m_pMappedSampleFrames->getBitrate());
+    }
+    return OpenResult::Succeeded;
+}
+
+ReadableSampleFrames AudioSourceDecodedCache::readSampleFramesClamped(
+        const WritableSampleFrames& writableSampleFrames) {
+    const auto mappedSampleFrames = m_pMappedSampleFrames->readableSampleFrames(
+            writableSampleFrames.frameIndexRange());
+    DEBUG_ASSERT(mappedSampleFrames.frameIndexRange() ==
+            writableSampleFrames.frameIndexRange());
+    SampleUtil::copy(
+            writableSampleFrames.writableData(),
+            mappedSampleFrames.readableData(),
+            mappedSampleFrames.readableLength());
+    return ReadableSampleFrames(
+            mappedSampleFrames.frameIndexRange(),
+            SampleBuffer::ReadableSlice(
+                    writableSampleFrames.writableData(),
+                    mappedSampleFrames.readableLength()));
+}
+
+DecodedAudioCacheWriter::DecodedAudioCacheWriter(
+        const QString& filePath,
+        const QDir& directory,
+        qint64 maxSizeBytes,
+        audio::ChannelCount requestedChannelCount,
+        const audio::SignalInfo& signalInfo,
+        audio::Bitrate bitrate,
+        IndexRange frameIndexRange)
+        : m_file(filePath),
+          m_directory(directory),
+          m_maxSizeBytes(maxSizeBytes),
+          m_requestedChannelCount(requestedChannelCount),
+          m_signalInfo(signalInfo),
+          m_bitrate(bitrate),
+          m_frameIndexRange(frameIndexRange),
+          m_writtenFrameIndexRange(IndexRange::forward(frameIndexRange.start(), 0)),
+          m_failed(false) {
+    DEBUG_ASSERT(m_signalInfo.isValid());
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        kLogger.warning()
+                << "Failed to create file"
+                << filePath
+                << m_file.errorString();
+        m_failed = true;
+        return;
+    }
+    // The header is written upfront, because the file is only committed
+    // if all frames have been written.
+    char headerBytes[kSampleDataOffset] = {};
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.byteOrderMark = kByteOrderMark;
+    header.version = kVersion;
+    header.channelCount = m_signalInfo.getChannelCount();
+    header.requestedChannelCount = m_requestedChannelCount;
+    header.sampleRate = m_signalInfo.getSampleRate();
+    header.bitrate = m_bitrate;
+    header.firstFrameIndex = m_frameIndexRange.start();
+    header.frameCount = m_frameIndexRange.length();
+    std::memcpy(headerBytes, &header, sizeof(header));
+    if (m_file.write(headerBytes, sizeof(headerBytes)) != sizeof(headerBytes)) {
+        m_failed = true;
+    }
+}
+
+DecodedAudioCacheWriter::~DecodedAudioCacheWriter() {
+    if (m_file.isOpen()) {
+        // Discard the incomplete file
+        m_file.cancelWriting();
+    }
+}
+
+bool DecodedAudioCacheWriter::write(const ReadableSampleFrames& sampleFrames) {
+    if (m_failed) {
+        return false;
+    }
+    if (sampleFrames.frameIndexRange().empty()) {
+        return true;
+    }
+    if (sampleFrames.frameIndexRange().start() != m_writtenFrameIndexRange.end() ||
+            !sampleFrames.frameIndexRange().isSubrangeOf(m_frameIndexRange) ||
+            sampleFrames.readableLength() !=
+                    m_signalInfo.frames2samples(sampleFrames.frameLength())) {
+        // Gaps occur if the file could not be decoded completely
+        kLogger.debug()
+                << "Discarding non-consecutive frames"
+                << sampleFrames.frameIndexRange()
+                << "after"
+                << m_writtenFrameIndexRange;
+        m_failed = true;
+        return false;
+    }
+    const qint64 bytes = sampleFrames.readableLength() * static_cast<qint64>(sizeof(CSAMPLE));
+    if (m_file.write(reinterpret_cast<const char*>(sampleFrames.readableData()), bytes) !=
+            bytes) {
+        kLogger.warning()
+                << "Failed to write"
+                << m_file.fileName()
+                << m_file.errorString();
+        m_failed = true;
+        return false;
+    }
+    m_writtenFrameIndexRange.growBack(sampleFrames.frameLength());
+    return true;
+}
+
+bool DecodedAudioCacheWriter::commit() {
+    if (m_failed || !isComplete()) {
+        return false;
+    }
+    if (!m_file.commit()) {
+        kLogger.warning()
+                << "Failed to commit"
+                << m_file.fileName()
+                << m_file.errorString();
+        m_failed = true;
+        return false;
+    }
+    kLogger.debug()
+            << "Cached" << m_writtenFrameIndexRange.length()
+            << "frames in" << m_file.fileName();
+    evictLeastRecentlyUsedFiles(m_directory, m_maxSizeBytes);
+    return true;
+}
+
+// static
+std::shared_ptr<DecodedAudioCache> DecodedAudioCache::create(
+        const UserSettingsPointer& pConfig) {
+    if (!pConfig) {
+        return nullptr;
+    }
+    const int maxSizeMB = pConfig->getValue(ConfigKey(kConfigGroup, kMaxSizeKey), 0);
+    if (maxSizeMB <= 0) {
+        return nullptr;
+    }
+    QDir directory(pConfig->getSettingsPath() + QStringLiteral("/decoded_audio_cache"));
+    if (!directory.mkpath(QStringLiteral("."))) {
+        kLogger.warning()
+                << "Failed to create directory"
+                << directory.absolutePath();
+        return nullptr;
+    }
+    return std::make_shared<DecodedAudioCache>(
+            directory,
+            static_cast<qint64>(maxSizeMB) * 1024 * 1024);
+}
+
+DecodedAudioCache::DecodedAudioCache(
+        const QDir& directory,
+        qint64 maxSizeBytes)
+        : m_directory(directory),
+          m_maxSizeBytes(maxSizeBytes) {
+}
+
+// static
+cache_key_t DecodedAudioCache::cacheKey(
+        const TrackPointer& pTrack,
+        const AudioSource::OpenParams& params) {
+    auto fileInfo = pTrack->getFileInfo();
+    // Detect modifications of the file since it has been added
+    fileInfo.refresh();
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(fileInfo.location().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.sizeInBytes()));
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+#ifdef __STEM__
+    hash.addData(QByteArray::number(static_cast<int>(params.stemMask())));
+#else
+    Q_UNUSED(params);
+#endif
+    return cacheKeyFromMessageDigest(hash.result());
+}
+
+QString DecodedAudioCache::filePath(cache_key_t cacheKey) const {
+    return m_directory.filePath(QString::number(cacheKey, 16) + kFileSuffix);
+}
+
+AudioSourcePointer DecodedAudioCache::openAudioSource(
+        const TrackPointer& pTrack,
+        const AudioSource::OpenParams& params) const {
+    const QString cacheFilePath = filePath(cacheKey(pTrack, params));
+    if (!QFile::exists(cacheFilePath)) {
+        return nullptr;
+    }
+    const auto pMappedSampleFrames = MappedSampleFrames::map(cacheFilePath);
+    if (!pMappedSampleFrames ||
+            !isCompatible(params.getSignalInfo().getChannelCount(),
+                    *pMappedSampleFrames)) {
+        return nullptr;
+    }
+    auto pAudioSource = std::make_shared<AudioSourceDecodedCache>(
+            pTrack->getFileInfo().toQUrl(),
+            pMappedSampleFrames);
+    if (pAudioSource->open(AudioSource::OpenMode::Strict, params) !=
+            AudioSource::OpenResult::Succeeded) {
+        return nullptr;
+    }
+    touchFile(cacheFilePath);
+    kLogger.debug()
+            << "Opened cached audio data of"
+            << pTrack->getLocation();
+    return pAudioSource;
+}
+
+std::unique_ptr<DecodedAudioCacheWriter> DecodedAudioCache::createWriter(
+        const TrackPointer& pTrack,
+        const AudioSource::OpenParams& params,
+        const audio::SignalInfo& signalInfo,
+        audio::Bitrate bitrate,
+        IndexRange frameIndexRange) const {
+    VERIFY_OR_DEBUG_ASSERT(signalInfo.isValid()) {
+        return nullptr;
+    }
+    return std::make_unique<DecodedAudioCacheWriter>(
+            filePath(cacheKey(pTrack, params)),
+            m_directory,
+            m_maxSizeBytes,
+            params.getSignalInfo().getChannelCount(),
+            signalInfo,
+            bitrate,
+            frameIndexRange);
+}
+
+} // namespace mixxx
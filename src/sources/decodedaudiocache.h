@@ -0,0 +1,179 @@
+#pragma once
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <memory>
+
+#include "preferences/usersettings.h"
+#include "sources/audiosource.h"
+#include "track/track_decl.h"
+#include "util/cache.h"
+
+namespace mixxx {
+
+/// Decoded sample frames of a track, memory-mapped from a file of the
+/// DecodedAudioCache. The mapping stays valid as long as a reference
+/// exists, independent of the audio source that has opened it.
+class MappedSampleFrames final {
+  public:
+    /// Returns nullptr if the file could not be mapped or if it
+    /// is not a valid cache file.
+    static std::shared_ptr<const MappedSampleFrames> map(const QString& filePath);
+    ~MappedSampleFrames();
+
+    MappedSampleFrames(const MappedSampleFrames&) = delete;
+    MappedSampleFrames& operator=(const MappedSampleFrames&) = delete;
+
+    const audio::SignalInfo& getSignalInfo() const {
+        return m_signalInfo;
+    }
+    audio::Bitrate getBitrate() const {
+        return m_bitrate;
+    }
+    IndexRange frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+    /// The number of channels that has been requested when decoding
+    /// the track, which could have caused a downmix.
+    audio::ChannelCount getRequestedChannelCount() const {
+        return m_requestedChannelCount;
+    }
+
+    /// The mapped samples of the given frames without copying them.
+    ReadableSampleFrames readableSampleFrames(IndexRange frameIndexRange) const;
+
+  private:
+    MappedSampleFrames() = default;
+
+    QFile m_file;
+    const CSAMPLE* m_pSamples = nullptr;
+    audio::SignalInfo m_signalInfo;
+    audio::Bitrate m_bitrate;
+    audio::ChannelCount m_requestedChannelCount;
+    IndexRange m_frameIndexRange;
+};
+
+typedef std::shared_ptr<const MappedSampleFrames> MappedSampleFramesPointer;
+
+/// Reads the memory-mapped sample frames of a track in the
+/// DecodedAudioCache instead of decoding the file.
+class AudioSourceDecodedCache : public AudioSource {
+  public:
+    AudioSourceDecodedCache(
+            const QUrl& url,
+            MappedSampleFramesPointer pMappedSampleFrames);
+    ~AudioSourceDecodedCache() override;
+
+    void close() override;
+
+    /// Allows to access the sample frames without copying them.
+    /// The returned mapping stays valid after closing the source.
+    const MappedSampleFramesPointer& mappedSampleFrames() const {
+        return m_pMappedSampleFrames;
+    }
+
+  protected:
+    OpenResult tryOpen(
+            OpenMode mode,
+            const OpenParams& params) override;
+
+    ReadableSampleFrames readSampleFramesClamped(
+            const WritableSampleFrames& writableSampleFrames) override;
+
+  private:
+    MappedSampleFramesPointer m_pMappedSampleFrames;
+};
+
+/// Writes the decoded sample frames of a track into the DecodedAudioCache.
+/// The frames must be written consecutively from the first to the last
+/// frame. The file only becomes visible for readers after commit() has
+/// succeeded and is discarded otherwise.
+class DecodedAudioCacheWriter final {
+  public:
+    DecodedAudioCacheWriter(
+            const QString& filePath,
+            const QDir& directory,
+            qint64 maxSizeBytes,
+            audio::ChannelCount requestedChannelCount,
+            const audio::SignalInfo& signalInfo,
+            audio::Bitrate bitrate,
+            IndexRange frameIndexRange);
+    ~DecodedAudioCacheWriter();
+
+    DecodedAudioCacheWriter(const DecodedAudioCacheWriter&) = delete;
+    DecodedAudioCacheWriter& operator=(const DecodedAudioCacheWriter&) = delete;
+
+    /// Appends the next sample frames. Returns false if writing has
+    /// failed or if the frames do not directly follow the frames that
+    /// have been written before. All following writes are ignored then.
+    bool write(const ReadableSampleFrames& sampleFrames);
+
+    /// Returns true after all frames have been written.
+    bool isComplete() const {
+        return m_writtenFrameIndexRange == m_frameIndexRange;
+    }
+
+    /// Stores the file in the cache if complete and evicts the least
+    /// recently used files if the cache exceeds its maximum size.
+    bool commit();
+
+  private:
+    QSaveFile m_file;
+    const QDir m_directory;
+    const qint64 m_maxSizeBytes;
+    const audio::ChannelCount m_requestedChannelCount;
+    const audio::SignalInfo m_signalInfo;
+    const audio::Bitrate m_bitrate;
+    const IndexRange m_frameIndexRange;
+    IndexRange m_writtenFrameIndexRange;
+    bool m_failed;
+};
+
+/// DecodedAudioCache stores the decoded audio data of tracks as raw
+/// interleaved samples in files that are memory-mapped for reading.
+/// This allows to load tracks that have been analyzed or played before
+/// without running the decoder again.
+///
+/// The files are keyed by a cache key of the file location, size,
+/// modification time and (for stems) the selected stems, so modified
+/// files are decoded again. The least recently used files are deleted
+/// when the total size exceeds [DecodedAudioCache],max_size_mb. The
+/// cache is disabled if the size is 0, which is the default.
+class DecodedAudioCache final {
+  public:
+    /// Returns nullptr if the cache is disabled.
+    static std::shared_ptr<DecodedAudioCache> create(
+            const UserSettingsPointer& pConfig);
+
+    DecodedAudioCache(
+            const QDir& directory,
+            qint64 maxSizeBytes);
+
+    /// Opens the cached audio data of the track if available and
+    /// compatible with the given parameters. Returns nullptr otherwise.
+    AudioSourcePointer openAudioSource(
+            const TrackPointer& pTrack,
+            const AudioSource::OpenParams& params) const;
+
+    /// Returns a writer for the decoded audio source that has been
+    /// opened with the given parameters or nullptr on failure.
+    std::unique_ptr<DecodedAudioCacheWriter> createWriter(
+            const TrackPointer& pTrack,
+            const AudioSource::OpenParams& params,
+            const audio::SignalInfo& signalInfo,
+            audio::Bitrate bitrate,
+            IndexRange frameIndexRange) const;
+
+    static cache_key_t cacheKey(
+            const TrackPointer& pTrack,
+            const AudioSource::OpenParams& params);
+
+  private:
+    QString filePath(cache_key_t cacheKey) const;
+
+    const QDir m_directory;
+    const qint64 m_maxSizeBytes;
+};
+
+} // namespace mixxx
@@ -0,0 +1,163 @@
+#include "analyzer/analyzerpipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "analyzer/analyzertrack.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr SINT kSamplesPerChunk = 16;
+constexpr int kChunkCount = 100;
+
+// Records the first sample of every chunk
+class RecordingAnalyzer : public Analyzer {
+  public:
+    explicit RecordingAnalyzer(int failAfterChunks = -1)
+            : m_failAfterChunks(failAfterChunks),
+              m_stored(false),
+              m_cleanedUp(false) {
+    }
+
+    bool initialize(const AnalyzerTrack&,
+            mixxx::audio::SampleRate,
+            mixxx::audio::ChannelCount,
+            SINT) override {
+        return true;
+    }
+
+    bool processSamples(const CSAMPLE* pIn, SINT count) override {
+        EXPECT_EQ(kSamplesPerChunk, count);
+        m_chunks.push_back(pIn[0]);
+        m_threads.push_back(QThread::currentThread());
+        return m_failAfterChunks < 0 ||
+                static_cast<int>(m_chunks.size()) < m_failAfterChunks;
+    }
+
+    void storeResults(TrackPointer) override {
+        m_stored = true;
+    }
+
+    void cleanup() override {
+        m_cleanedUp = true;
+    }
+
+    const int m_failAfterChunks;
+    std::vector<CSAMPLE> m_chunks;
+    std::vector<QThread*> m_threads;
+    bool m_stored;
+    bool m_cleanedUp;
+};
+
+class AnalyzerPipelineTest : public MixxxTest {
+  protected:
+    AnalyzerPipelineTest()
+            : m_track(Track::newTemporary()),
+              m_pipeline(kSamplesPerChunk) {
+    }
+
+    RecordingAnalyzer* addAnalyzer(int failAfterChunks = -1) {
+        auto pAnalyzer = std::make_unique<RecordingAnalyzer>(failAfterChunks);
+        RecordingAnalyzer* pRecordingAnalyzer = pAnalyzer.get();
+        m_analyzers.push_back(std::make_unique<AnalyzerWithState>(std::move(pAnalyzer)));
+        m_analyzers.back()->initialize(m_track,
+                mixxx::audio::SampleRate(44100),
+                mixxx::audio::ChannelCount::stereo(),
+                kChunkCount * kSamplesPerChunk / 2);
+        return pRecordingAnalyzer;
+    }
+
+    void start() {
+        std::vector<AnalyzerWithState*> analyzers;
+        for (const auto& pAnalyzer : m_analyzers) {
+            analyzers.push_back(pAnalyzer.get());
+        }
+        m_pipeline.start(analyzers);
+        EXPECT_TRUE(m_pipeline.isRunning());
+    }
+
+    void publishChunks(int count) {
+        for (int i = 0; i < count; ++i) {
+            auto buffer = m_pipeline.nextChunkBuffer();
+            ASSERT_EQ(kSamplesPerChunk, buffer.length());
+            std::fill(buffer.data(), buffer.data() + buffer.length(), static_cast<CSAMPLE>(i));
+            m_pipeline.publishChunk(buffer.data(), buffer.length());
+        }
+    }
+
+    AnalyzerTrack m_track;
+    std::vector<std::unique_ptr<AnalyzerWithState>> m_analyzers;
+    AnalyzerPipeline m_pipeline;
+};
+
+TEST_F(AnalyzerPipelineTest, allChunksInOrder) {
+    auto* pFirst = addAnalyzer();
+    auto* pSecond = addAnalyzer();
+    start();
+    publishChunks(kChunkCount);
+    m_pipeline.finish();
+    EXPECT_FALSE(m_pipeline.isRunning());
+
+    for (const auto* pAnalyzer : {pFirst, pSecond}) {
+        ASSERT_EQ(static_cast<size_t>(kChunkCount), pAnalyzer->m_chunks.size());
+        for (int i = 0; i < kChunkCount; ++i) {
+            EXPECT_EQ(static_cast<CSAMPLE>(i), pAnalyzer->m_chunks[i]);
+            EXPECT_NE(QThread::currentThread(), pAnalyzer->m_threads[i]);
+        }
+    }
+
+    for (const auto& pAnalyzer : m_analyzers) {
+        pAnalyzer->finish(m_track);
+    }
+    EXPECT_TRUE(pFirst->m_stored);
+    EXPECT_TRUE(pSecond->m_stored);
+}
+
+TEST_F(AnalyzerPipelineTest, failedAnalyzerReleasesChunks) {
+    auto* pFailing = addAnalyzer(3);
+    auto* pRecording = addAnalyzer();
+    start();
+    publishChunks(kChunkCount);
+    m_pipeline.finish();
+
+    EXPECT_EQ(3u, pFailing->m_chunks.size());
+    EXPECT_TRUE(pFailing->m_cleanedUp);
+    EXPECT_FALSE(m_analyzers[0]->isActive());
+    EXPECT_EQ(static_cast<size_t>(kChunkCount), pRecording->m_chunks.size());
+
+    for (const auto& pAnalyzer : m_analyzers) {
+        pAnalyzer->finish(m_track);
+    }
+    EXPECT_FALSE(pFailing->m_stored);
+    EXPECT_TRUE(pRecording->m_stored);
+}
+
+TEST_F(AnalyzerPipelineTest, cancelAndRestart) {
+    auto* pAnalyzer = addAnalyzer();
+    start();
+    publishChunks(AnalyzerPipeline::kDepth);
+    m_pipeline.cancel();
+    EXPECT_FALSE(m_pipeline.isRunning());
+    EXPECT_LE(pAnalyzer->m_chunks.size(), static_cast<size_t>(AnalyzerPipeline::kDepth));
+    m_analyzers[0]->cancel();
+
+    // All buffers are available again for the next track
+    pAnalyzer->m_chunks.clear();
+    m_analyzers[0]->initialize(m_track,
+            mixxx::audio::SampleRate(44100),
+            mixxx::audio::ChannelCount::stereo(),
+            kChunkCount * kSamplesPerChunk / 2);
+    start();
+    publishChunks(kChunkCount);
+    m_pipeline.finish();
+    EXPECT_EQ(static_cast<size_t>(kChunkCount), pAnalyzer->m_chunks.size());
+    m_analyzers[0]->finish(m_track);
+}
+
+} // namespace
@@ -0,0 +1,96 @@
+#include "library/analysis/batchanalysis.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QSqlQuery>
+#include <QThread>
+
+#include "analyzer/analyzerthread.h"
+#include "test/librarytest.h"
+#include "track/track.h"
+
+namespace {
+
+const QString kJournalFileName = QStringLiteral("batch_analysis.journal");
+
+class BatchAnalysisTest : public LibraryTest {
+  protected:
+    void SetUp() override {
+        // The analyzer threads would need a connection to the database
+        // for storing waveforms, but each connection to an in-memory
+        // database opens a separate database
+        config()->setValue(
+                ConfigKey("[Library]", "EnableWaveformGenerationWithAnalysis"),
+                false);
+        // Created by MixxxLibraryFeature in the application
+        QSqlQuery query(internalCollection()->database());
+        ASSERT_TRUE(query.exec(QStringLiteral(
+                "CREATE TEMPORARY VIEW IF NOT EXISTS library_cache_view AS "
+                "SELECT library.id AS id, library.mixxx_deleted AS mixxx_deleted, "
+                "track_locations.fs_deleted AS fs_deleted FROM library "
+                "INNER JOIN track_locations ON library.location = track_locations.id")));
+    }
+
+    QString journalFilePath() const {
+        return QDir(config()->getSettingsPath()).filePath(kJournalFileName);
+    }
+
+    bool runBatchAnalysis(mixxx::BatchAnalysis* pBatchAnalysis) {
+        bool finished = false;
+        QObject::connect(pBatchAnalysis,
+                &mixxx::BatchAnalysis::finished,
+                pBatchAnalysis,
+                [&finished] {
+                    finished = true;
+                });
+        if (!pBatchAnalysis->start()) {
+            return false;
+        }
+        for (int i = 0; !finished && i < 6000; ++i) {
+            application()->processEvents(QEventLoop::AllEvents, 10);
+            QThread::msleep(10);
+        }
+        return finished;
+    }
+};
+
+TEST_F(BatchAnalysisTest, resumeFromJournal) {
+    const TrackPointer pAnalyzedTrack = getOrAddTrackByLocation(
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover-test.wav")));
+    ASSERT_TRUE(pAnalyzedTrack);
+    const TrackPointer pTrack = getOrAddTrackByLocation(
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover-test.flac")));
+    ASSERT_TRUE(pTrack);
+    // Not an audio file
+    const QString brokenFilePath = getTestDataDir().filePath(QStringLiteral("broken.mp3"));
+    mixxxtest::copyFile(
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover_test.jpg")),
+            brokenFilePath);
+    const TrackPointer pBrokenTrack = getOrAddTrackByLocation(brokenFilePath);
+    ASSERT_TRUE(pBrokenTrack);
+
+    // The journal of an interrupted run. The last line is incomplete
+    // and must be ignored.
+    QFile journal(journalFilePath());
+    ASSERT_TRUE(journal.open(QIODevice::WriteOnly | QIODevice::Text));
+    journal.write(pAnalyzedTrack->getId().toString().toUtf8());
+    journal.write("\n");
+    journal.write(pBrokenTrack->getId().toString().toUtf8());
+    journal.close();
+
+    mixxx::BatchAnalysis batchAnalysis(
+            config(), trackCollectionManager(), dbConnectionPooler(), QString(), 1);
+    ASSERT_TRUE(runBatchAnalysis(&batchAnalysis));
+
+    EXPECT_EQ(1, batchAnalysis.skippedTracksCount());
+    EXPECT_EQ(2, batchAnalysis.savedTracksCount());
+    EXPECT_EQ(1, batchAnalysis.failedTracksCount());
+    // The next run starts from scratch
+    EXPECT_FALSE(QFile::exists(journalFilePath()));
+    // The CPU time is measured for the summary
+    EXPECT_TRUE(AnalyzerThread::analyzerCpuTimes().contains(QStringLiteral("beats")));
+}
+
+} // namespace
@@ -0,0 +1,199 @@
+#include "engine/cachingreader/cachingreader.h"
+
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "engine/engineworkerscheduler.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+const QString kGroup = QStringLiteral("[Channel1]");
+
+constexpr auto kChannelCount = mixxx::audio::ChannelCount::stereo();
+
+class CachingReaderTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    void SetUp() override {
+        m_scheduler.start();
+    }
+
+    std::unique_ptr<CachingReader> createReader() {
+        auto pReader = std::make_unique<CachingReader>(kGroup, config(), kChannelCount);
+        pReader->setScheduler(&m_scheduler);
+        return pReader;
+    }
+
+    // Runs the engine side of the reader until the predicate is fulfilled
+    template<typename Predicate>
+    bool waitFor(CachingReader* pReader, Predicate predicate) {
+        for (int i = 0; i < 1000; ++i) {
+            m_scheduler.runWorkers();
+            pReader->process();
+            if (predicate()) {
+                return true;
+            }
+            QThread::msleep(10);
+        }
+        return false;
+    }
+
+    bool loadTrack(CachingReader* pReader) {
+        m_trackLoaded = false;
+        QObject::connect(pReader,
+                &CachingReader::trackLoaded,
+                pReader,
+                [this] {
+                    m_trackLoaded = true;
+                },
+                Qt::DirectConnection);
+        pReader->newTrack(Track::newTemporary(
+                getTestDir().filePath(QStringLiteral("sine-30.wav"))));
+        return waitFor(pReader, [this] {
+            return m_trackLoaded.load();
+        });
+    }
+
+    static Hint chunkHint(SINT chunkIndex, Hint::Type type) {
+        return Hint{chunkIndex * CachingReaderChunk::kFrames,
+                CachingReaderChunk::kFrames,
+                type};
+    }
+
+    static CachingReader::ReadResult readFrames(
+            CachingReader* pReader, SINT firstFrame, SINT frameCount) {
+        mixxx::SampleBuffer buffer(
+                CachingReaderChunk::frames2samples(frameCount, kChannelCount));
+        return pReader->read(
+                CachingReaderChunk::frames2samples(firstFrame, kChannelCount),
+                buffer.size(),
+                false,
+                buffer.data(),
+                kChannelCount);
+    }
+
+    static CachingReader::ReadResult readChunks(
+            CachingReader* pReader, SINT firstChunkIndex, SINT chunkCount = 1) {
+        return readFrames(pReader,
+                firstChunkIndex * CachingReaderChunk::kFrames,
+                chunkCount * CachingReaderChunk::kFrames);
+    }
+
+    // Hints the chunks repeatedly until they have been read
+    bool hintAndWait(CachingReader* pReader,
+            const HintVector& hints,
+            SINT firstChunkIndex,
+            SINT chunkCount = 1) {
+        return waitFor(pReader, [&] {
+            pReader->hintAndMaybeWake(hints);
+            return readChunks(pReader, firstChunkIndex, chunkCount) ==
+                    CachingReader::ReadResult::AVAILABLE;
+        });
+    }
+
+    EngineWorkerScheduler m_scheduler;
+    std::atomic<bool> m_trackLoaded;
+};
+
+TEST_F(CachingReaderTest, capacityFromConfig) {
+    EXPECT_EQ(80,
+            CachingReader(kGroup, UserSettingsPointer(), kChannelCount)
+                    .numberOfCachedChunks());
+
+    // 1 second at the reference sample rate of 48 kHz
+    config()->setValue(ConfigKey(QStringLiteral("[App]"), QStringLiteral("cache_seconds")), 1.0);
+    EXPECT_EQ(6, createReader()->numberOfCachedChunks());
+
+    // The setting of the deck takes precedence and is limited to the minimum
+    config()->setValue(ConfigKey(kGroup, QStringLiteral("cache_seconds")), 0.01);
+    EXPECT_EQ(2, createReader()->numberOfCachedChunks());
+}
+
+TEST_F(CachingReaderTest, statistics) {
+    auto pReader = createReader();
+    ASSERT_TRUE(loadTrack(pReader.get()));
+    HintVector hints;
+    hints.append(chunkHint(0, Hint::Type::CurrentPosition));
+    ASSERT_TRUE(hintAndWait(pReader.get(), hints, 0));
+
+    auto before = pReader->statistics();
+    EXPECT_EQ(CachingReader::ReadResult::AVAILABLE, readChunks(pReader.get(), 0));
+    auto after = pReader->statistics();
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(before.underflows, after.underflows);
+
+    // The chunk has not been requested
+    before = after;
+    EXPECT_EQ(CachingReader::ReadResult::UNAVAILABLE, readChunks(pReader.get(), 10));
+    after = pReader->statistics();
+    EXPECT_EQ(before.hits, after.hits);
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.underflows + 1, after.underflows);
+
+    // Reading stops at the first missing chunk
+    before = after;
+    EXPECT_EQ(CachingReader::ReadResult::PARTIALLY_AVAILABLE,
+            readChunks(pReader.get(), 0, 3));
+    after = pReader->statistics();
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.underflows + 1, after.underflows);
+
+    // Preroll before the start of the track is an underflow without a miss
+    before = after;
+    EXPECT_EQ(CachingReader::ReadResult::PARTIALLY_AVAILABLE,
+            readFrames(pReader.get(),
+                    -CachingReaderChunk::kFrames / 2,
+                    CachingReaderChunk::kFrames));
+    after = pReader->statistics();
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(before.underflows + 1, after.underflows);
+}
+
+TEST_F(CachingReaderTest, evictByPriority) {
+    // Only 2 chunks
+    config()->setValue(ConfigKey(kGroup, QStringLiteral("cache_seconds")), 0.01);
+    auto pReader = createReader();
+    ASSERT_EQ(2, pReader->numberOfCachedChunks());
+    ASSERT_TRUE(loadTrack(pReader.get()));
+
+    HintVector playbackHints;
+    playbackHints.append(chunkHint(0, Hint::Type::CurrentPosition));
+    playbackHints.append(chunkHint(1, Hint::Type::LoopEndEnabled));
+    ASSERT_TRUE(hintAndWait(pReader.get(), playbackHints, 0, 2));
+
+    // A marker must not evict the chunks of the play position
+    auto before = pReader->statistics();
+    HintVector markerHints = playbackHints;
+    markerHints.append(chunkHint(5, Hint::Type::FirstSound));
+    pReader->hintAndMaybeWake(markerHints);
+    auto after = pReader->statistics();
+    EXPECT_EQ(before.rejectedHints + 1, after.rejectedHints);
+    EXPECT_EQ(before.evictions, after.evictions);
+
+    // The protection expires if it is not renewed by the next list of hints
+    HintVector cueHints;
+    cueHints.append(chunkHint(5, Hint::Type::HotCue));
+    before = pReader->statistics();
+    pReader->hintAndMaybeWake(cueHints);
+    after = pReader->statistics();
+    EXPECT_EQ(before.rejectedHints + 1, after.rejectedHints);
+    EXPECT_EQ(before.evictions, after.evictions);
+    ASSERT_TRUE(hintAndWait(pReader.get(), cueHints, 5));
+    after = pReader->statistics();
+    EXPECT_EQ(before.evictions + 1, after.evictions);
+
+    // The least recently used chunk has been evicted
+    EXPECT_EQ(CachingReader::ReadResult::AVAILABLE, readChunks(pReader.get(), 1));
+    EXPECT_EQ(CachingReader::ReadResult::UNAVAILABLE, readChunks(pReader.get(), 0));
+}
+
+} // namespace
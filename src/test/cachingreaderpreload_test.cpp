@@ -0,0 +1,106 @@
+#include "engine/cachingreader/cachingreaderpreload.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "engine/cachingreader/cachingreaderchunk.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr qint64 kUnlimitedBudget = std::numeric_limits<qint64>::max() / 2;
+
+class CachingReaderPreloadTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    mixxx::AudioSourcePointer openAudioSource() const {
+        auto pTrack = Track::newTemporary(
+                getTestDir().filePath(QStringLiteral("id3-test-data/cover-test.wav")));
+        mixxx::AudioSource::OpenParams openParams;
+        const auto channelCount = mixxx::audio::ChannelCount::stereo();
+        openParams.setChannelCount(channelCount);
+        auto pAudioSource = SoundSourceProxy(pTrack).openAudioSource(openParams);
+        if (pAudioSource && pAudioSource->getSignalInfo().getChannelCount() != channelCount) {
+            // The test file is mono
+            pAudioSource = mixxx::AudioSourceStereoProxy::create(
+                    pAudioSource,
+                    CachingReaderChunk::kFrames);
+        }
+        return pAudioSource;
+    }
+};
+
+TEST_F(CachingReaderPreloadTest, decodeWholeTrack) {
+    const auto pAudioSource = openAudioSource();
+    ASSERT_TRUE(pAudioSource);
+    const auto channelCount = pAudioSource->getSignalInfo().getChannelCount();
+    mixxx::SampleBuffer tempBuffer(CachingReaderChunk::frames2samples(
+            CachingReaderChunk::kFrames, channelCount));
+
+    auto pPreload = CachingReaderPreload::allocate(pAudioSource, kUnlimitedBudget);
+    ASSERT_TRUE(pPreload);
+    EXPECT_EQ(channelCount, pPreload->channelCount());
+    while (!pPreload->isComplete()) {
+        ASSERT_TRUE(pPreload->bufferNextSampleFrames(
+                pAudioSource, mixxx::SampleBuffer::WritableSlice(tempBuffer)));
+    }
+
+    // Compare the end of the track with the samples decoded directly
+    const auto frameIndexRange = mixxx::IndexRange::between(
+            std::max(pAudioSource->frameIndexRange().start(),
+                    pAudioSource->frameIndexRange().end() - 1000),
+            pAudioSource->frameIndexRange().end());
+    const SINT sampleCount = CachingReaderChunk::frames2samples(
+            frameIndexRange.length(), channelCount);
+    mixxx::SampleBuffer expected(sampleCount);
+    const auto readableSampleFrames = pAudioSource->readSampleFrames(
+            mixxx::WritableSampleFrames(
+                    frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(expected)));
+    ASSERT_EQ(frameIndexRange, readableSampleFrames.frameIndexRange());
+
+    pPreload->lendToReader();
+    mixxx::SampleBuffer actual(sampleCount);
+    EXPECT_EQ(frameIndexRange,
+            pPreload->readBufferedSampleFrames(actual.data(), frameIndexRange));
+    for (SINT i = 0; i < sampleCount; ++i) {
+        EXPECT_EQ(readableSampleFrames.readableData()[i], actual[i]) << "i=" << i;
+    }
+    pPreload->releaseByReader();
+}
+
+TEST_F(CachingReaderPreloadTest, budget) {
+    const auto pAudioSource = openAudioSource();
+    ASSERT_TRUE(pAudioSource);
+    const qint64 allocatedBytesBefore = CachingReaderPreload::allocatedBytes();
+
+    EXPECT_FALSE(CachingReaderPreload::allocate(pAudioSource, allocatedBytesBefore));
+    EXPECT_EQ(allocatedBytesBefore, CachingReaderPreload::allocatedBytes());
+
+    auto pPreload = CachingReaderPreload::allocate(pAudioSource, kUnlimitedBudget);
+    ASSERT_TRUE(pPreload);
+    const qint64 trackBytes = CachingReaderPreload::allocatedBytes() - allocatedBytesBefore;
+    EXPECT_LT(0, trackBytes);
+
+    // The budget suffices for only one track
+    EXPECT_FALSE(CachingReaderPreload::allocate(
+            pAudioSource, allocatedBytesBefore + trackBytes));
+
+    // The budget is released ahead of the memory
+    pPreload->releaseBudget();
+    EXPECT_EQ(allocatedBytesBefore, CachingReaderPreload::allocatedBytes());
+    auto pNextPreload = CachingReaderPreload::allocate(
+            pAudioSource, allocatedBytesBefore + trackBytes);
+    EXPECT_TRUE(pNextPreload);
+
+    pPreload.reset();
+    pNextPreload.reset();
+    EXPECT_EQ(allocatedBytesBefore, CachingReaderPreload::allocatedBytes());
+}
+
+} // namespace
@@ -0,0 +1,217 @@
+#include "engine/cachingreader/cachingreaderworker.h"
+
+#include <gtest/gtest.h>
+
+#include <QThread>
+#include <memory>
+#include <vector>
+
+#include "engine/engineworkerscheduler.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+#include "util/fifo.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+constexpr auto kChannelCount = mixxx::audio::ChannelCount::stereo();
+
+constexpr int kFifoSize = 64;
+
+constexpr int kNumChunks = 8;
+
+// A worker of a single deck with the chunks of a CachingReader
+class Deck {
+  public:
+    Deck(const QString& group, EngineWorkerScheduler* pScheduler)
+            : m_chunkReadRequestFIFO(kFifoSize),
+              m_readerStatusFIFO(kFifoSize),
+              m_sampleBuffer(CachingReaderChunk::kFrames * kChannelCount * kNumChunks),
+              m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO, kChannelCount),
+              m_pScheduler(pScheduler) {
+        for (int i = 0; i < kNumChunks; ++i) {
+            m_chunks.push_back(std::make_unique<CachingReaderChunkForOwner>(
+                    mixxx::SampleBuffer::WritableSlice(m_sampleBuffer,
+                            CachingReaderChunk::kFrames * kChannelCount * i,
+                            CachingReaderChunk::kFrames * kChannelCount)));
+        }
+        m_worker.setScheduler(pScheduler);
+        m_worker.start();
+    }
+
+    ~Deck() {
+        m_worker.quitWait();
+    }
+
+    bool loadTrack(const QString& location) {
+#ifdef __STEM__
+        m_worker.newTrack(Track::newTemporary(location), mixxx::StemChannelSelection());
+#else
+        m_worker.newTrack(Track::newTemporary(location));
+#endif
+        const auto updates = waitForUpdates(1);
+        return updates.size() == 1 && updates.front().status == TRACK_LOADED;
+    }
+
+    bool unloadTrack() {
+#ifdef __STEM__
+        m_worker.newTrack(TrackPointer(), mixxx::StemChannelSelection());
+#else
+        m_worker.newTrack(TrackPointer());
+#endif
+        const auto updates = waitForUpdates(1);
+        return updates.size() == 1 && updates.front().status == TRACK_UNLOADED;
+    }
+
+    // Requests chunk i of the track with priorities[i] and returns the
+    // indices of the chunks in the order they have been read
+    std::vector<SINT> readChunks(const std::vector<int>& priorities) {
+        std::vector<CachingReaderChunkReadRequest> requests(priorities.size());
+        for (std::size_t i = 0; i < priorities.size(); ++i) {
+            CachingReaderChunkForOwner* pChunk = m_chunks[i].get();
+            pChunk->init(static_cast<SINT>(i));
+            requests[i].giveToWorker(pChunk, priorities[i]);
+        }
+        // At once, so that the worker doesn't start with only a part of them
+        m_chunkReadRequestFIFO.write(requests.data(), static_cast<int>(requests.size()));
+        m_worker.workReady();
+        std::vector<SINT> chunkIndices;
+        for (auto update : waitForUpdates(static_cast<int>(priorities.size()))) {
+            EXPECT_EQ(CHUNK_READ_SUCCESS, update.status);
+            CachingReaderChunkForOwner* pChunk = update.takeFromWorker();
+            if (pChunk) {
+                chunkIndices.push_back(pChunk->getIndex());
+            }
+        }
+        return chunkIndices;
+    }
+
+    mixxx::SampleBuffer readChunkSamples(int chunkIndex) const {
+        mixxx::SampleBuffer buffer(CachingReaderChunk::kFrames * kChannelCount);
+        buffer.clear();
+        m_chunks[chunkIndex]->readBufferedSampleFrames(buffer.data(),
+                kChannelCount,
+                mixxx::IndexRange::forward(
+                        chunkIndex * CachingReaderChunk::kFrames,
+                        CachingReaderChunk::kFrames));
+        return buffer;
+    }
+
+  private:
+    std::vector<ReaderStatusUpdate> waitForUpdates(int count) {
+        std::vector<ReaderStatusUpdate> updates;
+        for (int i = 0; i < 1000 && static_cast<int>(updates.size()) < count; ++i) {
+            m_pScheduler->runWorkers();
+            ReaderStatusUpdate update;
+            while (m_readerStatusFIFO.read(&update, 1) == 1) {
+                updates.push_back(update);
+            }
+            if (static_cast<int>(updates.size()) < count) {
+                QThread::msleep(10);
+            }
+        }
+        return updates;
+    }
+
+    FIFO<CachingReaderChunkReadRequest> m_chunkReadRequestFIFO;
+    FIFO<ReaderStatusUpdate> m_readerStatusFIFO;
+    mixxx::SampleBuffer m_sampleBuffer;
+    std::vector<std::unique_ptr<CachingReaderChunkForOwner>> m_chunks;
+    CachingReaderWorker m_worker;
+    EngineWorkerScheduler* m_pScheduler;
+};
+
+class CachingReaderWorkerTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    void SetUp() override {
+        m_maxParallelDecoders = CachingReaderWorker::maxParallelDecoders();
+        m_scheduler.start();
+    }
+
+    void TearDown() override {
+        CachingReaderWorker::setMaxParallelDecoders(m_maxParallelDecoders);
+    }
+
+    QString trackLocation() const {
+        return getTestDir().filePath(QStringLiteral("sine-30.wav"));
+    }
+
+    EngineWorkerScheduler m_scheduler;
+    int m_maxParallelDecoders;
+};
+
+TEST_F(CachingReaderWorkerTest, readByPriority) {
+    // The results of the parallel decoders are sent in the same order
+    for (int maxParallelDecoders : {0, CachingReaderWorker::kMaxParallelDecoders}) {
+        CachingReaderWorker::setMaxParallelDecoders(maxParallelDecoders);
+        Deck deck(QStringLiteral("[Channel1]"), &m_scheduler);
+        ASSERT_TRUE(deck.loadTrack(trackLocation()));
+
+        // Requests with the same priority keep their order
+        EXPECT_EQ(std::vector<SINT>({1, 3, 5, 2, 0, 4}),
+                deck.readChunks({1, 5, 3, 5, 1, 5}));
+        ASSERT_TRUE(deck.unloadTrack());
+    }
+}
+
+TEST_F(CachingReaderWorkerTest, parallelReads) {
+    CachingReaderWorker::setMaxParallelDecoders(0);
+    Deck sequentialDeck(QStringLiteral("[Channel1]"), &m_scheduler);
+    ASSERT_TRUE(sequentialDeck.loadTrack(trackLocation()));
+    ASSERT_EQ(kNumChunks, static_cast<int>(sequentialDeck.readChunks(
+                                                   std::vector<int>(kNumChunks, 0))
+                                          .size()));
+    EXPECT_EQ(0, CachingReaderWorker::openParallelDecoders());
+
+    CachingReaderWorker::setMaxParallelDecoders(CachingReaderWorker::kMaxParallelDecoders);
+    Deck parallelDeck(QStringLiteral("[Channel2]"), &m_scheduler);
+    ASSERT_TRUE(parallelDeck.loadTrack(trackLocation()));
+    ASSERT_EQ(kNumChunks, static_cast<int>(parallelDeck.readChunks(
+                                                   std::vector<int>(kNumChunks, 0))
+                                          .size()));
+    EXPECT_EQ(CachingReaderWorker::kMaxParallelDecoders,
+            CachingReaderWorker::openParallelDecoders());
+
+    // The chunks don't depend on the decoder that has read them
+    for (int i = 0; i < kNumChunks; ++i) {
+        const auto expected = sequentialDeck.readChunkSamples(i);
+        const auto actual = parallelDeck.readChunkSamples(i);
+        for (SINT j = 0; j < expected.size(); ++j) {
+            ASSERT_EQ(expected.data()[j], actual.data()[j]) << "chunk " << i;
+        }
+    }
+
+    // The parallel decoders are closed with the track
+    ASSERT_TRUE(parallelDeck.unloadTrack());
+    EXPECT_EQ(0, CachingReaderWorker::openParallelDecoders());
+}
+
+TEST_F(CachingReaderWorkerTest, parallelDecodersOfAllDecks) {
+    CachingReaderWorker::setMaxParallelDecoders(2);
+    Deck deck1(QStringLiteral("[Channel1]"), &m_scheduler);
+    Deck deck2(QStringLiteral("[Channel2]"), &m_scheduler);
+    ASSERT_TRUE(deck1.loadTrack(trackLocation()));
+    ASSERT_TRUE(deck2.loadTrack(trackLocation()));
+
+    EXPECT_EQ(kNumChunks, static_cast<int>(deck1.readChunks(
+                                                   std::vector<int>(kNumChunks, 0))
+                                          .size()));
+    EXPECT_EQ(2, CachingReaderWorker::openParallelDecoders());
+
+    // The second deck reads all chunks without any parallel decoders
+    EXPECT_EQ(kNumChunks, static_cast<int>(deck2.readChunks(
+                                                   std::vector<int>(kNumChunks, 0))
+                                          .size()));
+    EXPECT_EQ(2, CachingReaderWorker::openParallelDecoders());
+
+    // Until the first deck releases them
+    ASSERT_TRUE(deck1.unloadTrack());
+    EXPECT_EQ(0, CachingReaderWorker::openParallelDecoders());
+    EXPECT_EQ(kNumChunks, static_cast<int>(deck2.readChunks(
+                                                   std::vector<int>(kNumChunks, 0))
+                                          .size()));
+    EXPECT_EQ(2, CachingReaderWorker::openParallelDecoders());
+}
+
+} // namespace
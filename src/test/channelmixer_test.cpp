@@ -0,0 +1,309 @@
+#include "engine/channelmixer.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QVarLengthArray>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "control/controlobject.h"
+#include "engine/effects/engineeffectsmanager.h"
+#include "test/mixxxtest.h"
+#include "util/messagepipe.h"
+#include "util/sample.h"
+#include "util/samplebuffer.h"
+
+namespace {
+
+constexpr auto kSampleRate = mixxx::audio::SampleRate(44100);
+
+// Not a multiple of the block size of the fused pass
+constexpr std::size_t kBufferSize = 2 * 1030;
+
+constexpr unsigned int kMessagePipeFifoSize = 16;
+
+// The gains of a channel in a single callback
+struct ChannelSetup {
+    CSAMPLE_GAIN oldGain;
+    CSAMPLE_GAIN volume;
+    bool fadeout;
+};
+
+std::unique_ptr<EngineEffectsManager> createEngineEffectsManager() {
+    auto [requestPipe, responsePipe] =
+            makeTwoWayMessagePipe<EffectsRequest*, EffectsResponse>(
+                    kMessagePipeFifoSize, kMessagePipeFifoSize);
+    Q_UNUSED(requestPipe);
+    return std::make_unique<EngineEffectsManager>(std::move(responsePipe));
+}
+
+class ChannelMixerTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pEngineEffectsManager = createEngineEffectsManager();
+        m_outputHandle = m_handleFactory.getOrCreateHandle(QStringLiteral("[Master]"));
+    }
+
+    void addChannels(const std::vector<ChannelSetup>& setups) {
+        for (const auto& setup : setups) {
+            const int index = static_cast<int>(m_channels.size());
+            const QString group = QStringLiteral("[Channel%1]").arg(index + 1);
+            auto pChannelInfo = std::make_unique<EngineMixer::ChannelInfo>(index);
+            pChannelInfo->m_handle = m_handleFactory.getOrCreateHandle(group);
+            pChannelInfo->m_pBuffer = mixxx::SampleBuffer(kBufferSize);
+            for (std::size_t i = 0; i < kBufferSize; ++i) {
+                pChannelInfo->m_pBuffer.data()[i] =
+                        static_cast<CSAMPLE>(std::sin(0.01 * (index + 1) * i));
+            }
+            pChannelInfo->m_pVolumeControl = std::make_unique<ControlObject>(
+                    ConfigKey(group, QStringLiteral("volume")));
+            pChannelInfo->m_pVolumeControl->set(setup.volume);
+            m_activeChannels.append(pChannelInfo.get());
+            m_gainCache.append(EngineMixer::GainCache{setup.oldGain, setup.fadeout});
+            m_channels.push_back(std::move(pChannelInfo));
+        }
+        m_setups = setups;
+    }
+
+    // The gain of each channel in the callback like ChannelMixer calculates it
+    CSAMPLE_GAIN newGain(const EngineMixer::GainCalculator& gainCalculator, int index) {
+        if (m_setups[index].fadeout) {
+            return CSAMPLE_GAIN_ZERO;
+        }
+        return gainCalculator.getGain(m_channels[index].get());
+    }
+
+    // Mixes each channel separately with EngineEffectsManager, i.e. without
+    // the fused pass
+    mixxx::SampleBuffer mixPerChannel(
+            const EngineMixer::GainCalculator& gainCalculator, bool inPlace) {
+        mixxx::SampleBuffer output(kBufferSize);
+        output.clear();
+        for (std::size_t i = 0; i < m_channels.size(); ++i) {
+            EngineMixer::ChannelInfo* pChannelInfo = m_channels[i].get();
+            if (inPlace) {
+                m_pEngineEffectsManager->processPostFaderInPlace(pChannelInfo->m_handle,
+                        m_outputHandle,
+                        pChannelInfo->m_pBuffer.data(),
+                        kBufferSize,
+                        kSampleRate,
+                        pChannelInfo->m_features,
+                        m_setups[i].oldGain,
+                        newGain(gainCalculator, static_cast<int>(i)),
+                        m_setups[i].fadeout);
+                SampleUtil::add(output.data(), pChannelInfo->m_pBuffer.data(), kBufferSize);
+            } else {
+                m_pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
+                        m_outputHandle,
+                        pChannelInfo->m_pBuffer.data(),
+                        output.data(),
+                        kBufferSize,
+                        kSampleRate,
+                        pChannelInfo->m_features,
+                        m_setups[i].oldGain,
+                        newGain(gainCalculator, static_cast<int>(i)),
+                        m_setups[i].fadeout);
+            }
+        }
+        return output;
+    }
+
+    // Mixes all channels with ChannelMixer. Without any effect chains all
+    // channels are mixed in the fused pass.
+    mixxx::SampleBuffer mixFused(
+            const EngineMixer::GainCalculator& gainCalculator, bool inPlace) {
+        mixxx::SampleBuffer output(kBufferSize);
+        // Stale content of the last callback must be overwritten
+        output.fill(1.0f);
+        if (inPlace) {
+            ChannelMixer::applyEffectsInPlaceAndMixChannels(gainCalculator,
+                    m_activeChannels,
+                    &m_gainCache,
+                    output.data(),
+                    m_outputHandle,
+                    kBufferSize,
+                    kSampleRate,
+                    m_pEngineEffectsManager.get());
+        } else {
+            ChannelMixer::applyEffectsAndMixChannels(gainCalculator,
+                    m_activeChannels,
+                    &m_gainCache,
+                    output.data(),
+                    m_outputHandle,
+                    kBufferSize,
+                    kSampleRate,
+                    m_pEngineEffectsManager.get());
+        }
+        return output;
+    }
+
+    std::vector<mixxx::SampleBuffer> copyChannelBuffers() const {
+        std::vector<mixxx::SampleBuffer> buffers;
+        for (const auto& pChannelInfo : m_channels) {
+            mixxx::SampleBuffer buffer(kBufferSize);
+            SampleUtil::copy(buffer.data(), pChannelInfo->m_pBuffer.data(), kBufferSize);
+            buffers.push_back(std::move(buffer));
+        }
+        return buffers;
+    }
+
+    void restoreChannelBuffers(const std::vector<mixxx::SampleBuffer>& buffers) {
+        for (std::size_t i = 0; i < m_channels.size(); ++i) {
+            SampleUtil::copy(m_channels[i]->m_pBuffer.data(), buffers[i].data(), kBufferSize);
+        }
+    }
+
+    static void assertBuffersEqual(const mixxx::SampleBuffer& expected,
+            const mixxx::SampleBuffer& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (SINT i = 0; i < expected.size(); ++i) {
+            // The fused pass adds the channels in a different order
+            ASSERT_NEAR(expected.data()[i], actual.data()[i], 1e-5f) << "at sample " << i;
+        }
+    }
+
+    void assertFusedMatchesPerChannel(const EngineMixer::GainCalculator& gainCalculator) {
+        const auto expected = mixPerChannel(gainCalculator, false);
+        const auto actual = mixFused(gainCalculator, false);
+        assertBuffersEqual(expected, actual);
+        // The gains are cached for the next callback
+        for (int i = 0; i < m_gainCache.size(); ++i) {
+            EXPECT_EQ(newGain(gainCalculator, i), m_gainCache[i].m_gain);
+            EXPECT_FALSE(m_gainCache[i].m_fadeout);
+        }
+    }
+
+    void assertFusedInPlaceMatchesPerChannel(const EngineMixer::GainCalculator& gainCalculator) {
+        const auto inputBuffers = copyChannelBuffers();
+        const auto expected = mixPerChannel(gainCalculator, true);
+        const auto expectedChannelBuffers = copyChannelBuffers();
+        restoreChannelBuffers(inputBuffers);
+        const auto actual = mixFused(gainCalculator, true);
+        assertBuffersEqual(expected, actual);
+        // The gain is applied to the channel buffers, too
+        const auto actualChannelBuffers = copyChannelBuffers();
+        for (std::size_t i = 0; i < m_channels.size(); ++i) {
+            assertBuffersEqual(expectedChannelBuffers[i], actualChannelBuffers[i]);
+        }
+    }
+
+    ChannelHandleFactory m_handleFactory;
+    ChannelHandle m_outputHandle;
+    std::unique_ptr<EngineEffectsManager> m_pEngineEffectsManager;
+    std::vector<std::unique_ptr<EngineMixer::ChannelInfo>> m_channels;
+    std::vector<ChannelSetup> m_setups;
+    QVarLengthArray<EngineMixer::ChannelInfo*, kPreallocatedChannels> m_activeChannels;
+    QVarLengthArray<EngineMixer::GainCache, kPreallocatedChannels> m_gainCache;
+};
+
+// Constant gains, gain ramps, a muted channel, and a channel that fades
+// out. More channels with a constant gain than are added in a single pass.
+const std::vector<ChannelSetup> kChannelSetups = {
+        {0.5f, 0.5f, false},
+        {0.2f, 0.9f, false},
+        {1.0f, 1.0f, false},
+        {0.0f, 0.0f, false},
+        {0.7f, 0.7f, true},
+        {0.3f, 0.3f, false},
+        {0.8f, 0.8f, false},
+        {0.0f, 0.6f, false},
+};
+
+TEST_F(ChannelMixerTest, talkoverMatchesPerChannelMix) {
+    addChannels(kChannelSetups);
+    assertFusedMatchesPerChannel(EngineMixer::TalkoverGainCalculator());
+}
+
+TEST_F(ChannelMixerTest, talkoverInPlaceMatchesPerChannelMix) {
+    addChannels(kChannelSetups);
+    assertFusedInPlaceMatchesPerChannel(EngineMixer::TalkoverGainCalculator());
+}
+
+TEST_F(ChannelMixerTest, headphoneMatchesPerChannelMix) {
+    addChannels(kChannelSetups);
+    // The headphone gain ramps every channel that had a different gain
+    EngineMixer::PflGainCalculator gainCalculator;
+    gainCalculator.setGain(0.8f);
+    assertFusedMatchesPerChannel(gainCalculator);
+}
+
+TEST_F(ChannelMixerTest, headphoneInPlaceMatchesPerChannelMix) {
+    addChannels(kChannelSetups);
+    EngineMixer::PflGainCalculator gainCalculator;
+    gainCalculator.setGain(0.8f);
+    assertFusedInPlaceMatchesPerChannel(gainCalculator);
+}
+
+TEST_F(ChannelMixerTest, noChannelsClearsOutput) {
+    const auto actual = mixFused(EngineMixer::TalkoverGainCalculator(), false);
+    for (SINT i = 0; i < actual.size(); ++i) {
+        ASSERT_EQ(CSAMPLE_ZERO, actual.data()[i]);
+    }
+}
+
+// Mixes state.range(0) channels with a constant gain, i.e. the common case
+// without crossfading, in the fused pass if state.range(1) is set
+static void BM_ChannelMixerConstantGain(benchmark::State& state) {
+    const int numChannels = static_cast<int>(state.range(0));
+    const bool fused = state.range(1) != 0;
+    ChannelHandleFactory handleFactory;
+    const ChannelHandle outputHandle = handleFactory.getOrCreateHandle(QStringLiteral("[Master]"));
+    auto pEngineEffectsManager = createEngineEffectsManager();
+    EngineMixer::PflGainCalculator gainCalculator;
+    gainCalculator.setGain(0.8f);
+
+    std::vector<std::unique_ptr<EngineMixer::ChannelInfo>> channels;
+    QVarLengthArray<EngineMixer::ChannelInfo*, kPreallocatedChannels> activeChannels;
+    QVarLengthArray<EngineMixer::GainCache, kPreallocatedChannels> gainCache;
+    for (int i = 0; i < numChannels; ++i) {
+        auto pChannelInfo = std::make_unique<EngineMixer::ChannelInfo>(i);
+        pChannelInfo->m_handle = handleFactory.getOrCreateHandle(
+                QStringLiteral("[Channel%1]").arg(i + 1));
+        pChannelInfo->m_pBuffer = mixxx::SampleBuffer(kBufferSize);
+        pChannelInfo->m_pBuffer.fill(0.1f * (i + 1));
+        activeChannels.append(pChannelInfo.get());
+        gainCache.append(EngineMixer::GainCache{0.8f, false});
+        channels.push_back(std::move(pChannelInfo));
+    }
+    mixxx::SampleBuffer output(kBufferSize);
+
+    for (auto _ : state) {
+        if (fused) {
+            ChannelMixer::applyEffectsAndMixChannels(gainCalculator,
+                    activeChannels,
+                    &gainCache,
+                    output.data(),
+                    outputHandle,
+                    kBufferSize,
+                    kSampleRate,
+                    pEngineEffectsManager.get());
+        } else {
+            // The mix before the fused pass
+            output.clear();
+            for (auto* pChannelInfo : activeChannels) {
+                pEngineEffectsManager->processPostFaderAndMix(pChannelInfo->m_handle,
+                        outputHandle,
+                        pChannelInfo->m_pBuffer.data(),
+                        output.data(),
+                        kBufferSize,
+                        kSampleRate,
+                        pChannelInfo->m_features,
+                        0.8f,
+                        0.8f,
+                        false);
+            }
+        }
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+BENCHMARK(BM_ChannelMixerConstantGain)
+        ->Args({1, 0})
+        ->Args({1, 1})
+        ->Args({4, 0})
+        ->Args({4, 1})
+        ->Args({8, 0})
+        ->Args({8, 1});
+
+} // namespace
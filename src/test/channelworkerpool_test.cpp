@@ -0,0 +1,56 @@
+#include "engine/channelworkerpool.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+
+namespace {
+
+constexpr int kMaxJobs = 64;
+
+struct JobCounters {
+    std::array<std::atomic<int>, kMaxJobs> runs{};
+};
+
+void countJob(void* pContext, int jobIndex) {
+    auto* pCounters = static_cast<JobCounters*>(pContext);
+    pCounters->runs[jobIndex].fetch_add(1);
+}
+
+class ChannelWorkerPoolTest : public testing::Test {
+  protected:
+    void runJobsRepeatedly(ChannelWorkerPool* pPool) {
+        for (int jobCount = 0; jobCount <= kMaxJobs; ++jobCount) {
+            for (int iteration = 0; iteration < 10; ++iteration) {
+                JobCounters counters;
+                pPool->run(&countJob, &counters, jobCount);
+                // All jobs must have completed exactly once when run() returns
+                for (int i = 0; i < kMaxJobs; ++i) {
+                    EXPECT_EQ(i < jobCount ? 1 : 0, counters.runs[i].load())
+                            << "job " << i << " of " << jobCount;
+                }
+            }
+        }
+    }
+};
+
+TEST_F(ChannelWorkerPoolTest, NoWorkers) {
+    ChannelWorkerPool pool(0);
+    EXPECT_EQ(0, pool.numWorkers());
+    runJobsRepeatedly(&pool);
+}
+
+TEST_F(ChannelWorkerPoolTest, SingleWorker) {
+    ChannelWorkerPool pool(1);
+    EXPECT_EQ(1, pool.numWorkers());
+    runJobsRepeatedly(&pool);
+}
+
+TEST_F(ChannelWorkerPoolTest, MoreWorkersThanJobs) {
+    ChannelWorkerPool pool(8);
+    EXPECT_EQ(8, pool.numWorkers());
+    runJobsRepeatedly(&pool);
+}
+
+} // namespace
@@ -0,0 +1,123 @@
+#include "library/columnartrackindex.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr int kTextColumn = 0;
+constexpr int kNumberColumn = 1;
+
+class ColumnarTrackIndexTest : public testing::Test {
+  protected:
+    ColumnarTrackIndexTest()
+            : m_index(&m_records, &m_collator) {
+    }
+
+    static TrackId trackId(int id) {
+        return TrackId(QVariant(id));
+    }
+
+    void addTrack(int id, const QVariant& text, const QVariant& number) {
+        m_records.insert(trackId(id), {text, number});
+        m_index.updateRow(trackId(id));
+    }
+
+    QVector<TrackId> sorted(QVector<TrackId> trackIds,
+            int column,
+            ColumnCache::SortType sortType,
+            Qt::SortOrder order = Qt::AscendingOrder) {
+        m_index.sort(&trackIds,
+                {{column, sortType, column, order}},
+                KeyUtils::KeyNotation::OpenKey);
+        return trackIds;
+    }
+
+    QVector<TrackId> sortedIds(
+            int column,
+            ColumnCache::SortType sortType,
+            Qt::SortOrder order = Qt::AscendingOrder) {
+        return sorted(m_index.trackIds(), column, sortType, order);
+    }
+
+    ColumnarTrackIndex::Records m_records;
+    const mixxx::StringCollator m_collator;
+    ColumnarTrackIndex m_index;
+};
+
+TEST_F(ColumnarTrackIndexTest, sortText) {
+    addTrack(1, QStringLiteral("beta"), QVariant());
+    addTrack(2, QStringLiteral("Alpha"), QVariant());
+    addTrack(3, QVariant(), QVariant());
+    addTrack(4, QStringLiteral("gamma"), QVariant());
+
+    const QVector<TrackId> expected = {trackId(3), trackId(2), trackId(1), trackId(4)};
+    EXPECT_EQ(expected,
+            sortedIds(kTextColumn, ColumnCache::SortType::NoCaseLexicographic));
+    EXPECT_EQ(expected, sortedIds(kTextColumn, ColumnCache::SortType::NoCase));
+
+    const QVector<TrackId> expectedDescending = {
+            trackId(4), trackId(1), trackId(2), trackId(3)};
+    EXPECT_EQ(expectedDescending,
+            sortedIds(kTextColumn,
+                    ColumnCache::SortType::NoCaseLexicographic,
+                    Qt::DescendingOrder));
+}
+
+TEST_F(ColumnarTrackIndexTest, sortMixedTypes) {
+    // NULL before numbers before strings like in SQLite
+    addTrack(1, QVariant(), 5.5);
+    addTrack(2, QVariant(), QStringLiteral("abc"));
+    addTrack(3, QVariant(), QVariant());
+    addTrack(4, QVariant(), 1);
+
+    const QVector<TrackId> expected = {trackId(3), trackId(4), trackId(1), trackId(2)};
+    EXPECT_EQ(expected, sortedIds(kNumberColumn, ColumnCache::SortType::Default));
+}
+
+TEST_F(ColumnarTrackIndexTest, sortInteger) {
+    // Like CAST(... AS INTEGER) for the track number
+    addTrack(1, QVariant(), QStringLiteral("12"));
+    addTrack(2, QVariant(), QStringLiteral("3/12"));
+    addTrack(3, QVariant(), QStringLiteral("abc"));
+    addTrack(4, QVariant(), QVariant());
+
+    const QVector<TrackId> expected = {trackId(4), trackId(3), trackId(2), trackId(1)};
+    EXPECT_EQ(expected, sortedIds(kNumberColumn, ColumnCache::SortType::Integer));
+}
+
+TEST_F(ColumnarTrackIndexTest, sortIsStable) {
+    addTrack(1, QStringLiteral("a"), 2);
+    addTrack(2, QStringLiteral("b"), 1);
+    addTrack(3, QStringLiteral("a"), 1);
+
+    const QVector<TrackId> trackIds = {trackId(3), trackId(2), trackId(1)};
+    const QVector<TrackId> expected = {trackId(3), trackId(1), trackId(2)};
+    EXPECT_EQ(expected, sorted(trackIds, kTextColumn, ColumnCache::SortType::NoCase));
+}
+
+TEST_F(ColumnarTrackIndexTest, updateAndRemoveRows) {
+    addTrack(1, QStringLiteral("a"), QVariant());
+    addTrack(2, QStringLiteral("b"), QVariant());
+    addTrack(3, QStringLiteral("c"), QVariant());
+    // Encode the column before modifying the records
+    sortedIds(kTextColumn, ColumnCache::SortType::NoCase);
+
+    m_records[trackId(1)][kTextColumn] = QStringLiteral("d");
+    m_index.updateRow(trackId(1));
+    m_records.remove(trackId(2));
+    m_index.removeRow(trackId(2));
+    EXPECT_EQ(2, m_index.size());
+    // Reuses the row of the removed track
+    addTrack(4, QStringLiteral("0"), QVariant());
+
+    const QVector<TrackId> expected = {trackId(4), trackId(3), trackId(1)};
+    EXPECT_EQ(expected, sortedIds(kTextColumn, ColumnCache::SortType::NoCase));
+
+    // Tracks that are not in the index are appended
+    const QVector<TrackId> trackIds = {trackId(2), trackId(1), trackId(4)};
+    const QVector<TrackId> expectedWithMissing = {trackId(4), trackId(1), trackId(2)};
+    EXPECT_EQ(expectedWithMissing,
+            sorted(trackIds, kTextColumn, ColumnCache::SortType::NoCase));
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+#include "control/controlguidispatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <memory>
+#include <thread>
+
+#include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "test/mixxxtest.h"
+
+namespace {
+
+class ControlGuiDispatcherTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pDispatcher = std::make_unique<ControlGuiDispatcher>();
+        m_pControl = std::make_unique<ControlObject>(ConfigKey("[Channel1]", "co1"));
+        m_pProxy = std::make_unique<ControlProxy>(ConfigKey("[Channel1]", "co1"));
+        ASSERT_TRUE(m_pProxy->connectValueChangedOnGuiTick(
+                &m_receiver, [this](double value) { m_values.append(value); }));
+    }
+
+    void TearDown() override {
+        m_pProxy.reset();
+        m_pControl.reset();
+        m_pDispatcher.reset();
+    }
+
+    void setFromOtherThread(const QList<double>& values) {
+        std::thread thread([this, values] {
+            for (double value : values) {
+                m_pControl->set(value);
+            }
+        });
+        thread.join();
+    }
+
+    std::unique_ptr<ControlGuiDispatcher> m_pDispatcher;
+    std::unique_ptr<ControlObject> m_pControl;
+    std::unique_ptr<ControlProxy> m_pProxy;
+    QObject m_receiver;
+    QList<double> m_values;
+};
+
+TEST_F(ControlGuiDispatcherTest, coalesceChangesFromOtherThreads) {
+    setFromOtherThread({1.0, 2.0, 3.0});
+    application()->processEvents();
+    EXPECT_TRUE(m_values.isEmpty());
+    EXPECT_EQ(3u, m_pDispatcher->recordedUpdates());
+    EXPECT_EQ(2u, m_pDispatcher->mergedUpdates());
+
+    m_pDispatcher->dispatch();
+    EXPECT_EQ(QList<double>{3.0}, m_values);
+    EXPECT_EQ(1u, m_pDispatcher->dispatchedUpdates());
+
+    // Nothing is pending anymore
+    m_pDispatcher->dispatch();
+    EXPECT_EQ(1, m_values.size());
+}
+
+TEST_F(ControlGuiDispatcherTest, deliverChangesFromGuiThreadImmediately) {
+    m_pControl->set(1.0);
+    EXPECT_EQ(QList<double>{1.0}, m_values);
+
+    // The proxy does not receive its own changes
+    m_pProxy->set(2.0);
+    EXPECT_EQ(QList<double>{1.0}, m_values);
+    EXPECT_EQ(0u, m_pDispatcher->recordedUpdates());
+}
+
+TEST_F(ControlGuiDispatcherTest, shareControlBetweenProxies) {
+    ControlProxy otherProxy(ConfigKey("[Channel1]", "co1"));
+    QList<double> otherValues;
+    ASSERT_TRUE(otherProxy.connectValueChangedOnGuiTick(
+            &m_receiver, [&otherValues](double value) { otherValues.append(value); }));
+
+    setFromOtherThread({1.0, 2.0});
+    m_pDispatcher->dispatch();
+    EXPECT_EQ(QList<double>{2.0}, m_values);
+    EXPECT_EQ(QList<double>{2.0}, otherValues);
+    EXPECT_EQ(1u, m_pDispatcher->dispatchedUpdates());
+}
+
+TEST_F(ControlGuiDispatcherTest, unsubscribeDeletedProxy) {
+    setFromOtherThread({1.0});
+    m_pProxy.reset();
+    m_pDispatcher->dispatch();
+    EXPECT_TRUE(m_values.isEmpty());
+
+    setFromOtherThread({2.0});
+    EXPECT_EQ(1u, m_pDispatcher->recordedUpdates());
+}
+
+TEST_F(ControlGuiDispatcherTest, connectDirectlyWithoutDispatcher) {
+    m_pProxy.reset();
+    m_pDispatcher.reset();
+    ControlProxy proxy(ConfigKey("[Channel1]", "co1"));
+    ASSERT_TRUE(proxy.connectValueChangedOnGuiTick(
+            &m_receiver, [this](double value) { m_values.append(value); }));
+    m_pControl->set(1.0);
+    EXPECT_EQ(QList<double>{1.0}, m_values);
+}
+
+} // namespace
@@ -320,6 +320,29 @@ TEST_F(ControllerScriptEngineLegacyTest, getSetParameter) {
     EXPECT_DOUBLE_EQ(2.0, co->get());
 }
 
+TEST_F(ControllerScriptEngineLegacyTest, getSetByHandle) {
+    auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
+            -10.0,
+            10.0);
+    EXPECT_TRUE(evaluateAndAssert(
+            "var handle = engine.getControlHandle('[Test]', 'co');"
+            "engine.setValueByHandle(handle, engine.getValueByHandle(handle) + 1);"));
+    EXPECT_DOUBLE_EQ(1.0, co->get());
+    EXPECT_TRUE(evaluateAndAssert(
+            "engine.setParameterByHandle(handle, "
+            "  engine.getParameterByHandle(handle) + 0.1);"));
+    EXPECT_DOUBLE_EQ(3.0, co->get());
+    EXPECT_TRUE(evaluateAndAssert("engine.setValueByHandle(handle, NaN);"));
+    EXPECT_DOUBLE_EQ(3.0, co->get());
+}
+
+TEST_F(ControllerScriptEngineLegacyTest, getControlHandle_InvalidControl) {
+    EXPECT_TRUE(evaluateAndAssert(
+            "var handle = engine.getControlHandle('[Nothing]', 'nothing');"
+            "engine.setValueByHandle(handle, 1.0);"
+            "engine.getValueByHandle(handle);"));
+}
+
 TEST_F(ControllerScriptEngineLegacyTest, softTakeover_setValue) {
     auto co = std::make_unique<ControlPotmeter>(ConfigKey("[Test]", "co"),
             -10.0,
@@ -1,7 +1,9 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 
 #include <QtDebug>
 #include <memory>
+#include <vector>
 
 #include "control/controlobject.h"
 #include "test/mixxxtest.h"
@@ -37,6 +39,50 @@ TEST_F(ControlObjectTest, getControl) {
             (ControlObject*)nullptr);
 }
 
+TEST_F(ControlObjectTest, getControlByHandle) {
+    const ControlHandle handle = ControlDoublePrivate::getHandle(ck1);
+    ASSERT_TRUE(handle.isValid());
+    EXPECT_EQ(handle, ControlDoublePrivate::getHandle(ck1));
+    EXPECT_NE(handle, ControlDoublePrivate::getHandle(ck2));
+    EXPECT_EQ(co1.get(), ControlObject::getControl(handle));
+
+    // The handle stays valid and resolves the control created again
+    co1.reset();
+    EXPECT_EQ(ControlObject::getControl(handle), (ControlObject*)nullptr);
+    co1 = std::make_unique<ControlObject>(ck1);
+    EXPECT_EQ(co1.get(), ControlObject::getControl(handle));
+
+    EXPECT_FALSE(ControlDoublePrivate::getHandle(ConfigKey()).isValid());
+}
+
+TEST_F(ControlObjectTest, getControlFromSnapshot) {
+    std::vector<std::unique_ptr<ControlObject>> controls;
+    for (int i = 0; i < 100; ++i) {
+        controls.push_back(std::make_unique<ControlObject>(
+                ConfigKey("[Snapshot]", QString::number(i))));
+    }
+    // The first lookups publish snapshots for the later ones
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(controls[i].get(),
+                    ControlObject::getControl(
+                            ConfigKey("[Snapshot]", QString::number(i))));
+        }
+    }
+}
+
+TEST_F(ControlObjectTest, AliasHandle) {
+    ConfigKey ckAlias("[Channel1]", "co1_alias");
+
+    // Resolve the handle of the alias before it is inserted
+    const ControlHandle aliasHandle = ControlDoublePrivate::getHandle(ckAlias);
+    EXPECT_EQ(ControlObject::getControl(aliasHandle), (ControlObject*)nullptr);
+
+    co1->addAlias(ckAlias);
+    EXPECT_EQ(co1.get(), ControlObject::getControl(aliasHandle));
+    EXPECT_EQ(co1.get(), ControlObject::getControl(ckAlias));
+}
+
 TEST_F(ControlObjectTest, AliasRetrieval) {
     ConfigKey ck("[Microphone1]", "volume");
     ConfigKey ckAlias("[Microphone]", "volume");
@@ -86,4 +132,23 @@ TEST_F(ControlObjectTest, Persistence_ValidValue) {
     EXPECT_DOUBLE_EQ(5.0, co.get());
 }
 
+static void BM_ControlObjectGetControlByKey(benchmark::State& state) {
+    const ConfigKey key("[Benchmark]", "co");
+    ControlObject co(key);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ControlObject::getControl(key));
+    }
+}
+BENCHMARK(BM_ControlObjectGetControlByKey);
+
+static void BM_ControlObjectGetControlByHandle(benchmark::State& state) {
+    const ConfigKey key("[Benchmark]", "co");
+    ControlObject co(key);
+    const ControlHandle handle = ControlDoublePrivate::getHandle(key);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ControlObject::getControl(handle));
+    }
+}
+BENCHMARK(BM_ControlObjectGetControlByHandle);
+
 } // namespace
@@ -0,0 +1,117 @@
+#include "sources/decodedaudiocache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "sources/audiosourcestereoproxy.h"
+#include "sources/soundsourceproxy.h"
+#include "test/mixxxtest.h"
+#include "test/soundsourceproviderregistration.h"
+#include "track/track.h"
+
+namespace {
+
+constexpr SINT kFramesPerChunk = 4096;
+
+constexpr qint64 kMaxSizeBytes = 100 * 1024 * 1024;
+
+class DecodedAudioCacheTest : public MixxxTest, SoundSourceProviderRegistration {
+  protected:
+    DecodedAudioCacheTest()
+            : m_pTrack(Track::newTemporary(getTestDir().filePath(
+                      QStringLiteral("id3-test-data/cover-test.wav")))),
+              m_cache(getTestDataDir().filePath(QStringLiteral("decoded_audio_cache")),
+                      kMaxSizeBytes) {
+        getTestDataDir().mkpath(QStringLiteral("decoded_audio_cache"));
+        m_openParams.setChannelCount(mixxx::audio::ChannelCount::stereo());
+    }
+
+    mixxx::AudioSourcePointer decodeAudioSource() const {
+        auto pAudioSource = SoundSourceProxy(m_pTrack).openAudioSource(m_openParams);
+        if (pAudioSource &&
+                pAudioSource->getSignalInfo().getChannelCount() !=
+                        mixxx::audio::ChannelCount::stereo()) {
+            // The test file is mono
+            pAudioSource = mixxx::AudioSourceStereoProxy::create(
+                    pAudioSource,
+                    kFramesPerChunk);
+        }
+        return pAudioSource;
+    }
+
+    const TrackPointer m_pTrack;
+    const mixxx::DecodedAudioCache m_cache;
+    mixxx::AudioSource::OpenParams m_openParams;
+};
+
+TEST_F(DecodedAudioCacheTest, writeAndRead) {
+    EXPECT_FALSE(m_cache.openAudioSource(m_pTrack, m_openParams));
+
+    const auto pAudioSource = decodeAudioSource();
+    ASSERT_TRUE(pAudioSource);
+    const auto frameIndexRange = pAudioSource->frameIndexRange();
+    const SINT sampleCount = pAudioSource->getSignalInfo().frames2samples(
+            frameIndexRange.length());
+    mixxx::SampleBuffer expected(sampleCount);
+    {
+        auto pWriter = m_cache.createWriter(m_pTrack,
+                m_openParams,
+                pAudioSource->getSignalInfo(),
+                pAudioSource->getBitrate(),
+                frameIndexRange);
+        ASSERT_TRUE(pWriter);
+        mixxx::IndexRange remainingFrameIndexRange = frameIndexRange;
+        while (!remainingFrameIndexRange.empty()) {
+            const auto chunkFrameIndexRange = remainingFrameIndexRange.splitAndShrinkFront(
+                    std::min(kFramesPerChunk, remainingFrameIndexRange.length()));
+            const SINT sampleOffset = pAudioSource->getSignalInfo().frames2samples(
+                    chunkFrameIndexRange.start() - frameIndexRange.start());
+            const auto readableSampleFrames = pAudioSource->readSampleFrames(
+                    mixxx::WritableSampleFrames(chunkFrameIndexRange,
+                            mixxx::SampleBuffer::WritableSlice(expected.data(sampleOffset),
+                                    pAudioSource->getSignalInfo().frames2samples(
+                                            chunkFrameIndexRange.length()))));
+            ASSERT_EQ(chunkFrameIndexRange, readableSampleFrames.frameIndexRange());
+            EXPECT_FALSE(pWriter->isComplete());
+            ASSERT_TRUE(pWriter->write(readableSampleFrames));
+        }
+        EXPECT_TRUE(pWriter->isComplete());
+        ASSERT_TRUE(pWriter->commit());
+    }
+
+    const auto pCachedAudioSource = m_cache.openAudioSource(m_pTrack, m_openParams);
+    ASSERT_TRUE(pCachedAudioSource);
+    EXPECT_EQ(pAudioSource->getSignalInfo(), pCachedAudioSource->getSignalInfo());
+    EXPECT_EQ(frameIndexRange, pCachedAudioSource->frameIndexRange());
+    mixxx::SampleBuffer actual(sampleCount);
+    const auto readableSampleFrames = pCachedAudioSource->readSampleFrames(
+            mixxx::WritableSampleFrames(frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(actual)));
+    ASSERT_EQ(frameIndexRange, readableSampleFrames.frameIndexRange());
+    for (SINT i = 0; i < sampleCount; ++i) {
+        EXPECT_EQ(expected[i], actual[i]) << "i=" << i;
+    }
+
+    // The cached stereo signal might have been downmixed from more channels
+    mixxx::AudioSource::OpenParams multiChannelOpenParams;
+    multiChannelOpenParams.setChannelCount(mixxx::audio::ChannelCount(8));
+    EXPECT_FALSE(m_cache.openAudioSource(m_pTrack, multiChannelOpenParams));
+}
+
+TEST_F(DecodedAudioCacheTest, discardIncompleteFile) {
+    const auto pAudioSource = decodeAudioSource();
+    ASSERT_TRUE(pAudioSource);
+    {
+        auto pWriter = m_cache.createWriter(m_pTrack,
+                m_openParams,
+                pAudioSource->getSignalInfo(),
+                pAudioSource->getBitrate(),
+                pAudioSource->frameIndexRange());
+        ASSERT_TRUE(pWriter);
+        EXPECT_FALSE(pWriter->commit());
+    }
+    EXPECT_FALSE(m_cache.openAudioSource(m_pTrack, m_openParams));
+}
+
+} // namespace
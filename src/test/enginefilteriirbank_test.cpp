@@ -0,0 +1,187 @@
+#include "engine/filters/enginefilteriirbank.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "engine/filters/enginefilterbessel8.h"
+#include "engine/filters/enginefilterlinkwitzriley8.h"
+#include "util/sample.h"
+
+namespace {
+
+constexpr mixxx::audio::SampleRate kSampleRate(44100);
+
+std::vector<CSAMPLE> noise(std::size_t size) {
+    std::vector<CSAMPLE> samples(size);
+    quint32 seed = 1;
+    for (auto& sample : samples) {
+        // A simple LCG is good enough and reproducible
+        seed = seed * 1664525 + 1013904223;
+        sample = static_cast<CSAMPLE>(seed) / static_cast<CSAMPLE>(0xFFFFFFFFu) - 0.5f;
+    }
+    return samples;
+}
+
+class EngineFilterIIRBankTest : public testing::Test {
+  protected:
+    static void expectEqualSamples(
+            const std::vector<CSAMPLE>& expected,
+            const std::vector<CSAMPLE>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_FLOAT_EQ(expected[i], actual[i]) << "at sample " << i;
+        }
+    }
+};
+
+TEST_F(EngineFilterIIRBankTest, bandsMatchSeparateFilters) {
+    constexpr std::size_t kBufferSize = 512;
+    EngineFilterBessel8Low low1(kSampleRate, 246);
+    EngineFilterBessel8Low low2(kSampleRate, 2484);
+    EngineFilterIIRBank<8, IIR_LP, 2, 2> bank;
+    bank.setCoefs(0, low1);
+    bank.setCoefs(1, low2);
+
+    const std::vector<CSAMPLE> input = noise(kBufferSize);
+    std::vector<CSAMPLE> expected1(kBufferSize);
+    std::vector<CSAMPLE> expected2(kBufferSize);
+    std::vector<CSAMPLE> actual1(kBufferSize);
+    std::vector<CSAMPLE> actual2(kBufferSize);
+    const CSAMPLE* inputs[] = {input.data(), input.data()};
+    CSAMPLE* outputs[] = {actual1.data(), actual2.data()};
+
+    for (int buffer = 0; buffer < 4; ++buffer) {
+        if (buffer == 2) {
+            // Only the second band ramps to the new coefficients
+            low2.setFrequencyCorners(kSampleRate, 1000);
+            bank.setCoefs(1, low2);
+        }
+        low1.process(input.data(), expected1.data(), kBufferSize);
+        low2.process(input.data(), expected2.data(), kBufferSize);
+        bank.process(inputs, outputs, kBufferSize);
+        expectEqualSamples(expected1, actual1);
+        expectEqualSamples(expected2, actual2);
+    }
+}
+
+TEST_F(EngineFilterIIRBankTest, stemChannelsMatchStereoFilters) {
+    constexpr int kStemChannels = 8;
+    constexpr std::size_t kFrames = 256;
+    EngineFilterIIRBank<8, IIR_HP, kStemChannels> bank;
+    std::vector<std::unique_ptr<EngineFilterLinkwitzRiley8High>> stereoFilters;
+    for (int i = 0; i < kStemChannels / 2; ++i) {
+        stereoFilters.push_back(
+                std::make_unique<EngineFilterLinkwitzRiley8High>(kSampleRate, 600));
+        stereoFilters.back()->setStartFromDry(true);
+    }
+    bank.setCoefs(0, *stereoFilters.front());
+    bank.setStartFromDry(0, true);
+
+    const std::vector<CSAMPLE> input = noise(kFrames * kStemChannels);
+    std::vector<CSAMPLE> actual(input.size());
+    const CSAMPLE* inputs[] = {input.data()};
+    CSAMPLE* outputs[] = {actual.data()};
+
+    for (int buffer = 0; buffer < 3; ++buffer) {
+        bank.process(inputs, outputs, input.size());
+        // Deinterleave each stereo pair of the stem deck
+        for (int stem = 0; stem < kStemChannels / 2; ++stem) {
+            std::vector<CSAMPLE> stereoInput(kFrames * 2);
+            std::vector<CSAMPLE> expected(kFrames * 2);
+            std::vector<CSAMPLE> stereoActual(kFrames * 2);
+            for (std::size_t frame = 0; frame < kFrames; ++frame) {
+                for (int channel = 0; channel < 2; ++channel) {
+                    const std::size_t i = frame * kStemChannels + stem * 2 + channel;
+                    stereoInput[frame * 2 + channel] = input[i];
+                    stereoActual[frame * 2 + channel] = actual[i];
+                }
+            }
+            stereoFilters[stem]->process(stereoInput.data(), expected.data(), kFrames * 2);
+            expectEqualSamples(expected, stereoActual);
+        }
+    }
+}
+
+// The two recursions per frame of the implementation before IIRLanes
+void processScalar(const double* pCoef,
+        double* pBuf1,
+        double* pBuf2,
+        const CSAMPLE* pIn,
+        CSAMPLE* pOutput,
+        std::size_t bufferSize) {
+    for (std::size_t i = 0; i < bufferSize; i += 2) {
+        pOutput[i] = static_cast<CSAMPLE>(
+                EngineFilterIIR<8, IIR_LP>::processSample(pCoef, pBuf1, double{pIn[i]}));
+        pOutput[i + 1] = static_cast<CSAMPLE>(EngineFilterIIR<8, IIR_LP>::processSample(
+                pCoef, pBuf2, double{pIn[i + 1]}));
+    }
+}
+
+static void BM_EngineFilterIIRScalar(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    EngineFilterBessel8Low filter(kSampleRate, 246);
+    double buf1[8] = {};
+    double buf2[8] = {};
+    const std::vector<CSAMPLE> input = noise(bufferSize);
+    std::vector<CSAMPLE> output(bufferSize);
+    for (auto _ : state) {
+        processScalar(filter.coefs(), buf1, buf2, input.data(), output.data(), bufferSize);
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+BENCHMARK(BM_EngineFilterIIRScalar)->Range(64, 4096);
+
+static void BM_EngineFilterIIRStereo(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    EngineFilterBessel8Low filter(kSampleRate, 246);
+    filter.assumeSettled();
+    const std::vector<CSAMPLE> input = noise(bufferSize);
+    std::vector<CSAMPLE> output(bufferSize);
+    for (auto _ : state) {
+        filter.process(input.data(), output.data(), bufferSize);
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+BENCHMARK(BM_EngineFilterIIRStereo)->Range(64, 4096);
+
+// Two bands of an LV-Mix EQ
+static void BM_EngineFilterIIRBankStereoTwoBands(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    EngineFilterIIRBank<8, IIR_LP, 2, 2> bank;
+    bank.setCoefs(0, EngineFilterBessel8Low(kSampleRate, 246));
+    bank.setCoefs(1, EngineFilterBessel8Low(kSampleRate, 2484));
+    bank.assumeSettled();
+    const std::vector<CSAMPLE> input = noise(bufferSize);
+    std::vector<CSAMPLE> output1(bufferSize);
+    std::vector<CSAMPLE> output2(bufferSize);
+    const CSAMPLE* inputs[] = {input.data(), input.data()};
+    CSAMPLE* outputs[] = {output1.data(), output2.data()};
+    for (auto _ : state) {
+        bank.process(inputs, outputs, bufferSize);
+        benchmark::DoNotOptimize(output1.data());
+        benchmark::DoNotOptimize(output2.data());
+    }
+}
+BENCHMARK(BM_EngineFilterIIRBankStereoTwoBands)->Range(64, 4096);
+
+// A stem deck with 4 stereo stems, the size is per stereo pair
+static void BM_EngineFilterIIRBankStem(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    EngineFilterIIRBank<8, IIR_LP, 8> bank;
+    bank.setCoefs(0, EngineFilterBessel8Low(kSampleRate, 246));
+    bank.assumeSettled();
+    const std::vector<CSAMPLE> input = noise(bufferSize * 4);
+    std::vector<CSAMPLE> output(bufferSize * 4);
+    const CSAMPLE* inputs[] = {input.data()};
+    CSAMPLE* outputs[] = {output.data()};
+    for (auto _ : state) {
+        bank.process(inputs, outputs, bufferSize * 4);
+        benchmark::DoNotOptimize(output.data());
+    }
+}
+BENCHMARK(BM_EngineFilterIIRBankStem)->Range(64, 4096);
+
+} // namespace
@@ -0,0 +1,173 @@
+#include "engine/enginejobscheduler.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Simulates a short stretching job of a few microseconds.
+float burnCycles(int iterations) {
+    float value = 0.5f;
+    for (int i = 0; i < iterations; ++i) {
+        value = std::sin(value) + 0.5f;
+    }
+    return value;
+}
+
+class CountingJob : public EngineJob {
+  public:
+    void run() override {
+        m_runs.fetch_add(1);
+    }
+
+    int runs() const {
+        return m_runs.load();
+    }
+
+  private:
+    std::atomic<int> m_runs{0};
+};
+
+class BurnJob : public EngineJob {
+  public:
+    explicit BurnJob(int iterations)
+            : m_iterations(iterations),
+              m_result(0) {
+    }
+    void run() override {
+        m_result = burnCycles(m_iterations);
+    }
+
+  private:
+    const int m_iterations;
+    float m_result;
+};
+
+// The scheme used for the Rubber Band stretchers before EngineJobScheduler
+class BurnRunnable : public QRunnable {
+  public:
+    explicit BurnRunnable(int iterations)
+            : m_iterations(iterations),
+              m_result(0),
+              m_completedSema(0) {
+        setAutoDelete(false);
+    }
+    void run() override {
+        m_result = burnCycles(m_iterations);
+        m_completedSema.release();
+    }
+    void waitReady() {
+        m_completedSema.acquire();
+    }
+
+  private:
+    const int m_iterations;
+    float m_result;
+    QSemaphore m_completedSema;
+};
+
+class EngineJobSchedulerTest : public testing::TestWithParam<int> {
+};
+
+TEST_P(EngineJobSchedulerTest, AllJobsRunOncePerSubmission) {
+    EngineJobScheduler scheduler(GetParam());
+    EXPECT_EQ(GetParam(), scheduler.numWorkers());
+
+    std::vector<std::unique_ptr<CountingJob>> jobs;
+    for (int i = 0; i < 16; ++i) {
+        jobs.push_back(std::make_unique<CountingJob>());
+    }
+    constexpr int kRounds = 1000;
+    for (int round = 1; round <= kRounds; ++round) {
+        for (const auto& pJob : jobs) {
+            scheduler.submit(pJob.get());
+        }
+        for (const auto& pJob : jobs) {
+            scheduler.wait(pJob.get());
+            EXPECT_EQ(round, pJob->runs());
+        }
+    }
+}
+
+TEST_P(EngineJobSchedulerTest, MoreJobsThanQueueCapacity) {
+    EngineJobScheduler scheduler(GetParam());
+
+    std::vector<std::unique_ptr<CountingJob>> jobs;
+    for (int i = 0; i < 1000; ++i) {
+        jobs.push_back(std::make_unique<CountingJob>());
+    }
+    for (const auto& pJob : jobs) {
+        scheduler.submit(pJob.get());
+    }
+    for (const auto& pJob : jobs) {
+        scheduler.wait(pJob.get());
+        EXPECT_EQ(1, pJob->runs());
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(EngineJobSchedulerWorkers,
+        EngineJobSchedulerTest,
+        testing::Values(0, 1, 3));
+
+// Each iteration submits state.range(0) jobs like a deck with as many
+// stretchers, and runs one more on the calling thread.
+static void BM_EngineJobScheduler(benchmark::State& state) {
+    const int numJobs = static_cast<int>(state.range(0));
+    EngineJobScheduler scheduler(numJobs);
+    std::vector<std::unique_ptr<BurnJob>> jobs;
+    for (int i = 0; i < numJobs; ++i) {
+        jobs.push_back(std::make_unique<BurnJob>(200));
+    }
+    BurnJob ownJob(200);
+
+    for (auto _ : state) {
+        for (const auto& pJob : jobs) {
+            scheduler.submit(pJob.get());
+        }
+        ownJob.run();
+        for (const auto& pJob : jobs) {
+            scheduler.wait(pJob.get());
+        }
+    }
+}
+BENCHMARK(BM_EngineJobScheduler)->DenseRange(1, 7, 2)->UseRealTime();
+
+static void BM_QThreadPool(benchmark::State& state) {
+    const int numJobs = static_cast<int>(state.range(0));
+    QThreadPool pool;
+    pool.setMaxThreadCount(numJobs);
+    for (int w = 0; w < numJobs; w++) {
+        pool.reserveThread();
+    }
+    std::vector<std::unique_ptr<BurnRunnable>> jobs;
+    for (int i = 0; i < numJobs; ++i) {
+        jobs.push_back(std::make_unique<BurnRunnable>(200));
+    }
+    BurnJob ownJob(200);
+
+    for (auto _ : state) {
+        for (const auto& pJob : jobs) {
+            if (!pool.tryStart(pJob.get())) {
+                pJob->run();
+            }
+        }
+        ownJob.run();
+        for (const auto& pJob : jobs) {
+            pJob->waitReady();
+        }
+    }
+    for (int w = 0; w < numJobs; w++) {
+        pool.releaseThread();
+    }
+}
+BENCHMARK(BM_QThreadPool)->DenseRange(1, 7, 2)->UseRealTime();
+
+} // namespace
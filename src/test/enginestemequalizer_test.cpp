@@ -0,0 +1,165 @@
+#include "engine/enginestemequalizer.h"
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "util/sample.h"
+
+namespace {
+
+constexpr mixxx::audio::SampleRate kSampleRate(44100);
+constexpr int kStemCount = mixxx::kMaxSupportedStems;
+constexpr int kDeckCount = 4;
+
+std::vector<CSAMPLE> noise(std::size_t size, quint32 seed) {
+    std::vector<CSAMPLE> samples(size);
+    for (auto& sample : samples) {
+        seed = seed * 1664525 + 1013904223;
+        sample = static_cast<CSAMPLE>(seed) / static_cast<CSAMPLE>(0xFFFFFFFFu) - 0.5f;
+    }
+    return samples;
+}
+
+class EngineStemEqualizerTest : public testing::Test {
+  protected:
+    static constexpr std::size_t kBufferSize = 1024;
+
+    void SetUp() override {
+        for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+            m_inputs.push_back(noise(kBufferSize, stemIdx + 1));
+            m_stems.push_back(m_inputs.back());
+        }
+    }
+
+    void process(EngineStemEqualizer* pEqualizer, const EngineStemEqualizer::Gains* pGains) {
+        CSAMPLE* stemPlanes[kStemCount];
+        for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+            m_stems[stemIdx] = m_inputs[stemIdx];
+            stemPlanes[stemIdx] = m_stems[stemIdx].data();
+        }
+        pEqualizer->process(stemPlanes, pGains, kStemCount, kSampleRate, kBufferSize);
+    }
+
+    std::vector<std::vector<CSAMPLE>> m_inputs;
+    std::vector<std::vector<CSAMPLE>> m_stems;
+};
+
+TEST_F(EngineStemEqualizerTest, unityGainDelaysStems) {
+    // The group delay of the low band filter, see LVMixEQEffectGroupState
+    EngineFilterBessel4Low lowFilter(kSampleRate, 246);
+    const std::size_t delay = 2 *
+            lowFilter.setFrequencyCornersForIntDelay(246.0 / kSampleRate, 3300);
+    ASSERT_LT(delay, kBufferSize);
+
+    EngineStemEqualizer equalizer(kSampleRate);
+    const EngineStemEqualizer::Gains gains[kStemCount];
+    process(&equalizer, gains);
+    for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+        for (std::size_t i = 0; i < delay; ++i) {
+            EXPECT_FLOAT_EQ(0, m_stems[stemIdx][i]);
+        }
+        for (std::size_t i = delay; i < kBufferSize; ++i) {
+            EXPECT_FLOAT_EQ(m_inputs[stemIdx][i - delay], m_stems[stemIdx][i]);
+        }
+    }
+}
+
+TEST_F(EngineStemEqualizerTest, killOnlyAffectsItsStem) {
+    EngineStemEqualizer equalizer(kSampleRate);
+    EngineStemEqualizer::Gains gains[kStemCount];
+    gains[1] = {CSAMPLE_GAIN_ZERO, CSAMPLE_GAIN_ZERO, CSAMPLE_GAIN_ZERO};
+    // The first buffer ramps to the new gains
+    process(&equalizer, gains);
+    process(&equalizer, gains);
+
+    for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+        const CSAMPLE maxAbs = SampleUtil::maxAbsAmplitude(
+                m_stems[stemIdx].data(), kBufferSize);
+        if (stemIdx == 1) {
+            EXPECT_FLOAT_EQ(0, maxAbs);
+        } else {
+            EXPECT_LT(0.1f, maxAbs);
+        }
+    }
+}
+
+// 4 decks with 4 stems each, the size is per stereo stem
+static void BM_EngineStemEqualizer(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    std::vector<std::unique_ptr<EngineStemEqualizer>> equalizers;
+    std::vector<std::vector<CSAMPLE>> stems;
+    for (int deck = 0; deck < kDeckCount; ++deck) {
+        equalizers.push_back(std::make_unique<EngineStemEqualizer>(kSampleRate));
+        for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+            stems.push_back(noise(bufferSize, deck * kStemCount + stemIdx + 1));
+        }
+    }
+    EngineStemEqualizer::Gains gains[kStemCount];
+    gains[0].low = 0.5f;
+    gains[2].high = 2.0f;
+    for (auto _ : state) {
+        for (int deck = 0; deck < kDeckCount; ++deck) {
+            CSAMPLE* stemPlanes[kStemCount];
+            for (int stemIdx = 0; stemIdx < kStemCount; ++stemIdx) {
+                stemPlanes[stemIdx] = stems[deck * kStemCount + stemIdx].data();
+            }
+            equalizers[deck]->process(stemPlanes, gains, kStemCount, kSampleRate, bufferSize);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EngineStemEqualizer)->Range(64, 4096);
+
+// The same filters with one EQ instance per stem, like a Bessel4 LV-Mix
+// EQ effect on every stem
+static void BM_EngineStemEqualizerSeparateStems(benchmark::State& state) {
+    const auto bufferSize = static_cast<std::size_t>(state.range(0));
+    constexpr int kStereoStemCount = kDeckCount * kStemCount;
+    std::vector<std::unique_ptr<EngineFilterBessel4Low>> lowFilters;
+    std::vector<std::unique_ptr<EngineFilterBessel4Low>> bandFilters;
+    std::vector<std::unique_ptr<EngineFilterDelay<3300>>> bandDelays;
+    std::vector<std::unique_ptr<EngineFilterDelay<3300>>> highDelays;
+    std::vector<std::vector<CSAMPLE>> stems;
+    for (int stemIdx = 0; stemIdx < kStereoStemCount; ++stemIdx) {
+        lowFilters.push_back(std::make_unique<EngineFilterBessel4Low>(kSampleRate, 246));
+        bandFilters.push_back(std::make_unique<EngineFilterBessel4Low>(kSampleRate, 2484));
+        const int delayLow = lowFilters.back()->setFrequencyCornersForIntDelay(
+                246.0 / kSampleRate, 3300);
+        const int delayBand = bandFilters.back()->setFrequencyCornersForIntDelay(
+                2484.0 / kSampleRate, 3300);
+        lowFilters.back()->assumeSettled();
+        bandFilters.back()->assumeSettled();
+        bandDelays.push_back(std::make_unique<EngineFilterDelay<3300>>());
+        bandDelays.back()->setDelay((delayLow - delayBand) * 2);
+        highDelays.push_back(std::make_unique<EngineFilterDelay<3300>>());
+        highDelays.back()->setDelay(delayLow * 2);
+        stems.push_back(noise(bufferSize, stemIdx + 1));
+    }
+    std::vector<CSAMPLE> lowBuffer(bufferSize);
+    std::vector<CSAMPLE> bandBuffer(bufferSize);
+    std::vector<CSAMPLE> highBuffer(bufferSize);
+    for (auto _ : state) {
+        for (int stemIdx = 0; stemIdx < kStereoStemCount; ++stemIdx) {
+            CSAMPLE* pStem = stems[stemIdx].data();
+            highDelays[stemIdx]->process(pStem, highBuffer.data(), bufferSize);
+            bandDelays[stemIdx]->process(pStem, bandBuffer.data(), bufferSize);
+            bandFilters[stemIdx]->process(bandBuffer.data(), bandBuffer.data(), bufferSize);
+            lowFilters[stemIdx]->process(pStem, lowBuffer.data(), bufferSize);
+            SampleUtil::copy3WithGain(pStem,
+                    lowBuffer.data(),
+                    0.0f,
+                    bandBuffer.data(),
+                    0.0f,
+                    highBuffer.data(),
+                    1.0f,
+                    static_cast<int>(bufferSize));
+        }
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EngineStemEqualizerSeparateStems)->Range(64, 4096);
+
+} // namespace
@@ -0,0 +1,173 @@
+#include "library/externallibraryimportcache.h"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+#include "library/treeitem.h"
+#include "test/mixxxdbtest.h"
+
+namespace {
+
+const QStringList kTrackColumns = {"artist", "title", "location"};
+
+class ExternalLibraryImportCacheTest : public MixxxDbTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_tempDir.isValid());
+        m_sourcePath = m_tempDir.filePath("collection.nml");
+        writeSource("<NML/>");
+    }
+
+    void writeSource(const QByteArray& contents) {
+        QFile file(m_sourcePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        ASSERT_EQ(contents.size(), file.write(contents));
+    }
+
+    ExternalTrackTableUpdater makeUpdater() const {
+        return ExternalTrackTableUpdater(dbConnection(),
+                "traktor_library",
+                "location",
+                kTrackColumns);
+    }
+
+    int countTracks() const {
+        QSqlQuery query(dbConnection());
+        EXPECT_TRUE(query.exec("SELECT COUNT(*) FROM traktor_library"));
+        EXPECT_TRUE(query.next());
+        return query.value(0).toInt();
+    }
+
+    QString trackTitle(int id) const {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT title FROM traktor_library WHERE id=:id");
+        query.bindValue(":id", id);
+        EXPECT_TRUE(query.exec());
+        EXPECT_TRUE(query.next());
+        return query.value(0).toString();
+    }
+
+    QTemporaryDir m_tempDir;
+    QString m_sourcePath;
+};
+
+TEST_F(ExternalLibraryImportCacheTest, updateTracksIncrementally) {
+    int idA;
+    int idB;
+    {
+        ExternalTrackTableUpdater updater = makeUpdater();
+        ASSERT_TRUE(updater.begin());
+        idA = updater.importTrack({"Artist A", "Title A", "/music/a.mp3"});
+        idB = updater.importTrack({"Artist B", "Title B", "/music/b.mp3"});
+        ASSERT_TRUE(updater.removeMissingTracks());
+        EXPECT_EQ(2, updater.insertedCount());
+        EXPECT_EQ(idA, updater.trackId("/music/a.mp3"));
+    }
+    ASSERT_LE(0, idA);
+    ASSERT_LE(0, idB);
+
+    // Track A is unchanged, B has been modified, C is new and D is missing
+    {
+        ExternalTrackTableUpdater updater = makeUpdater();
+        ASSERT_TRUE(updater.begin());
+        EXPECT_EQ(idA, updater.importTrack({"Artist A", "Title A", "/music/a.mp3"}));
+        EXPECT_EQ(idB, updater.importTrack({"Artist B", "New Title", "/music/b.mp3"}));
+        const int idC = updater.importTrack({"Artist C", "Title C", "/music/c.mp3"});
+        EXPECT_LE(0, idC);
+        ASSERT_TRUE(updater.removeMissingTracks());
+        EXPECT_EQ(1, updater.unchangedCount());
+        EXPECT_EQ(1, updater.updatedCount());
+        EXPECT_EQ(1, updater.insertedCount());
+        EXPECT_EQ(0, updater.removedCount());
+    }
+    EXPECT_EQ("New Title", trackTitle(idB));
+
+    {
+        ExternalTrackTableUpdater updater = makeUpdater();
+        ASSERT_TRUE(updater.begin());
+        EXPECT_EQ(idA, updater.importTrack({"Artist A", "Title A", "/music/a.mp3"}));
+        ASSERT_TRUE(updater.removeMissingTracks());
+        EXPECT_EQ(2, updater.removedCount());
+        EXPECT_EQ(-1, updater.trackId("/music/b.mp3"));
+    }
+    EXPECT_EQ(1, countTracks());
+}
+
+TEST_F(ExternalLibraryImportCacheTest, distinguishNullFromEmptyValues) {
+    ExternalTrackTableUpdater updater = makeUpdater();
+    ASSERT_TRUE(updater.begin());
+    updater.importTrack({QVariant(), "Title", "/music/a.mp3"});
+    ASSERT_TRUE(updater.removeMissingTracks());
+
+    ExternalTrackTableUpdater nextUpdater = makeUpdater();
+    ASSERT_TRUE(nextUpdater.begin());
+    nextUpdater.importTrack({QString(""), "Title", "/music/a.mp3"});
+    EXPECT_EQ(1, nextUpdater.updatedCount());
+}
+
+TEST_F(ExternalLibraryImportCacheTest, reuseUnchangedImport) {
+    TreeItem root;
+    TreeItem* pFolder = root.appendChild("Folder", "-->Folder");
+    pFolder->appendChild("Playlist", "-->Folder-->Playlist");
+    root.appendChild("Device", QVariant(QList<QString>{"/media/usb", "device"}));
+
+    {
+        ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+        EXPECT_FALSE(cache.isUpToDate());
+        ASSERT_TRUE(cache.save(&root));
+    }
+
+    ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+    ASSERT_TRUE(cache.isUpToDate());
+    TreeItem restoredRoot;
+    ASSERT_TRUE(cache.restorePlaylistTree(&restoredRoot));
+    ASSERT_EQ(2, restoredRoot.childRows());
+    const TreeItem* pRestoredFolder = restoredRoot.child(0);
+    EXPECT_EQ("Folder", pRestoredFolder->getLabel());
+    EXPECT_EQ("-->Folder", pRestoredFolder->getData().toString());
+    ASSERT_EQ(1, pRestoredFolder->childRows());
+    EXPECT_EQ("-->Folder-->Playlist", pRestoredFolder->child(0)->getData().toString());
+    EXPECT_EQ(QStringList({"/media/usb", "device"}),
+            restoredRoot.child(1)->getData().toStringList());
+
+    // Other features are not affected
+    ExternalLibraryImportCache otherCache(dbConnection(), "rhythmbox", {m_sourcePath});
+    EXPECT_FALSE(otherCache.isUpToDate());
+}
+
+TEST_F(ExternalLibraryImportCacheTest, reuseImportWithoutPlaylists) {
+    TreeItem root;
+    {
+        ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+        EXPECT_FALSE(cache.isUpToDate());
+        ASSERT_TRUE(cache.save(&root));
+    }
+
+    ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+    ASSERT_TRUE(cache.isUpToDate());
+    TreeItem restoredRoot;
+    ASSERT_TRUE(cache.restorePlaylistTree(&restoredRoot));
+    EXPECT_EQ(0, restoredRoot.childRows());
+}
+
+TEST_F(ExternalLibraryImportCacheTest, detectChangedSource) {
+    TreeItem root;
+    {
+        ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+        cache.isUpToDate();
+        ASSERT_TRUE(cache.save(&root));
+    }
+
+    writeSource("<NML><COLLECTION/></NML>");
+    ExternalLibraryImportCache cache(dbConnection(), "traktor", {m_sourcePath});
+    EXPECT_FALSE(cache.isUpToDate());
+
+    cache.invalidate();
+    ExternalLibraryImportCache invalidatedCache(dbConnection(), "traktor", {m_sourcePath});
+    EXPECT_FALSE(invalidatedCache.isUpToDate());
+}
+
+} // namespace
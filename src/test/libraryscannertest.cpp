@@ -1,9 +1,20 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QDateTime>
+#include <optional>
+
+#ifndef __WINDOWS__
+#include <utime.h>
+#endif
+
 #include "test/librarytest.h"
 
+#include "library/coverartutils.h"
 #include "library/scanner/libraryscanner.h"
+#include "library/scanner/recursivescandirectorytask.h"
+#include "library/scanner/scannerutil.h"
+#include "sources/soundsourceproxy.h"
 
 class LibraryScannerTest : public LibraryTest {
   protected:
@@ -13,6 +24,17 @@ class LibraryScannerTest : public LibraryTest {
     LibraryScanner m_libraryScanner;
 };
 
+namespace {
+
+struct ScanResult {
+    int unchanged = 0;
+    int hashedAndScanned = 0;
+    mixxx::cache_key_t hash = mixxx::invalidCacheKey();
+    std::optional<DirectoryJournalEntry> journalEntry;
+};
+
+} // anonymous namespace
+
 TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     // Normal flow:
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
@@ -52,3 +74,114 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+TEST_F(LibraryScannerTest, DirectoryJournalRoundtrip) {
+    LibraryHashDAO libraryHashDao;
+    libraryHashDao.initialize(internalCollection()->database());
+    EXPECT_TRUE(libraryHashDao.getDirectoryJournal().isEmpty());
+
+    libraryHashDao.saveDirectoryJournalEntry(QStringLiteral("/music"),
+            DirectoryJournalEntry{1234567890123456789, 42, {"a", "b c"}});
+    libraryHashDao.saveDirectoryJournalEntry(QStringLiteral("/music/a"),
+            DirectoryJournalEntry{1, 43, {}});
+    // Replaces the previous entry
+    libraryHashDao.saveDirectoryJournalEntry(QStringLiteral("/music/a"),
+            DirectoryJournalEntry{2, 43, {}});
+
+    auto journal = libraryHashDao.getDirectoryJournal();
+    ASSERT_EQ(2, journal.size());
+    EXPECT_EQ(1234567890123456789, journal.value("/music").modifiedNs);
+    EXPECT_EQ(42, journal.value("/music").inode);
+    EXPECT_EQ(QStringList({"a", "b c"}), journal.value("/music").subdirectories);
+    EXPECT_EQ(2, journal.value("/music/a").modifiedNs);
+    EXPECT_TRUE(journal.value("/music/a").subdirectories.isEmpty());
+
+    libraryHashDao.removeDirectoryJournalEntries({QStringLiteral("/music/a")});
+    journal = libraryHashDao.getDirectoryJournal();
+    EXPECT_EQ(QList<QString>({"/music"}), journal.keys());
+}
+
+TEST_F(LibraryScannerTest, DirectoryJournalSkipsUnchangedDirectory) {
+    const QString dirPath = getTestDataDir().filePath(QStringLiteral("journal"));
+    ASSERT_TRUE(QDir().mkpath(dirPath));
+    // Only a cover image, i.e. no import tasks are queued
+    mixxxtest::copyFile(
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover_test.jpg")),
+            QDir(dirPath).filePath(QStringLiteral("cover.jpg")));
+    qint64 modifiedNs = 0;
+    qint64 inode = 0;
+    if (!ScannerUtil::statDirectory(dirPath, &modifiedNs, &inode)) {
+        // The journal is not used for this file system
+        return;
+    }
+#ifndef __WINDOWS__
+    // Modifications within the last 2 seconds are not journaled
+    struct utimbuf times;
+    times.actime = QDateTime::currentSecsSinceEpoch() - 60;
+    times.modtime = times.actime;
+    ASSERT_EQ(0, ::utime(QFile::encodeName(dirPath).constData(), &times));
+#endif
+
+    QHash<QString, mixxx::cache_key_t> directoryHashes;
+    QHash<QString, DirectoryJournalEntry> directoryJournal;
+    const auto scan = [&] {
+        const auto pScannerGlobal = ScannerGlobalPointer::create(
+                QSet<QString>(),
+                directoryHashes,
+                directoryJournal,
+                QRegularExpression(SoundSourceProxy::getSupportedFileNamesRegex()),
+                QRegularExpression(CoverArtUtils::supportedCoverArtExtensionsRegex(),
+                        QRegularExpression::CaseInsensitiveOption),
+                QStringList());
+        RecursiveScanDirectoryTask task(&m_libraryScanner,
+                pScannerGlobal,
+                mixxx::FileAccess(mixxx::FileInfo(dirPath)),
+                true);
+        ScanResult result;
+        QObject::connect(&task,
+                &ScannerTask::directoryUnchanged,
+                [&result](const QString&) {
+                    ++result.unchanged;
+                });
+        QObject::connect(&task,
+                &ScannerTask::directoryHashedAndScanned,
+                [&result](const QString&, bool, mixxx::cache_key_t hash) {
+                    ++result.hashedAndScanned;
+                    result.hash = hash;
+                });
+        QObject::connect(&task,
+                &ScannerTask::directoryJournaled,
+                [&result](const QString&,
+                        qint64 modifiedNs,
+                        qint64 inode,
+                        const QStringList& subdirectories) {
+                    result.journalEntry =
+                            DirectoryJournalEntry{modifiedNs, inode, subdirectories};
+                });
+        task.run();
+        return result;
+    };
+
+    // The first scan lists and journals the directory
+    auto result = scan();
+    EXPECT_EQ(0, result.unchanged);
+    EXPECT_EQ(1, result.hashedAndScanned);
+    ASSERT_TRUE(result.journalEntry);
+    EXPECT_EQ(inode, result.journalEntry->inode);
+    const QString dirLocation = mixxx::FileInfo(dirPath).location();
+    directoryHashes.insert(dirLocation, result.hash);
+    directoryJournal.insert(dirLocation, *result.journalEntry);
+
+    // The unchanged directory is not listed again
+    result = scan();
+    EXPECT_EQ(1, result.unchanged);
+    EXPECT_EQ(0, result.hashedAndScanned);
+
+    // Adding a file modifies the directory, which is listed again
+    mixxxtest::copyFile(
+            getTestDir().filePath(QStringLiteral("id3-test-data/cover_test.jpg")),
+            QDir(dirPath).filePath(QStringLiteral("folder.jpg")));
+    result = scan();
+    EXPECT_EQ(0, result.unchanged);
+    EXPECT_EQ(1, result.hashedAndScanned);
+}
@@ -0,0 +1,112 @@
+#include "render/renderscript.h"
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+
+namespace {
+
+using mixxx::RenderScript;
+
+class RenderScriptTest : public testing::Test {
+  protected:
+    std::optional<RenderScript> parse(const char* json) {
+        m_errorMessage.clear();
+        return RenderScript::fromJson(QByteArray(json),
+                QDir(QStringLiteral("/music/mixes")),
+                &m_errorMessage);
+    }
+
+    void expectInvalid(const char* json) {
+        EXPECT_FALSE(parse(json)) << json;
+        EXPECT_FALSE(m_errorMessage.isEmpty()) << json;
+    }
+
+    QString m_errorMessage;
+};
+
+TEST_F(RenderScriptTest, defaults) {
+    const auto script = parse(R"({ "duration": 2 })");
+    ASSERT_TRUE(script) << m_errorMessage.toStdString();
+    EXPECT_EQ(mixxx::audio::SampleRate(44100), script->sampleRate());
+    EXPECT_EQ(RenderScript::kDefaultFramesPerBuffer, script->framesPerBuffer());
+    EXPECT_EQ(88200, script->durationFrames());
+    EXPECT_TRUE(script->events().isEmpty());
+}
+
+TEST_F(RenderScriptTest, quantizeEventsToBufferStart) {
+    const auto script = parse(R"({
+        "sampleRate": 48000,
+        "framesPerBuffer": 512,
+        "duration": 10,
+        "events": [
+            { "time": 0.02, "group": "[Channel1]", "key": "play", "value": 1 },
+            { "time": 1, "group": "[Channel1]", "key": "rate", "value": -0.5 }
+        ]
+    })");
+    ASSERT_TRUE(script) << m_errorMessage.toStdString();
+    EXPECT_EQ(mixxx::audio::SampleRate(48000), script->sampleRate());
+    EXPECT_EQ(512, script->framesPerBuffer());
+    EXPECT_EQ(480000, script->durationFrames());
+    ASSERT_EQ(2, script->events().size());
+    // 960 frames
+    EXPECT_EQ(512, script->events()[0].frame);
+    EXPECT_EQ(QStringLiteral("play"), script->events()[0].key);
+    EXPECT_EQ(1.0, script->events()[0].value);
+    EXPECT_FALSE(script->events()[0].isLoad());
+    // 48000 frames
+    EXPECT_EQ(47616, script->events()[1].frame);
+    EXPECT_EQ(-0.5, script->events()[1].value);
+}
+
+TEST_F(RenderScriptTest, sortEventsStable) {
+    const auto script = parse(R"({
+        "duration": 10,
+        "events": [
+            { "time": 5, "group": "[Master]", "key": "crossfader", "value": 1 },
+            { "time": 0, "group": "[Channel1]", "load": "a.flac" },
+            { "time": 0, "group": "[Channel1]", "key": "play", "value": 1 }
+        ]
+    })");
+    ASSERT_TRUE(script) << m_errorMessage.toStdString();
+    ASSERT_EQ(3, script->events().size());
+    EXPECT_TRUE(script->events()[0].isLoad());
+    EXPECT_EQ(QStringLiteral("play"), script->events()[1].key);
+    EXPECT_EQ(QStringLiteral("crossfader"), script->events()[2].key);
+}
+
+TEST_F(RenderScriptTest, resolveTrackLocations) {
+    const auto script = parse(R"({
+        "duration": 1,
+        "events": [
+            { "time": 0, "group": "[Channel1]", "load": "a.flac" },
+            { "time": 0, "group": "[Channel2]", "load": "../tracks/b.mp3" },
+            { "time": 0, "group": "[Channel3]", "load": "/tmp/c.wav" }
+        ]
+    })");
+    ASSERT_TRUE(script) << m_errorMessage.toStdString();
+    ASSERT_EQ(3, script->events().size());
+    EXPECT_EQ(QStringLiteral("/music/mixes/a.flac"), script->events()[0].location);
+    EXPECT_EQ(QStringLiteral("/music/tracks/b.mp3"), script->events()[1].location);
+    EXPECT_EQ(QStringLiteral("/tmp/c.wav"), script->events()[2].location);
+}
+
+TEST_F(RenderScriptTest, invalid) {
+    expectInvalid(R"({ "duration": )");
+    expectInvalid(R"([])");
+    expectInvalid(R"({})");
+    expectInvalid(R"({ "duration": 0 })");
+    expectInvalid(R"({ "duration": 1, "sampleRate": -1 })");
+    expectInvalid(R"({ "duration": 1, "framesPerBuffer": 0 })");
+    expectInvalid(R"({ "duration": 1, "framesPerBuffer": 1000000 })");
+    expectInvalid(R"({ "duration": 1, "events": [
+            { "time": -1, "group": "[Channel1]", "key": "play", "value": 1 } ] })");
+    expectInvalid(R"({ "duration": 1, "events": [
+            { "time": 0, "key": "play", "value": 1 } ] })");
+    expectInvalid(R"({ "duration": 1, "events": [
+            { "time": 0, "group": "[Channel1]", "key": "play" } ] })");
+    expectInvalid(R"({ "duration": 1, "events": [
+            { "time": 0, "group": "[Channel1]", "load": "" } ] })");
+}
+
+} // namespace
@@ -0,0 +1,116 @@
+#include "util/rtprofiler.h"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+namespace {
+
+using mixxx::RtProfiler;
+using mixxx::RtProfilerHistogram;
+using mixxx::RtProfilerScope;
+using mixxx::RtProfilerStage;
+
+TEST(RtProfilerTest, histogramEmpty) {
+    RtProfilerHistogram histogram;
+    EXPECT_EQ(0, histogram.count());
+    EXPECT_EQ(0, histogram.min());
+    EXPECT_EQ(0, histogram.max());
+    EXPECT_EQ(0.0, histogram.mean());
+    EXPECT_EQ(0, histogram.valueAtPercentile(50));
+}
+
+TEST(RtProfilerTest, histogramCountMinMax) {
+    RtProfilerHistogram histogram;
+    histogram.record(1000);
+    histogram.record(17);
+    histogram.record(123456789);
+    EXPECT_EQ(3, histogram.count());
+    EXPECT_EQ(17, histogram.min());
+    EXPECT_EQ(123456789, histogram.max());
+    EXPECT_DOUBLE_EQ((1000.0 + 17.0 + 123456789.0) / 3, histogram.mean());
+    EXPECT_EQ(123456789, histogram.valueAtPercentile(100));
+}
+
+TEST(RtProfilerTest, histogramPercentilePrecision) {
+    RtProfilerHistogram histogram;
+    // Uniformly distributed from 1 µs to 10 ms. The buckets have a
+    // relative width of 1/32.
+    constexpr qint64 kCount = 10000;
+    constexpr qint64 kStep = 1000;
+    for (qint64 i = 1; i <= kCount; ++i) {
+        histogram.record(i * kStep);
+    }
+    for (const double percentile : {1.0, 10.0, 50.0, 90.0, 99.0, 99.9}) {
+        const double expected = percentile / 100 * kCount * kStep;
+        const double actual = static_cast<double>(histogram.valueAtPercentile(percentile));
+        EXPECT_GE(actual, expected * 0.96) << "percentile " << percentile;
+        EXPECT_LE(actual, expected * 1.04) << "percentile " << percentile;
+    }
+}
+
+TEST(RtProfilerTest, registerStage) {
+    const RtProfilerStage stage = RtProfiler::registerStage(
+            QStringLiteral("RtProfilerTest::registerStage"));
+    EXPECT_EQ(stage,
+            RtProfiler::registerStage(
+                    QStringLiteral("RtProfilerTest::registerStage")));
+    EXPECT_NE(stage,
+            RtProfiler::registerStage(
+                    QStringLiteral("RtProfilerTest::registerStage 2")));
+}
+
+TEST(RtProfilerTest, writeChromeTrace) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString traceFilePath = tempDir.filePath(QStringLiteral("trace.json"));
+
+    const RtProfilerStage scopeStage =
+            RtProfiler::registerStage(QStringLiteral("RtProfilerTest::scope"));
+    const RtProfilerStage instantStage =
+            RtProfiler::registerStage(QStringLiteral("RtProfilerTest::instant"));
+
+    // Not recorded while the profiler is inactive
+    EXPECT_FALSE(RtProfiler::isActive());
+    { RtProfilerScope scope(scopeStage); }
+
+    RtProfiler::createInstance(traceFilePath);
+    EXPECT_TRUE(RtProfiler::isActive());
+    for (int i = 0; i < 10; ++i) {
+        RtProfilerScope scope(scopeStage);
+    }
+    RtProfiler::recordInstant(instantStage);
+    RtProfiler::destroy();
+    EXPECT_FALSE(RtProfiler::isActive());
+
+    QFile file(traceFilePath);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    ASSERT_EQ(QJsonParseError::NoError, error.error) << error.errorString().toStdString();
+
+    int scopeEvents = 0;
+    int instantEvents = 0;
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    for (const auto& value : events) {
+        const QJsonObject event = value.toObject();
+        const QString name = event.value(QStringLiteral("name")).toString();
+        const QString phase = event.value(QStringLiteral("ph")).toString();
+        if (name == QStringLiteral("RtProfilerTest::scope")) {
+            EXPECT_EQ(QStringLiteral("X"), phase);
+            EXPECT_GE(event.value(QStringLiteral("dur")).toDouble(), 0.0);
+            ++scopeEvents;
+        } else if (name == QStringLiteral("RtProfilerTest::instant")) {
+            EXPECT_EQ(QStringLiteral("i"), phase);
+            ++instantEvents;
+        }
+    }
+    EXPECT_EQ(10, scopeEvents);
+    EXPECT_EQ(1, instantEvents);
+}
+
+} // namespace
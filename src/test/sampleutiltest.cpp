@@ -4,9 +4,12 @@
 #include <QList>
 #include <QPair>
 #include <QtDebug>
+#include <random>
+#include <string>
 #include <vector>
 
 #include "util/sample.h"
+#include "util/samplekernels.h"
 #include "util/timer.h"
 
 namespace {
@@ -466,6 +469,163 @@ TEST_F(SampleUtilTest, mixMultichannelToStereo) {
     EXPECT_FLOAT_EQ(destination[3], 0.9f + 1.1f + 1.3f /* + 1.5f*/);
 }
 
+TEST_F(SampleUtilTest, copyMultiToStereoPlanes) {
+    CSAMPLE source[16];
+    for (int i = 0; i < 16; ++i) {
+        source[i] = i * 0.1f;
+    }
+    CSAMPLE planes[4][4];
+    CSAMPLE* destinations[] = {planes[0], planes[1], planes[2], planes[3]};
+
+    SampleUtil::copyMultiToStereoPlanes(
+            destinations, source, 2, mixxx::audio::ChannelCount::stem());
+
+    for (int plane = 0; plane < 4; ++plane) {
+        EXPECT_FLOAT_EQ(planes[plane][0], source[plane * 2]);
+        EXPECT_FLOAT_EQ(planes[plane][1], source[plane * 2 + 1]);
+        EXPECT_FLOAT_EQ(planes[plane][2], source[8 + plane * 2]);
+        EXPECT_FLOAT_EQ(planes[plane][3], source[8 + plane * 2 + 1]);
+    }
+}
+
+TEST_F(SampleUtilTest, kernelsMatchScalarReference) {
+    using namespace mixxx::sampleutil;
+    const Kernels& reference = scalarKernels();
+    std::minstd_rand generator(42);
+    std::uniform_real_distribution<CSAMPLE> distribution(-1.5f, 1.5f);
+    for (const Kernels* pKernels : supportedKernels()) {
+        SCOPED_TRACE(pKernels->name);
+        // Odd frame counts exercise the remainder loops of all vector widths
+        for (SINT numFrames : {0, 1, 3, 7, 8, 15, 16, 17, 33, 513}) {
+            SCOPED_TRACE(numFrames);
+            const SINT numSamples = numFrames * 2;
+            std::vector<CSAMPLE> src1(numSamples);
+            std::vector<CSAMPLE> src2(numSamples);
+            std::vector<CSAMPLE> src3(numSamples);
+            std::vector<CSAMPLE> dest(numSamples);
+            for (auto* pBuffer : {&src1, &src2, &src3, &dest}) {
+                for (auto& sample : *pBuffer) {
+                    sample = distribution(generator);
+                }
+            }
+            auto expectBuffersNear = [](const std::vector<CSAMPLE>& expected,
+                                             const std::vector<CSAMPLE>& actual) {
+                ASSERT_EQ(expected.size(), actual.size());
+                for (std::size_t i = 0; i < expected.size(); ++i) {
+                    // FMA and a different summation order are permitted
+                    EXPECT_NEAR(expected[i], actual[i], 1e-5f) << "i=" << i;
+                }
+            };
+
+            auto expected = dest;
+            auto actual = dest;
+            reference.applyGain(expected.data(), 0.7f, numSamples);
+            pKernels->applyGain(actual.data(), 0.7f, numSamples);
+            expectBuffersNear(expected, actual);
+
+            reference.applyRampingGain(expected.data(), 0.3f, 0.001f, numFrames);
+            pKernels->applyRampingGain(actual.data(), 0.3f, 0.001f, numFrames);
+            expectBuffersNear(expected, actual);
+
+            reference.addWithGain(expected.data(), src1.data(), 0.6f, numSamples);
+            pKernels->addWithGain(actual.data(), src1.data(), 0.6f, numSamples);
+            expectBuffersNear(expected, actual);
+
+            reference.addWithRampingGain(
+                    expected.data(), src1.data(), 0.9f, -0.001f, numFrames);
+            pKernels->addWithRampingGain(
+                    actual.data(), src1.data(), 0.9f, -0.001f, numFrames);
+            expectBuffersNear(expected, actual);
+
+            reference.add2WithGain(expected.data(),
+                    src1.data(),
+                    0.6f,
+                    src2.data(),
+                    0.2f,
+                    numSamples);
+            pKernels->add2WithGain(actual.data(),
+                    src1.data(),
+                    0.6f,
+                    src2.data(),
+                    0.2f,
+                    numSamples);
+            expectBuffersNear(expected, actual);
+
+            reference.add3WithGain(expected.data(),
+                    src1.data(),
+                    0.6f,
+                    src2.data(),
+                    0.2f,
+                    src3.data(),
+                    0.9f,
+                    numSamples);
+            pKernels->add3WithGain(actual.data(),
+                    src1.data(),
+                    0.6f,
+                    src2.data(),
+                    0.2f,
+                    src3.data(),
+                    0.9f,
+                    numSamples);
+            expectBuffersNear(expected, actual);
+
+            reference.copyWithGain(expected.data(), src1.data(), 0.6f, numSamples);
+            pKernels->copyWithGain(actual.data(), src1.data(), 0.6f, numSamples);
+            expectBuffersNear(expected, actual);
+
+            // Aliased
+            reference.copyWithGain(expected.data(), expected.data(), 0.5f, numSamples);
+            pKernels->copyWithGain(actual.data(), actual.data(), 0.5f, numSamples);
+            expectBuffersNear(expected, actual);
+
+            reference.copyWithRampingGain(
+                    expected.data(), src2.data(), 0.3f, 0.001f, numFrames);
+            pKernels->copyWithRampingGain(
+                    actual.data(), src2.data(), 0.3f, 0.001f, numFrames);
+            expectBuffersNear(expected, actual);
+
+            CSAMPLE expectedSumLeft;
+            CSAMPLE expectedSumRight;
+            const int expectedClipping = reference.sumAbsPerChannel(
+                    &expectedSumLeft, &expectedSumRight, src3.data(), numFrames);
+            CSAMPLE actualSumLeft;
+            CSAMPLE actualSumRight;
+            const int actualClipping = pKernels->sumAbsPerChannel(
+                    &actualSumLeft, &actualSumRight, src3.data(), numFrames);
+            EXPECT_EQ(expectedClipping, actualClipping);
+            EXPECT_NEAR(expectedSumLeft, actualSumLeft, 1e-5f * numFrames);
+            EXPECT_NEAR(expectedSumRight, actualSumRight, 1e-5f * numFrames);
+
+            EXPECT_FLOAT_EQ(reference.maxAbs(src3.data(), numSamples),
+                    pKernels->maxAbs(src3.data(), numSamples));
+
+            // Interleave numSamples frames from src1 and src2
+            std::vector<CSAMPLE> expectedInterleaved(numSamples * 2);
+            std::vector<CSAMPLE> actualInterleaved(numSamples * 2);
+            reference.interleaveStereo(expectedInterleaved.data(),
+                    src1.data(),
+                    src2.data(),
+                    numSamples);
+            pKernels->interleaveStereo(actualInterleaved.data(),
+                    src1.data(),
+                    src2.data(),
+                    numSamples);
+            EXPECT_EQ(expectedInterleaved, actualInterleaved);
+
+            std::vector<CSAMPLE> expectedLeft(numFrames);
+            std::vector<CSAMPLE> expectedRight(numFrames);
+            std::vector<CSAMPLE> actualLeft(numFrames);
+            std::vector<CSAMPLE> actualRight(numFrames);
+            reference.deinterleaveStereo(
+                    expectedLeft.data(), expectedRight.data(), src3.data(), numFrames);
+            pKernels->deinterleaveStereo(
+                    actualLeft.data(), actualRight.data(), src3.data(), numFrames);
+            EXPECT_EQ(expectedLeft, actualLeft);
+            EXPECT_EQ(expectedRight, actualRight);
+        }
+    }
+}
+
 static void BM_MemCpy(benchmark::State& state) {
     SINT size = static_cast<SINT>(state.range(0));
     CSAMPLE* buffer = SampleUtil::alloc(size);
@@ -652,4 +812,101 @@ static void BM_Copy2WithRampingGain(benchmark::State& state) {
 }
 BENCHMARK(BM_Copy2WithRampingGain)->Range(64, 4096);
 
+// Runs a benchmark with the kernels of the given instruction set and
+// restores the kernels that have been selected at startup afterwards
+template<typename Func>
+void runWithKernels(benchmark::State& state,
+        const mixxx::sampleutil::Kernels& kernels,
+        Func func) {
+    const mixxx::sampleutil::Kernels& activeKernels =
+            mixxx::sampleutil::activeKernels();
+    mixxx::sampleutil::setActiveKernels(kernels);
+    SINT size = static_cast<SINT>(state.range(0));
+    CSAMPLE* buffer = SampleUtil::alloc(size * 2);
+    SampleUtil::fill(buffer, 0.5f, size * 2);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.25f, size);
+    CSAMPLE* buffer3 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer3, -0.25f, size);
+    CSAMPLE* buffer4 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer4, 0.75f, size);
+
+    while (state.KeepRunning()) {
+        func(buffer, buffer2, buffer3, buffer4, size);
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+    SampleUtil::free(buffer3);
+    SampleUtil::free(buffer4);
+    mixxx::sampleutil::setActiveKernels(activeKernels);
+}
+
+// Registers the benchmarks for the dispatched SampleUtil functions once
+// per instruction set that is supported by the CPU
+[[maybe_unused]] const bool kKernelBenchmarksRegistered = [] {
+    for (const mixxx::sampleutil::Kernels* pKernels :
+            mixxx::sampleutil::supportedKernels()) {
+        const auto& kernels = *pKernels;
+        auto registerBenchmark = [&kernels](const char* name, auto func) {
+            benchmark::RegisterBenchmark(
+                    (std::string("BM_") + name + "/" + kernels.name).c_str(),
+                    [&kernels, func](benchmark::State& state) {
+                        runWithKernels(state, kernels, func);
+                    })
+                    ->Range(64, 4096);
+        };
+        registerBenchmark("ApplyGain",
+                [](CSAMPLE* pDest, CSAMPLE*, CSAMPLE*, CSAMPLE*, SINT size) {
+                    SampleUtil::applyGain(pDest, 0.9f, size);
+                });
+        registerBenchmark("ApplyRampingGain",
+                [](CSAMPLE* pDest, CSAMPLE*, CSAMPLE*, CSAMPLE*, SINT size) {
+                    SampleUtil::applyRampingGain(pDest, 0.9f, 1.1f, size);
+                });
+        registerBenchmark("Add3WithGain",
+                [](CSAMPLE* pDest,
+                        CSAMPLE* pSrc1,
+                        CSAMPLE* pSrc2,
+                        CSAMPLE* pSrc3,
+                        SINT size) {
+                    SampleUtil::add3WithGain(
+                            pDest, pSrc1, 1.1f, pSrc2, 0.9f, pSrc3, 0.5f, size);
+                });
+        registerBenchmark("CopyWithRampingNormalization",
+                [](CSAMPLE* pDest, CSAMPLE* pSrc, CSAMPLE*, CSAMPLE*, SINT size) {
+                    SampleUtil::copyWithRampingNormalization(
+                            pDest, pSrc, 0.9f, 1.1f, size);
+                });
+        registerBenchmark("SumAbsPerChannel",
+                [](CSAMPLE*, CSAMPLE* pSrc, CSAMPLE*, CSAMPLE*, SINT size) {
+                    CSAMPLE sumLeft;
+                    CSAMPLE sumRight;
+                    benchmark::DoNotOptimize(SampleUtil::sumAbsPerChannel(
+                            &sumLeft, &sumRight, pSrc, size));
+                    benchmark::DoNotOptimize(sumLeft);
+                    benchmark::DoNotOptimize(sumRight);
+                });
+        registerBenchmark("InterleaveBuffer",
+                [](CSAMPLE* pDest,
+                        CSAMPLE* pSrc1,
+                        CSAMPLE* pSrc2,
+                        CSAMPLE*,
+                        SINT size) {
+                    SampleUtil::interleaveBuffer(pDest, pSrc1, pSrc2, size);
+                });
+        registerBenchmark("DeinterleaveBuffer",
+                [](CSAMPLE* pSrc,
+                        CSAMPLE* pDest1,
+                        CSAMPLE* pDest2,
+                        CSAMPLE*,
+                        SINT size) {
+                    SampleUtil::deinterleaveBuffer(pDest1, pDest2, pSrc, size);
+                });
+    }
+    return true;
+}();
+
 }  // namespace
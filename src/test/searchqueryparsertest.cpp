@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <QDir>
+#include <QSqlQuery>
 #include <QtDebug>
 
 #include "library/searchquery.h"
@@ -1381,3 +1382,77 @@ TEST_F(SearchQueryParserTest, QuotedOrOperator) {
     pTrackI->setComment("house");
     EXPECT_TRUE(pQuery->match(pTrackI));
 }
+
+TEST_F(SearchQueryParserTest, SearchIndex) {
+    const QString kTrackALocationTest(getTestDir().filePath(
+            QStringLiteral("id3-test-data/cover-test-jpg.mp3")));
+    const QString kTrackBLocationTest(getTestDir().filePath(
+            QStringLiteral("id3-test-data/cover-test-png.mp3")));
+    const TrackId trackAId = addTrackToCollection(kTrackALocationTest);
+    const TrackId trackBId = addTrackToCollection(kTrackBLocationTest);
+    if (!internalCollection()->getTrackDAO().searchIndex().isAvailable()) {
+        // SQLite has been built without FTS5 or the trigram tokenizer
+        return;
+    }
+
+    m_parser.setSearchColumns({"artist", "location"});
+    m_parser.setSearchIndexEnabled(true);
+
+    const auto queryTrackIds = [this](const QString& searchQuery) {
+        const QString filter = m_parser.parseQuery(searchQuery, QString())->toSql();
+        QSqlQuery query(internalCollection()->database());
+        EXPECT_TRUE(query.exec(
+                QStringLiteral("SELECT id FROM library WHERE %1 ORDER BY id")
+                        .arg(filter)));
+        QList<TrackId> trackIds;
+        while (query.next()) {
+            trackIds.append(TrackId(query.value(0)));
+        }
+        return trackIds;
+    };
+
+    EXPECT_EQ(QList<TrackId>({trackAId, trackBId}), queryTrackIds("COVER-test"));
+    // Accents and case are folded like for LIKE
+    EXPECT_EQ(QList<TrackId>({trackBId}), queryTrackIds("t-PnG"));
+    EXPECT_EQ(QList<TrackId>({trackBId}), queryTrackIds(QString::fromUtf8("t-p\xC3\xB1g")));
+    EXPECT_EQ(QList<TrackId>({trackAId}), queryTrackIds("-png cover"));
+    EXPECT_EQ(QList<TrackId>(), queryTrackIds("cover-test-gif"));
+
+    EXPECT_STREQ(
+            qPrintable(QString("id IN (SELECT rowid FROM library_fts "
+                               "WHERE library_fts MATCH '{artist location}:\"asdf\"')")),
+            qPrintable(m_parser.parseQuery("asdf", QString())->toSql()));
+}
+
+TEST_F(SearchQueryParserTest, SearchIndexKeepsLikeSemantics) {
+    if (!internalCollection()->getTrackDAO().searchIndex().isAvailable()) {
+        // SQLite has been built without FTS5 or the trigram tokenizer
+        return;
+    }
+
+    m_parser.setSearchColumns({"artist", "album"});
+    m_parser.setSearchIndexEnabled(true);
+
+    // Quoted terms
+    EXPECT_STREQ(
+            qPrintable(QString("(artist LIKE '%asdf%') OR (album LIKE '%asdf%')")),
+            qPrintable(m_parser.parseQuery("\"asdf\"", QString())->toSql()));
+    // Field-prefixed terms
+    EXPECT_STREQ(
+            qPrintable(QString("album LIKE '%asdf%'")),
+            qPrintable(m_parser.parseQuery("al:asdf", QString())->toSql()));
+    // Terms that are too short for the index
+    EXPECT_STREQ(
+            qPrintable(QString("(artist LIKE '%as%') OR (album LIKE '%as%')")),
+            qPrintable(m_parser.parseQuery("as", QString())->toSql()));
+    // Wildcards
+    EXPECT_STREQ(
+            qPrintable(QString("(artist LIKE '%as_f%') OR (album LIKE '%as_f%')")),
+            qPrintable(m_parser.parseQuery("as_f", QString())->toSql()));
+
+    // Columns that are not indexed
+    m_parser.setSearchColumns({"artist", "composer"});
+    EXPECT_STREQ(
+            qPrintable(QString("(artist LIKE '%asdf%') OR (composer LIKE '%asdf%')")),
+            qPrintable(m_parser.parseQuery("asdf", QString())->toSql()));
+}
@@ -0,0 +1,89 @@
+#include "skin/legacy/skindocumentcache.h"
+
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+
+namespace {
+
+const QByteArray kTemplate(
+        "<Template>\n"
+        "  <WidgetGroup>\n"
+        "    <ObjectName>Deck<Variable name=\"i\"/></ObjectName>\n"
+        "    <Style><![CDATA[ #Deck { color: red; } ]]></Style>\n"
+        "    <Connection persist=\"true\"><ConfigKey>[Master],gain</ConfigKey></Connection>\n"
+        "  </WidgetGroup>\n"
+        "</Template>\n");
+
+class SkinDocumentCacheTest : public MixxxTest {
+  protected:
+    void TearDown() override {
+        SkinDocumentCache::setCacheDirectory(QString());
+    }
+
+    static bool writeFile(const QString& path, const QByteArray& content) {
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+    }
+};
+
+TEST_F(SkinDocumentCacheTest, restoreFromCacheDirectory) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString cacheDir = QDir(tempDir.path()).filePath("cache");
+    const QString templatePath = QDir(tempDir.path()).filePath("template.xml");
+    ASSERT_TRUE(writeFile(templatePath, kTemplate));
+    SkinDocumentCache::setCacheDirectory(cacheDir);
+
+    const QDomElement parsed = SkinDocumentCache::documentElement(templatePath);
+    ASSERT_FALSE(parsed.isNull());
+    EXPECT_EQ(1, QDir(cacheDir).entryList(QDir::Files).size());
+
+    // A new modification time invalidates the document in memory,
+    // but the contents are unchanged
+    {
+        QFile file(templatePath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.setFileTime(
+                QDateTime::currentDateTime().addSecs(60),
+                QFileDevice::FileModificationTime));
+    }
+    const QDomElement restored = SkinDocumentCache::documentElement(templatePath);
+    ASSERT_FALSE(restored.isNull());
+    EXPECT_NE(parsed, restored);
+
+    QDomDocument parsedDocument;
+    parsedDocument.appendChild(parsedDocument.importNode(parsed, true));
+    QDomDocument restoredDocument;
+    restoredDocument.appendChild(restoredDocument.importNode(restored, true));
+    EXPECT_EQ(parsedDocument.toString(), restoredDocument.toString());
+
+    const QDomElement style = restored.firstChildElement("WidgetGroup")
+                                      .firstChildElement("Style");
+    EXPECT_TRUE(style.firstChild().isCDATASection());
+    EXPECT_EQ(QStringLiteral(" #Deck { color: red; } "), style.text());
+}
+
+TEST_F(SkinDocumentCacheTest, reloadModifiedFile) {
+    QTemporaryDir tempDir;
+    ASSERT_TRUE(tempDir.isValid());
+    const QString templatePath = QDir(tempDir.path()).filePath("template.xml");
+    ASSERT_TRUE(writeFile(templatePath, kTemplate));
+
+    EXPECT_EQ(QStringLiteral("Template"),
+            SkinDocumentCache::documentElement(templatePath).tagName());
+
+    ASSERT_TRUE(writeFile(templatePath, QByteArrayLiteral("<Skin/>")));
+    EXPECT_EQ(QStringLiteral("Skin"),
+            SkinDocumentCache::documentElement(templatePath).tagName());
+
+    ASSERT_TRUE(writeFile(templatePath, QByteArrayLiteral("<Skin>")));
+    EXPECT_TRUE(SkinDocumentCache::documentElement(templatePath).isNull());
+}
+
+} // namespace
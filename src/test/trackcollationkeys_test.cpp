@@ -0,0 +1,129 @@
+#include "library/dao/trackcollationkeys.h"
+
+#include <gtest/gtest.h>
+
+#include <QSqlQuery>
+
+#include "library/dao/settingsdao.h"
+#include "test/librarytest.h"
+
+namespace {
+
+class TrackCollationKeysTest : public LibraryTest {
+  protected:
+    TrackCollationKeys& collationKeys() const {
+        return internalCollection()->getTrackDAO().collationKeys();
+    }
+
+    TrackId addTrack(const QVariant& artist, bool updateKeys = true) {
+        QSqlQuery query(internalCollection()->database());
+        query.prepare(QStringLiteral("INSERT INTO library (artist) VALUES (:artist)"));
+        query.bindValue(":artist", artist);
+        EXPECT_TRUE(query.exec());
+        const TrackId trackId(query.lastInsertId());
+        if (updateKeys) {
+            EXPECT_TRUE(collationKeys().updateTracks({trackId}));
+        }
+        return trackId;
+    }
+
+    QString revision() const {
+        return SettingsDAO(internalCollection()->database())
+                .getValue(QStringLiteral("mixxx.library.collation_keys.revision"));
+    }
+
+    QList<TrackId> sortedTrackIds() const {
+        QSqlQuery query(internalCollection()->database());
+        EXPECT_TRUE(query.exec(
+                QStringLiteral("SELECT id FROM library ORDER BY %1, id")
+                        .arg(TrackCollationKeys::sortSql(QStringLiteral("artist")))));
+        QList<TrackId> trackIds;
+        while (query.next()) {
+            trackIds.append(TrackId(query.value(0)));
+        }
+        return trackIds;
+    }
+};
+
+TEST_F(TrackCollationKeysTest, sortByKeys) {
+    const TrackId zuluId = addTrack(QStringLiteral("Zulu"));
+    const TrackId alphaId = addTrack(QStringLiteral("alpha"));
+    const TrackId nullId = addTrack(QVariant());
+    const TrackId mikeId = addTrack(QStringLiteral("Mike"));
+    const TrackId mikeLowerId = addTrack(QStringLiteral("mike"));
+
+    EXPECT_EQ(QList<TrackId>({nullId, alphaId, mikeId, mikeLowerId, zuluId}),
+            sortedTrackIds());
+
+    qint64 alphaKey;
+    qint64 mikeKey;
+    ASSERT_TRUE(collationKeys().sortKey(QStringLiteral("alpha"), &alphaKey));
+    ASSERT_TRUE(collationKeys().sortKey(
+            TrackCollationKeys::foldValue(QStringLiteral("Mike")), &mikeKey));
+    EXPECT_LT(alphaKey, mikeKey);
+    qint64 unknownKey;
+    EXPECT_FALSE(collationKeys().sortKey(QStringLiteral("unknown"), &unknownKey));
+}
+
+TEST_F(TrackCollationKeysTest, cachedSortKey) {
+    addTrack(QStringLiteral("alpha"));
+    ASSERT_TRUE(collationKeys().reloadIfModified());
+
+    qint64 alphaKey;
+    qint64 cachedAlphaKey;
+    ASSERT_TRUE(collationKeys().sortKey(QStringLiteral("alpha"), &alphaKey));
+    ASSERT_TRUE(collationKeys().cachedSortKey(QStringLiteral("alpha"), &cachedAlphaKey));
+    EXPECT_EQ(alphaKey, cachedAlphaKey);
+    qint64 unknownKey;
+    EXPECT_FALSE(collationKeys().cachedSortKey(QStringLiteral("unknown"), &unknownKey));
+}
+
+TEST_F(TrackCollationKeysTest, sortMissingKeysWithCollator) {
+    const TrackId zuluId = addTrack(QStringLiteral("Zulu"));
+    const TrackId nullId = addTrack(QVariant());
+    const TrackId mikeId = addTrack(QStringLiteral("Mike"), false);
+    const TrackId alphaId = addTrack(QStringLiteral("alpha"));
+
+    // Not sorted like NULL
+    EXPECT_EQ(QList<TrackId>({nullId, alphaId, mikeId, zuluId}), sortedTrackIds());
+}
+
+TEST_F(TrackCollationKeysTest, reloadKeysOfOtherConnection) {
+    const TrackId mikeId = addTrack(QStringLiteral("mike"));
+    qint64 mikeKey;
+    ASSERT_TRUE(collationKeys().sortKey(QStringLiteral("mike"), &mikeKey));
+    const QString initialRevision = revision();
+
+    // Another connection adds a key after "mike" and increments the revision
+    QSqlQuery query(internalCollection()->database());
+    query.prepare(QStringLiteral(
+            "INSERT INTO library_collation_keys (value,sort_key) VALUES (:value,:key)"));
+    query.bindValue(":value", QStringLiteral("oscar"));
+    query.bindValue(":key", mikeKey + 2);
+    ASSERT_TRUE(query.exec());
+    ASSERT_TRUE(SettingsDAO(internalCollection()->database())
+                        .setValue(QStringLiteral("mixxx.library.collation_keys.revision"),
+                                initialRevision.toLongLong() + 1));
+    const TrackId oscarId = addTrack(QStringLiteral("oscar"), false);
+
+    // The new key is inserted between both keys of the database
+    const TrackId novemberId = addTrack(QStringLiteral("november"));
+    EXPECT_EQ(QList<TrackId>({mikeId, novemberId, oscarId}), sortedTrackIds());
+    EXPECT_EQ(QString::number(initialRevision.toLongLong() + 2), revision());
+}
+
+TEST_F(TrackCollationKeysTest, renumberWithoutGap) {
+    const TrackId firstId = addTrack(QStringLiteral("a"));
+    const TrackId lastId = addTrack(QStringLiteral("b"));
+    // Each value is inserted into the gap of the previous value and
+    // "b" until there is no gap left
+    QList<TrackId> expectedTrackIds = {firstId};
+    for (int i = 10; i < 80; ++i) {
+        expectedTrackIds.append(addTrack(QStringLiteral("a%1").arg(i)));
+    }
+    expectedTrackIds.append(lastId);
+
+    EXPECT_EQ(expectedTrackIds, sortedTrackIds());
+}
+
+} // namespace
@@ -56,3 +56,31 @@ TEST_F(TrackDAOTest, detectMovedTracks) {
     QSet<QString> trackLocations = trackDAO.getAllTrackLocations();
     EXPECT_THAT(trackLocations, UnorderedElementsAre(newFile.location(), otherFile.location()));
 }
+
+TEST_F(TrackDAOTest, batchUpdate) {
+    TrackDAO& trackDAO = internalCollection()->getTrackDAO();
+
+    TrackPointer pFirstTrack = Track::newTemporary(mixxx::FileAccess(
+            mixxx::FileInfo(QDir(QDir::tempPath()), QStringLiteral("first.mp3"))));
+    TrackPointer pSecondTrack = Track::newTemporary(mixxx::FileAccess(
+            mixxx::FileInfo(QDir(QDir::tempPath()), QStringLiteral("second.mp3"))));
+    const TrackId firstId = internalCollection()->addTrack(pFirstTrack, false);
+    const TrackId secondId = internalCollection()->addTrack(pSecondTrack, false);
+    ASSERT_TRUE(firstId.isValid());
+    ASSERT_TRUE(secondId.isValid());
+
+    pFirstTrack->setTitle(QStringLiteral("First"));
+    pSecondTrack->setTitle(QStringLiteral("Second"));
+    trackDAO.beginBatchUpdate();
+    EXPECT_TRUE(trackDAO.updateTrack(*pFirstTrack));
+    EXPECT_TRUE(trackDAO.updateTrack(*pSecondTrack));
+    EXPECT_TRUE(trackDAO.finishBatchUpdate());
+
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec(QStringLiteral("SELECT id,title FROM library ORDER BY id")));
+    QStringList titles;
+    while (query.next()) {
+        titles.append(query.value(1).toString());
+    }
+    EXPECT_EQ(QStringList({"First", "Second"}), titles);
+}
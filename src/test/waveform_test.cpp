@@ -0,0 +1,88 @@
+#include "waveform/waveform.h"
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <memory>
+
+namespace {
+
+class WaveformTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_tempDir.isValid());
+    }
+
+    static std::unique_ptr<Waveform> createWaveform(int stemCount) {
+        auto pWaveform = std::make_unique<Waveform>(44100, 44100 * 10, 441, -1, stemCount);
+        WaveformData* pData = pWaveform->data();
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            pData[i].filtered.low = static_cast<unsigned char>(i);
+            pData[i].filtered.mid = static_cast<unsigned char>(i + 1);
+            pData[i].filtered.high = static_cast<unsigned char>(i + 2);
+            pData[i].filtered.all = static_cast<unsigned char>(i + 3);
+            for (int stemIdx = 0; stemIdx < stemCount; ++stemIdx) {
+                pData[i].stems[stemIdx] = static_cast<unsigned char>(i * stemIdx);
+            }
+        }
+        return pWaveform;
+    }
+
+    QString writeFile(const QByteArray& data) {
+        const QString fileName = m_tempDir.filePath(QStringLiteral("waveform"));
+        QFile file(fileName);
+        EXPECT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        EXPECT_EQ(data.size(), file.write(data));
+        return fileName;
+    }
+
+    const QTemporaryDir m_tempDir;
+};
+
+TEST_F(WaveformTest, compactFormatRoundTrip) {
+    for (int stemCount : {0, 4}) {
+        const auto pWaveform = createWaveform(stemCount);
+        const QByteArray data = pWaveform->toCompactByteArray();
+        EXPECT_TRUE(Waveform::isCompactFormat(data));
+        EXPECT_EQ(Waveform::kCompactHeaderSize +
+                        pWaveform->getDataSize() * static_cast<int>(sizeof(WaveformData)),
+                data.size());
+
+        const std::unique_ptr<Waveform> pLoaded(
+                Waveform::fromCompactFile(writeFile(data)));
+        ASSERT_EQ(pWaveform->getDataSize(), pLoaded->getDataSize());
+        EXPECT_EQ(pWaveform->getAudioVisualRatio(), pLoaded->getAudioVisualRatio());
+        EXPECT_EQ(pWaveform->getTextureStride(), pLoaded->getTextureStride());
+        EXPECT_EQ(pWaveform->getTextureSize(), pLoaded->getTextureSize());
+        EXPECT_EQ(pLoaded->getDataSize(), pLoaded->getCompletion());
+        EXPECT_EQ(stemCount > 0, pLoaded->hasStem());
+        EXPECT_EQ(Waveform::SaveState::Saved, pLoaded->saveState());
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            EXPECT_EQ(pWaveform->getLow(i), pLoaded->getLow(i));
+            EXPECT_EQ(pWaveform->getMid(i), pLoaded->getMid(i));
+            EXPECT_EQ(pWaveform->getHigh(i), pLoaded->getHigh(i));
+            EXPECT_EQ(pWaveform->getAll(i), pLoaded->getAll(i));
+            for (int stemIdx = 0; stemIdx < stemCount; ++stemIdx) {
+                EXPECT_EQ(pWaveform->get(i).stems[stemIdx], pLoaded->get(i).stems[stemIdx]);
+            }
+        }
+    }
+}
+
+TEST_F(WaveformTest, legacyFormatIsNotCompact) {
+    const auto pWaveform = createWaveform(0);
+    EXPECT_FALSE(Waveform::isCompactFormat(pWaveform->toByteArray()));
+    EXPECT_FALSE(Waveform::isCompactFormat(qCompress(pWaveform->toByteArray())));
+}
+
+TEST_F(WaveformTest, truncatedCompactFile) {
+    const auto pWaveform = createWaveform(0);
+    const QByteArray data = pWaveform->toCompactByteArray();
+    const std::unique_ptr<Waveform> pLoaded(
+            Waveform::fromCompactFile(writeFile(data.left(data.size() - 1))));
+    EXPECT_EQ(0, pLoaded->getDataSize());
+    EXPECT_EQ(nullptr, pLoaded->data());
+}
+
+} // namespace
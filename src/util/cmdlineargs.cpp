@@ -52,6 +52,8 @@ CmdlineArgs::CmdlineArgs()
         : m_startInFullscreen(false), // Initialize vars
           m_startAutoDJ(false),
           m_rescanLibrary(false),
+          m_analyzeLibrary(false),
+          m_analyzeThreads(0),
           m_controllerDebug(false),
           m_controllerAbortOnWarning(false),
           m_developer(false),
@@ -240,6 +242,60 @@ bool CmdlineArgs::parse(const QStringList& arguments, CmdlineArgs::ParseMode mod
     parser.addOption(timelinePath);
     parser.addOption(timelinePathDeprecated);
 
+    const QCommandLineOption engineProfilePath(QStringLiteral("engine-profile-path"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Enables the profiler of the audio engine. The "
+                                      "durations of the processing stages are logged on "
+                                      "exit and the latest events are written to path as "
+                                      "a Chrome trace.")
+                            : QString(),
+            QStringLiteral("path"));
+    parser.addOption(engineProfilePath);
+
+    const QCommandLineOption renderScript(QStringLiteral("render-script"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Renders the mix described by the JSON "
+                                      "script at path offline, without a user "
+                                      "interface or audio hardware and as fast as "
+                                      "possible.")
+                            : QString(),
+            QStringLiteral("path"));
+    parser.addOption(renderScript);
+
+    const QCommandLineOption renderOutput(QStringLiteral("render-output"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Writes the main mix rendered with "
+                                      "--render-script to path. The encoder is "
+                                      "chosen by the file extension.")
+                            : QString(),
+            QStringLiteral("path"));
+    parser.addOption(renderOutput);
+
+    const QCommandLineOption analyzeLibrary(QStringLiteral("analyze-library"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Analyzes all tracks in the library without a "
+                                      "user interface and exits afterwards. An "
+                                      "interrupted run continues where it stopped.")
+                            : QString());
+    parser.addOption(analyzeLibrary);
+
+    const QCommandLineOption analyzeQuery(QStringLiteral("analyze-query"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "Only analyzes the tracks matching the library "
+                                      "search query with --analyze-library.")
+                            : QString(),
+            QStringLiteral("query"));
+    parser.addOption(analyzeQuery);
+
+    const QCommandLineOption analyzeThreads(QStringLiteral("analyze-threads"),
+            forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
+                                      "The number of tracks that are analyzed "
+                                      "concurrently with --analyze-library. "
+                                      "Default: The number of CPU cores.")
+                            : QString(),
+            QStringLiteral("n"));
+    parser.addOption(analyzeThreads);
+
     const QCommandLineOption enableLegacyVuMeter(QStringLiteral("enable-legacy-vumeter"),
             forUserFeedback ? QCoreApplication::translate("CmdlineArgs",
                                       "Use legacy vu meter")
@@ -472,6 +528,30 @@ bool CmdlineArgs::parse(const QStringList& arguments, CmdlineArgs::ParseMode mod
         m_timelinePath = parser.value(timelinePathDeprecated);
     }
 
+    if (parser.isSet(engineProfilePath)) {
+        m_engineProfilePath = parser.value(engineProfilePath);
+    }
+
+    if (parser.isSet(renderScript)) {
+        m_renderScriptPath = parser.value(renderScript);
+    }
+    if (parser.isSet(renderOutput)) {
+        m_renderOutputPath = parser.value(renderOutput);
+    }
+
+    m_analyzeLibrary = parser.isSet(analyzeLibrary);
+    if (parser.isSet(analyzeQuery)) {
+        m_analyzeQuery = parser.value(analyzeQuery);
+    }
+    if (parser.isSet(analyzeThreads)) {
+        bool ok = false;
+        m_analyzeThreads = parser.value(analyzeThreads).toInt(&ok);
+        if (!ok || m_analyzeThreads <= 0) {
+            fputs("\nFailed to parse analyze-threads.\n", stdout);
+            return false;
+        }
+    }
+
     m_useLegacyVuMeter = parser.isSet(enableLegacyVuMeter);
     m_useLegacySpinny = parser.isSet(enableLegacySpinny);
     m_controllerDebug = parser.isSet(controllerDebug) || parser.isSet(controllerDebugDeprecated);
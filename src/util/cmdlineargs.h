@@ -79,6 +79,31 @@ class CmdlineArgs final {
     }
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    bool getEngineProfilerEnabled() const {
+        return !m_engineProfilePath.isEmpty();
+    }
+    const QString& getEngineProfilePath() const {
+        return m_engineProfilePath;
+    }
+    bool getRenderEnabled() const {
+        return !m_renderScriptPath.isEmpty();
+    }
+    const QString& getRenderScriptPath() const {
+        return m_renderScriptPath;
+    }
+    const QString& getRenderOutputPath() const {
+        return m_renderOutputPath;
+    }
+    bool getAnalyzeLibrary() const {
+        return m_analyzeLibrary;
+    }
+    const QString& getAnalyzeQuery() const {
+        return m_analyzeQuery;
+    }
+    /// Returns 0 if the number of threads has not been set
+    int getAnalyzeThreads() const {
+        return m_analyzeThreads;
+    }
 
     const QString& getStyle() const {
         return m_styleName;
@@ -103,6 +128,8 @@ class CmdlineArgs final {
     bool m_startInFullscreen;       // Start in fullscreen mode
     bool m_startAutoDJ;
     bool m_rescanLibrary;
+    bool m_analyzeLibrary;
+    int m_analyzeThreads;
     bool m_controllerDebug;
     bool m_controllerPreviewScreens;
     bool m_controllerAbortOnWarning; // Controller Engine will be stricter
@@ -126,5 +153,9 @@ class CmdlineArgs final {
     QString m_settingsPath;
     QString m_resourcePath;
     QString m_timelinePath;
+    QString m_engineProfilePath;
+    QString m_renderScriptPath;
+    QString m_renderOutputPath;
+    QString m_analyzeQuery;
     QString m_styleName;
 };
@@ -190,6 +190,8 @@ int sqliteStringCompareUTF16(void* pArg,
 
 const char kLexicographicalCollationFunc[] = "mixxxLexicographicalCollationFunc";
 
+const char kLatinLowFunc[] = "mixxxLatinLow";
+
 // This implements the like() SQL function. This is used by the LIKE operator.
 // The SQL statement 'A LIKE B' is implemented as 'like(B, A)', and if there is
 // an escape character, say E, it is implemented as 'like(B, A, E)'
@@ -230,6 +232,44 @@ void sqliteLikeUtf8(sqlite3_context* context,
     return;
 }
 
+// This implements the mixxxLatinLow() SQL function that folds accents
+// and case in the same way as the custom like() function.
+//static
+void sqliteLatinLowUtf16(sqlite3_context* context,
+        int aArgc,
+        sqlite3_value** aArgv) {
+    VERIFY_OR_DEBUG_ASSERT(aArgc == 1) {
+        return;
+    }
+
+    const void* data = sqlite3_value_text16(aArgv[0]);
+    if (!data) {
+        sqlite3_result_null(context);
+        return;
+    }
+    // The size must be queried after the conversion to UTF-16
+    const int size = sqlite3_value_bytes16(aArgv[0]);
+    QString string(static_cast<const QChar*>(data), size / static_cast<int>(sizeof(QChar)));
+    DbConnection::makeStringLatinLow(&string);
+    sqlite3_result_text16(context,
+            string.constData(),
+            string.size() * static_cast<int>(sizeof(QChar)),
+            SQLITE_TRANSIENT);
+}
+
+#endif // __SQLITE3__
+
+#ifdef __SQLITE3__
+// Receives the resulting journal mode of "PRAGMA journal_mode"
+int sqliteJournalModeCallback(void* pJournalMode,
+        int numColumns,
+        char** columnValues,
+        char** /*columnNames*/) {
+    if (numColumns > 0 && columnValues[0]) {
+        *static_cast<QByteArray*>(pJournalMode) = columnValues[0];
+    }
+    return SQLITE_OK;
+}
 #endif // __SQLITE3__
 
 bool initDatabase(const QSqlDatabase& database, mixxx::StringCollator* pCollator) {
@@ -304,6 +344,45 @@ bool initDatabase(const QSqlDatabase& database, mixxx::StringCollator* pCollator
                 << "Failed to install custom 3-arg LIKE function for SQLite3:"
                 << result;
     }
+
+    result = sqlite3_create_function(
+            handle,
+            kLatinLowFunc,
+            1,
+            SQLITE_UTF16 | SQLITE_DETERMINISTIC,
+            nullptr,
+            sqliteLatinLowUtf16,
+            nullptr,
+            nullptr);
+    VERIFY_OR_DEBUG_ASSERT(result == SQLITE_OK) {
+        kLogger.warning()
+                << "Failed to install custom latin low function for SQLite3:"
+                << result;
+    }
+
+    // With a write-ahead log readers and the writer don't block each
+    // other and commits only need to append to the log. In this mode
+    // synchronous=NORMAL is still safe against corruption, only the
+    // most recent commits might get lost on power failure. The journal
+    // mode of in-memory databases remains unchanged.
+    QByteArray journalMode;
+    result = sqlite3_exec(handle,
+            "PRAGMA journal_mode=WAL",
+            sqliteJournalModeCallback,
+            &journalMode,
+            nullptr);
+    if (result != SQLITE_OK) {
+        kLogger.warning()
+                << "Failed to enable write-ahead logging for SQLite3:"
+                << result;
+    } else if (journalMode == "wal") {
+        result = sqlite3_exec(handle, "PRAGMA synchronous=NORMAL", nullptr, nullptr, nullptr);
+        if (result != SQLITE_OK) {
+            kLogger.warning()
+                    << "Failed to reduce synchronization for SQLite3:"
+                    << result;
+        }
+    }
 #else
     Q_UNUSED(database);
     Q_UNUSED(pCollator);
@@ -381,6 +460,15 @@ QString DbConnection::collateLexicographically(const QString& orderByQuery) {
 #endif //  __SQLITE3__
 }
 
+//static
+QString DbConnection::latinLow(const QString& expression) {
+#ifdef __SQLITE3__
+    return kLatinLowFunc + QStringLiteral("(") + expression + QStringLiteral(")");
+#else
+    return expression;
+#endif //  __SQLITE3__
+}
+
 //static
 int DbConnection::likeCompareLatinLow(
         QString* pattern,
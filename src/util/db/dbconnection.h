@@ -15,6 +15,12 @@ class DbConnection final {
     static QString collateLexicographically(
             const QString& orderByQuery);
 
+    // Fold accents and case of a string expression like
+    // makeStringLatinLow() with a custom function if available
+    // (SQLite3). Otherwise the expression is returned unmodified.
+    static QString latinLow(
+            const QString& expression);
+
     static int likeCompareLatinLow(
         QString* pattern,
         QString* string,
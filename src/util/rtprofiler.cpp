@@ -0,0 +1,359 @@
+#include "util/rtprofiler.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include "rigtorp/SPSCQueue.h"
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("RtProfiler");
+
+// Values below kSubBucketCount are recorded exactly, each following
+// power of two range is divided into kSubBucketHalfCount buckets.
+constexpr int kSubBucketBits = 6;
+constexpr qint64 kSubBucketCount = qint64{1} << kSubBucketBits;
+constexpr qint64 kSubBucketHalfCount = kSubBucketCount / 2;
+constexpr int kBucketCount =
+        kSubBucketCount + (63 - kSubBucketBits) * kSubBucketHalfCount;
+
+// Enough for the engine thread, the sound device callback threads and the
+// channel worker pool. Threads that start afterwards are not profiled.
+constexpr int kMaxThreads = 64;
+
+// ~340 callbacks per second at 2.9 ms latency with a few dozen stages each
+constexpr std::size_t kEventsPerThread = 1 << 15;
+
+// The latest events that are kept for the Chrome trace, ~24 MB
+constexpr std::size_t kMaxTraceEvents = 1 << 20;
+
+constexpr unsigned long kDrainIntervalMillis = 50;
+
+QMutex s_stageMutex;
+QStringList s_stageNames;
+
+QStringList stageNames() {
+    const auto locker = lockMutex(&s_stageMutex);
+    return s_stageNames;
+}
+
+QString stageName(const QStringList& stageNames, RtProfilerStage stage) {
+    if (stage < 0 || stage >= stageNames.size()) {
+        return QStringLiteral("Unknown stage %1").arg(stage);
+    }
+    return stageNames.at(stage);
+}
+
+QString jsonString(QString value) {
+    value.replace(QChar('\\'), QStringLiteral("\\\\"));
+    value.replace(QChar('"'), QStringLiteral("\\\""));
+    return QChar('"') + value + QChar('"');
+}
+
+QString formatMicros(double nanos) {
+    return QString::number(nanos / 1000.0, 'f', 3);
+}
+
+} // anonymous namespace
+
+RtProfilerHistogram::RtProfilerHistogram()
+        : m_counts(kBucketCount, 0),
+          m_count(0),
+          m_sum(0),
+          m_min(std::numeric_limits<qint64>::max()),
+          m_max(0) {
+}
+
+// static
+int RtProfilerHistogram::bucketIndex(qint64 value) {
+    if (value < kSubBucketCount) {
+        return static_cast<int>(std::max(value, qint64{0}));
+    }
+    // value >= kSubBucketCount, i.e. shift >= 1
+    const int shift = static_cast<int>(std::bit_width(static_cast<quint64>(value))) -
+            kSubBucketBits;
+    const qint64 subBucket = value >> shift;
+    DEBUG_ASSERT(subBucket >= kSubBucketHalfCount && subBucket < kSubBucketCount);
+    return static_cast<int>(kSubBucketCount + (shift - 1) * kSubBucketHalfCount +
+            (subBucket - kSubBucketHalfCount));
+}
+
+// static
+qint64 RtProfilerHistogram::lowestValueInBucket(int index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const qint64 offset = index - kSubBucketCount;
+    const int shift = static_cast<int>(offset / kSubBucketHalfCount) + 1;
+    const qint64 subBucket = offset % kSubBucketHalfCount + kSubBucketHalfCount;
+    return subBucket << shift;
+}
+
+void RtProfilerHistogram::record(qint64 value) {
+    ++m_counts[bucketIndex(value)];
+    ++m_count;
+    m_sum += value;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+}
+
+qint64 RtProfilerHistogram::valueAtPercentile(double percentile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    const qint64 targetCount = std::max(qint64{1},
+            static_cast<qint64>(std::ceil(
+                    std::clamp(percentile, 0.0, 100.0) / 100.0 * m_count)));
+    qint64 cumulativeCount = 0;
+    for (int index = 0; index < kBucketCount; ++index) {
+        cumulativeCount += m_counts[index];
+        if (cumulativeCount >= targetCount) {
+            if (index + 1 >= kBucketCount) {
+                return m_max;
+            }
+            return std::min(lowestValueInBucket(index + 1) - 1, m_max);
+        }
+    }
+    return m_max;
+}
+
+class RtProfiler::ThreadBuffer {
+  public:
+    ThreadBuffer()
+            : m_queue(kEventsPerThread) {
+    }
+
+    bool tryPush(const Event& event) {
+        return m_queue.try_push(event);
+    }
+
+    const Event* front() {
+        return m_queue.front();
+    }
+
+    void pop() {
+        m_queue.pop();
+    }
+
+  private:
+    rigtorp::SPSCQueue<Event> m_queue;
+};
+
+// static
+std::atomic<RtProfiler*> RtProfiler::s_pActive{nullptr};
+// static
+std::atomic<int> RtProfiler::s_generation{0};
+
+RtProfiler::RtProfiler(const QString& traceFilePath)
+        : m_traceFilePath(traceFilePath),
+          m_generation(s_generation.fetch_add(1) + 1),
+          m_claimedThreadBuffers(0),
+          m_droppedEvents(0),
+          m_quit(false),
+          m_startTicks(ticks()),
+          m_startTime(std::chrono::steady_clock::now()),
+          m_nanosPerTick(1.0),
+          m_traceEvents(kMaxTraceEvents),
+          m_nextTraceEvent(0),
+          m_traceEventsWrapped(false) {
+    setObjectName(QStringLiteral("RtProfiler"));
+    m_threadBuffers.reserve(kMaxThreads);
+    for (int i = 0; i < kMaxThreads; ++i) {
+        m_threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+    }
+    kLogger.info() << "Profiling the audio engine, the trace will be written to"
+                   << m_traceFilePath;
+    s_pActive.store(this, std::memory_order_release);
+    start(QThread::LowPriority);
+}
+
+RtProfiler::~RtProfiler() {
+    s_pActive.store(nullptr, std::memory_order_release);
+    m_quit.store(true);
+    wait();
+    drain();
+    logReport();
+    if (!m_traceFilePath.isEmpty()) {
+        writeChromeTrace(m_traceFilePath);
+    }
+}
+
+// static
+RtProfilerStage RtProfiler::registerStage(const QString& name) {
+    const auto locker = lockMutex(&s_stageMutex);
+    int stage = s_stageNames.indexOf(name);
+    if (stage < 0) {
+        stage = static_cast<int>(s_stageNames.size());
+        s_stageNames.append(name);
+    }
+    return stage;
+}
+
+void RtProfiler::pushEvent(const Event& event) {
+    // Each thread claims its own buffer once. The generation prevents
+    // reusing a buffer index of a previous profiler instance.
+    thread_local int t_generation = 0;
+    thread_local int t_threadIndex = -1;
+    if (t_generation != m_generation) {
+        t_generation = m_generation;
+        t_threadIndex = m_claimedThreadBuffers.fetch_add(1, std::memory_order_acq_rel);
+    }
+    if (t_threadIndex >= kMaxThreads ||
+            !m_threadBuffers[t_threadIndex]->tryPush(event)) {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RtProfiler::run() {
+    while (!m_quit.load()) {
+        QThread::msleep(kDrainIntervalMillis);
+        drain();
+    }
+}
+
+void RtProfiler::updateCalibration() {
+    const std::uint64_t elapsedTicks = ticks() - m_startTicks;
+    const auto elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_startTime)
+                                      .count();
+    if (elapsedTicks > 0 && elapsedNanos > 0) {
+        m_nanosPerTick = static_cast<double>(elapsedNanos) / elapsedTicks;
+    }
+}
+
+double RtProfiler::ticksToNanos(std::uint64_t ticks) const {
+    return static_cast<double>(ticks) * m_nanosPerTick;
+}
+
+void RtProfiler::drain() {
+    const auto locker = lockMutex(&m_mutex);
+    updateCalibration();
+    const int threadCount = std::min(
+            m_claimedThreadBuffers.load(std::memory_order_acquire), kMaxThreads);
+    for (int threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+        ThreadBuffer* pBuffer = m_threadBuffers[threadIndex].get();
+        while (const Event* pEvent = pBuffer->front()) {
+            const Event event = *pEvent;
+            pBuffer->pop();
+            if (event.stage < 0) {
+                continue;
+            }
+            if (!event.instant) {
+                if (static_cast<std::size_t>(event.stage) >= m_histograms.size()) {
+                    m_histograms.resize(event.stage + 1);
+                }
+                m_histograms[event.stage].record(static_cast<qint64>(
+                        ticksToNanos(event.endTicks - event.startTicks)));
+            }
+            m_traceEvents[m_nextTraceEvent] = TraceEvent{event, threadIndex};
+            if (++m_nextTraceEvent == m_traceEvents.size()) {
+                m_nextTraceEvent = 0;
+                m_traceEventsWrapped = true;
+            }
+        }
+    }
+}
+
+void RtProfiler::logReport() {
+    const auto locker = lockMutex(&m_mutex);
+    std::vector<RtProfilerStage> stages;
+    for (std::size_t stage = 0; stage < m_histograms.size(); ++stage) {
+        if (m_histograms[stage].count() > 0) {
+            stages.push_back(static_cast<RtProfilerStage>(stage));
+        }
+    }
+    // The stages with the worst case durations first, these are the
+    // candidates for buffer underflows
+    std::sort(stages.begin(), stages.end(), [this](auto lhs, auto rhs) {
+        return m_histograms[lhs].max() > m_histograms[rhs].max();
+    });
+    const QStringList names = stageNames();
+    kLogger.info() << "Durations of the audio engine stages in microseconds:";
+    for (const auto stage : stages) {
+        const RtProfilerHistogram& histogram = m_histograms[stage];
+        kLogger.info().noquote()
+                << stageName(names, stage)
+                << "count" << histogram.count()
+                << "mean" << formatMicros(histogram.mean())
+                << "p50" << formatMicros(histogram.valueAtPercentile(50))
+                << "p99" << formatMicros(histogram.valueAtPercentile(99))
+                << "p99.9" << formatMicros(histogram.valueAtPercentile(99.9))
+                << "max" << formatMicros(histogram.max());
+    }
+    const qint64 droppedEvents = m_droppedEvents.load();
+    if (droppedEvents > 0) {
+        kLogger.warning() << "Dropped" << droppedEvents << "events";
+    }
+}
+
+bool RtProfiler::writeChromeTrace(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        kLogger.warning() << "Failed to open" << filePath << file.errorString();
+        return false;
+    }
+    const auto locker = lockMutex(&m_mutex);
+    updateCalibration();
+
+    const QStringList names = stageNames();
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    const int threadCount = std::min(
+            m_claimedThreadBuffers.load(std::memory_order_acquire), kMaxThreads);
+    for (int threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+        if (!first) {
+            out << ',';
+        }
+        first = false;
+        out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << threadIndex << ",\"args\":{\"name\":"
+            << jsonString(QStringLiteral("Audio thread %1").arg(threadIndex))
+            << "}}";
+    }
+    // Oldest events first
+    const std::size_t beginIndex = m_traceEventsWrapped ? m_nextTraceEvent : 0;
+    const std::size_t eventCount =
+            m_traceEventsWrapped ? m_traceEvents.size() : m_nextTraceEvent;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        const TraceEvent& traceEvent =
+                m_traceEvents[(beginIndex + i) % m_traceEvents.size()];
+        const Event& event = traceEvent.event;
+        if (!first) {
+            out << ',';
+        }
+        first = false;
+        // Relative to the start of the profiler, which also keeps the
+        // values in the precise range of double
+        const double startNanos = ticksToNanos(event.startTicks - m_startTicks);
+        out << "\n{\"name\":" << jsonString(stageName(names, event.stage))
+            << ",\"cat\":\"engine\",\"pid\":1,\"tid\":" << traceEvent.threadIndex
+            << ",\"ts\":" << formatMicros(startNanos);
+        if (event.instant) {
+            out << ",\"ph\":\"i\",\"s\":\"g\"}";
+        } else {
+            out << ",\"ph\":\"X\",\"dur\":"
+                << formatMicros(ticksToNanos(event.endTicks - event.startTicks))
+                << '}';
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    if (file.error() != QFileDevice::NoError) {
+        kLogger.warning() << "Failed to write" << filePath << file.errorString();
+        return false;
+    }
+    kLogger.info() << "Wrote" << eventCount << "events to" << filePath;
+    return true;
+}
+
+} // namespace mixxx
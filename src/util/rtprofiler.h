@@ -0,0 +1,200 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "util/singleton.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace mixxx {
+
+/// Identifies a named stage of the audio processing, see
+/// RtProfiler::registerStage().
+typedef int RtProfilerStage;
+
+/// A histogram of durations in nanoseconds, similar to HdrHistogram.
+/// The buckets grow exponentially and are linearly subdivided, so values
+/// are recorded with a relative precision of about 3% over the whole range
+/// at a fixed size.
+class RtProfilerHistogram {
+  public:
+    RtProfilerHistogram();
+
+    void record(qint64 value);
+
+    qint64 count() const {
+        return m_count;
+    }
+    qint64 min() const {
+        return m_count > 0 ? m_min : 0;
+    }
+    qint64 max() const {
+        return m_max;
+    }
+    double mean() const {
+        return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0;
+    }
+
+    /// Returns the highest value that is equivalent to the value at the
+    /// given percentile in the range [0, 100], i.e. an upper bound.
+    qint64 valueAtPercentile(double percentile) const;
+
+  private:
+    static int bucketIndex(qint64 value);
+    static qint64 lowestValueInBucket(int index);
+
+    std::vector<qint64> m_counts;
+    qint64 m_count;
+    qint64 m_sum;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+/// An allocation-free profiler for the real-time threads of the audio
+/// engine, enabled by the --engine-profile-path command line option.
+///
+/// The audio threads push the raw timestamps of RtProfilerScope into a
+/// fixed-size ring buffer per thread. A low priority background thread
+/// drains these buffers into a histogram per stage and keeps the most
+/// recent events for the export as a Chrome trace, which can be opened
+/// with chrome://tracing or https://ui.perfetto.dev. The histograms are
+/// logged and the trace is written when the profiler is destroyed.
+///
+/// The profiler must only be created and destroyed while no audio
+/// threads are running.
+class RtProfiler : public QThread, public Singleton<RtProfiler> {
+  public:
+    explicit RtProfiler(const QString& traceFilePath);
+    ~RtProfiler() override;
+
+    /// Returns the stage with the given name, registering it if needed.
+    /// Stages may be registered at any time, even if the profiler is not
+    /// enabled, but not from a real-time thread.
+    static RtProfilerStage registerStage(const QString& name);
+
+    static bool isActive() {
+        return s_pActive.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    /// A monotonic timestamp in the native unit of the CPU, e.g. the TSC
+    /// on x86. The ticks are calibrated against std::chrono::steady_clock
+    /// by the background thread.
+    static std::uint64_t ticks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        std::uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+    }
+
+    /// Called from the real-time threads. Never allocates or blocks,
+    /// events are dropped if the ring buffer of the thread is full.
+    static void record(RtProfilerStage stage,
+            std::uint64_t startTicks,
+            std::uint64_t endTicks) {
+        RtProfiler* pProfiler = s_pActive.load(std::memory_order_acquire);
+        if (pProfiler) {
+            pProfiler->pushEvent(Event{startTicks, endTicks, stage, false});
+        }
+    }
+
+    /// Records a point in time, e.g. a buffer underflow
+    static void recordInstant(RtProfilerStage stage) {
+        RtProfiler* pProfiler = s_pActive.load(std::memory_order_acquire);
+        if (pProfiler) {
+            const std::uint64_t now = ticks();
+            pProfiler->pushEvent(Event{now, now, stage, true});
+        }
+    }
+
+    /// Writes the events that are still buffered as a Chrome trace (JSON)
+    bool writeChromeTrace(const QString& filePath);
+
+  protected:
+    void run() override;
+
+  private:
+    struct Event {
+        std::uint64_t startTicks;
+        std::uint64_t endTicks;
+        RtProfilerStage stage;
+        bool instant;
+    };
+
+    struct TraceEvent {
+        Event event;
+        int threadIndex;
+    };
+
+    class ThreadBuffer;
+
+    void pushEvent(const Event& event);
+    void drain();
+    void updateCalibration();
+    double ticksToNanos(std::uint64_t ticks) const;
+    void logReport();
+
+    static std::atomic<RtProfiler*> s_pActive;
+    static std::atomic<int> s_generation;
+
+    const QString m_traceFilePath;
+    const int m_generation;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+    std::atomic<int> m_claimedThreadBuffers;
+    std::atomic<qint64> m_droppedEvents;
+    std::atomic<bool> m_quit;
+
+    const std::uint64_t m_startTicks;
+    const std::chrono::steady_clock::time_point m_startTime;
+
+    // Guards all members below that are owned by the background thread
+    QMutex m_mutex;
+    double m_nanosPerTick;
+    std::vector<RtProfilerHistogram> m_histograms;
+    std::vector<TraceEvent> m_traceEvents;
+    std::size_t m_nextTraceEvent;
+    bool m_traceEventsWrapped;
+};
+
+/// Measures the duration of the enclosing scope as the given stage if the
+/// RtProfiler is enabled. Otherwise it costs a single relaxed atomic load.
+class RtProfilerScope {
+  public:
+    explicit RtProfilerScope(RtProfilerStage stage)
+            : m_stage(stage),
+              m_startTicks(RtProfiler::isActive() ? RtProfiler::ticks() : 0) {
+    }
+    ~RtProfilerScope() {
+        if (m_startTicks != 0) {
+            RtProfiler::record(m_stage, m_startTicks, RtProfiler::ticks());
+        }
+    }
+
+    RtProfilerScope(const RtProfilerScope&) = delete;
+    RtProfilerScope& operator=(const RtProfilerScope&) = delete;
+
+  private:
+    const RtProfilerStage m_stage;
+    const std::uint64_t m_startTicks;
+};
+
+} // namespace mixxx
@@ -1,10 +1,17 @@
 #include "util/sample.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdlib>
 
 #include "engine/engine.h"
 #include "util/math.h"
+#include "util/samplekernels.h"
+
+#if defined(_MSC_VER) && \
+        (defined(MIXXX_SAMPLEUTIL_AVX2) || defined(MIXXX_SAMPLEUTIL_AVX512))
+#include <intrin.h>
+#endif
 
 #ifdef __WINDOWS__
 #include <QtGlobal>
@@ -110,6 +117,291 @@ void SampleUtil::free(CSAMPLE* pBuffer) {
     }
 }
 
+namespace {
+
+// The scalar kernels are the reference for all other variants, see
+// util/samplekernels.h. They rely on auto-vectorization.
+
+void applyGainScalar(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void applyRampingGainScalar(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        // a loop counter i += 2 prevents vectorizing.
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+void addWithGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+void addWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+void add2WithGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (int i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGainScalar(CSAMPLE* pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* M_RESTRICT pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+void copyWithGainScalar(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+void copyWithRampingGainScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED only with "int i" (not SINT i).
+    for (int i = 0; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] = pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
+    }
+}
+
+int sumAbsPerChannelScalar(CSAMPLE* pSumAbsLeft,
+        CSAMPLE* pSumAbsRight,
+        const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        // Replacing the code with a bool clipped will prevent vetorizing
+        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
+    }
+
+    *pSumAbsLeft = fAbsL;
+    *pSumAbsRight = fAbsR;
+    int clipping = 0;
+    if (clippedL > 0) {
+        clipping |= mixxx::sampleutil::kClippingLeft;
+    }
+    if (clippedR > 0) {
+        clipping |= mixxx::sampleutil::kClippingRight;
+    }
+    return clipping;
+}
+
+CSAMPLE maxAbsScalar(const CSAMPLE* pBuffer, SINT numSamples) {
+    CSAMPLE max = CSAMPLE_ZERO;
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numSamples; ++i) {
+        CSAMPLE absValue = abs(pBuffer[i]);
+        if (absValue > max) {
+            max = absValue;
+        }
+    }
+    return max;
+}
+
+void interleaveStereoScalar(CSAMPLE* M_RESTRICT pDest,
+        const CSAMPLE* M_RESTRICT pSrc1,
+        const CSAMPLE* M_RESTRICT pSrc2,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveStereoScalar(CSAMPLE* M_RESTRICT pDest1,
+        CSAMPLE* M_RESTRICT pDest2,
+        const CSAMPLE* M_RESTRICT pSrc,
+        SINT numFrames) {
+    // note: LOOP VECTORIZED.
+    for (SINT i = 0; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+constexpr mixxx::sampleutil::Kernels kScalarKernels = {
+        mixxx::sampleutil::InstructionSet::Scalar,
+        "Scalar",
+        applyGainScalar,
+        applyRampingGainScalar,
+        addWithGainScalar,
+        addWithRampingGainScalar,
+        add2WithGainScalar,
+        add3WithGainScalar,
+        copyWithGainScalar,
+        copyWithRampingGainScalar,
+        sumAbsPerChannelScalar,
+        maxAbsScalar,
+        interleaveStereoScalar,
+        deinterleaveStereoScalar,
+};
+
+#if defined(MIXXX_SAMPLEUTIL_AVX2) || defined(MIXXX_SAMPLEUTIL_AVX512)
+#if defined(_MSC_VER)
+// Checks the CPUID feature bits and if the operating system saves the
+// state of the extended registers, see the Intel SDM Vol. 1, 14.3.
+bool cpuSupportsAvx(int leaf7EbxBits, unsigned long long xcr0Bits) {
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    constexpr int kFma = 1 << 12;
+    constexpr int kOsxsave = 1 << 27;
+    if ((info[2] & (kFma | kOsxsave)) != (kFma | kOsxsave)) {
+        return false;
+    }
+    if ((_xgetbv(0) & xcr0Bits) != xcr0Bits) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & leaf7EbxBits) == leaf7EbxBits;
+}
+#endif
+#endif
+
+#ifdef MIXXX_SAMPLEUTIL_AVX2
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    // AVX2 and the XMM/YMM register state
+    return cpuSupportsAvx(1 << 5, 0x6);
+#else
+    // Required when called before the constructors of libgcc have run
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+#ifdef MIXXX_SAMPLEUTIL_AVX512
+bool cpuSupportsAvx512() {
+#if defined(_MSC_VER)
+    // AVX512F and the XMM/YMM/ZMM/opmask register state
+    return cpuSupportsAvx(1 << 16, 0xE6);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+#endif
+
+// Constant initialized, i.e. valid even when SampleUtil is used by
+// other static initializers before the best variant has been selected.
+std::atomic<const mixxx::sampleutil::Kernels*> s_pKernels{&kScalarKernels};
+
+[[maybe_unused]] const bool s_kernelsSelected = []() {
+    s_pKernels.store(mixxx::sampleutil::supportedKernels().back(),
+            std::memory_order_relaxed);
+    return true;
+}();
+
+inline const mixxx::sampleutil::Kernels& kernels() {
+    return *s_pKernels.load(std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+namespace mixxx {
+
+namespace sampleutil {
+
+const Kernels& scalarKernels() {
+    return kScalarKernels;
+}
+
+std::vector<const Kernels*> supportedKernels() {
+    std::vector<const Kernels*> kernels{&kScalarKernels};
+#ifdef MIXXX_SAMPLEUTIL_NEON
+    // NEON is mandatory on AArch64
+    kernels.push_back(&neonKernels());
+#endif
+#ifdef MIXXX_SAMPLEUTIL_AVX2
+    if (cpuSupportsAvx2()) {
+        kernels.push_back(&avx2Kernels());
+    }
+#endif
+#ifdef MIXXX_SAMPLEUTIL_AVX512
+    if (cpuSupportsAvx512()) {
+        kernels.push_back(&avx512Kernels());
+    }
+#endif
+    return kernels;
+}
+
+const Kernels& activeKernels() {
+    return kernels();
+}
+
+void setActiveKernels(const Kernels& kernels) {
+    s_pKernels.store(&kernels, std::memory_order_relaxed);
+}
+
+} // namespace sampleutil
+
+} // namespace mixxx
+
 // static
 void SampleUtil::applyGain(CSAMPLE* pBuffer, CSAMPLE_GAIN gain,
         SINT numSamples) {
@@ -121,10 +413,7 @@ void SampleUtil::applyGain(CSAMPLE* pBuffer, CSAMPLE_GAIN gain,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pBuffer[i] *= gain;
-    }
+    kernels().applyGain(pBuffer, gain, numSamples);
 }
 
 // static
@@ -142,18 +431,9 @@ void SampleUtil::applyRampingGain(CSAMPLE* pBuffer, CSAMPLE_GAIN old_gain,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            // a loop counter i += 2 prevents vectorizing.
-            pBuffer[i * 2] *= gain;
-            pBuffer[i * 2 + 1] *= gain;
-        }
+        kernels().applyRampingGain(pBuffer, start_gain, gain_delta, numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pBuffer[i] *= old_gain;
-        }
+        kernels().applyGain(pBuffer, old_gain, numSamples);
     }
 }
 
@@ -249,10 +529,7 @@ void SampleUtil::addWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc[i] * gain;
-    }
+    kernels().addWithGain(pDest, pSrc, gain, numSamples);
 }
 
 void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
@@ -267,17 +544,9 @@ void SampleUtil::addWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] += pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
-        }
+        kernels().addWithRampingGain(pDest, pSrc, start_gain, gain_delta, numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (int i = 0; i < numSamples; ++i) {
-            pDest[i] += pSrc[i] * old_gain;
-        }
+        kernels().addWithGain(pDest, pSrc, old_gain, numSamples);
     }
 }
 
@@ -294,10 +563,7 @@ void SampleUtil::add2WithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
-    }
+    kernels().add2WithGain(pDest, pSrc1, gain1, pSrc2, gain2, numSamples);
 }
 
 // static
@@ -317,10 +583,7 @@ void SampleUtil::add3WithGain(CSAMPLE* pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
-    }
+    kernels().add3WithGain(pDest, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, numSamples);
 }
 
 // static
@@ -336,10 +599,7 @@ void SampleUtil::copyWithGain(CSAMPLE* M_RESTRICT pDest,
         return;
     }
 
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples; ++i) {
-        pDest[i] = pSrc[i] * gain;
-    }
+    kernels().copyWithGain(pDest, pSrc, gain, numSamples);
 
     // OR! need to test which fares better
     // copy(pDest, pSrc, iNumSamples);
@@ -365,17 +625,9 @@ void SampleUtil::copyWithRampingGain(CSAMPLE* M_RESTRICT pDest,
             / CSAMPLE_GAIN(numSamples / 2);
     if (gain_delta != 0) {
         const CSAMPLE_GAIN start_gain = old_gain + gain_delta;
-        // note: LOOP VECTORIZED only with "int i" (not SINT i).
-        for (int i = 0; i < numSamples / 2; ++i) {
-            const CSAMPLE_GAIN gain = start_gain + gain_delta * i;
-            pDest[i * 2] = pSrc[i * 2] * gain;
-            pDest[i * 2 + 1] = pSrc[i * 2 + 1] * gain;
-        }
+        kernels().copyWithRampingGain(pDest, pSrc, start_gain, gain_delta, numSamples / 2);
     } else {
-        // note: LOOP VECTORIZED.
-        for (SINT i = 0; i < numSamples; ++i) {
-            pDest[i] = pSrc[i] * old_gain;
-        }
+        kernels().copyWithGain(pDest, pSrc, old_gain, numSamples);
     }
 
     // OR! need to test which fares better
@@ -415,32 +667,10 @@ void SampleUtil::convertFloat32ToS16(SAMPLE* pDest, const CSAMPLE* pSrc,
 // static
 SampleUtil::CLIP_STATUS SampleUtil::sumAbsPerChannel(CSAMPLE* pfAbsL,
         CSAMPLE* pfAbsR, const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE fAbsL = CSAMPLE_ZERO;
-    CSAMPLE fAbsR = CSAMPLE_ZERO;
-    CSAMPLE clippedL = 0;
-    CSAMPLE clippedR = 0;
-
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numSamples / 2; ++i) {
-        CSAMPLE absl = fabs(pBuffer[i * 2]);
-        fAbsL += absl;
-        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
-        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
-        fAbsR += absr;
-        // Replacing the code with a bool clipped will prevent vetorizing
-        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
-    }
-
-    *pfAbsL = fAbsL;
-    *pfAbsR = fAbsR;
-    SampleUtil::CLIP_STATUS clipping = SampleUtil::NO_CLIPPING;
-    if (clippedL > 0) {
-        clipping |= SampleUtil::CLIPPING_LEFT;
-    }
-    if (clippedR > 0) {
-        clipping |= SampleUtil::CLIPPING_RIGHT;
-    }
-    return clipping;
+    static_assert(mixxx::sampleutil::kClippingLeft == SampleUtil::CLIPPING_LEFT);
+    static_assert(mixxx::sampleutil::kClippingRight == SampleUtil::CLIPPING_RIGHT);
+    return SampleUtil::CLIP_STATUS(QFlag(
+            kernels().sumAbsPerChannel(pfAbsL, pfAbsR, pBuffer, numSamples / 2)));
 }
 
 // static
@@ -461,15 +691,11 @@ CSAMPLE SampleUtil::rms(const CSAMPLE* pBuffer, SINT numSamples) {
 }
 
 CSAMPLE SampleUtil::maxAbsAmplitude(const CSAMPLE* pBuffer, SINT numSamples) {
-    CSAMPLE max = pBuffer[0];
-    // note: LOOP VECTORIZED.
-    for (SINT i = 1; i < numSamples; ++i) {
-        CSAMPLE absValue = abs(pBuffer[i]);
-        if (absValue > max) {
-            max = absValue;
-        }
+    // The first sample is not made absolute for compatibility
+    if (numSamples <= 1) {
+        return pBuffer[0];
     }
-    return max;
+    return math_max(pBuffer[0], kernels().maxAbs(pBuffer + 1, numSamples - 1));
 }
 
 // static
@@ -486,11 +712,7 @@ void SampleUtil::interleaveBuffer(CSAMPLE* M_RESTRICT pDest,
         const CSAMPLE* M_RESTRICT pSrc1,
         const CSAMPLE* M_RESTRICT pSrc2,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest[2 * i] = pSrc1[i];
-        pDest[2 * i + 1] = pSrc2[i];
-    }
+    kernels().interleaveStereo(pDest, pSrc1, pSrc2, numFrames);
 }
 
 // static
@@ -522,11 +744,7 @@ void SampleUtil::deinterleaveBuffer(CSAMPLE* M_RESTRICT pDest1,
         CSAMPLE* M_RESTRICT pDest2,
         const CSAMPLE* M_RESTRICT pSrc,
         SINT numFrames) {
-    // note: LOOP VECTORIZED.
-    for (SINT i = 0; i < numFrames; ++i) {
-        pDest1[i] = pSrc[i * 2];
-        pDest2[i] = pSrc[i * 2 + 1];
-    }
+    kernels().deinterleaveStereo(pDest1, pDest2, pSrc, numFrames);
 }
 
 // static
@@ -896,6 +1114,18 @@ void SampleUtil::copyOneStereoFromMulti(
     }
 }
 
+// static
+void SampleUtil::copyMultiToStereoPlanes(CSAMPLE* const* ppDest,
+        const CSAMPLE* pSrc,
+        SINT numFrames,
+        mixxx::audio::ChannelCount numChannels) {
+    DEBUG_ASSERT(numChannels > mixxx::audio::ChannelCount::stereo() &&
+            numChannels % mixxx::audio::ChannelCount::stereo() == 0);
+    for (int plane = 0; plane < numChannels / 2; ++plane) {
+        copyOneStereoFromMulti(ppDest[plane], pSrc, numFrames, numChannels, plane * 2);
+    }
+}
+
 // static
 void SampleUtil::insertStereoToMulti(
         CSAMPLE* M_RESTRICT pDest,
@@ -391,6 +391,17 @@ class SampleUtil {
             mixxx::audio::ChannelCount numChannels,
             int sourceChannel = 0);
 
+    // Copies each stereo pair of the interleaved multi-channel samples in
+    // pSrc into its own stereo buffer (planar layout), e.g. with 4 stereo
+    // channels:
+    //   1L1R2L2R3L3R4L4R -> 1L1R... 2L2R... 3L3R... 4L4R...
+    // ppDest must point to (numChannels / 2) buffers with space for
+    // (numFrames * 2) samples each, none of them can be an alias of pSrc.
+    static void copyMultiToStereoPlanes(CSAMPLE* const* ppDest,
+            const CSAMPLE* pSrc,
+            SINT numFrames,
+            mixxx::audio::ChannelCount numChannels);
+
     // Copies and strips interleaved stereo sample data in pSrc with
     // down to multi-channel samples into pDest. Samples will be written at the
     // channel pointed by channelOffset. Samples from all other channels will be
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+
+#include "util/types.h"
+
+// The inner loops of SampleUtil in variants for different instruction sets.
+//
+// Each variant lives in its own translation unit that is compiled with the
+// corresponding compiler flags. The best variant that is supported by the
+// CPU is selected once at startup and SampleUtil calls it through a table
+// of function pointers. The scalar variant is always available and serves
+// as the reference implementation.
+//
+// The kernels don't check for special gain values, this is done by the
+// SampleUtil functions before calling them.
+//
+// NOTE: The translation units of the SIMD variants must not include any
+// headers with inline functions that are also used elsewhere. The linker
+// might otherwise pick the copy that has been compiled with the extended
+// instruction set for the whole program.
+namespace mixxx {
+
+namespace sampleutil {
+
+enum class InstructionSet {
+    Scalar,
+    Avx2,
+    Avx512,
+    Neon,
+};
+
+// Bits of the value that is returned by sumAbsPerChannel(), identical
+// to SampleUtil::CLIP_FLAG
+constexpr int kClippingLeft = 1;
+constexpr int kClippingRight = 2;
+
+struct Kernels {
+    InstructionSet instructionSet;
+    const char* name;
+
+    void (*applyGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN gain,
+            SINT numSamples);
+    // Multiplies interleaved stereo frame i by startGain + gainDelta * i
+    void (*applyRampingGain)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    void (*addWithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain,
+            SINT numSamples);
+    void (*addWithRampingGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    void (*add2WithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1,
+            CSAMPLE_GAIN gain1,
+            const CSAMPLE* pSrc2,
+            CSAMPLE_GAIN gain2,
+            SINT numSamples);
+    void (*add3WithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1,
+            CSAMPLE_GAIN gain1,
+            const CSAMPLE* pSrc2,
+            CSAMPLE_GAIN gain2,
+            const CSAMPLE* pSrc3,
+            CSAMPLE_GAIN gain3,
+            SINT numSamples);
+    // pDest may be identical to pSrc
+    void (*copyWithGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN gain,
+            SINT numSamples);
+    void (*copyWithRampingGain)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain,
+            CSAMPLE_GAIN gainDelta,
+            SINT numFrames);
+    // Returns a combination of kClippingLeft and kClippingRight
+    int (*sumAbsPerChannel)(CSAMPLE* pSumAbsLeft,
+            CSAMPLE* pSumAbsRight,
+            const CSAMPLE* pBuffer,
+            SINT numFrames);
+    // Returns 0 if numSamples is 0
+    CSAMPLE (*maxAbs)(const CSAMPLE* pBuffer,
+            SINT numSamples);
+    void (*interleaveStereo)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1,
+            const CSAMPLE* pSrc2,
+            SINT numFrames);
+    void (*deinterleaveStereo)(CSAMPLE* pDest1,
+            CSAMPLE* pDest2,
+            const CSAMPLE* pSrc,
+            SINT numFrames);
+};
+
+const Kernels& scalarKernels();
+#ifdef MIXXX_SAMPLEUTIL_AVX2
+const Kernels& avx2Kernels();
+#endif
+#ifdef MIXXX_SAMPLEUTIL_AVX512
+const Kernels& avx512Kernels();
+#endif
+#ifdef MIXXX_SAMPLEUTIL_NEON
+const Kernels& neonKernels();
+#endif
+
+// All variants that are available in this build and supported by the
+// CPU, starting with the scalar reference and ending with the variant
+// that is selected at startup.
+std::vector<const Kernels*> supportedKernels();
+
+// The variant that is currently used by SampleUtil
+const Kernels& activeKernels();
+
+// Replaces the variant that has been selected at startup. Only intended
+// for tests and benchmarks.
+void setActiveKernels(const Kernels& kernels);
+
+} // namespace sampleutil
+
+} // namespace mixxx
@@ -0,0 +1,309 @@
+// Compiled with AVX2 and FMA enabled, see util/samplekernels.h
+#include <immintrin.h>
+
+#include "util/samplekernels.h"
+
+namespace {
+
+// The number of samples in a vector
+constexpr SINT kLanes = 8;
+// The number of interleaved stereo frames in a vector
+constexpr SINT kStereoFrames = kLanes / 2;
+
+inline __m256 abs256(__m256 values) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), values);
+}
+
+// The gains of 4 consecutive stereo frames starting at firstFrame
+inline __m256 rampingGain256(
+        __m256 startGain, __m256 gainDelta, SINT firstFrame) {
+    const __m256 frameIndices = _mm256_add_ps(
+            _mm256_set1_ps(static_cast<float>(firstFrame)),
+            _mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3));
+    return _mm256_add_ps(startGain, _mm256_mul_ps(gainDelta, frameIndices));
+}
+
+void applyGainAvx2(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    const __m256 gains = _mm256_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm256_storeu_ps(pBuffer + i,
+                _mm256_mul_ps(_mm256_loadu_ps(pBuffer + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void applyRampingGainAvx2(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 startGains = _mm256_set1_ps(startGain);
+    const __m256 gainDeltas = _mm256_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m256 gains = rampingGain256(startGains, gainDeltas, frame);
+        CSAMPLE* pSamples = pBuffer + frame * 2;
+        _mm256_storeu_ps(pSamples, _mm256_mul_ps(_mm256_loadu_ps(pSamples), gains));
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pBuffer[frame * 2] *= gain;
+        pBuffer[frame * 2 + 1] *= gain;
+    }
+}
+
+void addWithGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    const __m256 gains = _mm256_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm256_storeu_ps(pDest + i,
+                _mm256_fmadd_ps(_mm256_loadu_ps(pSrc + i),
+                        gains,
+                        _mm256_loadu_ps(pDest + i)));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+void addWithRampingGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 startGains = _mm256_set1_ps(startGain);
+    const __m256 gainDeltas = _mm256_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m256 gains = rampingGain256(startGains, gainDeltas, frame);
+        const SINT i = frame * 2;
+        _mm256_storeu_ps(pDest + i,
+                _mm256_fmadd_ps(_mm256_loadu_ps(pSrc + i),
+                        gains,
+                        _mm256_loadu_ps(pDest + i)));
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pDest[frame * 2] += pSrc[frame * 2] * gain;
+        pDest[frame * 2 + 1] += pSrc[frame * 2 + 1] * gain;
+    }
+}
+
+void add2WithGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    const __m256 gains1 = _mm256_set1_ps(gain1);
+    const __m256 gains2 = _mm256_set1_ps(gain2);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        __m256 sum = _mm256_loadu_ps(pDest + i);
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(pSrc1 + i), gains1, sum);
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(pSrc2 + i), gains2, sum);
+        _mm256_storeu_ps(pDest + i, sum);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    const __m256 gains1 = _mm256_set1_ps(gain1);
+    const __m256 gains2 = _mm256_set1_ps(gain2);
+    const __m256 gains3 = _mm256_set1_ps(gain3);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        __m256 sum = _mm256_loadu_ps(pDest + i);
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(pSrc1 + i), gains1, sum);
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(pSrc2 + i), gains2, sum);
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(pSrc3 + i), gains3, sum);
+        _mm256_storeu_ps(pDest + i, sum);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+void copyWithGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    const __m256 gains = _mm256_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm256_storeu_ps(pDest + i,
+                _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), gains));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+void copyWithRampingGainAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m256 startGains = _mm256_set1_ps(startGain);
+    const __m256 gainDeltas = _mm256_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m256 gains = rampingGain256(startGains, gainDeltas, frame);
+        const SINT i = frame * 2;
+        _mm256_storeu_ps(pDest + i, _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), gains));
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pDest[frame * 2] = pSrc[frame * 2] * gain;
+        pDest[frame * 2 + 1] = pSrc[frame * 2 + 1] * gain;
+    }
+}
+
+int sumAbsPerChannelAvx2(CSAMPLE* pSumAbsLeft,
+        CSAMPLE* pSumAbsRight,
+        const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    const __m256 peak = _mm256_set1_ps(CSAMPLE_PEAK);
+    // Even lanes accumulate the left and odd lanes the right channel
+    __m256 sums = _mm256_setzero_ps();
+    __m256 clipped = _mm256_setzero_ps();
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m256 absValues = abs256(_mm256_loadu_ps(pBuffer + frame * 2));
+        sums = _mm256_add_ps(sums, absValues);
+        clipped = _mm256_or_ps(clipped, _mm256_cmp_ps(absValues, peak, _CMP_GT_OQ));
+    }
+    alignas(32) float lanes[kLanes];
+    _mm256_store_ps(lanes, sums);
+    CSAMPLE sumAbsLeft = lanes[0] + lanes[2] + lanes[4] + lanes[6];
+    CSAMPLE sumAbsRight = lanes[1] + lanes[3] + lanes[5] + lanes[7];
+    // One bit per lane, even bits for the left and odd bits for the right channel
+    const int clippedMask = _mm256_movemask_ps(clipped);
+    bool clippedLeft = (clippedMask & 0x55) != 0;
+    bool clippedRight = (clippedMask & 0xAA) != 0;
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE absLeft = pBuffer[frame * 2] < 0 ? -pBuffer[frame * 2] : pBuffer[frame * 2];
+        const CSAMPLE absRight = pBuffer[frame * 2 + 1] < 0
+                ? -pBuffer[frame * 2 + 1]
+                : pBuffer[frame * 2 + 1];
+        sumAbsLeft += absLeft;
+        sumAbsRight += absRight;
+        clippedLeft |= absLeft > CSAMPLE_PEAK;
+        clippedRight |= absRight > CSAMPLE_PEAK;
+    }
+    *pSumAbsLeft = sumAbsLeft;
+    *pSumAbsRight = sumAbsRight;
+    return (clippedLeft ? mixxx::sampleutil::kClippingLeft : 0) |
+            (clippedRight ? mixxx::sampleutil::kClippingRight : 0);
+}
+
+CSAMPLE maxAbsAvx2(const CSAMPLE* pBuffer, SINT numSamples) {
+    __m256 maxValues = _mm256_setzero_ps();
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        maxValues = _mm256_max_ps(maxValues, abs256(_mm256_loadu_ps(pBuffer + i)));
+    }
+    alignas(32) float lanes[kLanes];
+    _mm256_store_ps(lanes, maxValues);
+    CSAMPLE max = CSAMPLE_ZERO;
+    for (const float lane : lanes) {
+        max = lane > max ? lane : max;
+    }
+    for (; i < numSamples; ++i) {
+        const CSAMPLE absValue = pBuffer[i] < 0 ? -pBuffer[i] : pBuffer[i];
+        max = absValue > max ? absValue : max;
+    }
+    return max;
+}
+
+void interleaveStereoAvx2(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        const CSAMPLE* pSrc2,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        const __m256 left = _mm256_loadu_ps(pSrc1 + i);
+        const __m256 right = _mm256_loadu_ps(pSrc2 + i);
+        // l0 r0 l1 r1 | l4 r4 l5 r5
+        const __m256 low = _mm256_unpacklo_ps(left, right);
+        // l2 r2 l3 r3 | l6 r6 l7 r7
+        const __m256 high = _mm256_unpackhi_ps(left, right);
+        _mm256_storeu_ps(pDest + 2 * i, _mm256_permute2f128_ps(low, high, 0x20));
+        _mm256_storeu_ps(pDest + 2 * i + kLanes, _mm256_permute2f128_ps(low, high, 0x31));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveStereoAvx2(CSAMPLE* pDest1,
+        CSAMPLE* pDest2,
+        const CSAMPLE* pSrc,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        const __m256 first = _mm256_loadu_ps(pSrc + 2 * i);
+        const __m256 second = _mm256_loadu_ps(pSrc + 2 * i + kLanes);
+        // l0 l1 l4 l5 | l2 l3 l6 l7
+        const __m256 left = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+        // r0 r1 r4 r5 | r2 r3 r6 r7
+        const __m256 right = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+        // Restore the order of the 64-bit pairs
+        _mm256_storeu_ps(pDest1 + i,
+                _mm256_castpd_ps(_mm256_permute4x64_pd(
+                        _mm256_castps_pd(left), _MM_SHUFFLE(3, 1, 2, 0))));
+        _mm256_storeu_ps(pDest2 + i,
+                _mm256_castpd_ps(_mm256_permute4x64_pd(
+                        _mm256_castps_pd(right), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+    for (; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+constexpr mixxx::sampleutil::Kernels kAvx2Kernels = {
+        mixxx::sampleutil::InstructionSet::Avx2,
+        "AVX2",
+        applyGainAvx2,
+        applyRampingGainAvx2,
+        addWithGainAvx2,
+        addWithRampingGainAvx2,
+        add2WithGainAvx2,
+        add3WithGainAvx2,
+        copyWithGainAvx2,
+        copyWithRampingGainAvx2,
+        sumAbsPerChannelAvx2,
+        maxAbsAvx2,
+        interleaveStereoAvx2,
+        deinterleaveStereoAvx2,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+namespace sampleutil {
+
+const Kernels& avx2Kernels() {
+    return kAvx2Kernels;
+}
+
+} // namespace sampleutil
+
+} // namespace mixxx
@@ -0,0 +1,314 @@
+// Compiled with AVX-512F enabled, see util/samplekernels.h
+#include <immintrin.h>
+
+#include "util/samplekernels.h"
+
+namespace {
+
+// The number of samples in a vector
+constexpr SINT kLanes = 16;
+// The number of interleaved stereo frames in a vector
+constexpr SINT kStereoFrames = kLanes / 2;
+
+// Masks the lanes of the left and right channel of interleaved stereo frames
+constexpr __mmask16 kLeftLanes = 0x5555;
+constexpr __mmask16 kRightLanes = 0xAAAA;
+
+// Masks the first numSamples lanes for processing the remaining samples
+inline __mmask16 tailMask(SINT numSamples) {
+    return static_cast<__mmask16>((1u << numSamples) - 1);
+}
+
+// The gains of 8 consecutive stereo frames starting at firstFrame
+inline __m512 rampingGain512(
+        __m512 startGain, __m512 gainDelta, SINT firstFrame) {
+    const __m512 frameIndices = _mm512_add_ps(
+            _mm512_set1_ps(static_cast<float>(firstFrame)),
+            _mm512_setr_ps(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7));
+    return _mm512_add_ps(startGain, _mm512_mul_ps(gainDelta, frameIndices));
+}
+
+void applyGainAvx512(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    const __m512 gains = _mm512_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm512_storeu_ps(pBuffer + i,
+                _mm512_mul_ps(_mm512_loadu_ps(pBuffer + i), gains));
+    }
+    if (i < numSamples) {
+        const __mmask16 mask = tailMask(numSamples - i);
+        _mm512_mask_storeu_ps(pBuffer + i,
+                mask,
+                _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pBuffer + i), gains));
+    }
+}
+
+void applyRampingGainAvx512(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m512 startGains = _mm512_set1_ps(startGain);
+    const __m512 gainDeltas = _mm512_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        CSAMPLE* pSamples = pBuffer + frame * 2;
+        _mm512_storeu_ps(pSamples, _mm512_mul_ps(_mm512_loadu_ps(pSamples), gains));
+    }
+    if (frame < numFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        const __mmask16 mask = tailMask((numFrames - frame) * 2);
+        CSAMPLE* pSamples = pBuffer + frame * 2;
+        _mm512_mask_storeu_ps(pSamples,
+                mask,
+                _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pSamples), gains));
+    }
+}
+
+void addWithGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    const __m512 gains = _mm512_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm512_storeu_ps(pDest + i,
+                _mm512_fmadd_ps(_mm512_loadu_ps(pSrc + i),
+                        gains,
+                        _mm512_loadu_ps(pDest + i)));
+    }
+    if (i < numSamples) {
+        const __mmask16 mask = tailMask(numSamples - i);
+        _mm512_mask_storeu_ps(pDest + i,
+                mask,
+                _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc + i),
+                        gains,
+                        _mm512_maskz_loadu_ps(mask, pDest + i)));
+    }
+}
+
+void addWithRampingGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m512 startGains = _mm512_set1_ps(startGain);
+    const __m512 gainDeltas = _mm512_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        const SINT i = frame * 2;
+        _mm512_storeu_ps(pDest + i,
+                _mm512_fmadd_ps(_mm512_loadu_ps(pSrc + i),
+                        gains,
+                        _mm512_loadu_ps(pDest + i)));
+    }
+    if (frame < numFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        const __mmask16 mask = tailMask((numFrames - frame) * 2);
+        const SINT i = frame * 2;
+        _mm512_mask_storeu_ps(pDest + i,
+                mask,
+                _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc + i),
+                        gains,
+                        _mm512_maskz_loadu_ps(mask, pDest + i)));
+    }
+}
+
+void add2WithGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    const __m512 gains1 = _mm512_set1_ps(gain1);
+    const __m512 gains2 = _mm512_set1_ps(gain2);
+    SINT i = 0;
+    for (; i < numSamples; i += kLanes) {
+        const __mmask16 mask = i + kLanes <= numSamples
+                ? static_cast<__mmask16>(0xFFFF)
+                : tailMask(numSamples - i);
+        __m512 sum = _mm512_maskz_loadu_ps(mask, pDest + i);
+        sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc1 + i), gains1, sum);
+        sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc2 + i), gains2, sum);
+        _mm512_mask_storeu_ps(pDest + i, mask, sum);
+    }
+}
+
+void add3WithGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    const __m512 gains1 = _mm512_set1_ps(gain1);
+    const __m512 gains2 = _mm512_set1_ps(gain2);
+    const __m512 gains3 = _mm512_set1_ps(gain3);
+    SINT i = 0;
+    for (; i < numSamples; i += kLanes) {
+        const __mmask16 mask = i + kLanes <= numSamples
+                ? static_cast<__mmask16>(0xFFFF)
+                : tailMask(numSamples - i);
+        __m512 sum = _mm512_maskz_loadu_ps(mask, pDest + i);
+        sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc1 + i), gains1, sum);
+        sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc2 + i), gains2, sum);
+        sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pSrc3 + i), gains3, sum);
+        _mm512_mask_storeu_ps(pDest + i, mask, sum);
+    }
+}
+
+void copyWithGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    const __m512 gains = _mm512_set1_ps(gain);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        _mm512_storeu_ps(pDest + i,
+                _mm512_mul_ps(_mm512_loadu_ps(pSrc + i), gains));
+    }
+    if (i < numSamples) {
+        const __mmask16 mask = tailMask(numSamples - i);
+        _mm512_mask_storeu_ps(pDest + i,
+                mask,
+                _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pSrc + i), gains));
+    }
+}
+
+void copyWithRampingGainAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const __m512 startGains = _mm512_set1_ps(startGain);
+    const __m512 gainDeltas = _mm512_set1_ps(gainDelta);
+    SINT frame = 0;
+    for (; frame + kStereoFrames <= numFrames; frame += kStereoFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        const SINT i = frame * 2;
+        _mm512_storeu_ps(pDest + i, _mm512_mul_ps(_mm512_loadu_ps(pSrc + i), gains));
+    }
+    if (frame < numFrames) {
+        const __m512 gains = rampingGain512(startGains, gainDeltas, frame);
+        const __mmask16 mask = tailMask((numFrames - frame) * 2);
+        const SINT i = frame * 2;
+        _mm512_mask_storeu_ps(pDest + i,
+                mask,
+                _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pSrc + i), gains));
+    }
+}
+
+int sumAbsPerChannelAvx512(CSAMPLE* pSumAbsLeft,
+        CSAMPLE* pSumAbsRight,
+        const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    const __m512 peak = _mm512_set1_ps(CSAMPLE_PEAK);
+    const SINT numSamples = numFrames * 2;
+    // Even lanes accumulate the left and odd lanes the right channel
+    __m512 sums = _mm512_setzero_ps();
+    __mmask16 clipped = 0;
+    for (SINT i = 0; i < numSamples; i += kLanes) {
+        const __mmask16 mask = i + kLanes <= numSamples
+                ? static_cast<__mmask16>(0xFFFF)
+                : tailMask(numSamples - i);
+        const __m512 absValues = _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, pBuffer + i));
+        sums = _mm512_add_ps(sums, absValues);
+        clipped |= _mm512_cmp_ps_mask(absValues, peak, _CMP_GT_OQ);
+    }
+    *pSumAbsLeft = _mm512_mask_reduce_add_ps(kLeftLanes, sums);
+    *pSumAbsRight = _mm512_mask_reduce_add_ps(kRightLanes, sums);
+    return ((clipped & kLeftLanes) ? mixxx::sampleutil::kClippingLeft : 0) |
+            ((clipped & kRightLanes) ? mixxx::sampleutil::kClippingRight : 0);
+}
+
+CSAMPLE maxAbsAvx512(const CSAMPLE* pBuffer, SINT numSamples) {
+    __m512 maxValues = _mm512_setzero_ps();
+    for (SINT i = 0; i < numSamples; i += kLanes) {
+        const __mmask16 mask = i + kLanes <= numSamples
+                ? static_cast<__mmask16>(0xFFFF)
+                : tailMask(numSamples - i);
+        maxValues = _mm512_max_ps(maxValues,
+                _mm512_abs_ps(_mm512_maskz_loadu_ps(mask, pBuffer + i)));
+    }
+    return _mm512_reduce_max_ps(maxValues);
+}
+
+void interleaveStereoAvx512(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        const CSAMPLE* pSrc2,
+        SINT numFrames) {
+    // Indices 0-15 select from the left and 16-31 from the right channel
+    const __m512i lowIndices = _mm512_setr_epi32(
+            0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i highIndices = _mm512_setr_epi32(
+            8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        const __m512 left = _mm512_loadu_ps(pSrc1 + i);
+        const __m512 right = _mm512_loadu_ps(pSrc2 + i);
+        _mm512_storeu_ps(pDest + 2 * i,
+                _mm512_permutex2var_ps(left, lowIndices, right));
+        _mm512_storeu_ps(pDest + 2 * i + kLanes,
+                _mm512_permutex2var_ps(left, highIndices, right));
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveStereoAvx512(CSAMPLE* pDest1,
+        CSAMPLE* pDest2,
+        const CSAMPLE* pSrc,
+        SINT numFrames) {
+    const __m512i leftIndices = _mm512_setr_epi32(
+            0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i rightIndices = _mm512_setr_epi32(
+            1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        const __m512 first = _mm512_loadu_ps(pSrc + 2 * i);
+        const __m512 second = _mm512_loadu_ps(pSrc + 2 * i + kLanes);
+        _mm512_storeu_ps(pDest1 + i,
+                _mm512_permutex2var_ps(first, leftIndices, second));
+        _mm512_storeu_ps(pDest2 + i,
+                _mm512_permutex2var_ps(first, rightIndices, second));
+    }
+    for (; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+constexpr mixxx::sampleutil::Kernels kAvx512Kernels = {
+        mixxx::sampleutil::InstructionSet::Avx512,
+        "AVX-512",
+        applyGainAvx512,
+        applyRampingGainAvx512,
+        addWithGainAvx512,
+        addWithRampingGainAvx512,
+        add2WithGainAvx512,
+        add3WithGainAvx512,
+        copyWithGainAvx512,
+        copyWithRampingGainAvx512,
+        sumAbsPerChannelAvx512,
+        maxAbsAvx512,
+        interleaveStereoAvx512,
+        deinterleaveStereoAvx512,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+namespace sampleutil {
+
+const Kernels& avx512Kernels() {
+    return kAvx512Kernels;
+}
+
+} // namespace sampleutil
+
+} // namespace mixxx
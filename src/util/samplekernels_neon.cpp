@@ -0,0 +1,277 @@
+// Compiled for AArch64 where NEON is always available, see util/samplekernels.h
+#include <arm_neon.h>
+
+#include "util/samplekernels.h"
+
+namespace {
+
+// The number of samples in a vector
+constexpr SINT kLanes = 4;
+
+// The gains of the next kLanes stereo frames starting at firstFrame,
+// one vector per channel after deinterleaving with vld2q_f32()
+inline float32x4_t rampingGain128(
+        float32x4_t startGain, float32x4_t gainDelta, SINT firstFrame) {
+    const float frameOffsets[kLanes] = {0, 1, 2, 3};
+    const float32x4_t frameIndices = vaddq_f32(
+            vdupq_n_f32(static_cast<float>(firstFrame)), vld1q_f32(frameOffsets));
+    return vaddq_f32(startGain, vmulq_f32(gainDelta, frameIndices));
+}
+
+void applyGainNeon(CSAMPLE* pBuffer, CSAMPLE_GAIN gain, SINT numSamples) {
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        vst1q_f32(pBuffer + i, vmulq_n_f32(vld1q_f32(pBuffer + i), gain));
+    }
+    for (; i < numSamples; ++i) {
+        pBuffer[i] *= gain;
+    }
+}
+
+void applyRampingGainNeon(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t startGains = vdupq_n_f32(startGain);
+    const float32x4_t gainDeltas = vdupq_n_f32(gainDelta);
+    SINT frame = 0;
+    for (; frame + kLanes <= numFrames; frame += kLanes) {
+        const float32x4_t gains = rampingGain128(startGains, gainDeltas, frame);
+        float32x4x2_t samples = vld2q_f32(pBuffer + frame * 2);
+        samples.val[0] = vmulq_f32(samples.val[0], gains);
+        samples.val[1] = vmulq_f32(samples.val[1], gains);
+        vst2q_f32(pBuffer + frame * 2, samples);
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pBuffer[frame * 2] *= gain;
+        pBuffer[frame * 2 + 1] *= gain;
+    }
+}
+
+void addWithGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        vst1q_f32(pDest + i, vfmaq_n_f32(vld1q_f32(pDest + i), vld1q_f32(pSrc + i), gain));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc[i] * gain;
+    }
+}
+
+void addWithRampingGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t startGains = vdupq_n_f32(startGain);
+    const float32x4_t gainDeltas = vdupq_n_f32(gainDelta);
+    SINT frame = 0;
+    for (; frame + kLanes <= numFrames; frame += kLanes) {
+        const float32x4_t gains = rampingGain128(startGains, gainDeltas, frame);
+        const float32x4x2_t src = vld2q_f32(pSrc + frame * 2);
+        float32x4x2_t dest = vld2q_f32(pDest + frame * 2);
+        dest.val[0] = vfmaq_f32(dest.val[0], src.val[0], gains);
+        dest.val[1] = vfmaq_f32(dest.val[1], src.val[1], gains);
+        vst2q_f32(pDest + frame * 2, dest);
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pDest[frame * 2] += pSrc[frame * 2] * gain;
+        pDest[frame * 2 + 1] += pSrc[frame * 2 + 1] * gain;
+    }
+}
+
+void add2WithGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        float32x4_t sum = vld1q_f32(pDest + i);
+        sum = vfmaq_n_f32(sum, vld1q_f32(pSrc1 + i), gain1);
+        sum = vfmaq_n_f32(sum, vld1q_f32(pSrc2 + i), gain2);
+        vst1q_f32(pDest + i, sum);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2;
+    }
+}
+
+void add3WithGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        CSAMPLE_GAIN gain1,
+        const CSAMPLE* pSrc2,
+        CSAMPLE_GAIN gain2,
+        const CSAMPLE* pSrc3,
+        CSAMPLE_GAIN gain3,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        float32x4_t sum = vld1q_f32(pDest + i);
+        sum = vfmaq_n_f32(sum, vld1q_f32(pSrc1 + i), gain1);
+        sum = vfmaq_n_f32(sum, vld1q_f32(pSrc2 + i), gain2);
+        sum = vfmaq_n_f32(sum, vld1q_f32(pSrc3 + i), gain3);
+        vst1q_f32(pDest + i, sum);
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] += pSrc1[i] * gain1 + pSrc2[i] * gain2 + pSrc3[i] * gain3;
+    }
+}
+
+void copyWithGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN gain,
+        SINT numSamples) {
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        vst1q_f32(pDest + i, vmulq_n_f32(vld1q_f32(pSrc + i), gain));
+    }
+    for (; i < numSamples; ++i) {
+        pDest[i] = pSrc[i] * gain;
+    }
+}
+
+void copyWithRampingGainNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain,
+        CSAMPLE_GAIN gainDelta,
+        SINT numFrames) {
+    const float32x4_t startGains = vdupq_n_f32(startGain);
+    const float32x4_t gainDeltas = vdupq_n_f32(gainDelta);
+    SINT frame = 0;
+    for (; frame + kLanes <= numFrames; frame += kLanes) {
+        const float32x4_t gains = rampingGain128(startGains, gainDeltas, frame);
+        float32x4x2_t samples = vld2q_f32(pSrc + frame * 2);
+        samples.val[0] = vmulq_f32(samples.val[0], gains);
+        samples.val[1] = vmulq_f32(samples.val[1], gains);
+        vst2q_f32(pDest + frame * 2, samples);
+    }
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * frame;
+        pDest[frame * 2] = pSrc[frame * 2] * gain;
+        pDest[frame * 2 + 1] = pSrc[frame * 2 + 1] * gain;
+    }
+}
+
+int sumAbsPerChannelNeon(CSAMPLE* pSumAbsLeft,
+        CSAMPLE* pSumAbsRight,
+        const CSAMPLE* pBuffer,
+        SINT numFrames) {
+    const float32x4_t peak = vdupq_n_f32(CSAMPLE_PEAK);
+    float32x4_t sumsLeft = vdupq_n_f32(0);
+    float32x4_t sumsRight = vdupq_n_f32(0);
+    uint32x4_t clippedLeftLanes = vdupq_n_u32(0);
+    uint32x4_t clippedRightLanes = vdupq_n_u32(0);
+    SINT frame = 0;
+    for (; frame + kLanes <= numFrames; frame += kLanes) {
+        const float32x4x2_t samples = vld2q_f32(pBuffer + frame * 2);
+        const float32x4_t absLeft = vabsq_f32(samples.val[0]);
+        const float32x4_t absRight = vabsq_f32(samples.val[1]);
+        sumsLeft = vaddq_f32(sumsLeft, absLeft);
+        sumsRight = vaddq_f32(sumsRight, absRight);
+        clippedLeftLanes = vorrq_u32(clippedLeftLanes, vcgtq_f32(absLeft, peak));
+        clippedRightLanes = vorrq_u32(clippedRightLanes, vcgtq_f32(absRight, peak));
+    }
+    CSAMPLE sumAbsLeft = vaddvq_f32(sumsLeft);
+    CSAMPLE sumAbsRight = vaddvq_f32(sumsRight);
+    bool clippedLeft = vmaxvq_u32(clippedLeftLanes) != 0;
+    bool clippedRight = vmaxvq_u32(clippedRightLanes) != 0;
+    for (; frame < numFrames; ++frame) {
+        const CSAMPLE absLeft = pBuffer[frame * 2] < 0 ? -pBuffer[frame * 2] : pBuffer[frame * 2];
+        const CSAMPLE absRight = pBuffer[frame * 2 + 1] < 0
+                ? -pBuffer[frame * 2 + 1]
+                : pBuffer[frame * 2 + 1];
+        sumAbsLeft += absLeft;
+        sumAbsRight += absRight;
+        clippedLeft |= absLeft > CSAMPLE_PEAK;
+        clippedRight |= absRight > CSAMPLE_PEAK;
+    }
+    *pSumAbsLeft = sumAbsLeft;
+    *pSumAbsRight = sumAbsRight;
+    return (clippedLeft ? mixxx::sampleutil::kClippingLeft : 0) |
+            (clippedRight ? mixxx::sampleutil::kClippingRight : 0);
+}
+
+CSAMPLE maxAbsNeon(const CSAMPLE* pBuffer, SINT numSamples) {
+    float32x4_t maxValues = vdupq_n_f32(0);
+    SINT i = 0;
+    for (; i + kLanes <= numSamples; i += kLanes) {
+        maxValues = vmaxq_f32(maxValues, vabsq_f32(vld1q_f32(pBuffer + i)));
+    }
+    CSAMPLE max = vmaxvq_f32(maxValues);
+    for (; i < numSamples; ++i) {
+        const CSAMPLE absValue = pBuffer[i] < 0 ? -pBuffer[i] : pBuffer[i];
+        max = absValue > max ? absValue : max;
+    }
+    return max;
+}
+
+void interleaveStereoNeon(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1,
+        const CSAMPLE* pSrc2,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        float32x4x2_t samples;
+        samples.val[0] = vld1q_f32(pSrc1 + i);
+        samples.val[1] = vld1q_f32(pSrc2 + i);
+        vst2q_f32(pDest + 2 * i, samples);
+    }
+    for (; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+void deinterleaveStereoNeon(CSAMPLE* pDest1,
+        CSAMPLE* pDest2,
+        const CSAMPLE* pSrc,
+        SINT numFrames) {
+    SINT i = 0;
+    for (; i + kLanes <= numFrames; i += kLanes) {
+        const float32x4x2_t samples = vld2q_f32(pSrc + 2 * i);
+        vst1q_f32(pDest1 + i, samples.val[0]);
+        vst1q_f32(pDest2 + i, samples.val[1]);
+    }
+    for (; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+constexpr mixxx::sampleutil::Kernels kNeonKernels = {
+        mixxx::sampleutil::InstructionSet::Neon,
+        "NEON",
+        applyGainNeon,
+        applyRampingGainNeon,
+        addWithGainNeon,
+        addWithRampingGainNeon,
+        add2WithGainNeon,
+        add3WithGainNeon,
+        copyWithGainNeon,
+        copyWithRampingGainNeon,
+        sumAbsPerChannelNeon,
+        maxAbsNeon,
+        interleaveStereoNeon,
+        deinterleaveStereoNeon,
+};
+
+} // anonymous namespace
+
+namespace mixxx {
+
+namespace sampleutil {
+
+const Kernels& neonKernels() {
+    return kNeonKernels;
+}
+
+} // namespace sampleutil
+
+} // namespace mixxx
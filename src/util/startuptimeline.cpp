@@ -0,0 +1,81 @@
+#include "util/startuptimeline.h"
+
+#include <algorithm>
+
+#include "util/compatibility/qmutex.h"
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("StartupTimeline");
+
+} // anonymous namespace
+
+StartupTimeline::ConcurrentStage::ConcurrentStage(
+        StartupTimeline* pTimeline, const QString& name)
+        : m_pTimeline(pTimeline),
+          m_name(name),
+          m_begin(pTimeline->m_timer.elapsed()) {
+}
+
+StartupTimeline::ConcurrentStage::~ConcurrentStage() {
+    m_pTimeline->addStage(m_name, m_begin, m_pTimeline->m_timer.elapsed(), true);
+}
+
+StartupTimeline::StartupTimeline() {
+    m_timer.start();
+}
+
+void StartupTimeline::beginStage(const QString& name) {
+    endStage();
+    m_currentStageName = name;
+    m_currentStageBegin = m_timer.elapsed();
+}
+
+void StartupTimeline::endStage() {
+    if (m_currentStageName.isEmpty()) {
+        return;
+    }
+    addStage(m_currentStageName, m_currentStageBegin, m_timer.elapsed(), false);
+    m_currentStageName.clear();
+}
+
+void StartupTimeline::addStage(
+        const QString& name, Duration begin, Duration end, bool concurrent) {
+    const auto locker = lockMutex(&m_mutex);
+    m_stages.append(Stage{name, begin, end, concurrent});
+}
+
+void StartupTimeline::logReport() const {
+    QVector<Stage> stages;
+    {
+        const auto locker = lockMutex(&m_mutex);
+        stages = m_stages;
+    }
+    std::stable_sort(stages.begin(),
+            stages.end(),
+            [](const Stage& lhs, const Stage& rhs) {
+                return lhs.begin < rhs.begin;
+            });
+    Duration end;
+    for (const auto& stage : std::as_const(stages)) {
+        end = std::max(end, stage.end);
+    }
+    kLogger.info() << "Startup took" << end.formatMillisWithUnit();
+    for (const auto& stage : std::as_const(stages)) {
+        // Aligned columns: begin, end, duration, name
+        kLogger.info().noquote()
+                << QStringLiteral("%1 ms - %2 ms %3 ms %4%5")
+                           .arg(QString::number(stage.begin.toIntegerMillis()), 6)
+                           .arg(QString::number(stage.end.toIntegerMillis()), 6)
+                           .arg(QString::number((stage.end - stage.begin)
+                                                        .toIntegerMillis()),
+                                   6)
+                           .arg(stage.concurrent ? QStringLiteral("  | ") : QString(),
+                                   stage.name);
+    }
+}
+
+} // namespace mixxx
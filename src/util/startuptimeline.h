@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "util/duration.h"
+#include "util/performancetimer.h"
+
+namespace mixxx {
+
+/// Records the duration of the startup stages for a report in the log.
+///
+/// The stages of the GUI thread are consecutive, i.e. beginning a stage
+/// ends the previous one. Stages that run concurrently on worker threads
+/// are recorded with StartupTimeline::ConcurrentStage and may overlap
+/// with any other stage.
+class StartupTimeline {
+  public:
+    /// Measures the lifetime of the scope as a concurrent stage.
+    /// Can be used on any thread.
+    class ConcurrentStage {
+      public:
+        ConcurrentStage(StartupTimeline* pTimeline, const QString& name);
+        ~ConcurrentStage();
+
+      private:
+        StartupTimeline* const m_pTimeline;
+        const QString m_name;
+        const Duration m_begin;
+    };
+
+    StartupTimeline();
+
+    /// Ends the current stage of the GUI thread and begins the next one.
+    void beginStage(const QString& name);
+
+    /// Ends the current stage of the GUI thread.
+    void endStage();
+
+    /// Logs all stages that have been recorded so far, ordered by
+    /// their beginning.
+    void logReport() const;
+
+  private:
+    struct Stage {
+        QString name;
+        Duration begin;
+        Duration end;
+        bool concurrent;
+    };
+
+    void addStage(const QString& name, Duration begin, Duration end, bool concurrent);
+
+    PerformanceTimer m_timer;
+
+    // Only accessed by the GUI thread
+    QString m_currentStageName;
+    Duration m_currentStageBegin;
+
+    mutable QMutex m_mutex;
+    QVector<Stage> m_stages;
+};
+
+} // namespace mixxx
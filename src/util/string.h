@@ -29,6 +29,12 @@ class StringCollator {
         return m_collator.compare(s1, s2);
     }
 
+    /// Sort keys are faster to compare than the strings if the same
+    /// strings are compared repeatedly.
+    QCollatorSortKey sortKey(const QString& string) const {
+        return m_collator.sortKey(string);
+    }
+
   private:
     QCollator m_collator;
 };
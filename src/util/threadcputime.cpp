@@ -0,0 +1,36 @@
+#include "util/threadcputime.h"
+
+#if defined(__WINDOWS__)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace mixxx {
+
+Duration threadCpuTime() {
+#if defined(__WINDOWS__)
+    FILETIME creationTime;
+    FILETIME exitTime;
+    FILETIME kernelTime;
+    FILETIME userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return Duration::empty();
+    }
+    // In units of 100 ns
+    const auto toTicks = [](const FILETIME& time) {
+        return (static_cast<qint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return Duration::fromNanos((toTicks(kernelTime) + toTicks(userTime)) * 100);
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+        return Duration::empty();
+    }
+    return Duration::fromNanos(static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec);
+#else
+    return Duration::empty();
+#endif
+}
+
+} // namespace mixxx
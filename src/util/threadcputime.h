@@ -0,0 +1,11 @@
+#pragma once
+
+#include "util/duration.h"
+
+namespace mixxx {
+
+/// Returns the CPU time that has been consumed by the calling thread,
+/// or zero if not supported by the platform.
+Duration threadCpuTime();
+
+} // namespace mixxx
@@ -20,6 +20,8 @@ GuiTick::GuiTick() {
 // this is called from WaveformWidgetFactory::render in the main thread with the
 // configured waveform frame rate
 void GuiTick::process() {
+    m_controlGuiDispatcher.dispatch();
+
     m_cpuTimeLastTick += m_cpuTimer.restart();
     double cpuTimeLastTickSeconds = m_cpuTimeLastTick.toDoubleSeconds();
     m_pCOGuiTickTime->set(cpuTimeLastTickSeconds);
@@ -2,19 +2,22 @@
 
 #include <memory>
 
+#include "control/controlguidispatcher.h"
 #include "control/controlobject.h"
 #include "util/duration.h"
 #include "util/performancetimer.h"
 
 /// A helper class that manages the `gui_Tick` COs, that drive updates of the
 /// GUI from the `VSyncThread` at the user's configured FPS (possibly
-/// downsampled).
+/// downsampled). It also drives the ControlGuiDispatcher that delivers the
+/// control changes to the widgets.
 class GuiTick {
   public:
     GuiTick();
     void process();
 
   private:
+    ControlGuiDispatcher m_controlGuiDispatcher;
     std::unique_ptr<ControlObject> m_pCOGuiTickTime;
     std::unique_ptr<ControlObject> m_pCOGuiTick50ms;
     PerformanceTimer m_cpuTimer;
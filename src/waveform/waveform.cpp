@@ -1,13 +1,58 @@
 #include "waveform/waveform.h"
 
+#include <QDataStream>
 #include <QtDebug>
+#include <algorithm>
+#include <cstring>
 
 #include "analyzer/constants.h"
 #include "engine/engine.h"
 #include "proto/waveform.pb.h"
+#include "util/assert.h"
 
 using namespace mixxx::track;
 
+namespace {
+
+// The compact format stores the WaveformData records uncompressed after a
+// fixed size header, so that they can be memory-mapped while loading. All
+// header fields are little-endian.
+//
+// The magic number can't be confused with the big-endian length prefix of
+// data compressed with qCompress(), since it would amount to more than 1 GB.
+constexpr char kCompactMagic[] = {'M', 'X', 'W', 'F'};
+constexpr quint32 kCompactFormatVersion = 1;
+
+struct CompactHeader {
+    quint32 formatVersion = 0;
+    quint32 headerSize = 0;
+    quint32 recordSize = 0;
+    quint32 dataSize = 0;
+    quint32 stemCount = 0;
+    double visualSampleRate = 0;
+    double audioVisualRatio = 0;
+};
+
+bool readCompactHeader(const QByteArray& data, CompactHeader* pHeader) {
+    if (!Waveform::isCompactFormat(data) || data.size() < Waveform::kCompactHeaderSize) {
+        return false;
+    }
+    QDataStream in(data);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    in.skipRawData(sizeof(kCompactMagic));
+    in >> pHeader->formatVersion >> pHeader->headerSize >> pHeader->recordSize >>
+            pHeader->dataSize >> pHeader->stemCount >> pHeader->visualSampleRate >>
+            pHeader->audioVisualRatio;
+    return in.status() == QDataStream::Ok &&
+            pHeader->formatVersion == kCompactFormatVersion &&
+            pHeader->headerSize >= static_cast<quint32>(Waveform::kCompactHeaderSize) &&
+            pHeader->recordSize >= sizeof(WaveformFilteredData) &&
+            pHeader->stemCount <= static_cast<quint32>(mixxx::kMaxSupportedStems);
+}
+
+} // anonymous namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -22,10 +67,12 @@ Waveform::Waveform(const QByteArray& data)
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
-          m_completion(-1) {
+          m_completion(-1),
+          m_stemCount(0) {
     readByteArray(data);
 }
 
@@ -38,6 +85,7 @@ Waveform::Waveform(
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
@@ -76,6 +124,46 @@ Waveform::Waveform(
 Waveform::~Waveform() {
 }
 
+// static
+bool Waveform::isCompactFormat(const QByteArray& header) {
+    return header.size() >= static_cast<int>(sizeof(kCompactMagic)) &&
+            std::memcmp(header.constData(), kCompactMagic, sizeof(kCompactMagic)) == 0;
+}
+
+// static
+Waveform* Waveform::fromCompactFile(const QString& fileName) {
+    Waveform* pWaveform = new Waveform();
+    pWaveform->readCompactFile(fileName);
+    return pWaveform;
+}
+
+QByteArray Waveform::toCompactByteArray() const {
+    const int dataSize = getDataSize();
+    QByteArray data;
+    data.reserve(kCompactHeaderSize + dataSize * static_cast<int>(sizeof(WaveformData)));
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        out.writeRawData(kCompactMagic, sizeof(kCompactMagic));
+        out << kCompactFormatVersion
+            << static_cast<quint32>(kCompactHeaderSize)
+            << static_cast<quint32>(sizeof(WaveformData))
+            << static_cast<quint32>(dataSize)
+            << static_cast<quint32>(m_stemCount)
+            << m_visualSampleRate
+            << m_audioVisualRatio;
+    }
+    // Reserved for future header fields
+    DEBUG_ASSERT(data.size() <= kCompactHeaderSize);
+    data.append(QByteArray(kCompactHeaderSize - data.size(), '\0'));
+    if (dataSize > 0) {
+        data.append(reinterpret_cast<const char*>(m_pData),
+                dataSize * static_cast<int>(sizeof(WaveformData)));
+    }
+    return data;
+}
+
 QByteArray Waveform::toByteArray() const {
     io::Waveform waveform;
     waveform.set_visual_sample_rate(m_visualSampleRate);
@@ -121,7 +209,7 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
@@ -133,7 +221,7 @@ QByteArray Waveform::toByteArray() const {
         stem->set_units(io::Waveform::RMS);
         stem->set_channels(mixxx::kEngineChannelOutputCount);
         for (int i = 0; i < dataSize; ++i) {
-            const WaveformData& datum = m_data.at(i);
+            const WaveformData& datum = m_pData[i];
             stem->add_value(datum.stems[stemIdx]);
         }
         stemIdx++;
@@ -238,16 +326,77 @@ void Waveform::readByteArray(const QByteArray& data) {
     m_saveState = SaveState::Saved;
 }
 
+void Waveform::readCompactFile(const QString& fileName) {
+    m_mappedFile.setFileName(fileName);
+    if (!m_mappedFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open waveform" << fileName << m_mappedFile.errorString();
+        return;
+    }
+    CompactHeader header;
+    if (!readCompactHeader(m_mappedFile.peek(kCompactHeaderSize), &header)) {
+        qWarning() << "Invalid waveform header in" << fileName;
+        m_mappedFile.close();
+        return;
+    }
+    const qint64 dataBytes = static_cast<qint64>(header.dataSize) * header.recordSize;
+    if (m_mappedFile.size() < header.headerSize + dataBytes) {
+        qWarning() << "Truncated waveform" << fileName;
+        m_mappedFile.close();
+        return;
+    }
+
+    m_visualSampleRate = header.visualSampleRate;
+    m_audioVisualRatio = header.audioVisualRatio;
+    m_stemCount = static_cast<int>(header.stemCount);
+#if !defined(__WINDOWS__)
+    // Files can't be replaced while they are mapped on Windows, which
+    // would prevent reanalyzing the track
+    if (header.recordSize == sizeof(WaveformData) && header.dataSize > 0) {
+        // Copy-on-write, the data is never modified after loading
+        uchar* pMapped = m_mappedFile.map(header.headerSize,
+                dataBytes,
+                QFileDevice::MapPrivateOption);
+        if (pMapped) {
+            m_dataSize = static_cast<int>(header.dataSize);
+            m_textureStride = computeTextureStride(m_dataSize);
+            m_pData = reinterpret_cast<WaveformData*>(pMapped);
+            m_completion = m_dataSize;
+            m_saveState = SaveState::Saved;
+            return;
+        }
+    }
+#endif
+
+    // Written by a build with a different number of supported stems or
+    // the file can't be mapped
+    m_mappedFile.seek(header.headerSize);
+    const QByteArray records = m_mappedFile.read(dataBytes);
+    m_mappedFile.close();
+    if (records.size() != dataBytes) {
+        qWarning() << "Failed to read waveform" << fileName;
+        return;
+    }
+    resize(static_cast<int>(header.dataSize));
+    const std::size_t copySize = std::min<std::size_t>(header.recordSize, sizeof(WaveformData));
+    for (int i = 0; i < m_dataSize; ++i) {
+        std::memcpy(&m_pData[i], records.constData() + i * header.recordSize, copySize);
+    }
+    m_completion = m_dataSize;
+    m_saveState = SaveState::Saved;
+}
+
 void Waveform::resize(int size) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.resize(m_textureStride * m_textureStride);
+    m_pData = m_data.data();
 }
 
 void Waveform::assign(int size) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.assign(m_textureStride * m_textureStride, {});
+    m_pData = m_data.data();
     m_saveState = SaveState::SavePending;
 }
 
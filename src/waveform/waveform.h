@@ -2,6 +2,7 @@
 
 #include <QAtomicInt>
 #include <QByteArray>
+#include <QFile>
 #include <QMutex>
 #include <QSharedPointer>
 #include <QString>
@@ -39,6 +40,9 @@ class Waveform {
         Saved
     };
 
+    // The size of the header of the compact format in bytes
+    static constexpr int kCompactHeaderSize = 64;
+
     explicit Waveform(const QByteArray& pData = QByteArray());
     Waveform(
             int audioSampleRate,
@@ -49,6 +53,16 @@ class Waveform {
 
     virtual ~Waveform();
 
+    // Returns true if the data starts with the header of the compact format,
+    // otherwise it is a serialized protobuf message.
+    static bool isCompactFormat(const QByteArray& header);
+
+    // Opens a waveform that has been stored in the compact format. The
+    // records are memory-mapped instead of copied if the file has been
+    // written by a build with the same record layout. Returns an empty
+    // waveform if the file could not be read.
+    static Waveform* fromCompactFile(const QString& fileName);
+
     int getId() const {
         const auto locker = lockMutex(&m_mutex);
         return m_id;
@@ -81,6 +95,17 @@ class Waveform {
 
     QByteArray toByteArray() const;
 
+    // Serializes the waveform into the compact format, i.e. a fixed size
+    // header followed by the WaveformData records.
+    //
+    // The records are not compressed, because compressed records can't be
+    // mapped into memory and would have to be decoded and copied again.
+    // At 441 visual samples per second, 2 channels and 8 bytes per record
+    // this takes about 7 KB per second of audio, i.e. about 2 MB for a
+    // track of 5 minutes compared to about 0.6 MB for the zlib-compressed
+    // protobuf format. The summary takes less than 64 KB per track.
+    QByteArray toCompactByteArray() const;
+
     SaveState saveState() const {
         return m_saveState;
     }
@@ -110,28 +135,29 @@ class Waveform {
     // the constructor runs.
     inline int getTextureStride() const { return m_textureStride; }
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    inline int getTextureSize() const { return static_cast<int>(m_data.size()); }
+    // The size of the texture, which is larger than the data. We do not lock
+    // the mutex since m_textureStride is not changed after the constructor
+    // runs.
+    inline int getTextureSize() const { return m_textureStride * m_textureStride; }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    WaveformData* data() { return &m_data[0];}
+    // Contains at least getDataSize() elements. We do not lock the mutex
+    // since m_pData is not changed after the constructor runs.
+    WaveformData* data() { return m_pData;}
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    // Contains at least getDataSize() elements. We do not lock the mutex
+    // since m_pData is not changed after the constructor runs.
+    const WaveformData* data() const { return m_pData;}
 
     bool hasStem() const {
         return m_stemCount > 0;
@@ -141,14 +167,15 @@ class Waveform {
 
   private:
     void readByteArray(const QByteArray& data);
+    void readCompactFile(const QString& fileName);
     void resize(int size);
     void assign(int size);
 
-    inline WaveformData& at(int i) { return m_data[i];}
-    inline unsigned char& low(int i) { return m_data[i].filtered.low;}
-    inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
-    inline unsigned char& high(int i) { return m_data[i].filtered.high;}
-    inline unsigned char& all(int i) { return m_data[i].filtered.all;}
+    inline WaveformData& at(int i) { return m_pData[i];}
+    inline unsigned char& low(int i) { return m_pData[i].filtered.low;}
+    inline unsigned char& mid(int i) { return m_pData[i].filtered.mid;}
+    inline unsigned char& high(int i) { return m_pData[i].filtered.high;}
+    inline unsigned char& all(int i) { return m_pData[i].filtered.all;}
     double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
@@ -168,7 +195,12 @@ class Waveform {
     // checking when accessing the vector.
     // TODO(XXX): In the future we should switch to QVector and use the raw data
     // pointer when performance matters.
+    // It stays empty if the data is memory-mapped from m_mappedFile.
     std::vector<WaveformData> m_data;
+    // Either points to m_data or into the memory-mapped file. Not allowed
+    // to change after the constructor runs.
+    WaveformData* m_pData;
+    QFile m_mappedFile;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -40,7 +40,8 @@ ControlWidgetConnection::ControlWidgetConnection(
           m_pWidget(pBaseWidget),
           m_pControl(make_parented<ControlProxy>(key, this, ControlFlag::NoAssertIfMissing)),
           m_pValueTransformer(std::move(pTransformer)) {
-    m_pControl->connectValueChanged(this, &ControlWidgetConnection::slotControlValueChanged);
+    m_pControl->connectValueChangedOnGuiTick(
+            this, &ControlWidgetConnection::slotControlValueChanged);
 }
 
 ControlWidgetConnection::~ControlWidgetConnection() = default;